@@ -69,6 +69,25 @@ int main (int argc, char *argv[])
   ConfigStore outputConfig2;
   outputConfig2.ConfigureDefaults ();
   outputConfig2.ConfigureAttributes ();
+
+  // Output config store to binary format, and load it back
+  Config::SetDefault ("ns3::ConfigStore::Filename", StringValue ("output-attributes.bin"));
+  Config::SetDefault ("ns3::ConfigStore::FileFormat", StringValue ("Binary"));
+  Config::SetDefault ("ns3::ConfigStore::Mode", StringValue ("Save"));
+  ConfigStore outputConfig3;
+  outputConfig3.ConfigureDefaults ();
+  outputConfig3.ConfigureAttributes ();
+
+  Config::SetDefault ("ns3::ConfigExample::TestInt16", IntegerValue (-6));
+  b_obj->SetAttribute ("TestInt16", IntegerValue (-4));
+  Config::SetDefault ("ns3::ConfigStore::Mode", StringValue ("Load"));
+  ConfigStore inputConfig;
+  inputConfig.ConfigureDefaults ();
+  inputConfig.ConfigureAttributes ();
+  NS_ABORT_MSG_UNLESS (CreateObject<ConfigExample> ()->m_int16 == -5,
+                       "Cannot load ConfigExample's default value from a binary file");
+  NS_ABORT_MSG_UNLESS (b_obj->m_int16 == -3,
+                       "Cannot load ConfigExample's integer attribute from a binary file");
  
   Simulator::Run ();
 
@@ -0,0 +1,721 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "binary-config.h"
+#include "attribute-iterator.h"
+#include "attribute-default-iterator.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include "ns3/pointer.h"
+#include "ns3/object-ptr-container.h"
+#include "ns3/log.h"
+#include "ns3/config.h"
+#include "ns3/fatal-error.h"
+#include "ns3/assert.h"
+
+#include <fstream>
+#include <sstream>
+#include <limits>
+#include <cstring>
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryConfig");
+
+/**
+ * Record the objects and the values found by AttributeIterator.
+ *
+ * An object is only written to the file when a value of the object, or
+ * of one of the objects reached from it, is written.
+ */
+class BinaryConfigSave::Iterator : public AttributeIterator
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] save The records to add to.
+   */
+  Iterator (BinaryConfigSave *save)
+    : m_save (save),
+      m_roots (0)
+  {
+  }
+private:
+  /** An object being visited. */
+  struct Visit
+  {
+    struct BinaryConfigObject record;  //!< the record of the object
+    bool written;                      //!< whether the record has been written
+    uint32_t id;                       //!< the index of the written record
+  };
+  /**
+   * Start the visit of an object.
+   * \param [in] kind The kind of object record.
+   * \param [in] object The object.
+   * \param [in] attribute The attribute record, or 0.
+   * \param [in] index The index of the object.
+   */
+  void Push (enum BinaryConfigObject::Kind kind, Ptr<Object> object,
+             uint32_t attribute, uint32_t index)
+  {
+    struct Visit visit;
+    visit.record.kind = kind;
+    visit.record.parent = 0;
+    visit.record.type = m_save->AddString (object->GetInstanceTypeId ().GetName ());
+    visit.record.attribute = attribute;
+    visit.record.index = index;
+    visit.written = false;
+    visit.id = 0;
+    m_visits.push_back (visit);
+  }
+  /**
+   * \param [in] name The name of an attribute of the current object.
+   * \returns The attribute record.
+   */
+  uint32_t AddAttribute (std::string name)
+  {
+    return m_save->AddAttribute (m_visits.back ().record.type, name);
+  }
+  /** Write the records of the current object and of its parents. */
+  void Write (void)
+  {
+    for (uint32_t i = 0; i < m_visits.size (); i++)
+      {
+        if (!m_visits[i].written)
+          {
+            m_visits[i].record.parent = (i == 0) ? 0 : m_visits[i - 1].id;
+            m_visits[i].id = m_save->m_objects.size ();
+            m_visits[i].written = true;
+            m_save->m_objects.push_back (m_visits[i].record);
+          }
+      }
+  }
+  virtual void DoVisitAttribute (Ptr<Object> object, std::string name)
+  {
+    StringValue str;
+    object->GetAttribute (name, str);
+    NS_LOG_DEBUG ("Saving " << GetCurrentPath ());
+    Write ();
+    struct BinaryConfigValue value;
+    value.object = m_visits.back ().id;
+    value.attribute = AddAttribute (name);
+    value.value = m_save->AddString (str.Get ());
+    m_save->m_values.push_back (value);
+  }
+  virtual void DoStartVisitObject (Ptr<Object> object)
+  {
+    if (m_visits.empty ())
+      {
+        Push (BinaryConfigObject::ROOT, object, 0, m_roots++);
+      }
+    else
+      {
+        Push (BinaryConfigObject::AGGREGATE, object, 0, 0);
+      }
+  }
+  virtual void DoEndVisitObject (void)
+  {
+    m_visits.pop_back ();
+  }
+  virtual void DoStartVisitPointerAttribute (Ptr<Object> object, std::string name, Ptr<Object> value)
+  {
+    Push (BinaryConfigObject::POINTER, value, AddAttribute (name), 0);
+  }
+  virtual void DoEndVisitPointerAttribute (void)
+  {
+    m_visits.pop_back ();
+  }
+  virtual void DoStartVisitArrayAttribute (Ptr<Object> object, std::string name, const ObjectPtrContainerValue &vector)
+  {
+    m_arrays.push_back (AddAttribute (name));
+  }
+  virtual void DoEndVisitArrayAttribute (void)
+  {
+    m_arrays.pop_back ();
+  }
+  virtual void DoStartVisitArrayItem (const ObjectPtrContainerValue &vector, uint32_t index, Ptr<Object> item)
+  {
+    Push (BinaryConfigObject::ITEM, item, m_arrays.back (), index);
+  }
+  virtual void DoEndVisitArrayItem (void)
+  {
+    m_visits.pop_back ();
+  }
+
+  BinaryConfigSave *m_save;        //!< the records to add to
+  uint32_t m_roots;                //!< the number of root namespace objects visited
+  std::vector<struct Visit> m_visits;  //!< the objects being visited
+  std::vector<uint32_t> m_arrays;  //!< the container attributes being visited
+};
+
+BinaryConfigSave::BinaryConfigSave ()
+{
+  NS_LOG_FUNCTION (this);
+}
+BinaryConfigSave::~BinaryConfigSave ()
+{
+  NS_LOG_FUNCTION (this);
+}
+void
+BinaryConfigSave::SetFilename (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_filename = filename;
+}
+uint32_t
+BinaryConfigSave::AddString (std::string value)
+{
+  std::map<std::string, uint32_t>::const_iterator i = m_stringIndex.find (value);
+  if (i != m_stringIndex.end ())
+    {
+      return i->second;
+    }
+  uint32_t index = m_strings.size ();
+  m_strings.push_back (value);
+  m_stringIndex.insert (std::make_pair (value, index));
+  return index;
+}
+uint32_t
+BinaryConfigSave::AddAttribute (uint32_t type, std::string name)
+{
+  std::pair<uint32_t, uint32_t> key = std::make_pair (type, AddString (name));
+  std::map<std::pair<uint32_t, uint32_t>, uint32_t>::const_iterator i = m_attributeIndex.find (key);
+  if (i != m_attributeIndex.end ())
+    {
+      return i->second;
+    }
+  struct BinaryConfigAttribute attribute;
+  attribute.type = key.first;
+  attribute.name = key.second;
+  uint32_t index = m_attributes.size ();
+  m_attributes.push_back (attribute);
+  m_attributeIndex.insert (std::make_pair (key, index));
+  return index;
+}
+void
+BinaryConfigSave::Default (void)
+{
+  NS_LOG_FUNCTION (this);
+  class BinaryDefaultIterator : public AttributeDefaultIterator
+  {
+public:
+    BinaryDefaultIterator (BinaryConfigSave *save)
+      : m_save (save) {}
+private:
+    virtual void VisitAttribute (TypeId tid, std::string name, std::string defaultValue, uint32_t index) {
+      NS_LOG_DEBUG ("Saving " << tid.GetName () << "::" << name);
+      struct BinaryConfigSetting setting;
+      setting.name = m_save->AddAttribute (m_save->AddString (tid.GetName ()), name);
+      setting.value = m_save->AddString (defaultValue);
+      m_save->m_defaults.push_back (setting);
+    }
+    BinaryConfigSave *m_save;
+  };
+
+  m_defaults.clear ();
+  BinaryDefaultIterator iterator = BinaryDefaultIterator (this);
+  iterator.Iterate ();
+  Write ();
+}
+void
+BinaryConfigSave::Global (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_globals.clear ();
+  for (GlobalValue::Iterator i = GlobalValue::Begin (); i != GlobalValue::End (); ++i)
+    {
+      StringValue value;
+      (*i)->GetValue (value);
+      NS_LOG_LOGIC ("Saving " << (*i)->GetName ());
+      struct BinaryConfigSetting setting;
+      setting.name = AddString ((*i)->GetName ());
+      setting.value = AddString (value.Get ());
+      m_globals.push_back (setting);
+    }
+  Write ();
+}
+void
+BinaryConfigSave::Attributes (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_objects.clear ();
+  m_values.clear ();
+  Iterator iterator = Iterator (this);
+  iterator.Iterate ();
+  Write ();
+}
+void
+BinaryConfigSave::Write (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<uint32_t> offsets;
+  uint32_t stringBytes = 0;
+  for (std::vector<std::string>::const_iterator i = m_strings.begin (); i != m_strings.end (); i++)
+    {
+      offsets.push_back (stringBytes);
+      stringBytes += i->size () + 1;
+    }
+  struct BinaryConfigHeader header;
+  header.magic = BinaryConfigLoad::MAGIC;
+  header.version = BinaryConfigLoad::VERSION;
+  header.nStrings = m_strings.size ();
+  header.stringBytes = stringBytes;
+  header.nAttributes = m_attributes.size ();
+  header.nDefaults = m_defaults.size ();
+  header.nGlobals = m_globals.size ();
+  header.nObjects = m_objects.size ();
+  header.nValues = m_values.size ();
+
+  std::ofstream os (m_filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!os.is_open ())
+    {
+      NS_FATAL_ERROR ("Could not open " << m_filename);
+    }
+  os.write ((const char *)&header, sizeof (header));
+  if (!offsets.empty ())
+    {
+      os.write ((const char *)&offsets[0], offsets.size () * sizeof (uint32_t));
+    }
+  if (!m_attributes.empty ())
+    {
+      os.write ((const char *)&m_attributes[0], m_attributes.size () * sizeof (struct BinaryConfigAttribute));
+    }
+  if (!m_defaults.empty ())
+    {
+      os.write ((const char *)&m_defaults[0], m_defaults.size () * sizeof (struct BinaryConfigSetting));
+    }
+  if (!m_globals.empty ())
+    {
+      os.write ((const char *)&m_globals[0], m_globals.size () * sizeof (struct BinaryConfigSetting));
+    }
+  if (!m_objects.empty ())
+    {
+      os.write ((const char *)&m_objects[0], m_objects.size () * sizeof (struct BinaryConfigObject));
+    }
+  if (!m_values.empty ())
+    {
+      os.write ((const char *)&m_values[0], m_values.size () * sizeof (struct BinaryConfigValue));
+    }
+  for (std::vector<std::string>::const_iterator i = m_strings.begin (); i != m_strings.end (); i++)
+    {
+      os.write (i->c_str (), i->size () + 1);
+    }
+  if (!os.good ())
+    {
+      NS_FATAL_ERROR ("Could not write " << m_filename);
+    }
+}
+
+BinaryConfigLoad::BinaryConfigLoad ()
+  : m_map (0),
+    m_size (0),
+    m_header (0),
+    m_stringOffsets (0),
+    m_attributeRecords (0),
+    m_defaults (0),
+    m_globals (0),
+    m_objects (0),
+    m_values (0),
+    m_strings (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+BinaryConfigLoad::~BinaryConfigLoad ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_map != 0)
+    {
+      munmap (m_map, m_size);
+      m_map = 0;
+    }
+}
+void
+BinaryConfigLoad::SetFilename (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::string error = Open (filename);
+  if (error != "")
+    {
+      NS_FATAL_ERROR (error);
+    }
+}
+std::string
+BinaryConfigLoad::Open (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  if (m_map != 0)
+    {
+      munmap (m_map, m_size);
+      m_map = 0;
+      m_header = 0;
+    }
+  m_filename = filename;
+  std::ostringstream error;
+  int fd = open (filename.c_str (), O_RDONLY);
+  if (fd == -1)
+    {
+      error << "Could not open " << filename << ": " << std::strerror (errno);
+      return error.str ();
+    }
+  struct stat st;
+  if (fstat (fd, &st) == -1)
+    {
+      error << "Could not stat " << filename << ": " << std::strerror (errno);
+      close (fd);
+      return error.str ();
+    }
+  if (st.st_size < (off_t)sizeof (struct BinaryConfigHeader)
+      || st.st_size > std::numeric_limits<uint32_t>::max ())
+    {
+      error << filename << " is not a binary config file";
+      close (fd);
+      return error.str ();
+    }
+  m_size = st.st_size;
+  void *map = mmap (0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (map == MAP_FAILED)
+    {
+      error << "Could not map " << filename << ": " << std::strerror (errno);
+      return error.str ();
+    }
+  m_map = (uint8_t *)map;
+  m_header = (const struct BinaryConfigHeader *)m_map;
+  if (m_header->magic != MAGIC)
+    {
+      error << filename << " is not a binary config file, or was written "
+            << "on a machine with another byte order";
+    }
+  else if (m_header->version != VERSION)
+    {
+      error << filename << " has version " << m_header->version
+            << " instead of " << VERSION;
+    }
+  else if (!Check ())
+    {
+      error << filename << " is truncated or corrupted";
+    }
+  if (error.str () != "")
+    {
+      munmap (m_map, m_size);
+      m_map = 0;
+      m_header = 0;
+    }
+  return error.str ();
+}
+bool
+BinaryConfigLoad::Check (void)
+{
+  NS_LOG_FUNCTION (this);
+  const struct BinaryConfigHeader *h = m_header;
+  uint64_t size = sizeof (struct BinaryConfigHeader)
+    + (uint64_t)h->nStrings * sizeof (uint32_t)
+    + (uint64_t)h->nAttributes * sizeof (struct BinaryConfigAttribute)
+    + (uint64_t)h->nDefaults * sizeof (struct BinaryConfigSetting)
+    + (uint64_t)h->nGlobals * sizeof (struct BinaryConfigSetting)
+    + (uint64_t)h->nObjects * sizeof (struct BinaryConfigObject)
+    + (uint64_t)h->nValues * sizeof (struct BinaryConfigValue)
+    + h->stringBytes;
+  if (size != m_size)
+    {
+      NS_LOG_WARN (m_filename << " has " << m_size << " bytes instead of " << size);
+      return false;
+    }
+  const uint8_t *p = m_map + sizeof (struct BinaryConfigHeader);
+  m_stringOffsets = (const uint32_t *)p;
+  p += h->nStrings * sizeof (uint32_t);
+  m_attributeRecords = (const struct BinaryConfigAttribute *)p;
+  p += h->nAttributes * sizeof (struct BinaryConfigAttribute);
+  m_defaults = (const struct BinaryConfigSetting *)p;
+  p += h->nDefaults * sizeof (struct BinaryConfigSetting);
+  m_globals = (const struct BinaryConfigSetting *)p;
+  p += h->nGlobals * sizeof (struct BinaryConfigSetting);
+  m_objects = (const struct BinaryConfigObject *)p;
+  p += h->nObjects * sizeof (struct BinaryConfigObject);
+  m_values = (const struct BinaryConfigValue *)p;
+  p += h->nValues * sizeof (struct BinaryConfigValue);
+  m_strings = (const char *)p;
+
+  // Check all the indices once, so that the records can be used as is.
+  bool ok = h->stringBytes == 0 || m_strings[h->stringBytes - 1] == 0;
+  for (uint32_t i = 0; ok && i < h->nStrings; i++)
+    {
+      ok = m_stringOffsets[i] < h->stringBytes;
+    }
+  for (uint32_t i = 0; ok && i < h->nAttributes; i++)
+    {
+      ok = m_attributeRecords[i].type < h->nStrings && m_attributeRecords[i].name < h->nStrings;
+    }
+  for (uint32_t i = 0; ok && i < h->nDefaults; i++)
+    {
+      ok = m_defaults[i].name < h->nAttributes && m_defaults[i].value < h->nStrings;
+    }
+  for (uint32_t i = 0; ok && i < h->nGlobals; i++)
+    {
+      ok = m_globals[i].name < h->nStrings && m_globals[i].value < h->nStrings;
+    }
+  for (uint32_t i = 0; ok && i < h->nObjects; i++)
+    {
+      const struct BinaryConfigObject &o = m_objects[i];
+      ok = o.kind <= BinaryConfigObject::ITEM && o.type < h->nStrings
+        && (o.kind == BinaryConfigObject::ROOT || o.parent < i)
+        && (o.kind < BinaryConfigObject::POINTER || o.attribute < h->nAttributes);
+    }
+  for (uint32_t i = 0; ok && i < h->nValues; i++)
+    {
+      ok = m_values[i].object < h->nObjects && m_values[i].attribute < h->nAttributes
+        && m_values[i].value < h->nStrings;
+    }
+  if (!ok)
+    {
+      NS_LOG_WARN (m_filename << " has an invalid index");
+      return false;
+    }
+  m_types.assign (h->nStrings, TypeId ());
+  m_typeState.assign (h->nStrings, 0);
+  struct Attribute attribute;
+  attribute.resolved = false;
+  attribute.found = false;
+  attribute.index = 0;
+  m_attributes.assign (h->nAttributes, attribute);
+  m_converted.clear ();
+  return true;
+}
+const char *
+BinaryConfigLoad::GetString (uint32_t i) const
+{
+  return m_strings + m_stringOffsets[i];
+}
+bool
+BinaryConfigLoad::LookupType (uint32_t name, TypeId *tid)
+{
+  if (m_typeState[name] == 0)
+    {
+      m_typeState[name] = TypeId::LookupByNameFailSafe (GetString (name), &m_types[name]) ? 1 : 2;
+    }
+  *tid = m_types[name];
+  return m_typeState[name] == 1;
+}
+const struct BinaryConfigLoad::Attribute &
+BinaryConfigLoad::GetAttribute (uint32_t i)
+{
+  struct Attribute &attribute = m_attributes[i];
+  if (attribute.resolved)
+    {
+      return attribute;
+    }
+  attribute.resolved = true;
+  const struct BinaryConfigAttribute &record = m_attributeRecords[i];
+  if (!LookupType (record.type, &attribute.tid))
+    {
+      NS_LOG_WARN ("No TypeId " << GetString (record.type));
+      return attribute;
+    }
+  std::string name = GetString (record.name);
+  for (attribute.index = 0; attribute.index < attribute.tid.GetAttributeN (); attribute.index++)
+    {
+      attribute.info = attribute.tid.GetAttribute (attribute.index);
+      if (attribute.info.name == name)
+        {
+          attribute.found = true;
+          return attribute;
+        }
+    }
+  // The attribute of an object may be defined by a parent of its TypeId.
+  attribute.found = attribute.tid.LookupAttributeByName (name, &attribute.info);
+  if (!attribute.found)
+    {
+      NS_LOG_WARN ("No attribute " << name << " in " << attribute.tid.GetName ());
+    }
+  return attribute;
+}
+Ptr<const AttributeValue>
+BinaryConfigLoad::GetValue (uint32_t attribute, uint32_t value)
+{
+  std::pair<uint32_t, uint32_t> key = std::make_pair (attribute, value);
+  std::map<std::pair<uint32_t, uint32_t>, Ptr<const AttributeValue> >::const_iterator i = m_converted.find (key);
+  if (i != m_converted.end ())
+    {
+      return i->second;
+    }
+  const struct Attribute &a = GetAttribute (attribute);
+  Ptr<const AttributeValue> v = a.info.checker->CreateValidValue (StringValue (GetString (value)));
+  if (v == 0)
+    {
+      NS_FATAL_ERROR ("Invalid value \"" << GetString (value) << "\" for "
+                      << a.tid.GetName () << "::" << a.info.name);
+    }
+  m_converted.insert (std::make_pair (key, v));
+  return v;
+}
+void
+BinaryConfigLoad::Default (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_header != 0, "No binary config file was loaded");
+  for (uint32_t i = 0; i < m_header->nDefaults; i++)
+    {
+      const struct Attribute &a = GetAttribute (m_defaults[i].name);
+      if (!a.found || a.index == a.tid.GetAttributeN ())
+        {
+          const struct BinaryConfigAttribute &record = m_attributeRecords[m_defaults[i].name];
+          NS_FATAL_ERROR ("Could not set default value for " << GetString (record.type)
+                          << "::" << GetString (record.name));
+        }
+      NS_LOG_DEBUG ("name=" << a.tid.GetName () << "::" << a.info.name
+                    << ", value=" << GetString (m_defaults[i].value));
+      Ptr<const AttributeValue> value = GetValue (m_defaults[i].name, m_defaults[i].value);
+      TypeId tid = a.tid;
+      tid.SetAttributeInitialValue (a.index, value);
+    }
+}
+void
+BinaryConfigLoad::Global (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_header != 0, "No binary config file was loaded");
+  for (uint32_t i = 0; i < m_header->nGlobals; i++)
+    {
+      NS_LOG_DEBUG ("name=" << GetString (m_globals[i].name)
+                    << ", value=" << GetString (m_globals[i].value));
+      Config::SetGlobal (GetString (m_globals[i].name), StringValue (GetString (m_globals[i].value)));
+    }
+}
+Ptr<Object>
+BinaryConfigLoad::LookupObject (const struct BinaryConfigObject &record, Ptr<Object> parent)
+{
+  TypeId tid;
+  if (!LookupType (record.type, &tid))
+    {
+      return 0;
+    }
+  Ptr<Object> object = 0;
+  if (record.kind == BinaryConfigObject::ROOT)
+    {
+      if (record.index < Config::GetRootNamespaceObjectN ())
+        {
+          object = Config::GetRootNamespaceObject (record.index);
+        }
+    }
+  else if (parent == 0)
+    {
+      return 0;
+    }
+  else if (record.kind == BinaryConfigObject::AGGREGATE)
+    {
+      object = parent->GetObject<Object> (tid);
+    }
+  else
+    {
+      const struct Attribute &a = GetAttribute (record.attribute);
+      if (!a.found)
+        {
+          return 0;
+        }
+      if (record.kind == BinaryConfigObject::POINTER)
+        {
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (a.info.checker)) == 0)
+            {
+              return 0;
+            }
+          PointerValue pointer;
+          a.info.accessor->Get (PeekPointer (parent), pointer);
+          object = pointer.Get<Object> ();
+        }
+      else
+        {
+          const ObjectPtrContainerAccessor *accessor =
+            dynamic_cast<const ObjectPtrContainerAccessor *> (PeekPointer (a.info.accessor));
+          uint32_t n;
+          if (accessor == 0 || !accessor->GetN (PeekPointer (parent), &n))
+            {
+              return 0;
+            }
+          // The index of an item is usually its position.
+          uint32_t index;
+          bool found = false;
+          if (record.index < n)
+            {
+              object = accessor->Get (PeekPointer (parent), record.index, &index);
+              found = (index == record.index);
+            }
+          for (uint32_t i = 0; !found && i < n; i++)
+            {
+              object = accessor->Get (PeekPointer (parent), i, &index);
+              found = (index == record.index);
+            }
+          if (!found)
+            {
+              object = 0;
+            }
+        }
+    }
+  // The attributes of the file were found in the saved TypeId; they can
+  // only be set on an object of this TypeId or of a subclass.
+  if (object != 0 && object->GetInstanceTypeId () != tid
+      && !object->GetInstanceTypeId ().IsChildOf (tid))
+    {
+      NS_LOG_WARN ("Object " << object->GetInstanceTypeId ().GetName ()
+                   << " is not a " << tid.GetName ());
+      return 0;
+    }
+  return object;
+}
+void
+BinaryConfigLoad::Attributes (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_header != 0, "No binary config file was loaded");
+  // The parent of each object precedes it.
+  std::vector<Ptr<Object> > objects;
+  objects.reserve (m_header->nObjects);
+  for (uint32_t i = 0; i < m_header->nObjects; i++)
+    {
+      const struct BinaryConfigObject &record = m_objects[i];
+      Ptr<Object> parent = (record.kind == BinaryConfigObject::ROOT) ? 0 : objects[record.parent];
+      objects.push_back (LookupObject (record, parent));
+    }
+  for (uint32_t i = 0; i < m_header->nValues; i++)
+    {
+      const struct BinaryConfigValue &record = m_values[i];
+      Ptr<Object> object = objects[record.object];
+      if (object == 0)
+        {
+          continue;
+        }
+      const struct Attribute &a = GetAttribute (record.attribute);
+      if (!a.found || !(a.info.flags & TypeId::ATTR_SET))
+        {
+          continue;
+        }
+      NS_LOG_DEBUG ("object=" << record.object << ", name=" << a.info.name
+                    << ", value=" << GetString (record.value));
+      Ptr<const AttributeValue> value = GetValue (record.attribute, record.value);
+      if (!a.info.accessor->Set (PeekPointer (object), *value))
+        {
+          NS_FATAL_ERROR ("Could not set " << a.tid.GetName () << "::" << a.info.name
+                          << " to \"" << GetString (record.value) << "\"");
+        }
+    }
+}
+
+} // namespace ns3
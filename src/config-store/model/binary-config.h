@@ -0,0 +1,268 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_CONFIG_H
+#define BINARY_CONFIG_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+#include "ns3/type-id.h"
+#include "ns3/object.h"
+#include "file-config.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup configstore
+ *
+ * The header of a binary config file.
+ *
+ * A binary config file holds, in this order, the header, the offsets
+ * of the strings, the attribute, default, global, object and value
+ * records, and the strings.  All the fields are 32-bit integers in the
+ * byte order of the machine which wrote the file, and all the strings
+ * (TypeId names, attribute names and values) are stored once and
+ * referred to by their index.
+ *
+ * The objects are stored as a tree which mirrors the walk of
+ * AttributeIterator: each object is reached from its parent through an
+ * aggregation, a pointer attribute or an item of a container attribute,
+ * so loading the values does not parse any Config path.
+ */
+struct BinaryConfigHeader
+{
+  uint32_t magic;        //!< BinaryConfigLoad::MAGIC
+  uint32_t version;      //!< BinaryConfigLoad::VERSION
+  uint32_t nStrings;     //!< number of strings
+  uint32_t stringBytes;  //!< size of the strings, with their terminating nul
+  uint32_t nAttributes;  //!< number of attribute records
+  uint32_t nDefaults;    //!< number of default records
+  uint32_t nGlobals;     //!< number of global records
+  uint32_t nObjects;     //!< number of object records
+  uint32_t nValues;      //!< number of value records
+};
+
+/**
+ * \ingroup configstore
+ *
+ * An attribute of a TypeId in a binary config file.
+ */
+struct BinaryConfigAttribute
+{
+  uint32_t type;  //!< the TypeId name
+  uint32_t name;  //!< the attribute name
+};
+
+/**
+ * \ingroup configstore
+ *
+ * A default value or a global value in a binary config file.
+ */
+struct BinaryConfigSetting
+{
+  uint32_t name;   //!< the attribute record, or the global value name
+  uint32_t value;  //!< the value
+};
+
+/**
+ * \ingroup configstore
+ *
+ * An object in a binary config file.
+ */
+struct BinaryConfigObject
+{
+  /** How the object is reached from its parent. */
+  enum Kind
+  {
+    ROOT,       //!< a root namespace object, with no parent
+    AGGREGATE,  //!< an object aggregated to the parent
+    POINTER,    //!< the value of a pointer attribute of the parent
+    ITEM        //!< an item of a container attribute of the parent
+  };
+  uint32_t kind;       //!< a Kind
+  uint32_t parent;     //!< the parent object record, which precedes this one
+  uint32_t type;       //!< the TypeId name of the object
+  uint32_t attribute;  //!< the attribute record of a POINTER or ITEM
+  uint32_t index;      //!< the root namespace index of a ROOT, or the index of an ITEM
+};
+
+/**
+ * \ingroup configstore
+ *
+ * An attribute value of an object in a binary config file.
+ */
+struct BinaryConfigValue
+{
+  uint32_t object;     //!< the object record
+  uint32_t attribute;  //!< the attribute record, of the TypeId of the object
+  uint32_t value;      //!< the value
+};
+
+/**
+ * \ingroup configstore
+ *
+ * Save a configuration in a binary config file.
+ *
+ * The file is rewritten at the end of each call of Default, Global
+ * and Attributes.
+ */
+class BinaryConfigSave : public FileConfig
+{
+public:
+  BinaryConfigSave ();
+  virtual ~BinaryConfigSave ();
+  virtual void SetFilename (std::string filename);
+  virtual void Default (void);
+  virtual void Global (void);
+  virtual void Attributes (void);
+private:
+  class Iterator;
+  /**
+   * \param [in] value A string.
+   * \returns The index of the string.
+   */
+  uint32_t AddString (std::string value);
+  /**
+   * \param [in] type The index of the TypeId name.
+   * \param [in] name The attribute name.
+   * \returns The index of the attribute record.
+   */
+  uint32_t AddAttribute (uint32_t type, std::string name);
+  /** Write the file. */
+  void Write (void);
+
+  std::string m_filename;                          //!< the file name
+  std::vector<std::string> m_strings;              //!< the strings
+  std::map<std::string, uint32_t> m_stringIndex;   //!< the index of each string
+  std::vector<struct BinaryConfigAttribute> m_attributes;  //!< the attribute records
+  /** The index of each attribute record. */
+  std::map<std::pair<uint32_t, uint32_t>, uint32_t> m_attributeIndex;
+  std::vector<struct BinaryConfigSetting> m_defaults;  //!< the default records
+  std::vector<struct BinaryConfigSetting> m_globals;   //!< the global records
+  std::vector<struct BinaryConfigObject> m_objects;    //!< the object records
+  std::vector<struct BinaryConfigValue> m_values;      //!< the value records
+};
+
+/**
+ * \ingroup configstore
+ *
+ * Load a configuration from a binary config file.
+ *
+ * The file is mapped in memory.  Each TypeId, attribute and object of
+ * the file is looked up once, and each value is converted once for
+ * each attribute it is set to, however many objects it is set on.
+ */
+class BinaryConfigLoad : public FileConfig
+{
+public:
+  /** The first field of a binary config file. */
+  static const uint32_t MAGIC = 0x6e733363;
+  /** The version of the format of a binary config file. */
+  static const uint32_t VERSION = 1;
+
+  BinaryConfigLoad ();
+  virtual ~BinaryConfigLoad ();
+  /**
+   * Map a binary config file and check its records.
+   *
+   * \param [in] filename The file name.
+   * \returns An empty string if the file can be loaded, or else the
+   *          reason why it cannot.
+   */
+  std::string Open (std::string filename);
+  /**
+   * Map a binary config file and check its records, or abort.
+   *
+   * \param [in] filename The file name.
+   */
+  virtual void SetFilename (std::string filename);
+  virtual void Default (void);
+  virtual void Global (void);
+  virtual void Attributes (void);
+private:
+  /** An attribute record, once looked up. */
+  struct Attribute
+  {
+    bool resolved;  //!< whether the attribute has been looked up
+    bool found;     //!< whether the TypeId and the attribute exist
+    TypeId tid;     //!< the TypeId
+    /** The index of the attribute in the TypeId, or GetAttributeN if inherited. */
+    uint32_t index;
+    struct TypeId::AttributeInformation info;  //!< the attribute
+  };
+  /**
+   * Check the records of the file.
+   * \returns \c true if the file has the size given by its header and
+   *          all its indices are valid.
+   */
+  bool Check (void);
+  /**
+   * \param [in] i The index of a string.
+   * \returns The string.
+   */
+  const char * GetString (uint32_t i) const;
+  /**
+   * Look up a TypeId, once.
+   * \param [in] name The index of the TypeId name.
+   * \param [out] tid The TypeId.
+   * \returns \c true if the TypeId exists.
+   */
+  bool LookupType (uint32_t name, TypeId *tid);
+  /**
+   * Look up the TypeId and the attribute of an attribute record.
+   * \param [in] i The index of the attribute record.
+   * \returns The attribute.
+   */
+  const struct Attribute & GetAttribute (uint32_t i);
+  /**
+   * Look up an object of the file.
+   * \param [in] record The object record.
+   * \param [in] parent The parent object, if the record has one.
+   * \returns The object, or 0 if there is no such object.
+   */
+  Ptr<Object> LookupObject (const struct BinaryConfigObject &record, Ptr<Object> parent);
+  /**
+   * Convert a value for an attribute, once.
+   * \param [in] attribute The index of the attribute record.
+   * \param [in] value The index of the value.
+   * \returns The value.
+   */
+  Ptr<const AttributeValue> GetValue (uint32_t attribute, uint32_t value);
+
+  std::string m_filename;   //!< the file name
+  uint8_t *m_map;           //!< the file mapped in memory
+  uint32_t m_size;          //!< the size of the file
+  const struct BinaryConfigHeader *m_header;       //!< the header
+  const uint32_t *m_stringOffsets;                 //!< the offsets of the strings
+  const struct BinaryConfigAttribute *m_attributeRecords;  //!< the attribute records
+  const struct BinaryConfigSetting *m_defaults;    //!< the default records
+  const struct BinaryConfigSetting *m_globals;     //!< the global records
+  const struct BinaryConfigObject *m_objects;      //!< the object records
+  const struct BinaryConfigValue *m_values;        //!< the value records
+  const char *m_strings;                           //!< the strings
+  std::vector<TypeId> m_types;                     //!< the TypeIds looked up, by name
+  /** Whether each TypeId has been looked up (1), or is missing (2). */
+  std::vector<uint8_t> m_typeState;
+  std::vector<struct Attribute> m_attributes;      //!< the attributes looked up
+  /** The values converted, by attribute record and value. */
+  std::map<std::pair<uint32_t, uint32_t>, Ptr<const AttributeValue> > m_converted;
+};
+
+} // namespace ns3
+
+#endif /* BINARY_CONFIG_H */
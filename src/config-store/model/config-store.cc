@@ -20,6 +20,7 @@
 
 #include "config-store.h"
 #include "raw-text-config.h"
+#include "binary-config.h"
 #include "ns3/abort.h"
 #include "ns3/string.h"
 #include "ns3/log.h"
@@ -67,7 +68,8 @@ ConfigStore::GetTypeId (void)
                    EnumValue (ConfigStore::RAW_TEXT),
                    MakeEnumAccessor (&ConfigStore::SetFileFormat),
                    MakeEnumChecker (ConfigStore::RAW_TEXT, "RawText",
-                                    ConfigStore::XML, "Xml"))
+                                    ConfigStore::XML, "Xml",
+                                    ConfigStore::BINARY, "Binary"))
   ;
   return tid;
 }
@@ -128,6 +130,21 @@ ConfigStore::ConfigStore ()
           m_file = new NoneFileConfig ();
         }
     }
+  if (m_fileFormat == ConfigStore::BINARY)
+    {
+      if (m_mode == ConfigStore::SAVE)
+        {
+          m_file = new BinaryConfigSave ();
+        }
+      else if (m_mode == ConfigStore::LOAD)
+        {
+          m_file = new BinaryConfigLoad ();
+        }
+      else
+        {
+          m_file = new NoneFileConfig ();
+        }
+    }
   m_file->SetFilename (m_filename);
   NS_LOG_FUNCTION (this << ": format: " << m_fileFormat
                 << ", mode: " << m_mode
@@ -195,6 +212,7 @@ operator << (std::ostream & os, ConfigStore::FileFormat & format)
     {
     case ConfigStore::XML:       os << "XML";       break;
     case ConfigStore::RAW_TEXT:  os << "RAW_TEXT";  break;
+    case ConfigStore::BINARY:    os << "BINARY";    break;
     }
   return os;
 }
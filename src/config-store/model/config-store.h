@@ -61,7 +61,8 @@ public:
   };
   enum FileFormat {
     XML,
-    RAW_TEXT
+    RAW_TEXT,
+    BINARY
   };
   static TypeId GetTypeId (void);
   virtual TypeId GetInstanceTypeId (void) const;
@@ -0,0 +1,320 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/object.h"
+#include "ns3/config.h"
+#include "ns3/integer.h"
+#include "ns3/pointer.h"
+#include "ns3/global-value.h"
+#include "../model/binary-config.h"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup configstore
+ * An object with an integer attribute and a pointer attribute.
+ */
+class BinaryConfigTestObject : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::BinaryConfigTestObject")
+      .SetParent<Object> ()
+      .AddConstructor<BinaryConfigTestObject> ()
+      .AddAttribute ("TestInt16", "help text",
+                     IntegerValue (-2),
+                     MakeIntegerAccessor (&BinaryConfigTestObject::m_int16),
+                     MakeIntegerChecker<int16_t> ())
+      .AddAttribute ("TestPtr", "help text",
+                     PointerValue (),
+                     MakePointerAccessor (&BinaryConfigTestObject::m_ptr),
+                     MakePointerChecker<BinaryConfigTestObject> ())
+    ;
+    return tid;
+  }
+  int16_t m_int16;                        //!< The integer attribute.
+  Ptr<BinaryConfigTestObject> m_ptr;      //!< The pointer attribute.
+};
+
+NS_OBJECT_ENSURE_REGISTERED (BinaryConfigTestObject);
+
+/**
+ * \ingroup configstore
+ * An object aggregated to a BinaryConfigTestObject.
+ */
+class BinaryConfigTestAggregate : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::BinaryConfigTestAggregate")
+      .SetParent<Object> ()
+      .AddConstructor<BinaryConfigTestAggregate> ()
+      .AddAttribute ("TestInt16", "help text",
+                     IntegerValue (-2),
+                     MakeIntegerAccessor (&BinaryConfigTestAggregate::m_int16),
+                     MakeIntegerChecker<int16_t> ())
+    ;
+    return tid;
+  }
+  int16_t m_int16;                        //!< The integer attribute.
+};
+
+NS_OBJECT_ENSURE_REGISTERED (BinaryConfigTestAggregate);
+
+/** A global value saved in a binary config file. */
+static GlobalValue g_binaryConfigTestGlobal ("BinaryConfigTestGlobal", "help text",
+                                             IntegerValue (1),
+                                             MakeIntegerChecker<int32_t> ());
+
+/**
+ * \ingroup configstore
+ * Save the defaults, a global value and the attributes of a tree of
+ * objects in a binary config file, change them, and load them back.
+ */
+class BinaryConfigRoundTripTestCase : public TestCase
+{
+public:
+  BinaryConfigRoundTripTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+BinaryConfigRoundTripTestCase::BinaryConfigRoundTripTestCase ()
+  : TestCase ("Check a binary config file round trip")
+{
+}
+
+void
+BinaryConfigRoundTripTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("binary-config-round-trip.bin");
+
+  Config::SetDefault ("ns3::BinaryConfigTestObject::TestInt16", IntegerValue (-5));
+  Ptr<BinaryConfigTestObject> root = CreateObject<BinaryConfigTestObject> ();
+  root->m_ptr = CreateObject<BinaryConfigTestObject> ();
+  Ptr<BinaryConfigTestAggregate> aggregate = CreateObject<BinaryConfigTestAggregate> ();
+  root->AggregateObject (aggregate);
+  root->m_int16 = -3;
+  root->m_ptr->m_int16 = -7;
+  aggregate->m_int16 = -9;
+  g_binaryConfigTestGlobal.SetValue (IntegerValue (2));
+  Config::RegisterRootNamespaceObject (root);
+
+  BinaryConfigSave save;
+  save.SetFilename (filename);
+  save.Default ();
+  save.Global ();
+  save.Attributes ();
+
+  Config::SetDefault ("ns3::BinaryConfigTestObject::TestInt16", IntegerValue (-6));
+  root->m_int16 = 0;
+  root->m_ptr->m_int16 = 0;
+  aggregate->m_int16 = 0;
+  g_binaryConfigTestGlobal.SetValue (IntegerValue (3));
+
+  BinaryConfigLoad load;
+  NS_TEST_ASSERT_MSG_EQ (load.Open (filename), "", "Could not open a binary config file");
+  load.Default ();
+  load.Global ();
+  load.Attributes ();
+
+  NS_TEST_EXPECT_MSG_EQ (CreateObject<BinaryConfigTestObject> ()->m_int16, -5, "Default value not loaded");
+  NS_TEST_EXPECT_MSG_EQ (root->m_int16, -3, "Attribute of a root object not loaded");
+  NS_TEST_EXPECT_MSG_EQ (root->m_ptr->m_int16, -7, "Attribute of a pointed object not loaded");
+  NS_TEST_EXPECT_MSG_EQ (aggregate->m_int16, -9, "Attribute of an aggregated object not loaded");
+  IntegerValue value;
+  g_binaryConfigTestGlobal.GetValue (value);
+  NS_TEST_EXPECT_MSG_EQ (value.Get (), 2, "Global value not loaded");
+
+  Config::UnregisterRootNamespaceObject (root);
+  Config::SetDefault ("ns3::BinaryConfigTestObject::TestInt16", IntegerValue (-2));
+  g_binaryConfigTestGlobal.ResetInitialValue ();
+}
+
+/**
+ * \ingroup configstore
+ * Check that truncated and corrupted binary config files are rejected.
+ */
+class BinaryConfigCorruptTestCase : public TestCase
+{
+public:
+  BinaryConfigCorruptTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Write a file and check that it cannot be opened.
+   * \param [in] content The content of the file.
+   * \param [in] what The corruption, for the test messages.
+   */
+  void CheckRejected (std::string content, std::string what);
+  /**
+   * \param [in] content The content of a binary config file.
+   * \returns A copy of its header.
+   */
+  static struct BinaryConfigHeader GetHeader (const std::string &content);
+  /**
+   * Read a 32-bit field of a binary config file.
+   * \param [in] content The content of the file.
+   * \param [in] offset The offset of the field.
+   * \returns The value of the field.
+   */
+  static uint32_t GetField (const std::string &content, uint32_t offset);
+  /**
+   * Overwrite a 32-bit field of a binary config file.
+   * \param [in] content The content of the file.
+   * \param [in] offset The offset of the field.
+   * \param [in] value The new value of the field.
+   * \returns The modified content.
+   */
+  static std::string SetField (std::string content, uint32_t offset, uint32_t value);
+};
+
+BinaryConfigCorruptTestCase::BinaryConfigCorruptTestCase ()
+  : TestCase ("Check that corrupted binary config files are rejected")
+{
+}
+
+void
+BinaryConfigCorruptTestCase::CheckRejected (std::string content, std::string what)
+{
+  std::string filename = CreateTempDirFilename ("binary-config-corrupt.bin");
+  std::ofstream os (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  os.write (content.data (), content.size ());
+  os.close ();
+  BinaryConfigLoad load;
+  NS_TEST_EXPECT_MSG_NE (load.Open (filename), "", "Opened a binary config file with " << what);
+}
+
+struct BinaryConfigHeader
+BinaryConfigCorruptTestCase::GetHeader (const std::string &content)
+{
+  struct BinaryConfigHeader h;
+  std::memcpy (&h, content.data (), sizeof (h));
+  return h;
+}
+
+uint32_t
+BinaryConfigCorruptTestCase::GetField (const std::string &content, uint32_t offset)
+{
+  uint32_t value;
+  std::memcpy (&value, content.data () + offset, sizeof (value));
+  return value;
+}
+
+std::string
+BinaryConfigCorruptTestCase::SetField (std::string content, uint32_t offset, uint32_t value)
+{
+  content.replace (offset, sizeof (value), (const char *)&value, sizeof (value));
+  return content;
+}
+
+void
+BinaryConfigCorruptTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("binary-config-valid.bin");
+  Ptr<BinaryConfigTestObject> root = CreateObject<BinaryConfigTestObject> ();
+  root->m_ptr = CreateObject<BinaryConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  BinaryConfigSave save;
+  save.SetFilename (filename);
+  save.Attributes ();
+  Config::UnregisterRootNamespaceObject (root);
+
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  std::ostringstream oss;
+  oss << is.rdbuf ();
+  std::string valid = oss.str ();
+
+  BinaryConfigLoad load;
+  NS_TEST_ASSERT_MSG_EQ (load.Open (filename), "", "Could not open a valid binary config file");
+  NS_TEST_EXPECT_MSG_NE (load.Open (CreateTempDirFilename ("missing.bin")), "",
+                         "Opened a missing binary config file");
+
+  struct BinaryConfigHeader h = GetHeader (valid);
+  NS_TEST_ASSERT_MSG_GT (h.nValues, 0, "No value saved");
+  uint32_t strings = sizeof (h);
+  uint32_t objects = strings + h.nStrings * sizeof (uint32_t)
+    + h.nAttributes * sizeof (struct BinaryConfigAttribute)
+    + (h.nDefaults + h.nGlobals) * sizeof (struct BinaryConfigSetting);
+  uint32_t values = objects + h.nObjects * sizeof (struct BinaryConfigObject);
+  uint32_t stringBytes = values + h.nValues * sizeof (struct BinaryConfigValue);
+  NS_TEST_ASSERT_MSG_EQ (stringBytes + h.stringBytes, valid.size (), "Unexpected file layout");
+
+  CheckRejected ("", "no content");
+  CheckRejected (valid.substr (0, sizeof (h) - 1), "a truncated header");
+  CheckRejected (valid.substr (0, valid.size () - 1), "a truncated string");
+  CheckRejected (valid.substr (0, values), "no value records");
+  CheckRejected (valid + '\0', "trailing bytes");
+  CheckRejected (SetField (valid, 0, BinaryConfigLoad::MAGIC + 1), "a wrong magic");
+  CheckRejected (SetField (valid, 4, BinaryConfigLoad::VERSION + 1), "a wrong version");
+  CheckRejected (SetField (valid, 8, h.nStrings + 1), "a wrong number of strings");
+
+  std::string unterminated = valid;
+  unterminated[unterminated.size () - 1] = 'x';
+  CheckRejected (unterminated, "an unterminated string");
+  CheckRejected (SetField (valid, strings, h.stringBytes), "a string offset out of range");
+
+  // an object reached from another one may not be its own parent, nor
+  // have an unknown kind
+  uint32_t k = 0;
+  while (k < h.nObjects
+         && GetField (valid, objects + k * sizeof (struct BinaryConfigObject)) == BinaryConfigObject::ROOT)
+    {
+      k++;
+    }
+  NS_TEST_ASSERT_MSG_LT (k, h.nObjects, "No pointed object saved");
+  uint32_t object = objects + k * sizeof (struct BinaryConfigObject);
+  CheckRejected (SetField (valid, object, BinaryConfigObject::ITEM + 1), "an unknown object kind");
+  CheckRejected (SetField (valid, object + 4, k), "an object which is its own parent");
+  CheckRejected (SetField (valid, object + 8, h.nStrings), "an object type out of range");
+
+  CheckRejected (SetField (valid, values, h.nObjects), "a value of an unknown object");
+  CheckRejected (SetField (valid, values + 4, h.nAttributes), "a value of an unknown attribute");
+  CheckRejected (SetField (valid, values + 8, h.nStrings), "a value string out of range");
+}
+
+/**
+ * \ingroup configstore
+ * The binary config file test suite.
+ */
+class BinaryConfigTestSuite : public TestSuite
+{
+public:
+  BinaryConfigTestSuite ();
+};
+
+BinaryConfigTestSuite::BinaryConfigTestSuite ()
+  : TestSuite ("binary-config", UNIT)
+{
+  AddTestCase (new BinaryConfigRoundTripTestCase, TestCase::QUICK);
+  AddTestCase (new BinaryConfigCorruptTestCase, TestCase::QUICK);
+}
+
+static BinaryConfigTestSuite g_binaryConfigTestSuite; //!< Static variable for test initialization
@@ -61,9 +61,14 @@ std::string
 CallbackValue::SerializeToString (Ptr<const AttributeChecker> checker) const
 {
   NS_LOG_FUNCTION (this << checker);
-  std::ostringstream oss;
-  oss << PeekPointer (m_value.GetImpl ());
-  return oss.str ();
+  // The address of an impl stored in place differs between copies of
+  // the same Callback, so print the impl type, which does not.
+  CallbackImplBase *impl = m_value.GetImpl ();
+  if (impl == 0)
+    {
+      return "0";
+    }
+  return impl->GetTypeid ();
 }
 bool
 CallbackValue::DeserializeFromString (std::string value, Ptr<const AttributeChecker> checker)
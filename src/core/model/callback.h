@@ -29,6 +29,7 @@
 #include "attribute-helper.h"
 #include "simple-ref-count.h"
 #include <typeinfo>
+#include <new>
 
 /**
  * \file
@@ -147,12 +148,26 @@ public:
    * \param [in] other Callback Ptr
    * \return \c true if we are equal
    */
-  virtual bool IsEqual (Ptr<const CallbackImplBase> other) const = 0;
+  virtual bool IsEqual (const CallbackImplBase *other) const = 0;
   /**
    * Get the name of this object type.
    * \return The object type as a string.
    */
   virtual std::string GetTypeid (void) const = 0;
+  /**
+   * Copy this implementation into the storage of a Callback.
+   *
+   * Only the implementations which a Callback can store in place,
+   * rather than on the heap, override this method.
+   *
+   * \param [in] buffer The storage of the Callback.
+   * \return The copy, constructed in \p buffer.
+   */
+  virtual CallbackImplBase * CopyTo (void *buffer) const
+  {
+    NS_FATAL_ERROR ("This CallbackImpl cannot be stored in a Callback");
+    return 0;
+  }
 
 protected:
   /**
@@ -563,9 +578,9 @@ public:
    * \param [in] other CallbackImpl Ptr
    * \return \c true if this and other have the same functor
    */
-  virtual bool IsEqual (Ptr<const CallbackImplBase> other) const {
+  virtual bool IsEqual (const CallbackImplBase *other) const {
     FunctorCallbackImpl<T,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> const *otherDerived = 
-      dynamic_cast<FunctorCallbackImpl<T,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> const *> (PeekPointer (other));
+      dynamic_cast<FunctorCallbackImpl<T,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> const *> (other);
     if (otherDerived == 0)
       {
         return false;
@@ -576,6 +591,10 @@ public:
       }
     return true;
   }
+  /** \copydoc CallbackImplBase::CopyTo */
+  virtual CallbackImplBase * CopyTo (void *buffer) const {
+    return new (buffer) FunctorCallbackImpl<T,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (*this);
+  }
 private:
   T m_functor;                          //!< the functor
 };
@@ -710,9 +729,9 @@ public:
    * \param [in] other Callback Ptr
    * \return \c true if we have the same object and member function
    */
-  virtual bool IsEqual (Ptr<const CallbackImplBase> other) const {
+  virtual bool IsEqual (const CallbackImplBase *other) const {
     MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> const *otherDerived = 
-      dynamic_cast<MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> const *> (PeekPointer (other));
+      dynamic_cast<MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> const *> (other);
     if (otherDerived == 0)
       {
         return false;
@@ -724,6 +743,10 @@ public:
       }
     return true;
   }
+  /** \copydoc CallbackImplBase::CopyTo */
+  virtual CallbackImplBase * CopyTo (void *buffer) const {
+    return new (buffer) MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (*this);
+  }
 private:
   OBJ_PTR const m_objPtr;               //!< the object pointer
   MEM_PTR m_memPtr;                     //!< the member function pointer
@@ -844,9 +867,9 @@ public:
    * \param [in] other Callback Ptr
    * \return \c true if we have the same functor and bound arguments
    */
-  virtual bool IsEqual (Ptr<const CallbackImplBase> other) const {
+  virtual bool IsEqual (const CallbackImplBase *other) const {
     BoundFunctorCallbackImpl<T,R,TX,T1,T2,T3,T4,T5,T6,T7,T8> const *otherDerived = 
-      dynamic_cast<BoundFunctorCallbackImpl<T,R,TX,T1,T2,T3,T4,T5,T6,T7,T8> const *> (PeekPointer (other));
+      dynamic_cast<BoundFunctorCallbackImpl<T,R,TX,T1,T2,T3,T4,T5,T6,T7,T8> const *> (other);
     if (otherDerived == 0)
       {
         return false;
@@ -965,9 +988,9 @@ public:
    * \param [in] other Callback Ptr
    * \return \c true if we have the same functor and bound arguments
    */
-  virtual bool IsEqual (Ptr<const CallbackImplBase> other) const {
+  virtual bool IsEqual (const CallbackImplBase *other) const {
     TwoBoundFunctorCallbackImpl<T,R,TX1,TX2,T1,T2,T3,T4,T5,T6,T7> const *otherDerived = 
-      dynamic_cast<TwoBoundFunctorCallbackImpl<T,R,TX1,TX2,T1,T2,T3,T4,T5,T6,T7> const *> (PeekPointer (other));
+      dynamic_cast<TwoBoundFunctorCallbackImpl<T,R,TX1,TX2,T1,T2,T3,T4,T5,T6,T7> const *> (other);
     if (otherDerived == 0)
       {
         return false;
@@ -1075,9 +1098,9 @@ public:
    * \param [in] other Callback Ptr
    * \return \c true if we have the same functor and bound arguments
    */
-  virtual bool IsEqual (Ptr<const CallbackImplBase> other) const {
+  virtual bool IsEqual (const CallbackImplBase *other) const {
     ThreeBoundFunctorCallbackImpl<T,R,TX1,TX2,TX3,T1,T2,T3,T4,T5,T6> const *otherDerived = 
-      dynamic_cast<ThreeBoundFunctorCallbackImpl<T,R,TX1,TX2,TX3,T1,T2,T3,T4,T5,T6> const *> (PeekPointer (other));
+      dynamic_cast<ThreeBoundFunctorCallbackImpl<T,R,TX1,TX2,TX3,T1,T2,T3,T4,T5,T6> const *> (other);
     if (otherDerived == 0)
       {
         return false;
@@ -1100,19 +1123,125 @@ private:
  * \ingroup callbackimpl
  * Base class for Callback class.
  * Provides pimpl abstraction.
+ *
+ * The pimpl of the function and member function Callbacks, which
+ * are created for every packet in many places, is small enough
+ * to be stored in the Callback itself. Such a pimpl is constructed
+ * in place, without a heap allocation, and it is copied rather
+ * than shared when the Callback is copied. Any other pimpl is
+ * allocated on the heap and shared through its reference count.
  */
 class CallbackBase {
 public:
-  CallbackBase () : m_impl () {}
-  /** \return The impl pointer */
-  Ptr<CallbackImplBase> GetImpl (void) const { return m_impl; }
+  CallbackBase () : m_impl (0) {}
+  /**
+   * Copy constructor.
+   * \param [in] o The Callback to copy.
+   */
+  CallbackBase (const CallbackBase &o) : m_impl (0) { CopyImpl (o); }
+  /**
+   * Assignment operator.
+   * \param [in] o The Callback to copy.
+   * \return This Callback.
+   */
+  CallbackBase & operator = (const CallbackBase &o)
+  {
+    if (&o != this)
+      {
+        ReleaseImpl ();
+        CopyImpl (o);
+      }
+    return *this;
+  }
+  ~CallbackBase () { ReleaseImpl (); }
+  /**
+   * \return The impl pointer
+   *
+   * The pointer must not be kept beyond the lifetime of this Callback,
+   * whose storage may hold the impl.
+   */
+  CallbackImplBase *GetImpl (void) const { return m_impl; }
 protected:
   /**
    * Construct from a pimpl
    * \param [in] impl The CallbackImplBase Ptr
    */
-  CallbackBase (Ptr<CallbackImplBase> impl) : m_impl (impl) {}
-  Ptr<CallbackImplBase> m_impl;         //!< the pimpl
+  CallbackBase (Ptr<CallbackImplBase> impl) : m_impl (PeekPointer (impl))
+  {
+    if (m_impl != 0)
+      {
+        m_impl->Ref ();
+      }
+  }
+  /**
+   * Set the pimpl to a copy of an implementation, stored in place
+   * if it fits and the storage is aligned enough for it.
+   *
+   * \tparam IMPL \deduced The implementation type.
+   * \param [in] impl The implementation.
+   */
+  template <typename IMPL>
+  void SetImpl (IMPL const &impl)
+  {
+    if (sizeof (IMPL) <= sizeof (m_storage) && alignof (IMPL) <= alignof (Storage))
+      {
+        m_impl = impl.CopyTo (m_storage.buffer);
+      }
+    else
+      {
+        m_impl = new IMPL (impl);
+      }
+  }
+  /**
+   * Copy or share the pimpl of another Callback.
+   * \param [in] o The other Callback.
+   */
+  void CopyImpl (const CallbackBase &o)
+  {
+    if (o.IsImplInPlace ())
+      {
+        m_impl = o.m_impl->CopyTo (m_storage.buffer);
+      }
+    else
+      {
+        m_impl = o.m_impl;
+        if (m_impl != 0)
+          {
+            m_impl->Ref ();
+          }
+      }
+  }
+  /** Release the pimpl, and destroy it if it is stored in place. */
+  void ReleaseImpl (void)
+  {
+    if (IsImplInPlace ())
+      {
+        NS_ASSERT_MSG (m_impl->GetReferenceCount () == 1,
+                       "The impl of a Callback is referenced beyond its lifetime");
+        m_impl->~CallbackImplBase ();
+      }
+    else if (m_impl != 0)
+      {
+        m_impl->Unref ();
+      }
+    m_impl = 0;
+  }
+  /** \return \c true if the pimpl is stored in this Callback. */
+  bool IsImplInPlace (void) const
+  {
+    return m_impl == static_cast<const void *> (m_storage.buffer);
+  }
+  CallbackImplBase *m_impl;             //!< the pimpl
+private:
+  /** The storage of a pimpl constructed in place. */
+  union Storage
+  {
+    void *pointer;                      //!< for the alignment of pointers
+    double number;                      //!< for the alignment of numbers
+    /** The buffer, large enough for a member function Callback. */
+    char buffer[5 * sizeof (void *)];
+  };
+  Storage m_storage;                    //!< the storage of the pimpl
 };
 
 /**
@@ -1188,8 +1317,9 @@ public:
    */
   template <typename FUNCTOR>
   Callback (FUNCTOR const &functor, bool, bool) 
-    : CallbackBase (Create<FunctorCallbackImpl<FUNCTOR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (functor))
-  {}
+  {
+    SetImpl (FunctorCallbackImpl<FUNCTOR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (functor));
+  }
 
   /**
    * Construct a member function pointer call back.
@@ -1199,8 +1329,9 @@ public:
    */
   template <typename OBJ_PTR, typename MEM_PTR>
   Callback (OBJ_PTR const &objPtr, MEM_PTR memPtr)
-    : CallbackBase (Create<MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (objPtr, memPtr))
-  {}
+  {
+    SetImpl (MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (objPtr, memPtr));
+  }
 
   /**
    * Construct from a CallbackImpl pointer
@@ -1272,7 +1403,7 @@ public:
   }
   /** Discard the implementation, set it to null */
   void Nullify (void) {
-    m_impl = 0;
+    ReleaseImpl ();
   }
 
   /**
@@ -1410,12 +1541,12 @@ public:
    * \returns \c true if \p other was type-compatible and could be adopted.
    */
   bool Assign (const CallbackBase &other) {
-    return DoAssign (other.GetImpl ());
+    return DoAssign (other);
   }
 private:
   /** \return The pimpl pointer */
   CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *DoPeekImpl (void) const {
-    return static_cast<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (PeekPointer (m_impl));
+    return static_cast<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (m_impl);
   }
   /**
    * Check for compatible types
@@ -1423,9 +1554,9 @@ private:
    * \param [in] other Callback Ptr
    * \return \c true if other can be dynamic_cast to my type
    */
-  bool DoCheckType (Ptr<const CallbackImplBase> other) const {
+  bool DoCheckType (const CallbackImplBase *other) const {
     if (other != 0 &&
-        dynamic_cast<const CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (PeekPointer (other)) != 0)
+        dynamic_cast<const CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (other) != 0)
       {
         return true;
       }
@@ -1439,17 +1570,21 @@ private:
       }
   }
   /** \copydoc Assign */
-  bool DoAssign (Ptr<const CallbackImplBase> other) {
-    if (!DoCheckType (other))
+  bool DoAssign (const CallbackBase &other) {
+    if (!DoCheckType (other.GetImpl ()))
       {
-        std::string othTid = other->GetTypeid ();
+        std::string othTid = other.GetImpl ()->GetTypeid ();
         std::string myTid = CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9>::DoGetTypeid ();
         NS_FATAL_ERROR_CONT ("Incompatible types. (feed to \"c++filt -t\" if needed)" << std::endl <<
                         "got=" << othTid << std::endl <<
                         "expected=" << myTid);
         return false;
       }
-    m_impl = const_cast<CallbackImplBase *> (PeekPointer (other));
+    if (&other != this)
+      {
+        ReleaseImpl ();
+        CopyImpl (other);
+      }
     return true;
   }
 };
@@ -27,6 +27,8 @@
 #include "log.h"
 
 #include <sstream>
+#include <algorithm>
+#include <map>
 
 /**
  * \file
@@ -166,7 +168,21 @@ public:
    * \returns \c true if the index matches the Config Path.
    */
   bool Matches (uint32_t i) const;
+  /**
+   * Get the indices which match the Config Path.
+   *
+   * \param [in] n The number of indices to consider, from 0.
+   * \param [out] indices The indices in [0,n[ which match, in increasing
+   *                      order.
+   */
+  void GetMatches (uint32_t n, std::vector<uint32_t> *indices) const;
 private:
+  /**
+   * Parse a Config path specification into ranges.
+   *
+   * \param [in] element The Config path specification.
+   */
+  void Parse (std::string element);
   /**
    * Convert a string to an \c uint32_t.
    *
@@ -177,77 +193,117 @@ private:
   bool StringToUint32 (std::string str, uint32_t *value) const;
   /** The Config path element. */
   std::string m_element;
+  /** Whether all the indices match. */
+  bool m_all;
+  /** The ranges of matching indices, sorted and disjoint. */
+  std::vector<std::pair<uint32_t, uint32_t> > m_ranges;
 };
 
 
 ArrayMatcher::ArrayMatcher (std::string element)
-  : m_element (element)
+  : m_element (element),
+    m_all (false)
 {
   NS_LOG_FUNCTION (this << element);
+  Parse (element);
+  // merge the overlapping ranges of "a|b" specifications
+  std::sort (m_ranges.begin (), m_ranges.end ());
+  std::vector<std::pair<uint32_t, uint32_t> > ranges;
+  for (uint32_t i = 0; i < m_ranges.size (); i++)
+    {
+      if (!ranges.empty () && m_ranges[i].first <= ranges.back ().second + (uint64_t) 1)
+        {
+          ranges.back ().second = std::max (ranges.back ().second, m_ranges[i].second);
+        }
+      else
+        {
+          ranges.push_back (m_ranges[i]);
+        }
+    }
+  m_ranges.swap (ranges);
 }
-bool
-ArrayMatcher::Matches (uint32_t i) const
+void
+ArrayMatcher::Parse (std::string element)
 {
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  NS_LOG_FUNCTION (this << element);
+  if (element == "*")
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches *");
-      return true;
+      m_all = true;
+      return;
     }
   std::string::size_type tmp;
-  tmp = m_element.find ("|");
+  tmp = element.find ("|");
   if (tmp != std::string::npos)
     {
-      std::string left = m_element.substr (0, tmp-0);
-      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-      return false;
+      Parse (element.substr (0, tmp-0));
+      Parse (element.substr (tmp+1, element.size () - (tmp + 1)));
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1 &&
       dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
-      if (StringToUint32 (lowerBound, &min) && 
+      if (StringToUint32 (lowerBound, &min) &&
           StringToUint32 (upperBound, &max) &&
-          i >= min && i <= max)
+          min <= max)
         {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-          return true;
-        }
-      else
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" does not "<<m_element);
-          return false;
+          m_ranges.push_back (std::make_pair (min, max));
         }
+      return;
     }
   uint32_t value;
-  if (StringToUint32 (m_element, &value) &&
-      i == value)
+  if (StringToUint32 (element, &value))
+    {
+      m_ranges.push_back (std::make_pair (value, value));
+    }
+}
+bool
+ArrayMatcher::Matches (uint32_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_all)
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+      NS_LOG_DEBUG ("Array "<<i<<" matches *");
       return true;
     }
+  for (uint32_t j = 0; j < m_ranges.size () && m_ranges[j].first <= i; j++)
+    {
+      if (i <= m_ranges[j].second)
+        {
+          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+          return true;
+        }
+    }
   NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
   return false;
 }
+void
+ArrayMatcher::GetMatches (uint32_t n, std::vector<uint32_t> *indices) const
+{
+  NS_LOG_FUNCTION (this << n << indices);
+  if (m_all)
+    {
+      for (uint32_t i = 0; i < n; i++)
+        {
+          indices->push_back (i);
+        }
+      return;
+    }
+  for (uint32_t j = 0; j < m_ranges.size () && m_ranges[j].first < n; j++)
+    {
+      uint32_t last = std::min (m_ranges[j].second, n - 1);
+      for (uint32_t i = m_ranges[j].first; i <= last; i++)
+        {
+          indices->push_back (i);
+        }
+    }
+}
 
 bool
 ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
@@ -259,6 +315,201 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
   return !iss.bad () && !iss.fail ();
 }
 
+/**
+ * A Config path split into segments, each of them parsed once.
+ */
+class ParsedPath : public SimpleRefCount<ParsedPath>
+{
+public:
+  /** A segment of the path, between two slashes. */
+  struct Segment
+  {
+    /**
+     * Parse a segment.
+     *
+     * \param [in] item The segment.
+     */
+    Segment (std::string item);
+    /** The segment. */
+    std::string item;
+    /** Whether the segment can be the "/Names" namespace. */
+    bool names;
+    /** Whether the segment is a call to GetObject ("$TypeId"). */
+    bool getObject;
+    /** Whether the TypeId of a GetObject segment was found. */
+    bool typed;
+    /** The TypeId of a GetObject segment, if found. */
+    TypeId tid;
+    /** The matcher of the segment as an array index. */
+    ArrayMatcher matcher;
+  };
+
+  /**
+   * Parse a Config path.
+   *
+   * \param [in] path The Config path.
+   */
+  ParsedPath (std::string path);
+
+  /**
+   * Check if no object can match the leading segments.
+   *
+   * \param [in] n The number of leading segments.
+   * \returns \c true if a GetObject segment names a type without live
+   *          objects, so that no object can match.
+   */
+  bool IsEmpty (uint32_t n) const;
+
+  /** The Config path. */
+  std::string path;
+  /** The segments of the path. */
+  std::vector<Segment> segments;
+  /** The path up to the final slash, for the Config functions with a leaf. */
+  std::string root;
+  /** The number of segments of the root path. */
+  uint32_t rootN;
+  /** The segment after the final slash. */
+  std::string leaf;
+};
+
+ParsedPath::Segment::Segment (std::string item)
+  : item (item),
+    names (item.compare (0, 5, "Names") == 0),
+    getObject (item.find ("$") == 0),
+    typed (false),
+    matcher (item)
+{
+  if (getObject)
+    {
+      typed = TypeId::LookupByNameFailSafe (item.substr (1, item.size () - 1), &tid);
+    }
+}
+
+ParsedPath::ParsedPath (std::string path)
+  : path (path),
+    rootN (0)
+{
+  NS_LOG_FUNCTION (this << path);
+
+  std::string::size_type slash = path.find_last_of ("/");
+  if (slash != std::string::npos)
+    {
+      root = path.substr (0, slash);
+      leaf = path.substr (slash+1, path.size ()-(slash+1));
+    }
+
+  // ensure that we start and end with a '/'
+  std::string canonical = path;
+  if (canonical.find ("/") != 0)
+    {
+      canonical = "/" + canonical;
+    }
+  if (canonical.find_last_of ("/") != (canonical.size () - 1))
+    {
+      canonical = canonical + "/";
+    }
+  std::string::size_type start = 1;
+  while (start < canonical.size ())
+    {
+      std::string::size_type next = canonical.find ("/", start);
+      segments.push_back (Segment (canonical.substr (start, next - start)));
+      start = next + 1;
+    }
+  // the leaf, if any, is the last segment
+  rootN = (leaf.empty () || segments.empty ()) ? segments.size () : segments.size () - 1;
+}
+
+bool
+ParsedPath::IsEmpty (uint32_t n) const
+{
+  NS_LOG_FUNCTION (this << n);
+  bool empty = false;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      if (segments[i].getObject)
+        {
+          if (!segments[i].typed)
+            {
+              // resolve the path, to report the unknown type if reached
+              return false;
+            }
+          empty = empty || Object::GetLiveObjectN (segments[i].tid) == 0;
+        }
+    }
+  return empty;
+}
+
+/** An attribute through which a Config path goes down to other objects. */
+struct PathAttribute
+{
+  /** The attribute. */
+  struct TypeId::AttributeInformation info;
+  /** Whether the attribute is a pointer (otherwise, a container). */
+  bool pointer;
+  /** Whether the attribute can be read through its accessor. */
+  bool gettable;
+  /** The accessor of a container attribute. */
+  Ptr<const ObjectPtrContainerAccessor> container;
+};
+
+/**
+ * Get the attributes of a type which match a Config path segment.
+ *
+ * The attributes are searched once per type and segment.
+ *
+ * \param [in] tid The type of the object.
+ * \param [in] item The path segment.
+ * \returns The matching pointer and container attributes, in the order
+ *          of the search, from \p tid up to its root.
+ */
+static const std::vector<PathAttribute> &
+GetPathAttributes (TypeId tid, const std::string &item)
+{
+  NS_LOG_FUNCTION (tid << item);
+  typedef std::map<std::pair<uint16_t, std::string>, std::vector<PathAttribute> > Cache;
+  static Cache cache;
+  std::pair<Cache::iterator, bool> inserted =
+    cache.insert (std::make_pair (std::make_pair (tid.GetUid (), item), std::vector<PathAttribute> ()));
+  std::vector<PathAttribute> &attributes = inserted.first->second;
+  if (!inserted.second)
+    {
+      return attributes;
+    }
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          PathAttribute attribute;
+          attribute.info = tid.GetAttribute (i);
+          if (attribute.info.name != item && item != "*")
+            {
+              continue;
+            }
+          attribute.gettable = (attribute.info.flags & TypeId::ATTR_GET) &&
+            attribute.info.accessor->HasGetter ();
+          // attempt to cast to a pointer checker.
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (attribute.info.checker)) != 0)
+            {
+              attribute.pointer = true;
+              attributes.push_back (attribute);
+            }
+          // attempt to cast to an object vector.
+          else if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (attribute.info.checker)) != 0)
+            {
+              attribute.pointer = false;
+              attribute.container = DynamicCast<const ObjectPtrContainerAccessor> (attribute.info.accessor);
+              attributes.push_back (attribute);
+            }
+          // this could be anything else and we don't know what to do with it.
+          // So, we just ignore it.
+        }
+      nextTid = tid.GetParent ();
+    } while (nextTid != tid);
+  return attributes;
+}
+
 /**
  * Abstract class to parse Config paths into object references.
  */
@@ -268,9 +519,10 @@ public:
   /**
    * Construct from a base Config path.
    *
-   * \param [in] path The Config path.
+   * \param [in] path The parsed Config path.
+   * \param [in] n The number of segments of \p path to resolve.
    */
-  Resolver (std::string path);
+  Resolver (const ParsedPath &path, uint32_t n);
   /** Destructor. */
   virtual ~Resolver ();
 
@@ -282,25 +534,24 @@ public:
    *                  in the Config path.
    */
   void Resolve (Ptr<Object> root);
-  
+
 private:
-  /** Ensure the Config path starts and ends with a '/'. */
-  void Canonicalize (void);
   /**
    * Parse the next element in the Config path.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] i The index of the next segment of the Config path.
    * \param [in] root The object corresponding to the current positon
    *                  in the Config path.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (uint32_t i, Ptr<Object> root);
   /**
    * Parse an index on the Config path.
    *
-   * \param [in] path The remaining Config path.
-   * \param [in,out] vector The resulting list of matching objects.
+   * \param [in] i The index of the index segment of the Config path.
+   * \param [in] root The object holding the container.
+   * \param [in] attribute The container attribute.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoArrayResolve (uint32_t i, Ptr<Object> root, const PathAttribute &attribute);
   /**
    * Handle one object found on the path.
    *
@@ -324,45 +575,28 @@ private:
   /** Current list of path tokens. */
   std::vector<std::string> m_workStack;
   /** The Config path. */
-  std::string m_path;
+  const ParsedPath &m_path;
+  /** The number of segments to resolve. */
+  uint32_t m_n;
 };
 
-Resolver::Resolver (std::string path)
-  : m_path (path)
+Resolver::Resolver (const ParsedPath &path, uint32_t n)
+  : m_path (path),
+    m_n (n)
 {
-  NS_LOG_FUNCTION (this << path);
-  Canonicalize ();
+  NS_LOG_FUNCTION (this << path.path << n);
 }
 Resolver::~Resolver ()
 {
   NS_LOG_FUNCTION (this);
 }
-void
-Resolver::Canonicalize (void)
-{
-  NS_LOG_FUNCTION (this);
 
-  // ensure that we start and end with a '/'
-  std::string::size_type tmp = m_path.find ("/");
-  if (tmp != 0)
-    {
-      // no slash at start
-      m_path = "/" + m_path;
-    }
-  tmp = m_path.find_last_of ("/");
-  if (tmp != (m_path.size () - 1))
-    {
-      // no slash at end
-      m_path = m_path + "/";
-    }
-}
-
-void 
+void
 Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
@@ -378,7 +612,7 @@ Resolver::GetResolvedPath (void) const
   return fullPath;
 }
 
-void 
+void
 Resolver::DoResolveOne (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
@@ -388,48 +622,42 @@ Resolver::DoResolveOne (Ptr<Object> object)
 }
 
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::DoResolve (uint32_t i, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (this << i << root);
 
-  if (next == std::string::npos)
+  if (i == m_n)
     {
       //
-      // If root is zero, we're beginning to see if we can use the object name 
-      // service to resolve this path.  It is impossible to have a object name 
+      // If root is zero, we're beginning to see if we can use the object name
+      // service to resolve this path.  It is impossible to have a object name
       // associated with the root of the object name service since that root
       // is not an object.  This path must be referring to something in another
       // namespace and it will have been found already since the name service
       // is always consulted last.
-      // 
+      //
       if (root)
         {
           DoResolveOne (root);
         }
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const ParsedPath::Segment &segment = m_path.segments[i];
+  const std::string &item = segment.item;
 
   //
-  // If root is zero, we're beginning to see if we can use the object name 
-  // service to resolve this path.  In this case, we must see the name space 
-  // "/Names" on the front of this path.  There is no object associated with 
-  // the root of the "/Names" namespace, so we just ignore it and move on to 
+  // If root is zero, we're beginning to see if we can use the object name
+  // service to resolve this path.  In this case, we must see the name space
+  // "/Names" on the front of this path.  There is no object associated with
+  // the root of the "/Names" namespace, so we just ignore it and move on to
   // the next segment.
   //
-  if (root == 0)
+  if (root == 0 && segment.names)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
-        {
-          m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
-          m_workStack.pop_back ();
-          return;
-        }
+      m_workStack.push_back (item);
+      DoResolve (i + 1, root);
+      m_workStack.pop_back ();
+      return;
     }
 
   //
@@ -443,7 +671,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
       m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      DoResolve (i + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -459,83 +687,57 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       return;
     }
-  std::string::size_type dollarPos = item.find ("$");
-  if (dollarPos == 0)
+  if (segment.getObject)
     {
       // This is a call to GetObject
-      std::string tidString = item.substr (1, item.size () - 1);
-      NS_LOG_DEBUG ("GetObject="<<tidString<<" on path="<<GetResolvedPath ());
-      TypeId tid = TypeId::LookupByName (tidString);
+      NS_LOG_DEBUG ("GetObject="<<item<<" on path="<<GetResolvedPath ());
+      TypeId tid = segment.typed ? segment.tid : TypeId::LookupByName (item.substr (1, item.size () - 1));
       Ptr<Object> object = root->GetObject<Object> (tid);
       if (object == 0)
         {
-          NS_LOG_DEBUG ("GetObject ("<<tidString<<") failed on path="<<GetResolvedPath ());
+          NS_LOG_DEBUG ("GetObject ("<<item<<") failed on path="<<GetResolvedPath ());
           return;
         }
       m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      DoResolve (i + 1, object);
       m_workStack.pop_back ();
     }
-  else 
+  else
     {
       // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
-      bool foundMatch = false;
-      
-      do
+      const std::vector<PathAttribute> &attributes = GetPathAttributes (root->GetInstanceTypeId (), item);
+      for (std::vector<PathAttribute>::const_iterator it = attributes.begin (); it != attributes.end (); it++)
         {
-          tid = nextTid;
-          
-          for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+          if (it->pointer)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute(i);
-              if (info.name != item && item != "*")
-                {
-                  continue;
-                }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *ptr = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker));
-              if (ptr != 0)
+              NS_LOG_DEBUG ("GetAttribute(ptr)="<<it->info.name<<" on path="<<GetResolvedPath ());
+              PointerValue ptr;
+              if (!it->gettable || !it->info.accessor->Get (PeekPointer (root), ptr))
                 {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)="<<info.name<<" on path="<<GetResolvedPath ());
-                  PointerValue ptr;
-                  root->GetAttribute (info.name, ptr);
-                  Ptr<Object> object = ptr.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\""<<item<<
-                                    "\" exists on path=\""<<GetResolvedPath ()<<"\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
+                  root->GetAttribute (it->info.name, ptr);
                 }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker = 
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
+              Ptr<Object> object = ptr.Get<Object> ();
+              if (object == 0)
                 {
-                  NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
+                  NS_LOG_ERROR ("Requested object name=\""<<item<<
+                                "\" exists on path=\""<<GetResolvedPath ()<<"\""
+                                " but is null.");
+                  continue;
                 }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              m_workStack.push_back (it->info.name);
+              DoResolve (i + 1, object);
+              m_workStack.pop_back ();
+            }
+          else
+            {
+              NS_LOG_DEBUG ("GetAttribute(vector)="<<it->info.name<<" on path="<<GetResolvedPath ());
+              m_workStack.push_back (it->info.name);
+              DoArrayResolve (i + 1, root, *it);
+              m_workStack.pop_back ();
             }
+        }
 
-          nextTid = tid.GetParent ();
-        } while (nextTid != tid);
-      
-      if (!foundMatch)
+      if (attributes.empty ())
         {
           NS_LOG_DEBUG ("Requested item="<<item<<" does not exist on path="<<GetResolvedPath ());
           return;
@@ -543,33 +745,60 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     }
 }
 
-void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+void
+Resolver::DoArrayResolve (uint32_t i, Ptr<Object> root, const PathAttribute &attribute)
 {
-  NS_LOG_FUNCTION(this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION (this << i << root << attribute.info.name);
+  if (i == m_n)
     {
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  const ArrayMatcher &matcher = m_path.segments[i].matcher;
 
-  ArrayMatcher matcher = ArrayMatcher (item);
-  ObjectPtrContainerValue::Iterator it;
-  for (it = container.Begin (); it != container.End (); ++it)
+  //
+  // Fetch the matching objects directly from the container, as long as their
+  // index is their position in the container (e.g., for a vector).  Otherwise,
+  // copy the whole container, which is sorted by index.
+  //
+  std::vector<std::pair<uint32_t, Ptr<Object> > > items;
+  uint32_t n;
+  bool indexed = false;
+  if (attribute.gettable && attribute.container != 0 &&
+      attribute.container->GetN (PeekPointer (root), &n))
     {
-      if (matcher.Matches ((*it).first))
+      std::vector<uint32_t> indices;
+      matcher.GetMatches (n, &indices);
+      indexed = true;
+      for (std::vector<uint32_t>::const_iterator k = indices.begin (); k != indices.end () && indexed; k++)
         {
-          std::ostringstream oss;
-          oss << (*it).first;
-          m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
-          m_workStack.pop_back ();
+          uint32_t index;
+          Ptr<Object> object = attribute.container->Get (PeekPointer (root), *k, &index);
+          items.push_back (std::make_pair (index, object));
+          indexed = (index == *k);
         }
     }
+  if (!indexed)
+    {
+      items.clear ();
+      ObjectPtrContainerValue container;
+      root->GetAttribute (attribute.info.name, container);
+      for (ObjectPtrContainerValue::Iterator it = container.Begin (); it != container.End (); ++it)
+        {
+          if (matcher.Matches ((*it).first))
+            {
+              items.push_back (*it);
+            }
+        }
+    }
+
+  for (std::vector<std::pair<uint32_t, Ptr<Object> > >::const_iterator it = items.begin (); it != items.end (); ++it)
+    {
+      std::ostringstream oss;
+      oss << (*it).first;
+      m_workStack.push_back (oss.str ());
+      DoResolve (i + 1, (*it).second);
+      m_workStack.pop_back ();
+    }
 }
 
 /** Config system implementation class. */
@@ -588,6 +817,15 @@ public:
   void Disconnect (std::string path, const CallbackBase &cb);
   /** \copydoc Config::LookupMatches() */
   Config::MatchContainer LookupMatches (std::string path);
+  /**
+   * Get the objects which match the leading segments of a parsed path.
+   *
+   * \param [in] path The parsed path.
+   * \param [in] n The number of leading segments to match.
+   * \param [in] matchPath The path stored in the returned container.
+   * \returns The container of the matching objects.
+   */
+  Config::MatchContainer LookupMatches (const ParsedPath &path, uint32_t n, std::string matchPath);
 
   /** \copydoc Config::RegisterRootNamespaceObject() */
   void RegisterRootNamespaceObject (Ptr<Object> obj);
@@ -681,11 +919,19 @@ Config::MatchContainer
 ConfigImpl::LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
+  ParsedPath parsed (path);
+  return LookupMatches (parsed, parsed.segments.size (), path);
+}
+
+Config::MatchContainer
+ConfigImpl::LookupMatches (const ParsedPath &path, uint32_t n, std::string matchPath)
+{
+  NS_LOG_FUNCTION (this << path.path << n << matchPath);
   class LookupMatchesResolver : public Resolver 
   {
   public:
-    LookupMatchesResolver (std::string path)
-      : Resolver (path)
+    LookupMatchesResolver (const ParsedPath &path, uint32_t n)
+      : Resolver (path, n)
     {}
     virtual void DoOne (Ptr<Object> object, std::string path) {
       m_objects.push_back (object);
@@ -693,7 +939,18 @@ ConfigImpl::LookupMatches (std::string path)
     }
     std::vector<Ptr<Object> > m_objects;
     std::vector<std::string> m_contexts;
-  } resolver = LookupMatchesResolver (path);
+  } resolver = LookupMatchesResolver (path, n);
+
+  //
+  // A path through a type without live objects matches nothing, whatever
+  // its root; skip the walk of the objects.
+  //
+  if (path.IsEmpty (n))
+    {
+      NS_LOG_DEBUG ("No live object of a type on path=" << path.path);
+      return Config::MatchContainer (resolver.m_objects, resolver.m_contexts, matchPath);
+    }
+
   for (Roots::const_iterator i = m_roots.begin (); i != m_roots.end (); i++)
     {
       resolver.Resolve (*i);
@@ -706,7 +963,7 @@ ConfigImpl::LookupMatches (std::string path)
   //
   resolver.Resolve (0);
 
-  return Config::MatchContainer (resolver.m_objects, resolver.m_contexts, path);
+  return Config::MatchContainer (resolver.m_objects, resolver.m_contexts, matchPath);
 }
 
 void 
@@ -849,6 +1106,77 @@ Config::MatchContainer LookupMatches (std::string path)
   return ConfigImpl::Get ()->LookupMatches (path);
 }
 
+CompiledPath::CompiledPath (std::string path)
+  : m_path (Create<ParsedPath> (path))
+{
+  NS_LOG_FUNCTION (this << path);
+}
+CompiledPath::CompiledPath (const CompiledPath &o)
+  : m_path (o.m_path)
+{
+  NS_LOG_FUNCTION (this << &o);
+}
+CompiledPath &
+CompiledPath::operator = (const CompiledPath &o)
+{
+  NS_LOG_FUNCTION (this << &o);
+  m_path = o.m_path;
+  return *this;
+}
+CompiledPath::~CompiledPath ()
+{
+  NS_LOG_FUNCTION (this);
+}
+std::string
+CompiledPath::GetPath (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_path->path;
+}
+MatchContainer
+CompiledPath::LookupMatches (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return ConfigImpl::Get ()->LookupMatches (*m_path, m_path->segments.size (), m_path->path);
+}
+MatchContainer
+CompiledPath::LookupLeafMatches (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_path->path.find ("/") != std::string::npos);
+  return ConfigImpl::Get ()->LookupMatches (*m_path, m_path->rootN, m_path->root);
+}
+void
+CompiledPath::Set (const AttributeValue &value) const
+{
+  NS_LOG_FUNCTION (this << &value);
+  LookupLeafMatches ().Set (m_path->leaf, value);
+}
+void
+CompiledPath::Connect (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  LookupLeafMatches ().Connect (m_path->leaf, cb);
+}
+void
+CompiledPath::ConnectWithoutContext (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  LookupLeafMatches ().ConnectWithoutContext (m_path->leaf, cb);
+}
+void
+CompiledPath::Disconnect (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  LookupLeafMatches ().Disconnect (m_path->leaf, cb);
+}
+void
+CompiledPath::DisconnectWithoutContext (const CallbackBase &cb) const
+{
+  NS_LOG_FUNCTION (this << &cb);
+  LookupLeafMatches ().DisconnectWithoutContext (m_path->leaf, cb);
+}
+
 void RegisterRootNamespaceObject (Ptr<Object> obj)
 {
   NS_LOG_FUNCTION (obj);
@@ -35,6 +35,7 @@ namespace ns3 {
 class AttributeValue;
 class Object;
 class CallbackBase;
+class ParsedPath;
 
 /**
  * \ingroup core
@@ -258,6 +259,102 @@ private:
  */
 MatchContainer LookupMatches (std::string path);
 
+/**
+ * \ingroup config
+ * \brief A Config path parsed once, to be resolved many times.
+ *
+ * The Config functions parse their path on each call. A CompiledPath
+ * splits the path into its segments, looks up the TypeIds of its
+ * \c $ segments and the ranges of its index segments once, and can then
+ * be resolved against the current objects as often as needed, e.g.,
+ * to connect the same trace source again after new nodes are created.
+ *
+ * A path whose \c $ segments name a type without live objects
+ * (see Object::GetLiveObjectN) matches no object, and is resolved
+ * without walking the objects.
+ *
+ * \code
+ *   Config::CompiledPath path ("/NodeList/[0-99]/DeviceList/0/$ns3::CsmaNetDevice/MacRx");
+ *   path.ConnectWithoutContext (MakeCallback (&MacRx));
+ * \endcode
+ */
+class CompiledPath
+{
+public:
+  /**
+   * Parse a path.
+   *
+   * \param [in] path The path, as given to the Config functions.
+   */
+  CompiledPath (std::string path);
+  /**
+   * Copy constructor.
+   *
+   * \param [in] o The CompiledPath to copy; the parsed path is shared.
+   */
+  CompiledPath (const CompiledPath &o);
+  /**
+   * Assignment operator.
+   *
+   * \param [in] o The CompiledPath to copy; the parsed path is shared.
+   * \returns This CompiledPath.
+   */
+  CompiledPath & operator = (const CompiledPath &o);
+  /** Destructor. */
+  ~CompiledPath ();
+
+  /**
+   * \returns The path.
+   */
+  std::string GetPath (void) const;
+
+  /**
+   * \returns A container of the objects which match the path.
+   * \sa ns3::Config::LookupMatches
+   */
+  MatchContainer LookupMatches (void) const;
+  /**
+   * \param [in] value The value to set to the attribute named by the
+   *                   last segment of the path.
+   * \sa ns3::Config::Set
+   */
+  void Set (const AttributeValue &value) const;
+  /**
+   * \param [in] cb The sink to connect to the trace source named by the
+   *                last segment of the path.
+   * \sa ns3::Config::Connect
+   */
+  void Connect (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The sink to connect to the trace source named by the
+   *                last segment of the path.
+   * \sa ns3::Config::ConnectWithoutContext
+   */
+  void ConnectWithoutContext (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The sink to disconnect from the trace source named by
+   *                the last segment of the path.
+   * \sa ns3::Config::Disconnect
+   */
+  void Disconnect (const CallbackBase &cb) const;
+  /**
+   * \param [in] cb The sink to disconnect from the trace source named by
+   *                the last segment of the path.
+   * \sa ns3::Config::DisconnectWithoutContext
+   */
+  void DisconnectWithoutContext (const CallbackBase &cb) const;
+
+private:
+  /**
+   * \returns A container of the objects which match the path up to its
+   *          last segment.
+   */
+  MatchContainer LookupLeafMatches (void) const;
+
+  /** The parsed path. */
+  Ptr<const ParsedPath> m_path;
+};
+
 /**
  * \ingroup config
  * \param [in] obj A new root object
@@ -16,7 +16,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-#include <map>
+#include <unordered_map>
 #include "object.h"
 #include "log.h"
 #include "assert.h"
@@ -73,15 +73,17 @@ public:
   NameNode *m_parent;
   /** The name of this NameNode. */
   std::string m_name;
+  /** The path of this NameNode, without the "/Names/" prefix. */
+  std::string m_path;
   /** The object corresponding to this NameNode. */
   Ptr<Object> m_object;
 
   /** Children of this NameNode. */
-  std::map<std::string, NameNode *> m_nameMap;
+  std::unordered_map<std::string, NameNode *> m_nameMap;
 };
 
 NameNode::NameNode ()
-  : m_parent (0), m_name (""), m_object (0)
+  : m_parent (0), m_name (""), m_path (""), m_object (0)
 {
 }
 
@@ -89,6 +91,7 @@ NameNode::NameNode (const NameNode &nameNode)
 {
   m_parent = nameNode.m_parent;
   m_name = nameNode.m_name;
+  m_path = nameNode.m_path;
   m_object = nameNode.m_object;
   m_nameMap = nameNode.m_nameMap;
 }
@@ -98,6 +101,7 @@ NameNode::operator = (const NameNode &rhs)
 {
   m_parent = rhs.m_parent;
   m_name = rhs.m_name;
+  m_path = rhs.m_path;
   m_object = rhs.m_object;
   m_nameMap = rhs.m_nameMap;
   return *this;
@@ -191,12 +195,34 @@ private:
    * \returns \c true if \c name already exists as a child of \c node.
    */
   bool IsDuplicateName (NameNode *node, std::string name);
+  /**
+   * Set the path of a NameNode and of its children, and add them
+   * to the path map.
+   *
+   * A NameNode whose name contains a '/' cannot be reached by a path,
+   * since Find splits the path at each '/', so neither it nor its
+   * children are added to the path map.
+   *
+   * \param [in] node The NameNode.
+   */
+  void AddPath (NameNode *node);
+  /**
+   * Remove a NameNode and its children from the path map.
+   *
+   * \param [in] node The NameNode.
+   */
+  void RemovePath (NameNode *node);
 
   /** The root NameNode. */
   NameNode m_root;
 
   /** Map from object pointers to their NameNodes. */
-  std::map<Ptr<Object>, NameNode *> m_objectMap;
+  std::unordered_map<Object *, NameNode *> m_objectMap;
+  /**
+   * Map from the paths, without the "/Names/" prefix, to their
+   * NameNodes, so that Find does not walk the naming tree.
+   */
+  std::unordered_map<std::string, NameNode *> m_pathMap;
 };
 
 NamesPriv::NamesPriv ()
@@ -223,13 +249,14 @@ NamesPriv::Clear (void)
   // Every name is associated with an object in the object map, so freeing the
   // NameNodes in this map will free all of the memory allocated for the NameNodes
   //
-  for (std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.begin (); i != m_objectMap.end (); ++i)
+  for (std::unordered_map<Object *, NameNode *>::iterator i = m_objectMap.begin (); i != m_objectMap.end (); ++i)
     {
       delete i->second;
       i->second = 0;
     }
 
   m_objectMap.clear ();
+  m_pathMap.clear ();
 
   m_root.m_parent = 0;
   m_root.m_name = "Names";
@@ -340,7 +367,8 @@ NamesPriv::Add (Ptr<Object> context, std::string name, Ptr<Object> object)
 
   NameNode *newNode = new NameNode (node, name, object);
   node->m_nameMap[name] = newNode;
-  m_objectMap[object] = newNode;
+  m_objectMap[PeekPointer (object)] = newNode;
+  AddPath (newNode);
 
   return true;
 }
@@ -442,7 +470,7 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
       return false;
     }
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (oldname);
+  std::unordered_map<std::string, NameNode *>::iterator i = node->m_nameMap.find (oldname);
   if (i == node->m_nameMap.end ())
     {
       NS_LOG_LOGIC ("Old name does not exist in name map");
@@ -457,12 +485,16 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
       // 1.  Geting the pointer to the name node from the map and remembering it;
       // 2.  Removing the map entry corresponding to oldname from the map;
       // 3.  Changing the name string in the name node;
-      // 4.  Adding the name node back in the map under the newname.
+      // 4.  Adding the name node back in the map under the newname;
+      // 5.  Replacing the paths of the name node and of its children in
+      //     the path map.
       //
       NameNode *changeNode = i->second;
       node->m_nameMap.erase (i);
+      RemovePath (changeNode);
       changeNode->m_name = newname;
       node->m_nameMap[newname] = changeNode;
+      AddPath (changeNode);
       return true;
     }
 }
@@ -472,7 +504,7 @@ NamesPriv::FindName (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
+  std::unordered_map<Object *, NameNode *>::iterator i = m_objectMap.find (PeekPointer (object));
   if (i == m_objectMap.end ())
     {
       NS_LOG_LOGIC ("Object does not exist in object map");
@@ -490,7 +522,7 @@ NamesPriv::FindPath (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
+  std::unordered_map<Object *, NameNode *>::iterator i = m_objectMap.find (PeekPointer (object));
   if (i == m_objectMap.end ())
     {
       NS_LOG_LOGIC ("Object does not exist in object map");
@@ -500,16 +532,7 @@ NamesPriv::FindPath (Ptr<Object> object)
   NameNode *p = i->second;
   NS_ASSERT_MSG (p, "NamesPriv::FindFullName(): Internal error: Invalid NameNode pointer from map");
 
-  std::string path;
-
-  do
-    {
-      path = "/" + p->m_name + path;
-      NS_LOG_LOGIC ("path is " << path);
-    }
-  while ((p = p->m_parent) != 0);
-
-  return path;
+  return "/" + m_root.m_name + "/" + p->m_path;
 }
 
 
@@ -547,64 +570,26 @@ NamesPriv::Find (std::string path)
       remaining = path;
     }
 
-  NameNode *node = &m_root;
-
   //
   // The string <remaining> is now composed entirely of path segments in
   // the /Names name space and we have eaten the leading slash. e.g., 
   // remaining = "ClientNode/eth0"
   //
-  // The start of the search is always at the root of the name space.
+  // Rather than walking the naming tree segment by segment, we look the
+  // whole path up in the path map, which holds the path of every NameNode
+  // that can be reached by a path.
   //
-  for (;;)
+  std::unordered_map<std::string, NameNode *>::iterator i = m_pathMap.find (remaining);
+  if (i == m_pathMap.end ())
     {
-      NS_LOG_LOGIC ("Looking for the object of name " << remaining);
-      offset = remaining.find ("/");
-      if (offset == std::string::npos)
-        {
-          //
-          // There are no remaining slashes so this is the last segment of the 
-          // specified name.  We're done when we find it
-          //
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (remaining);
-          if (i == node->m_nameMap.end ())
-            {
-              NS_LOG_LOGIC ("Name does not exist in name map");
-              return 0;
-            }
-          else
-            {
-              NS_LOG_LOGIC ("Name parsed, found object");
-              return i->second->m_object;
-            }
-        }
-      else
-        {
-          //
-          // There are more slashes so this is an intermediate segment of the 
-          // specified name.  We need to "recurse" when we find this segment.
-          //
-          offset = remaining.find ("/");
-          std::string segment = remaining.substr (0, offset);
-
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (segment);
-          if (i == node->m_nameMap.end ())
-            {
-              NS_LOG_LOGIC ("Name does not exist in name map");
-              return 0;
-            }
-          else
-            {
-              node = i->second;
-              remaining = remaining.substr (offset + 1);
-              NS_LOG_LOGIC ("Intermediate segment parsed");
-              continue;
-            }
-        }
+      NS_LOG_LOGIC ("Path does not exist in path map");
+      return 0;
+    }
+  else
+    {
+      NS_LOG_LOGIC ("Path exists in path map, found object");
+      return i->second->m_object;
     }
-
-  NS_ASSERT_MSG (node, "NamesPriv::Find(): Internal error:  this can't happen");
-  return 0;
 }
 
 Ptr<Object>
@@ -641,7 +626,7 @@ NamesPriv::Find (Ptr<Object> context, std::string name)
         }
     }
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
+  std::unordered_map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
   if (i == node->m_nameMap.end ())
     {
       NS_LOG_LOGIC ("Name does not exist in name map");
@@ -659,7 +644,7 @@ NamesPriv::IsNamed (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
+  std::unordered_map<Object *, NameNode *>::iterator i = m_objectMap.find (PeekPointer (object));
   if (i == m_objectMap.end ())
     {
       NS_LOG_LOGIC ("Object does not exist in object map, returning NameNode 0");
@@ -677,7 +662,7 @@ NamesPriv::IsDuplicateName (NameNode *node, std::string name)
 {
   NS_LOG_FUNCTION (this << node << name);
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
+  std::unordered_map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
   if (i == node->m_nameMap.end ())
     {
       NS_LOG_LOGIC ("Name does not exist in name map");
@@ -690,6 +675,61 @@ NamesPriv::IsDuplicateName (NameNode *node, std::string name)
     }
 }
 
+void
+NamesPriv::AddPath (NameNode *node)
+{
+  NS_LOG_FUNCTION (this << node);
+
+  NameNode *parent = node->m_parent;
+  if (parent == &m_root)
+    {
+      node->m_path = node->m_name;
+    }
+  else
+    {
+      node->m_path = parent->m_path + "/" + node->m_name;
+    }
+
+  //
+  // The parent of a NameNode which cannot be reached by a path is not in
+  // the path map, and neither are its children.
+  //
+  bool reachable = node->m_name.find ("/") == std::string::npos;
+  if (reachable && parent != &m_root)
+    {
+      std::unordered_map<std::string, NameNode *>::iterator i = m_pathMap.find (parent->m_path);
+      reachable = i != m_pathMap.end () && i->second == parent;
+    }
+  if (reachable)
+    {
+      NS_LOG_LOGIC ("Adding path " << node->m_path);
+      m_pathMap[node->m_path] = node;
+    }
+
+  for (std::unordered_map<std::string, NameNode *>::iterator i = node->m_nameMap.begin (); i != node->m_nameMap.end (); ++i)
+    {
+      AddPath (i->second);
+    }
+}
+
+void
+NamesPriv::RemovePath (NameNode *node)
+{
+  NS_LOG_FUNCTION (this << node);
+
+  std::unordered_map<std::string, NameNode *>::iterator i = m_pathMap.find (node->m_path);
+  if (i != m_pathMap.end () && i->second == node)
+    {
+      NS_LOG_LOGIC ("Removing path " << node->m_path);
+      m_pathMap.erase (i);
+    }
+
+  for (std::unordered_map<std::string, NameNode *>::iterator j = node->m_nameMap.begin (); j != node->m_nameMap.end (); ++j)
+    {
+      RemovePath (j->second);
+    }
+}
+
 void
 Names::Add (std::string name, Ptr<Object> object)
 {
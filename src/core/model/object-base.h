@@ -40,15 +40,22 @@
  *
  * If the class is in a namespace, then the macro call should also be
  * in the namespace.
+ *
+ * The TypeId is not constructed when the program starts: it is
+ * constructed when it is first looked up by name, or when the TypeIds
+ * are enumerated (see TypeId::DeferRegistration).
  */
 #define NS_OBJECT_ENSURE_REGISTERED(type)               \
   static struct Object ## type ## RegistrationClass     \
   {                                                     \
-    Object ## type ## RegistrationClass () {            \
+    static void Register (void) {                       \
       ns3::TypeId tid = type::GetTypeId ();             \
       tid.SetSize (sizeof (type));                      \
       tid.GetParent ();                                 \
     }                                                   \
+    Object ## type ## RegistrationClass () {            \
+      ns3::TypeId::DeferRegistration (#type, &Register); \
+    }                                                   \
   } Object ## type ## RegistrationVariable
 
 
@@ -71,11 +78,14 @@
   }                                                                    \
   static struct Object ## type ## param ## RegistrationClass           \
   {                                                                    \
-    Object ## type ## param ## RegistrationClass () {                  \
+    static void Register (void) {                                      \
       ns3::TypeId tid = type<param>::GetTypeId ();                     \
       tid.SetSize (sizeof (type<param>));                              \
       tid.GetParent ();                                                \
     }                                                                  \
+    Object ## type ## param ## RegistrationClass () {                  \
+      ns3::TypeId::DeferRegistration (#type "<" #param ">", &Register); \
+    }                                                                  \
   } Object ## type ## param ## RegistrationVariable
 
 
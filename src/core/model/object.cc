@@ -40,6 +40,77 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Object");
 
+namespace {
+
+/** The number of live Objects, by type. */
+struct LiveObjects
+{
+  /** Constructor. */
+  LiveObjects ()
+    : objectUid (Object::GetTypeId ().GetUid ()),
+      untyped (0)
+  {}
+  /**
+   * Add the Objects of a type.
+   *
+   * \param [in] tid The type of the Objects.
+   * \param [in] delta The number of Objects to add, or remove if negative.
+   */
+  void Add (TypeId tid, int32_t delta)
+  {
+    uint16_t uid = tid.GetUid ();
+    if (uid == objectUid)
+      {
+        untyped += delta;
+        return;
+      }
+    // walk up the hierarchy with the parents recorded when the type was
+    // first seen, as the TypeId database may be gone when the Objects
+    // held by static variables are destroyed
+    if (uid >= parents.size () || parents[uid] == 0)
+      {
+        for (TypeId cur = tid; cur.GetUid () != objectUid; cur = cur.GetParent ())
+          {
+            NS_ASSERT_MSG (cur.GetParent () != cur, tid.GetName () << " is not an Object");
+            if (cur.GetUid () >= parents.size ())
+              {
+                parents.resize (cur.GetUid () + 1, 0);
+                counts.resize (cur.GetUid () + 1, 0);
+              }
+            parents[cur.GetUid ()] = cur.GetParent ().GetUid ();
+          }
+      }
+    for (; uid != objectUid; uid = parents[uid])
+      {
+        counts[uid] += delta;
+      }
+  }
+  /** The uid of the Object TypeId. */
+  uint16_t objectUid;
+  /** The number of live Objects without a known type. */
+  uint32_t untyped;
+  /** The number of live Objects of each type, indexed by TypeId uid. */
+  std::vector<uint32_t> counts;
+  /** The parent of each type seen, indexed by TypeId uid. */
+  std::vector<uint16_t> parents;
+};
+
+/**
+ * Get the live Objects.
+ *
+ * Never deleted, so that it outlives the Objects held by static variables.
+ *
+ * \returns The live Objects.
+ */
+LiveObjects *
+GetLiveObjects (void)
+{
+  static LiveObjects *liveObjects = new LiveObjects ();
+  return liveObjects;
+}
+
+} // unnamed namespace
+
 /*********************************************************************
  *         The Object implementation
  *********************************************************************/
@@ -92,6 +163,29 @@ Object::GetTypeId (void)
   return tid;
 }
 
+uint32_t
+Object::GetLiveObjectN (TypeId tid)
+{
+  NS_LOG_FUNCTION (tid);
+  LiveObjects *liveObjects = GetLiveObjects ();
+  uint32_t n = liveObjects->untyped;
+  if (tid.GetUid () == liveObjects->objectUid || tid == ObjectBase::GetTypeId ())
+    {
+      for (uint32_t i = 0; i < liveObjects->counts.size (); i++)
+        {
+          if (liveObjects->parents[i] == liveObjects->objectUid)
+            {
+              n += liveObjects->counts[i];
+            }
+        }
+    }
+  else if (tid.GetUid () < liveObjects->counts.size ())
+    {
+      n += liveObjects->counts[tid.GetUid ()];
+    }
+  return n;
+}
+
 
 Object::Object ()
   : m_tid (Object::GetTypeId ()),
@@ -101,13 +195,16 @@ Object::Object ()
     m_getObjectCount (0)
 {
   NS_LOG_FUNCTION (this);
+  ClearCache (m_aggregates);
   m_aggregates->n = 1;
   m_aggregates->buffer[0] = this;
+  GetLiveObjects ()->untyped++;
 }
 Object::~Object () 
 {
   // remove this object from the aggregate list
   NS_LOG_FUNCTION (this);
+  GetLiveObjects ()->Add (m_tid, -1);
   uint32_t n = m_aggregates->n;
   for (uint32_t i = 0; i < n; i++)
     {
@@ -120,6 +217,8 @@ Object::~Object ()
           m_aggregates->n--;
         }
     }
+  // the cached lookups may return this object
+  ClearCache (m_aggregates);
   // finally, if all objects have been removed from the list,
   // delete the aggregate list
   if (m_aggregates->n == 0)
@@ -135,8 +234,10 @@ Object::Object (const Object &o)
     m_aggregates ((struct Aggregates *) std::malloc (sizeof (struct Aggregates))),
     m_getObjectCount (0)
 {
+  ClearCache (m_aggregates);
   m_aggregates->n = 1;
   m_aggregates->buffer[0] = this;
+  GetLiveObjects ()->Add (m_tid, 1);
 }
 void
 Object::Construct (const AttributeConstructionList &attributes)
@@ -151,33 +252,51 @@ Object::DoGetObject (TypeId tid) const
   NS_LOG_FUNCTION (this << tid);
   NS_ASSERT (CheckLoose ());
 
-  uint32_t n = m_aggregates->n;
-  TypeId objectTid = Object::GetTypeId ();
-  for (uint32_t i = 0; i < n; i++)
+  struct Aggregates::CacheEntry *entry =
+    &m_aggregates->cache[tid.GetUid () & (Aggregates::CACHE_SIZE - 1)];
+  if (entry->uid == tid.GetUid ())
     {
-      Object *current = m_aggregates->buffer[i];
-      TypeId cur = current->GetInstanceTypeId ();
-      while (cur != tid && cur != objectTid)
-        {
-          cur = cur.GetParent ();
-        }
-      if (cur == tid)
+      return entry->object;
+    }
+
+  // the aggregates are Objects, which cannot be found as an ObjectBase
+  Object *found = 0;
+  if (tid != ObjectBase::GetTypeId ())
+    {
+      uint32_t n = m_aggregates->n;
+      for (uint32_t i = 0; i < n; i++)
         {
-          // This is an attempt to 'cache' the result of this lookup.
-          // the idea is that if we perform a lookup for a TypeId on this object,
-          // we are likely to perform the same lookup later so, we make sure
-          // that the aggregate array is sorted by the number of accesses
-          // to each object.
-
-          // first, increment the access count
-          current->m_getObjectCount++;
-          // then, update the sort
-          UpdateSortedArray (m_aggregates, i);
-          // finally, return the match
-          return const_cast<Object *> (current);
+          Object *current = m_aggregates->buffer[i];
+          TypeId cur = current->GetInstanceTypeId ();
+          if (cur == tid || cur.IsChildOf (tid))
+            {
+              // This is an attempt to 'cache' the result of this lookup.
+              // the idea is that if we perform a lookup for a TypeId on this object,
+              // we are likely to perform the same lookup later so, we make sure
+              // that the aggregate array is sorted by the number of accesses
+              // to each object.
+
+              // first, increment the access count
+              current->m_getObjectCount++;
+              // then, update the sort
+              UpdateSortedArray (m_aggregates, i);
+              found = current;
+              break;
+            }
         }
     }
-  return 0;
+  entry->uid = tid.GetUid ();
+  entry->object = found;
+  return found;
+}
+void
+Object::ClearCache (struct Aggregates *aggregates)
+{
+  NS_LOG_FUNCTION (aggregates);
+  for (uint32_t i = 0; i < Aggregates::CACHE_SIZE; i++)
+    {
+      aggregates->cache[i].uid = 0;
+    }
 }
 void
 Object::Initialize (void)
@@ -262,6 +381,7 @@ Object::AggregateObject (Ptr<Object> o)
   uint32_t total = m_aggregates->n + other->m_aggregates->n;
   struct Aggregates *aggregates = 
     (struct Aggregates *)std::malloc (sizeof(struct Aggregates)+(total-1)*sizeof(Object*));
+  ClearCache (aggregates);
   aggregates->n = total;
 
   // copy our buffer to the new buffer
@@ -339,6 +459,9 @@ Object::SetTypeId (TypeId tid)
 {
   NS_LOG_FUNCTION (this << tid);
   NS_ASSERT (Check ());
+  LiveObjects *liveObjects = GetLiveObjects ();
+  liveObjects->Add (m_tid, -1);
+  liveObjects->Add (tid, 1);
   m_tid = tid;
 }
 
@@ -93,6 +93,20 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  /**
+   * \brief Get the number of live Objects of a type.
+   *
+   * The Objects of the subclasses of \p tid are included. The type
+   * of an Object is the TypeId given to it by CreateObject or by an
+   * ObjectFactory; the Objects created otherwise have no known type, and
+   * are counted for every TypeId. Hence, when this method returns zero,
+   * GetObject (tid) cannot succeed on any Object.
+   *
+   * \param [in] tid The TypeId.
+   * \returns The number of live Objects which may be of type \p tid.
+   */
+  static uint32_t GetLiveObjectN (TypeId tid);
+
   /**
    * \brief Iterate over the Objects aggregated to an ns3::Object.
    *
@@ -331,14 +345,37 @@ private:
    * chunk of memory than the struct to allow space for a larger
    * variable sized buffer whose size is indicated by the element
    * \c n
+   *
+   * The results of DoGetObject are cached in a small direct-mapped
+   * table indexed by TypeId uid, which is valid as long as the set of
+   * aggregated Objects does not change: aggregation allocates a new
+   * structure, and the destruction of an Object clears the cache.
    */
   struct Aggregates {
+    /** A DoGetObject result. */
+    struct CacheEntry {
+      /** The uid of the TypeId looked up, or 0 if the entry is empty. */
+      uint16_t uid;
+      /** The Object found, or 0 if none. */
+      Object *object;
+    };
+    /** The number of entries of \c cache; must be a power of 2. */
+    static const uint32_t CACHE_SIZE = 8;
+    /** The DoGetObject results, by TypeId uid modulo CACHE_SIZE. */
+    CacheEntry cache[CACHE_SIZE];
     /** The number of entries in \c buffer. */
     uint32_t n;
     /** The array of Objects. */
     Object *buffer[1];
   };
 
+  /**
+   * Clear the DoGetObject results cached in the aggregates.
+   *
+   * \param [in] aggregates The aggregates.
+   */
+  static void ClearCache (struct Aggregates *aggregates);
+
   /**
    * Find an Object of TypeId tid in the aggregates of this Object.
    *
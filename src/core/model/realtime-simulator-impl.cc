@@ -34,6 +34,7 @@
 
 
 #include <cmath>
+#include <algorithm>
 
 
 /**
@@ -69,6 +70,12 @@ RealtimeSimulatorImpl::GetTypeId (void)
                    TimeValue (Seconds (0.1)),
                    MakeTimeAccessor (&RealtimeSimulatorImpl::m_hardLimit),
                    MakeTimeChecker ())
+    .AddAttribute ("BatchSlack",
+                   "The events due within this time of the current real time "
+                   "are processed as a batch, without waiting for them.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&RealtimeSimulatorImpl::m_batchSlack),
+                   MakeTimeChecker (Seconds (0)))
   ;
   return tid;
 }
@@ -91,6 +98,9 @@ RealtimeSimulatorImpl::RealtimeSimulatorImpl ()
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
 
+  m_driftHistogram.resize (DRIFT_HISTOGRAM_BUCKETS, 0);
+  m_maxDrift = 0;
+
   m_main = SystemThread::Self();
 
   // Be very careful not to do anything that would cause a change or assignment
@@ -231,6 +241,16 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
         tsNow = m_synchronizer->GetCurrentRealtime ();
         tsNext = NextTs ();
 
+        //
+        // If the next event is due, or due within the batch slack, there is
+        // nothing to wait for: we process it right away, and so on for the
+        // events that follow it within the slack, as a batch.
+        //
+        if (tsNext <= tsNow + m_batchSlack.GetTimeStep ())
+          {
+            break;
+          }
+
         //
         // tsDelay is therefore the real time we need to delay in order to bring the
         // real time in sync with the simulation time.  If we wait for this amount of
@@ -359,25 +379,27 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
     // We check the simulation time against the current real time to make this
     // judgement.
     //
-    if (m_synchronizationMode == SYNC_HARD_LIMIT)
-      {
-        uint64_t tsFinal = m_synchronizer->GetCurrentRealtime ();
-        uint64_t tsJitter;
+    // The lateness of the event is also recorded in the drift histogram.
+    //
+    uint64_t tsFinal = m_synchronizer->GetCurrentRealtime ();
+    uint64_t tsJitter;
 
-        if (tsFinal >= m_currentTs)
-          {
-            tsJitter = tsFinal - m_currentTs;
-          }
-        else
-          {
-            tsJitter = m_currentTs - tsFinal;
-          }
+    if (tsFinal >= m_currentTs)
+      {
+        tsJitter = tsFinal - m_currentTs;
+        RecordDrift (tsJitter);
+      }
+    else
+      {
+        tsJitter = m_currentTs - tsFinal;
+        RecordDrift (0);
+      }
 
-        if (tsJitter > static_cast<uint64_t>(m_hardLimit.GetTimeStep ()))
-          {
-            NS_FATAL_ERROR ("RealtimeSimulatorImpl::ProcessOneEvent (): "
-                            "Hard real-time limit exceeded (jitter = " << tsJitter << ")");
-          }
+    if (m_synchronizationMode == SYNC_HARD_LIMIT
+        && tsJitter > static_cast<uint64_t>(m_hardLimit.GetTimeStep ()))
+      {
+        NS_FATAL_ERROR ("RealtimeSimulatorImpl::ProcessOneEvent (): "
+                        "Hard real-time limit exceeded (jitter = " << tsJitter << ")");
       }
   }
 
@@ -405,6 +427,34 @@ RealtimeSimulatorImpl::IsFinished (void) const
   return rc;
 }
 
+void
+RealtimeSimulatorImpl::RecordDrift (uint64_t tsDrift)
+{
+  m_maxDrift = std::max (m_maxDrift, tsDrift);
+  uint64_t us = tsDrift / MicroSeconds (1).GetTimeStep ();
+  uint32_t bucket = 0;
+  while (us > 0 && bucket < DRIFT_HISTOGRAM_BUCKETS - 1)
+    {
+      us >>= 1;
+      bucket++;
+    }
+  m_driftHistogram[bucket]++;
+}
+
+std::vector<uint64_t>
+RealtimeSimulatorImpl::GetDriftHistogram (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_driftHistogram;
+}
+
+Time
+RealtimeSimulatorImpl::GetMaxDrift (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return TimeStep (m_maxDrift);
+}
+
 //
 // Peeks into event list.  Should be called with critical section locked.
 //
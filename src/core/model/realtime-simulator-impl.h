@@ -32,6 +32,7 @@
 #include "system-mutex.h"
 
 #include <list>
+#include <vector>
 
 /**
  * \file
@@ -52,6 +53,12 @@ namespace ns3 {
  * \ingroup realtime
  *
  * Realtime version of SimulatorImpl.
+ *
+ * The events which are due within the \c BatchSlack attribute of the
+ * current real time are processed as a batch, without waiting, so that
+ * events that are late or close together don't each pay for a wait in
+ * the synchronizer.  The lateness of the events is recorded in a
+ * histogram, returned by GetDriftHistogram.
  */
 class RealtimeSimulatorImpl : public SimulatorImpl
 {
@@ -154,6 +161,26 @@ public:
    */
   Time GetHardLimit (void) const;
 
+  /** The number of buckets of the drift histogram. */
+  static const uint32_t DRIFT_HISTOGRAM_BUCKETS = 32;
+
+  /**
+   * Get the histogram of the lateness of the events processed so far,
+   * with respect to real time.
+   *
+   * Bucket 0 counts the events that were less than 1 us late (or early),
+   * and bucket \c i > 0 the events that were late by 2^(i-1) to 2^i us;
+   * the last bucket also counts the events that were later than that.
+   *
+   * \returns The drift histogram, with DRIFT_HISTOGRAM_BUCKETS buckets.
+   */
+  std::vector<uint64_t> GetDriftHistogram (void) const;
+  /**
+   * Get the lateness of the latest event processed so far.
+   * \returns The maximum drift.
+   */
+  Time GetMaxDrift (void) const;
+
 private:
   /**
    * Is the simulator running?
@@ -170,6 +197,11 @@ private:
    * \returns The timestep of the next event.
    */
   uint64_t NextTs (void) const;
+  /**
+   * Record the drift of an event in the drift histogram.
+   * \param [in] tsDrift The lateness of the event, in timesteps.
+   */
+  void RecordDrift (uint64_t tsDrift);
   /** Process the next event. */
   void ProcessOneEvent (void);
   /** Destructor implementation. */
@@ -216,6 +248,14 @@ private:
   /** The maximum allowable drift from real-time in SYNC_HARD_LIMIT mode. */
   Time m_hardLimit;
 
+  /** The events due within this time are processed without waiting. */
+  Time m_batchSlack;
+
+  /** The drift histogram. */
+  std::vector<uint64_t> m_driftHistogram;
+  /** The maximum drift, in timesteps. */
+  uint64_t m_maxDrift;
+
   /** Main SystemThread. */
   SystemThread::ThreadId m_main;
 };
@@ -23,12 +23,25 @@
 #include "system-path.h"
 #include "log.h"
 #include "des-metrics.h"
+#include "ns3/core-config.h"
 #include <cmath>
 #include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
 #include <vector>
 #include <list>
 #include <map>
 
+#if defined (HAVE_SYS_WAIT_H) && defined (HAVE_SYS_TYPES_H)
+/** Do we have fork() and waitpid(), to run tests in worker processes? */
+#define HAVE_FORK
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
 
 /**
  * \file
@@ -239,6 +252,31 @@ private:
   std::list<TestCase *> FilterTests (std::string testName,
                                      enum TestSuite::Type testType,
                                      enum TestCase::TestDuration maximumTestDuration);
+  /**
+   * Run a test, after setting up DES metrics if enabled.
+   *
+   * \param [in] test The test to run.
+   * \param [in] argc The number of arguments of the test runner.
+   * \param [in] argv The arguments of the test runner.
+   */
+  void RunTest (TestCase *test, int argc, char *argv[]);
+  /**
+   * Run tests in up to \p jobs worker processes, one per test.
+   *
+   * The output of each worker, and the report of its test, are
+   * printed in the order of \p tests, once the worker and the
+   * workers of the previous tests are done.
+   *
+   * \param [in] tests The tests to run.
+   * \param [in,out] os The stream of the reports.
+   * \param [in] xml Generate XML reports if \c true.
+   * \param [in] jobs The maximum number of workers.
+   * \param [in] argc The number of arguments of the test runner.
+   * \param [in] argv The arguments of the test runner.
+   * \returns \c true if a test failed or crashed.
+   */
+  bool RunWorkers (const std::list<TestCase *> &tests, std::ostream *os,
+                   bool xml, uint32_t jobs, int argc, char *argv[]);
 
 
   /** Container type for the test. */
@@ -756,6 +794,9 @@ TestRunnerImpl::PrintHelp (const char *program_name) const
             << "                           includes QUICK and TAKES_FOREVER includes " << std::endl
             << "                           QUICK and EXTENSIVE (only QUICK tests are " << std::endl
             << "                           run by default)" << std::endl
+            << "  --jobs=N               : run up to N test suites at once, in worker" << std::endl
+            << "                           processes; the reports keep the order of the" << std::endl
+            << "                           suites" << std::endl
             << "  --verbose              : print details of test execution" << std::endl
             << "  --xml                  : format test run output as xml" << std::endl
             << "  --tempdir=DIR          : set temp dir for tests to store output files" << std::endl
@@ -859,6 +900,192 @@ TestRunnerImpl::FilterTests (std::string testName,
 }
 
 
+void
+TestRunnerImpl::RunTest (TestCase *test, int argc, char *argv[])
+{
+  NS_LOG_FUNCTION (this << test << argc << argv);
+#ifdef ENABLE_DES_METRICS
+  {
+    /*
+      Reorganize argv
+      Since DES Metrics uses argv[0] for the trace file name,
+      grab the test name and put it in argv[0],
+      with test-runner as argv[1]
+      then the rest of the original arguments.
+    */
+    std::string testname = test->GetName ();
+    std::string runner = "[" + SystemPath::Split (argv[0]).back () + "]";
+
+    int  desargc = argc + 1;
+    char ** desargv = new char * [desargc];
+    desargv[0] = const_cast<char *>(testname.c_str ());
+    desargv[1] = const_cast<char *>(runner.c_str ());
+    for (int i = 2; i < desargc; ++i)
+      {
+        desargv[i] = argv[i - 1];
+      }
+    DesMetrics::Get ()->Initialize (desargc, desargv, m_tempDir);
+    delete [] desargv;
+  }
+#endif
+  
+
+  test->Run (this);
+}
+
+#ifdef HAVE_FORK
+/**
+ * Read the whole content of a temporary file, and close it.
+ * \param [in] file The file.
+ * \returns The content of the file.
+ */
+static std::string
+ReadTemporaryFile (FILE *file)
+{
+  std::string content;
+  std::rewind (file);
+  char buffer[4096];
+  std::size_t n;
+  while ((n = std::fread (buffer, 1, sizeof (buffer), file)) > 0)
+    {
+      content.append (buffer, n);
+    }
+  std::fclose (file);
+  return content;
+}
+#endif /* HAVE_FORK */
+
+bool
+TestRunnerImpl::RunWorkers (const std::list<TestCase *> &tests, std::ostream *os,
+                            bool xml, uint32_t jobs, int argc, char *argv[])
+{
+  NS_LOG_FUNCTION (this << &tests << os << xml << jobs << argc << argv);
+  bool failed = false;
+#ifdef HAVE_FORK
+  /** A test run by a worker process. */
+  struct Worker
+  {
+    TestCase *test;  //!< The test.
+    pid_t pid;       //!< The worker process.
+    FILE *out;       //!< The standard output of the worker.
+    FILE *err;       //!< The standard error of the worker.
+    FILE *report;    //!< The report of the test.
+    bool done;       //!< Whether the worker has exited.
+    int status;      //!< The exit status of the worker.
+  };
+  std::vector<struct Worker> workers;
+  for (std::list<TestCase *>::const_iterator i = tests.begin (); i != tests.end (); ++i)
+    {
+      struct Worker worker = { *i, 0, 0, 0, 0, false, 0 };
+      workers.push_back (worker);
+    }
+
+  uint32_t next = 0;     // the next test to start
+  uint32_t printed = 0;  // the number of tests reported
+  uint32_t running = 0;  // the number of workers running
+  bool stop = false;
+  while (printed < workers.size () && !stop)
+    {
+      while (running < jobs && next < workers.size ())
+        {
+          struct Worker &worker = workers[next++];
+          worker.out = std::tmpfile ();
+          worker.err = std::tmpfile ();
+          worker.report = std::tmpfile ();
+          NS_ABORT_MSG_IF (worker.out == 0 || worker.err == 0 || worker.report == 0,
+                           "Could not create the temporary files of a worker");
+          // Do not let the worker inherit pending output.
+          std::cout.flush ();
+          std::cerr.flush ();
+          os->flush ();
+          std::fflush (0);
+          worker.pid = fork ();
+          NS_ABORT_MSG_IF (worker.pid == -1, "Could not fork a worker");
+          if (worker.pid == 0)
+            {
+              dup2 (fileno (worker.out), 1);
+              dup2 (fileno (worker.err), 2);
+              RunTest (worker.test, argc, argv);
+              std::ostringstream report;
+              PrintReport (worker.test, &report, xml, 0);
+              std::fputs (report.str ().c_str (), worker.report);
+              std::cout.flush ();
+              std::cerr.flush ();
+              std::clog.flush ();
+              std::fflush (0);
+              // Do not run the exit handlers of the test runner.
+              _exit (worker.test->IsFailed () ? 1 : 0);
+            }
+          running++;
+        }
+
+      struct Worker &worker = workers[printed];
+      if (!worker.done)
+        {
+          int status;
+          pid_t pid = waitpid (-1, &status, 0);
+          NS_ABORT_MSG_IF (pid == -1, "Could not wait for the workers");
+          for (uint32_t i = 0; i < workers.size (); i++)
+            {
+              if (workers[i].pid == pid && !workers[i].done)
+                {
+                  workers[i].done = true;
+                  workers[i].status = status;
+                  running--;
+                }
+            }
+          continue;
+        }
+
+      // Print the output and the report of the test, in the order of the tests.
+      std::cout << ReadTemporaryFile (worker.out);
+      std::cerr << ReadTemporaryFile (worker.err);
+      std::string report = ReadTemporaryFile (worker.report);
+      bool crashed = !WIFEXITED (worker.status) || WEXITSTATUS (worker.status) > 1;
+      if (crashed)
+        {
+          std::string name = worker.test->GetName ();
+          if (xml)
+            {
+              *os << "<Test>" << std::endl
+                  << "  <Name>" << ReplaceXmlSpecialCharacters (name) << "</Name>" << std::endl
+                  << "  <Result>CRASH</Result>" << std::endl
+                  << "</Test>" << std::endl;
+            }
+          else
+            {
+              *os << "CRASH " << name << std::endl;
+            }
+        }
+      else
+        {
+          *os << report;
+        }
+      if (crashed || WEXITSTATUS (worker.status) != 0)
+        {
+          failed = true;
+          stop = !m_continueOnFailure;
+        }
+      printed++;
+    }
+
+  // Stop the workers of the tests which will not be reported.
+  for (uint32_t i = printed; i < next; i++)
+    {
+      struct Worker &worker = workers[i];
+      if (!worker.done)
+        {
+          kill (worker.pid, SIGKILL);
+          waitpid (worker.pid, 0, 0);
+        }
+      std::fclose (worker.out);
+      std::fclose (worker.err);
+      std::fclose (worker.report);
+    }
+#endif /* HAVE_FORK */
+  return failed;
+}
+
 int 
 TestRunnerImpl::Run (int argc, char *argv[])
 {
@@ -873,6 +1100,7 @@ TestRunnerImpl::Run (int argc, char *argv[])
   bool printTestTypeList = false;
   bool printTestNameList = false;
   bool printTestTypeAndName = false;
+  uint32_t jobs = 1;
   enum TestCase::TestDuration maximumTestDuration = TestCase::QUICK;
   char *progname = argv[0];
 
@@ -949,6 +1177,23 @@ TestRunnerImpl::Run (int argc, char *argv[])
         {
           out = arg + strlen("--out=");
         }
+      else if (strncmp(arg, "--jobs=", strlen("--jobs=")) == 0)
+        {
+          const char *value = arg + strlen("--jobs=");
+          char *end;
+          long n = strtol (value, &end, 10);
+          if (*value == '\0' || *end != '\0' || n < 1 || n > 0xffff)
+            {
+              std::cout << "Invalid number of jobs specified: " << value << std::endl;
+              return 1;
+            }
+          jobs = n;
+#ifndef HAVE_FORK
+          std::cerr << "Warning: --jobs is not supported on this system, "
+                    << "running the tests serially" << std::endl;
+          jobs = 1;
+#endif
+        }
       else if (strncmp(arg, "--fullness=", strlen("--fullness=")) == 0)
         {
           fullness = arg + strlen("--fullness=");
@@ -1062,36 +1307,20 @@ TestRunnerImpl::Run (int argc, char *argv[])
       std::cerr << "Error:  no tests match the requested string" << std::endl;
       return 1;
     }
-  for (std::list<TestCase *>::const_iterator i = tests.begin (); i != tests.end (); ++i)
+  bool parallel = jobs > 1 && tests.size () > 1;
+  if (parallel)
+    {
+      failed = RunWorkers (tests, os, xml, jobs, argc, argv);
+      if (failed && !m_continueOnFailure)
+        {
+          return 1;
+        }
+    }
+  for (std::list<TestCase *>::const_iterator i = tests.begin ();
+       !parallel && i != tests.end (); ++i)
     {
       TestCase *test = *i;
-
-#ifdef ENABLE_DES_METRICS
-      {
-        /*
-          Reorganize argv
-          Since DES Metrics uses argv[0] for the trace file name,
-          grab the test name and put it in argv[0],
-          with test-runner as argv[1]
-          then the rest of the original arguments.
-        */
-        std::string testname = test->GetName ();
-        std::string runner = "[" + SystemPath::Split (argv[0]).back () + "]";
-
-        int  desargc = argc + 1;
-        char ** desargv = new char * [desargc];
-        desargv[0] = const_cast<char *>(testname.c_str ());
-        desargv[1] = const_cast<char *>(runner.c_str ());
-        for (int i = 2; i < desargc; ++i)
-          {
-            desargv[i] = argv[i - 1];
-          }
-        DesMetrics::Get ()->Initialize (desargc, desargv, m_tempDir);
-        delete [] desargv;
-      }
-#endif
-      
-      test->Run (this);
+      RunTest (test, argc, argv);
       PrintReport (test, os, xml, 0);
       if (test->IsFailed ())
         {
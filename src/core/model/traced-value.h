@@ -207,7 +207,10 @@ public:
   void Set (const T &v) {
     if (m_v != v)
       {
-        m_cb (m_v, v);
+        if (!m_cb.IsEmpty ())
+          {
+            m_cb (m_v, v);
+          }
         m_v = v;
       }
   }
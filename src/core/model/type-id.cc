@@ -24,7 +24,9 @@
 #include "trace-source-accessor.h"
 
 #include <map>
+#include <unordered_map>
 #include <vector>
+#include <cstring>
 #include <sstream>
 #include <iomanip>
 
@@ -51,7 +53,19 @@ NS_LOG_COMPONENT_DEFINE ("TypeId");
  * \brief TypeId information manager
  *
  * Information records are stored in a vector.  Name and hash lookup
- * are performed by maps to the vector index.
+ * are performed by hash tables to the vector index.
+ *
+ * \internal
+ * <b>Deferred Registration</b>
+ *
+ * NS_OBJECT_ENSURE_REGISTERED() does not construct the type id of a
+ * class at static initialization, which would construct all the
+ * attributes and trace sources of all the classes of all the modules
+ * linked into a program.  It only records the class name and its
+ * registration function with DeferRegistration().  The pending
+ * registrations of a class are run when its type id is first looked
+ * up by name, and all of them are run as soon as the type ids are
+ * enumerated or looked up by hash.
  *
  * \internal
  * <b>Hash Chaining</b>
@@ -143,6 +157,13 @@ public:
    * \returns The parent type id of the type id.
    */
   uint16_t GetParent (uint16_t uid) const;
+  /**
+   * Check if a type id is a subclass of another.
+   * \param [in] uid The id.
+   * \param [in] other The id of the potential parent.
+   * \returns \c true if \p other is an ancestor of \p uid.
+   */
+  bool IsChildOf (uint16_t uid, uint16_t other) const;
   /**
    * Get the group name of a type id.
    * \param [in] uid The id.
@@ -182,6 +203,27 @@ public:
    * \returns The type id.
    */
   uint16_t GetRegistered (uint32_t i) const;
+  /**
+   * Record the registration of a class, to be run when its type id
+   * is first needed.
+   * \param [in] name The name of the class.
+   * \param [in] registration The function which registers the class.
+   */
+  void DeferRegistration (const char *name, void (*registration) (void));
+  /**
+   * Run the pending registrations of the classes which may register
+   * a type id.
+   * \param [in] name The name of the type id, or the empty string to
+   *             run all the pending registrations.
+   */
+  void RegisterPending (std::string name);
+  /**
+   * Get a type id by name, running the pending registrations it
+   * may depend on.
+   * \param [in] name The type id to find.
+   * \returns The type id.  A type id of 0 means \p name wasn't found.
+   */
+  uint16_t LookupUid (std::string name);
   /**
    * Record a new attribute in a type id.
    * \param [in] uid The id.
@@ -319,6 +361,11 @@ private:
     TypeId::SupportLevel supportLevel;
     /** Support message. */
     std::string supportMsg;
+    /**
+     * The ancestors, as a bitset indexed by uid, computed by IsChildOf
+     * on first use; empty if not computed yet.
+     */
+    std::vector<bool> ancestors;
   };
   /** Iterator type. */
   typedef std::vector<struct IidInformation>::const_iterator Iterator;
@@ -334,15 +381,26 @@ private:
   std::vector<struct IidInformation> m_information;
 
   /** Type of the by-name index. */
-  typedef std::map<std::string, uint16_t> namemap_t;
+  typedef std::unordered_map<std::string, uint16_t> namemap_t;
   /** The by-name index. */
   namemap_t m_namemap;
 
   /** Type of the by-hash index. */
-  typedef std::map<TypeId::hash_t, uint16_t> hashmap_t;
+  typedef std::unordered_map<TypeId::hash_t, uint16_t> hashmap_t;
   /** The by-hash index. */
   hashmap_t m_hashmap;
 
+  /** A registration recorded by DeferRegistration(). */
+  struct PendingRegistration
+  {
+    /** The name of the class. */
+    const char *name;
+    /** The function which registers the class. */
+    void (*registration) (void);
+  };
+  /** The registrations which have not been run yet. */
+  std::vector<struct PendingRegistration> m_pending;
+
 
   /** IidManager constants. */
   enum {
@@ -456,6 +514,11 @@ IidManager::SetParent (uint16_t uid, uint16_t parent)
   NS_ASSERT (parent <= m_information.size ());
   struct IidInformation *information = LookupInformation (uid);
   information->parent = parent;
+  // the ancestors of the subclasses of uid have changed
+  for (std::vector<struct IidInformation>::iterator i = m_information.begin (); i != m_information.end (); i++)
+    {
+      i->ancestors.clear ();
+    }
 }
 void 
 IidManager::SetGroupName (uint16_t uid, std::string groupName)
@@ -544,6 +607,27 @@ IidManager::GetParent (uint16_t uid) const
   NS_LOG_LOGIC (IIDL << pid);
   return pid;
 }
+bool
+IidManager::IsChildOf (uint16_t uid, uint16_t other) const
+{
+  NS_LOG_FUNCTION (IID << uid << other);
+  struct IidInformation *information = LookupInformation (uid);
+  if (information->ancestors.empty ())
+    {
+      // the size is at least one, to tell the computed bitset apart
+      information->ancestors.resize (m_information.size () + 1, false);
+      uint16_t cur = uid;
+      uint16_t parent = information->parent;
+      while (parent != cur && parent != 0)
+        {
+          information->ancestors[parent] = true;
+          cur = parent;
+          parent = LookupInformation (cur)->parent;
+        }
+    }
+  // the types allocated after the bitset was computed are not ancestors
+  return other < information->ancestors.size () && information->ancestors[other];
+}
 std::string 
 IidManager::GetGroupName (uint16_t uid) const
 {
@@ -597,6 +681,77 @@ IidManager::GetRegistered (uint32_t i) const
   return i + 1;
 }
 
+void
+IidManager::DeferRegistration (const char *name, void (*registration) (void))
+{
+  NS_LOG_FUNCTION (IID << name << registration);
+  struct PendingRegistration pending;
+  pending.name = name;
+  pending.registration = registration;
+  m_pending.push_back (pending);
+}
+
+void
+IidManager::RegisterPending (std::string name)
+{
+  NS_LOG_FUNCTION (IID << name << m_pending.size ());
+  if (m_pending.empty ())
+    {
+      return;
+    }
+  // The class name is the type id name without its namespace.
+  std::string::size_type colon = name.rfind ("::");
+  std::string className = name;
+  if (colon != std::string::npos)
+    {
+      className = name.substr (colon + 2);
+    }
+  // The registrations are removed from m_pending before they are run,
+  // since they may look up other type ids, and run other pending
+  // registrations.
+  std::vector<struct PendingRegistration> ready;
+  std::vector<struct PendingRegistration>::iterator i = m_pending.begin ();
+  while (i != m_pending.end ())
+    {
+      if (name.empty ()
+          || std::strcmp (i->name, name.c_str ()) == 0
+          || std::strcmp (i->name, className.c_str ()) == 0)
+        {
+          ready.push_back (*i);
+          i = m_pending.erase (i);
+        }
+      else
+        {
+          i++;
+        }
+    }
+  for (std::vector<struct PendingRegistration>::iterator j = ready.begin ();
+       j != ready.end (); j++)
+    {
+      NS_LOG_LOGIC (IIDL << "register " << j->name);
+      j->registration ();
+    }
+}
+
+uint16_t
+IidManager::LookupUid (std::string name)
+{
+  NS_LOG_FUNCTION (IID << name);
+  uint16_t uid = GetUid (name);
+  if (uid == 0 && !m_pending.empty ())
+    {
+      RegisterPending (name);
+      uid = GetUid (name);
+      if (uid == 0)
+        {
+          // The type id is not named after its class.
+          RegisterPending ("");
+          uid = GetUid (name);
+        }
+    }
+  return uid;
+}
+
 bool
 IidManager::HasAttribute (uint16_t uid,
                           std::string name)
@@ -813,7 +968,7 @@ TypeId
 TypeId::LookupByName (std::string name)
 {
   NS_LOG_FUNCTION (name);
-  uint16_t uid = IidManager::Get ()->GetUid (name);
+  uint16_t uid = IidManager::Get ()->LookupUid (name);
   NS_ASSERT_MSG (uid != 0, "Assert in TypeId::LookupByName: " << name << " not found");
   return TypeId (uid);
 }
@@ -821,7 +976,7 @@ bool
 TypeId::LookupByNameFailSafe (std::string name, TypeId *tid)
 {
   NS_LOG_FUNCTION (name << tid->GetUid ());
-  uint16_t uid = IidManager::Get ()->GetUid (name);
+  uint16_t uid = IidManager::Get ()->LookupUid (name);
   if (uid == 0)
     {
       return false;
@@ -832,6 +987,7 @@ TypeId::LookupByNameFailSafe (std::string name, TypeId *tid)
 TypeId
 TypeId::LookupByHash (hash_t hash)
 {
+  IidManager::Get ()->RegisterPending ("");
   uint16_t uid = IidManager::Get ()->GetUid (hash);
   NS_ASSERT_MSG (uid != 0, "Assert in TypeId::LookupByHash: 0x"
                  << std::hex << hash << std::dec << " not found");
@@ -840,6 +996,7 @@ TypeId::LookupByHash (hash_t hash)
 bool
 TypeId::LookupByHashFailSafe (hash_t hash, TypeId *tid)
 {
+  IidManager::Get ()->RegisterPending ("");
   uint16_t uid = IidManager::Get ()->GetUid (hash);
   if (uid == 0)
     {
@@ -853,14 +1010,22 @@ uint32_t
 TypeId::GetRegisteredN (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  IidManager::Get ()->RegisterPending ("");
   return IidManager::Get ()->GetRegisteredN ();
 }
 TypeId 
 TypeId::GetRegistered (uint32_t i)
 {
   NS_LOG_FUNCTION (i);
+  IidManager::Get ()->RegisterPending ("");
   return TypeId (IidManager::Get ()->GetRegistered (i));
 }
+void
+TypeId::DeferRegistration (const char *name, void (*registration) (void))
+{
+  NS_LOG_FUNCTION (name << registration);
+  IidManager::Get ()->DeferRegistration (name, registration);
+}
 
 bool
 TypeId::LookupAttributeByName (std::string name, struct TypeId::AttributeInformation *info) const
@@ -939,12 +1104,7 @@ bool
 TypeId::IsChildOf (TypeId other) const
 {
   NS_LOG_FUNCTION (this << other.GetUid ());
-  TypeId tmp = *this;
-  while (tmp != other && tmp != tmp.GetParent ())
-    {
-      tmp = tmp.GetParent ();
-    }
-  return tmp == other && *this != other;
+  return IidManager::Get ()->IsChildOf (m_tid, other.m_tid);
 }
 std::string 
 TypeId::GetGroupName (void) const
@@ -164,6 +164,19 @@ public:
    * \returns The TypeId instance whose index is \c i.
    */
   static TypeId GetRegistered (uint32_t i);
+  /**
+   * Record the registration of a class, to be run when its TypeId is
+   * first looked up by name, or when the TypeIds are enumerated or
+   * looked up by hash.
+   *
+   * This is used by NS_OBJECT_ENSURE_REGISTERED(), so that a program
+   * does not construct the TypeIds of all the classes it is linked
+   * with when it starts.
+   *
+   * \param [in] name The name of the class, without its namespace.
+   * \param [in] registration The function which registers the class.
+   */
+  static void DeferRegistration (const char *name, void (*registration) (void));
 
   /**
    * Constructor.
@@ -204,6 +217,8 @@ public:
    * Calling this method is roughly similar to calling dynamic_cast
    * except that you do not need object instances: you can do the check
    * with TypeId instances instead.
+   *
+   * The ancestors of each TypeId are computed once, on the first call.
    */
   bool IsChildOf (TypeId other) const;
 
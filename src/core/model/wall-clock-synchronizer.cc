@@ -23,6 +23,7 @@
 
 #include "log.h"
 #include "system-condition.h"
+#include "nstime.h"
 
 #include "wall-clock-synchronizer.h"
 
@@ -44,6 +45,13 @@ WallClockSynchronizer::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::WallClockSynchronizer")
     .SetParent<Synchronizer> ()
     .SetGroupName ("Core")
+    .AddAttribute ("BusyPollTime",
+                   "If not zero, sleep until this time before the target "
+                   "time, and busy-wait for the rest, rather than sleeping "
+                   "for most of the wait (lower jitter, but more CPU time).",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&WallClockSynchronizer::m_busyPollTime),
+                   MakeTimeChecker (Seconds (0)))
   ;
   return tid;
 }
@@ -192,6 +200,21 @@ WallClockSynchronizer::DoSynchronize (uint64_t nsCurrent, uint64_t nsDelay)
   uint64_t ns = DriftCorrect (nsCurrent, nsDelay);
   NS_LOG_INFO ("Synchronize ns = " << ns);
 //
+// In busy-poll mode, the wake-up latency of the sleep is absorbed by the
+// busy wait, provided that it is shorter than the busy-poll time.
+//
+  uint64_t nsBusyPoll = m_busyPollTime.GetNanoSeconds ();
+  if (nsBusyPoll > 0)
+    {
+      if (ns > nsBusyPoll && SleepWait (ns - nsBusyPoll) == false)
+        {
+          NS_LOG_INFO ("SleepWait interrupted");
+          return false;
+        }
+      NS_LOG_INFO ("SpinWait until " << nsCurrent + nsDelay);
+      return SpinWait (nsCurrent + nsDelay);
+    }
+//
 // Once we've decided on how long we need to delay, we need to split this
 // time into sleep waits and busy waits.  The reason for this is described
 // in the comments for the constructor where jiffies and jiffy resolution is
@@ -374,9 +397,15 @@ uint64_t
 WallClockSynchronizer::GetRealtime (void)
 {
   NS_LOG_FUNCTION (this);
+#ifdef CLOCK_REALTIME
+  struct timespec tsNow;
+  clock_gettime (CLOCK_REALTIME, &tsNow);
+  return tsNow.tv_sec * NS_PER_SEC + tsNow.tv_nsec;
+#else
   struct timeval tvNow;
   gettimeofday (&tvNow, NULL);
   return TimevalToNs (&tvNow);
+#endif
 }
 
 uint64_t
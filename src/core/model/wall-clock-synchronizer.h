@@ -21,6 +21,7 @@
 
 #include "system-condition.h"
 #include "synchronizer.h"
+#include "nstime.h"
 
 /**
  * @file
@@ -62,6 +63,15 @@ namespace ns3 {
  *
  * @todo Add more on jiffies, sleep, processes, etc.
  *
+ * Waking up from a sleep takes tens of microseconds, or more on a loaded
+ * system, so events are typically late by that much.  The @c BusyPollTime
+ * attribute trades CPU time for accuracy: the synchronizer sleeps until
+ * @c BusyPollTime before the target time, and busy-waits for the rest.
+ * @code
+ *   Config::SetDefault ("ns3::WallClockSynchronizer::BusyPollTime",
+ *                       TimeValue (MicroSeconds (100)));
+ * @endcode
+ *
  * @internal
  * Nanosleep takes a <tt>struct timeval</tt> as an input so we have to
  * deal with conversion between Time and @c timeval here.
@@ -196,6 +206,9 @@ protected:
 
   /** Thread synchronizer. */
   SystemCondition m_condition;
+
+  /** Time busy-waited before the target time, if not zero. */
+  Time m_busyPollTime;
 };
 
 } // namespace ns3
@@ -557,6 +557,178 @@ NullifyCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (target1.IsNull (), true, "Nullified Callback reports not IsNull()");
 }
 
+// ===========================================================================
+// Test the copy of Callbacks whose implementation is stored in place
+// ===========================================================================
+class CopyCallbackTestCase : public TestCase
+{
+public:
+  CopyCallbackTestCase ();
+  virtual ~CopyCallbackTestCase () {}
+
+  void Target1 (int a) { m_test1 += a; }
+  void Target2 (int a) { m_test2 += a; }
+
+private:
+  virtual void DoRun (void);
+  virtual void DoSetup (void);
+
+  int m_test1;
+  int m_test2;
+};
+
+/** A reference counted object, to check the references held by Callbacks. */
+class CopyCallbackTestObject : public SimpleRefCount<CopyCallbackTestObject>
+{
+public:
+  void Target (int a) { m_value = a; }
+  int m_value;
+};
+
+static int gCopyCallbackTest3;
+
+static int gCopyCallbackMisaligned;
+
+/** A functor aligned more strictly than the storage of a Callback. */
+struct alignas (16) CopyCallbackAlignedFunctor
+{
+  /**
+   * Count the invocations of a misaligned functor.
+   * \param a The value passed to the Callback.
+   */
+  void operator () (int a) const
+  {
+    if (reinterpret_cast<uintptr_t> (this) % alignof (CopyCallbackAlignedFunctor) != 0)
+      {
+        gCopyCallbackMisaligned++;
+      }
+    gCopyCallbackTest3 += a;
+  }
+  /**
+   * Compare two functors, as Callback::IsEqual does.
+   * \returns \c false, all these functors are equal.
+   */
+  bool operator != (const CopyCallbackAlignedFunctor &) const
+  {
+    return false;
+  }
+};
+
+/** A Callback at an offset which misaligns its storage for 16 bytes. */
+struct alignas (16) CopyCallbackAlignedHolder
+{
+  Callback<void, int> m_callback;  //!< The Callback.
+};
+
+void
+CopyCallbackTarget3 (int a)
+{
+  gCopyCallbackTest3 += a;
+}
+
+CopyCallbackTestCase::CopyCallbackTestCase ()
+  : TestCase ("Check the copy of Callbacks stored in place")
+{
+}
+
+void
+CopyCallbackTestCase::DoSetup (void)
+{
+  m_test1 = 0;
+  m_test2 = 0;
+  gCopyCallbackTest3 = 0;
+}
+
+void
+CopyCallbackTestCase::DoRun (void)
+{
+  //
+  // A copy invokes the same target, and is equal to the original, even
+  // after the original is gone.
+  //
+  Callback<void, int> copy;
+  {
+    Callback<void, int> target1 = MakeCallback (&CopyCallbackTestCase::Target1, this);
+    copy = target1;
+    NS_TEST_ASSERT_MSG_EQ (copy.IsEqual (target1), true, "Copy not equal to the original");
+  }
+  copy (1);
+  NS_TEST_ASSERT_MSG_EQ (m_test1, 1, "Copy did not fire");
+  NS_TEST_ASSERT_MSG_EQ (copy.IsEqual (MakeCallback (&CopyCallbackTestCase::Target1, this)), true,
+                         "Copy not equal to a new Callback to the same target");
+  NS_TEST_ASSERT_MSG_EQ (copy.IsEqual (MakeCallback (&CopyCallbackTestCase::Target2, this)), false,
+                         "Copy equal to a Callback to another target");
+
+  //
+  // Assignment replaces the target, and self assignment keeps it.
+  //
+  copy = MakeCallback (&CopyCallbackTestCase::Target2, this);
+  Callback<void, int> &self = copy;
+  copy = self;
+  copy (2);
+  NS_TEST_ASSERT_MSG_EQ (m_test1, 1, "Replaced target fired");
+  NS_TEST_ASSERT_MSG_EQ (m_test2, 2, "Assigned target did not fire");
+
+  //
+  // Function Callbacks, and Callbacks adopted through CallbackBase,
+  // are copied too.
+  //
+  CallbackBase base = MakeCallback (&CopyCallbackTarget3);
+  Callback<void, int> target3;
+  NS_TEST_ASSERT_MSG_EQ (target3.Assign (base), true, "Callback not assigned");
+  base = CallbackBase ();
+  target3 (3);
+  NS_TEST_ASSERT_MSG_EQ (gCopyCallbackTest3, 3, "Assigned Callback did not fire");
+
+  //
+  // A bound Callback holds its own copy of the Callback it binds.
+  //
+  Callback<void> bound = MakeCallback (&CopyCallbackTestCase::Target1, this).Bind (4);
+  bound ();
+  NS_TEST_ASSERT_MSG_EQ (m_test1, 5, "Bound Callback did not fire");
+
+  //
+  // Each copy of a Callback to a Ptr holds a reference to the object,
+  // which is released when the copy is destroyed or nullified.
+  //
+  Ptr<CopyCallbackTestObject> object = Create<CopyCallbackTestObject> ();
+  {
+    Callback<void, int> target4 = MakeCallback (&CopyCallbackTestObject::Target, object);
+    Callback<void, int> copy4 = target4;
+    NS_TEST_ASSERT_MSG_EQ (object->GetReferenceCount (), 3, "References not held by the copies");
+    copy4.Nullify ();
+    NS_TEST_ASSERT_MSG_EQ (copy4.IsNull (), true, "Nullified Callback reports not IsNull()");
+    NS_TEST_ASSERT_MSG_EQ (object->GetReferenceCount (), 2, "Reference not released by Nullify");
+    target4 (5);
+  }
+  NS_TEST_ASSERT_MSG_EQ (object->m_value, 5, "Callback to a Ptr did not fire");
+  NS_TEST_ASSERT_MSG_EQ (object->GetReferenceCount (), 1, "References not released");
+
+  //
+  // A functor which needs a stricter alignment than the storage of the
+  // Callback is not stored in place.
+  //
+  gCopyCallbackMisaligned = 0;
+  CopyCallbackAlignedHolder holder;
+  holder.m_callback = Callback<void, int> (CopyCallbackAlignedFunctor (), true, true);
+  holder.m_callback (6);
+  CopyCallbackAlignedHolder copyHolder;
+  copyHolder.m_callback = holder.m_callback;
+  copyHolder.m_callback (7);
+  NS_TEST_ASSERT_MSG_EQ (gCopyCallbackTest3, 16, "Aligned functor Callback did not fire");
+  NS_TEST_ASSERT_MSG_EQ (gCopyCallbackMisaligned, 0, "Functor stored misaligned in a Callback");
+
+  //
+  // The copies of a CallbackValue serialize to the same string.
+  //
+  CallbackValue value (MakeCallback (&CopyCallbackTestCase::Target1, this));
+  Ptr<AttributeValue> valueCopy = value.Copy ();
+  NS_TEST_ASSERT_MSG_EQ (valueCopy->SerializeToString (0), value.SerializeToString (0),
+                         "Copies of a CallbackValue serialized differently");
+  NS_TEST_ASSERT_MSG_EQ (CallbackValue ().SerializeToString (0), "0",
+                         "Null CallbackValue not serialized as 0");
+}
+
 // ===========================================================================
 // Make sure that various MakeCallback template functions compile and execute.
 // Doesn't check an results of the execution.
@@ -704,6 +876,7 @@ CallbackTestSuite::CallbackTestSuite ()
   AddTestCase (new MakeCallbackTestCase, TestCase::QUICK);
   AddTestCase (new MakeBoundCallbackTestCase, TestCase::QUICK);
   AddTestCase (new NullifyCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new CopyCallbackTestCase, TestCase::QUICK);
   AddTestCase (new MakeCallbackTemplatesTestCase, TestCase::QUICK);
 }
 
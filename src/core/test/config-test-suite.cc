@@ -721,6 +721,114 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+// ===========================================================================
+// Test for the compiled paths, which are parsed once and resolved against
+// the current objects each time they are used.
+// ===========================================================================
+class CompiledPathConfigTestCase : public TestCase
+{
+public:
+  CompiledPathConfigTestCase ();
+  virtual ~CompiledPathConfigTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+};
+
+CompiledPathConfigTestCase::CompiledPathConfigTestCase ()
+  : TestCase ("Check that compiled paths match the same objects as the Config functions")
+{
+}
+
+void
+CompiledPathConfigTestCase::DoRun (void)
+{
+  IntegerValue iv;
+
+  //
+  // Set aside the roots of the other test cases, which have the same
+  // attributes as the root of this one.
+  //
+  std::vector<Ptr<Object> > roots;
+  while (Config::GetRootNamespaceObjectN () > 0)
+    {
+      roots.push_back (Config::GetRootNamespaceObject (0));
+      Config::UnregisterRootNamespaceObject (roots.back ());
+    }
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  Names::Add ("CompiledPathRoot", root);
+
+  std::vector<Ptr<ConfigTestObject> > nodes;
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      nodes.push_back (CreateObject<ConfigTestObject> ());
+      root->AddNodeA (nodes.back ());
+    }
+
+  //
+  // An index segment with ranges, in any order, matches each object once
+  // and in index order.
+  //
+  Config::CompiledPath ranges ("/NodesA/[1-3]|0|[2-2]");
+  Config::MatchContainer matches = ranges.LookupMatches ();
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 4, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (0), "/NodesA/0/", "Wrong first match");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (3), "/NodesA/3/", "Wrong last match");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (3), nodes[3], "Wrong object matched");
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/NodesA/[1-3]|0|[2-2]").GetN (), 4, "Config::LookupMatches does not match");
+
+  Config::CompiledPath set ("/NodesA/[1-3]|0/A");
+  set.Set (IntegerValue (3));
+  nodes[3]->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 3, "Attribute not set through a compiled path");
+  nodes[4]->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 10, "Attribute set outside of the ranges");
+
+  //
+  // The path is resolved again each time, so it finds the new objects.
+  //
+  Config::CompiledPath all ("/NodesA/*/B");
+  all.Set (IntegerValue (-5));
+  nodes.push_back (CreateObject<ConfigTestObject> ());
+  root->AddNodeA (nodes.back ());
+  all.Set (IntegerValue (-6));
+  for (uint32_t i = 0; i < nodes.size (); i++)
+    {
+      nodes[i]->GetAttribute ("B", iv);
+      NS_TEST_ASSERT_MSG_EQ (iv.Get (), -6, "Attribute not set on object " << i);
+    }
+
+  //
+  // The object name service is consulted as well.
+  //
+  Config::CompiledPath named ("/Names/CompiledPathRoot/NodesA/5/A");
+  named.Set (IntegerValue (7));
+  nodes[5]->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 7, "Attribute not set through a named path");
+
+  //
+  // A path through a type without live objects matches nothing; once such
+  // an object exists, it is found.
+  //
+  Config::CompiledPath aggregated ("/NodesA/*/$DerivedConfigObject");
+  NS_TEST_ASSERT_MSG_EQ (aggregated.LookupMatches ().GetN (), 0, "Unexpected match");
+  nodes[2]->AggregateObject (CreateObject<DerivedConfigObject> ());
+  matches = aggregated.LookupMatches ();
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 1, "Aggregated object not found");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (0), "/NodesA/2/$DerivedConfigObject/", "Wrong match");
+  NS_TEST_ASSERT_MSG_EQ (Config::CompiledPath ("/NodesA/*/$BaseConfigObject").LookupMatches ().GetN (), 1,
+                         "Object not found through its parent type");
+
+  Names::Clear ();
+  Config::UnregisterRootNamespaceObject (root);
+  for (uint32_t i = 0; i < roots.size (); i++)
+    {
+      Config::RegisterRootNamespaceObject (roots[i]);
+    }
+}
+
 // ===========================================================================
 // The Test Suite that glues all of the Test Cases together.
 // ===========================================================================
@@ -737,6 +845,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase, TestCase::QUICK);
   AddTestCase (new ObjectVectorConfigTestCase, TestCase::QUICK);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase, TestCase::QUICK);
+  AddTestCase (new CompiledPathConfigTestCase, TestCase::QUICK);
 }
 
 static ConfigTestSuite configTestSuite;
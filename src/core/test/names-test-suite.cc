@@ -929,6 +929,87 @@ AlternateFindTestCase::DoRun (void)
                          "Unexpectedly able to GetObject<TestObject> on an AlternateTestObject");
 }
 
+// ===========================================================================
+// Test case to make sure that the paths of the Objects found by Names::Find
+// and Names::FindPath follow Names::Rename of a parent and Names::Clear.
+// ===========================================================================
+class RenameParentFindTestCase : public TestCase
+{
+public:
+  RenameParentFindTestCase ();
+  virtual ~RenameParentFindTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+RenameParentFindTestCase::RenameParentFindTestCase ()
+  : TestCase ("Check Names::Find and Names::FindPath after renaming a parent")
+{
+}
+
+RenameParentFindTestCase::~RenameParentFindTestCase ()
+{
+}
+
+void
+RenameParentFindTestCase::DoTeardown (void)
+{
+  Names::Clear ();
+}
+
+void
+RenameParentFindTestCase::DoRun (void)
+{
+  Ptr<TestObject> found;
+
+  Ptr<TestObject> objectOne = CreateObject<TestObject> ();
+  Names::Add ("Name", objectOne);
+
+  Ptr<TestObject> childOfObjectOne = CreateObject<TestObject> ();
+  Names::Add ("Name/Child", childOfObjectOne);
+
+  Ptr<TestObject> grandChildOfObjectOne = CreateObject<TestObject> ();
+  Names::Add ("Name/Child/Grandchild", grandChildOfObjectOne);
+
+  Names::Rename ("Name", "New Name");
+
+  found = Names::Find<TestObject> ("/Names/Name/Child/Grandchild");
+  NS_TEST_ASSERT_MSG_EQ (found, 0, "Unexpectedly found an Object under the old name of its parent");
+
+  found = Names::Find<TestObject> ("/Names/New Name/Child/Grandchild");
+  NS_TEST_ASSERT_MSG_EQ (found, grandChildOfObjectOne, "Could not find an Object under the new name of its parent");
+
+  found = Names::Find<TestObject> ("New Name/Child");
+  NS_TEST_ASSERT_MSG_EQ (found, childOfObjectOne, "Could not find an Object under the new name of its parent");
+
+  std::string path = Names::FindPath (grandChildOfObjectOne);
+  NS_TEST_ASSERT_MSG_EQ (path, "/Names/New Name/Child/Grandchild", "Unexpected path after renaming a parent");
+
+  //
+  // A name which contains a '/' can only be found through its context, as
+  // before, and does not hide the object with the same path.
+  //
+  Ptr<TestObject> objectTwo = CreateObject<TestObject> ();
+  Names::Add (Ptr<Object> (0, false), "New Name/Child", objectTwo);
+
+  found = Names::Find<TestObject> ("New Name/Child");
+  NS_TEST_ASSERT_MSG_EQ (found, childOfObjectOne, "An Object with a '/' in its name hid another Object");
+
+  found = Names::Find<TestObject> (Ptr<Object> (0, false), "New Name/Child");
+  NS_TEST_ASSERT_MSG_EQ (found, objectTwo, "Could not find an Object with a '/' in its name via object context");
+
+  Names::Clear ();
+
+  found = Names::Find<TestObject> ("/Names/New Name/Child/Grandchild");
+  NS_TEST_ASSERT_MSG_EQ (found, 0, "Unexpectedly found an Object after Names::Clear");
+
+  Names::Add ("New Name", objectOne);
+  found = Names::Find<TestObject> ("/Names/New Name/Child");
+  NS_TEST_ASSERT_MSG_EQ (found, 0, "Unexpectedly found a cleared child Object");
+}
+
 class NamesTestSuite : public TestSuite
 {
 public:
@@ -952,6 +1033,7 @@ NamesTestSuite::NamesTestSuite ()
   AddTestCase (new FullyQualifiedFindTestCase, TestCase::QUICK);
   AddTestCase (new RelativeFindTestCase, TestCase::QUICK);
   AddTestCase (new AlternateFindTestCase, TestCase::QUICK);
+  AddTestCase (new RenameParentFindTestCase, TestCase::QUICK);
 }
 
 static NamesTestSuite namesTestSuite;
@@ -359,6 +359,67 @@ AggregateObjectTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_NE (baseA, 0, "Unable to GetObject on released object");
 }
 
+// ===========================================================================
+// Test case to make sure that the cached lookups follow the aggregation.
+// ===========================================================================
+class AggregateCacheTestCase : public TestCase
+{
+public:
+  AggregateCacheTestCase ();
+  virtual ~AggregateCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AggregateCacheTestCase::AggregateCacheTestCase ()
+  : TestCase ("Check the GetObject cache")
+{
+}
+
+AggregateCacheTestCase::~AggregateCacheTestCase ()
+{
+}
+
+void
+AggregateCacheTestCase::DoRun (void)
+{
+  Ptr<DerivedA> derivedA = CreateObject<DerivedA> ();
+  Ptr<BaseB> baseB = CreateObject<BaseB> ();
+  Ptr<DerivedB> derivedB = CreateObject<DerivedB> ();
+
+  //
+  // Look up the same types several times, so that the results are cached,
+  // before and after each aggregation.
+  //
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (derivedA->GetObject<BaseB> (), 0, "Unexpectedly found a BaseB");
+      NS_TEST_ASSERT_MSG_EQ (derivedA->GetObject<Object> (BaseA::GetTypeId ()), derivedA, "Parent type not found");
+    }
+  derivedA->AggregateObject (baseB);
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (derivedA->GetObject<BaseB> (), baseB, "BaseB not found after aggregation");
+      NS_TEST_ASSERT_MSG_EQ (derivedA->GetObject<DerivedB> (), 0, "Unexpectedly found a DerivedB");
+      NS_TEST_ASSERT_MSG_EQ (baseB->GetObject<Object> (DerivedA::GetTypeId ()), derivedA, "DerivedA not found through baseB");
+    }
+
+  //
+  // Each aggregation has its own cache.
+  //
+  Ptr<BaseA> other = CreateObject<BaseA> ();
+  other->AggregateObject (derivedB);
+  NS_TEST_ASSERT_MSG_EQ (other->GetObject<BaseB> (), derivedB, "BaseB part of a DerivedB not found");
+  NS_TEST_ASSERT_MSG_EQ (other->GetObject<DerivedA> (), 0, "Unexpectedly found a DerivedA");
+
+  //
+  // The lookups of ObjectBase fail, as before the cache.
+  //
+  NS_TEST_ASSERT_MSG_EQ (derivedA->GetObject<Object> (ObjectBase::GetTypeId ()), 0, "Unexpectedly found an ObjectBase");
+  NS_TEST_ASSERT_MSG_NE (derivedA->GetObject<Object> (Object::GetTypeId ()), 0, "Object not found");
+}
+
 // ===========================================================================
 // Test case to make sure that an Object factory can create Objects
 // ===========================================================================
@@ -431,6 +492,67 @@ ObjectFactoryTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_NE (a->GetObject<DerivedA> (), 0, "Unexpectedly able to work around C++ type system");
 }
 
+// ===========================================================================
+// Test case to make sure that the live Objects are counted by type.
+// ===========================================================================
+class LiveObjectTestCase : public TestCase
+{
+public:
+  LiveObjectTestCase ();
+  virtual ~LiveObjectTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LiveObjectTestCase::LiveObjectTestCase ()
+  : TestCase ("Check Object::GetLiveObjectN")
+{
+}
+
+LiveObjectTestCase::~LiveObjectTestCase ()
+{
+}
+
+void
+LiveObjectTestCase::DoRun (void)
+{
+  uint32_t baseN = Object::GetLiveObjectN (BaseB::GetTypeId ());
+  uint32_t derivedN = Object::GetLiveObjectN (DerivedB::GetTypeId ());
+  uint32_t objectN = Object::GetLiveObjectN (Object::GetTypeId ());
+
+  //
+  // The Objects of a derived type are counted for their parent types, the
+  // Objects made by a factory like those made by CreateObject.
+  //
+  Ptr<BaseB> baseB = CreateObject<BaseB> ();
+  ObjectFactory factory;
+  factory.SetTypeId (DerivedB::GetTypeId ());
+  Ptr<Object> derivedB = factory.Create ();
+  NS_TEST_ASSERT_MSG_EQ (Object::GetLiveObjectN (BaseB::GetTypeId ()), baseN + 2, "Wrong number of BaseB");
+  NS_TEST_ASSERT_MSG_EQ (Object::GetLiveObjectN (DerivedB::GetTypeId ()), derivedN + 1, "Wrong number of DerivedB");
+  NS_TEST_ASSERT_MSG_EQ (Object::GetLiveObjectN (Object::GetTypeId ()), objectN + 2, "Wrong number of Object");
+
+  //
+  // An Object which did not get its type from CreateObject may be of any type.
+  //
+  Ptr<BaseB> untyped = Create<BaseB> ();
+  NS_TEST_ASSERT_MSG_EQ (Object::GetLiveObjectN (DerivedB::GetTypeId ()), derivedN + 2, "Untyped Object not counted");
+
+  //
+  // Copies are counted as well, and destroyed Objects are not.
+  //
+  Ptr<DerivedB> copy = CopyObject<DerivedB> (DynamicCast<DerivedB> (derivedB));
+  NS_TEST_ASSERT_MSG_EQ (Object::GetLiveObjectN (DerivedB::GetTypeId ()), derivedN + 3, "Copy not counted");
+  baseB = 0;
+  derivedB = 0;
+  untyped = 0;
+  copy = 0;
+  NS_TEST_ASSERT_MSG_EQ (Object::GetLiveObjectN (BaseB::GetTypeId ()), baseN, "Destroyed BaseB counted");
+  NS_TEST_ASSERT_MSG_EQ (Object::GetLiveObjectN (DerivedB::GetTypeId ()), derivedN, "Destroyed DerivedB counted");
+  NS_TEST_ASSERT_MSG_EQ (Object::GetLiveObjectN (Object::GetTypeId ()), objectN, "Destroyed Object counted");
+}
+
 // ===========================================================================
 // The Test Suite that glues the Test Cases together.
 // ===========================================================================
@@ -445,7 +567,9 @@ ObjectTestSuite::ObjectTestSuite ()
 {
   AddTestCase (new CreateObjectTestCase, TestCase::QUICK);
   AddTestCase (new AggregateObjectTestCase, TestCase::QUICK);
+  AddTestCase (new AggregateCacheTestCase, TestCase::QUICK);
   AddTestCase (new ObjectFactoryTestCase, TestCase::QUICK);
+  AddTestCase (new LiveObjectTestCase, TestCase::QUICK);
 }
 
 static ObjectTestSuite objectTestSuite;
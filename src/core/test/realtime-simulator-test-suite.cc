@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/realtime-simulator-impl.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/nstime.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup core-tests
+ * \ingroup tests
+ *
+ * \brief RealtimeSimulatorImpl synchronization test
+ *
+ * Events are scheduled a few milliseconds apart, with the given busy-poll
+ * time and batch slack.  Without slack, no event may run before its time
+ * in real time; with a slack larger than the whole schedule, all the
+ * events must run as a batch at the start of the simulation.  In both
+ * cases, the drift histogram must count every event, and its highest
+ * bucket must match the maximum drift.
+ */
+class RealtimeSimulatorTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param busyPollTime the busy-poll time of the synchronizer
+   * \param batchSlack the batch slack of the simulator
+   */
+  RealtimeSimulatorTestCase (Time busyPollTime, Time batchSlack);
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * \brief Check the real time of an event
+   */
+  void Event (void);
+
+  Time m_busyPollTime; //!< the busy-poll time of the synchronizer
+  Time m_batchSlack;   //!< the batch slack of the simulator
+  uint32_t m_events;   //!< number of events run
+  uint32_t m_early;    //!< number of events run before their time
+  Time m_latestRealtime; //!< latest real time of an event
+};
+
+/// The number of events
+static const uint32_t REALTIME_TEST_EVENTS = 100;
+
+RealtimeSimulatorTestCase::RealtimeSimulatorTestCase (Time busyPollTime, Time batchSlack)
+  : TestCase ("Realtime simulator with busy-poll time " + std::to_string (busyPollTime.GetMicroSeconds ())
+              + " us and batch slack " + std::to_string (batchSlack.GetMicroSeconds ()) + " us"),
+    m_busyPollTime (busyPollTime),
+    m_batchSlack (batchSlack),
+    m_events (0),
+    m_early (0)
+{
+}
+
+void
+RealtimeSimulatorTestCase::DoSetup (void)
+{
+  Config::SetDefault ("ns3::WallClockSynchronizer::BusyPollTime", TimeValue (m_busyPollTime));
+  Config::SetDefault ("ns3::RealtimeSimulatorImpl::BatchSlack", TimeValue (m_batchSlack));
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::RealtimeSimulatorImpl"));
+}
+
+void
+RealtimeSimulatorTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::SetDefault ("ns3::WallClockSynchronizer::BusyPollTime", TimeValue (Seconds (0)));
+  Config::SetDefault ("ns3::RealtimeSimulatorImpl::BatchSlack", TimeValue (Seconds (0)));
+}
+
+void
+RealtimeSimulatorTestCase::Event (void)
+{
+  Ptr<RealtimeSimulatorImpl> impl = DynamicCast<RealtimeSimulatorImpl> (Simulator::GetImplementation ());
+  Time realtime = impl->RealtimeNow ();
+  if (realtime < Simulator::Now ())
+    {
+      m_early++;
+    }
+  m_latestRealtime = Max (m_latestRealtime, realtime);
+  m_events++;
+}
+
+void
+RealtimeSimulatorTestCase::DoRun (void)
+{
+  Ptr<RealtimeSimulatorImpl> impl = DynamicCast<RealtimeSimulatorImpl> (Simulator::GetImplementation ());
+  NS_TEST_ASSERT_MSG_NE (impl, 0, "Not a realtime simulator");
+
+  for (uint32_t i = 0; i < REALTIME_TEST_EVENTS; i++)
+    {
+      Simulator::Schedule (MilliSeconds (100) + MicroSeconds (500 * i), &RealtimeSimulatorTestCase::Event, this);
+    }
+  // the realtime simulator waits for external events until it is stopped
+  Simulator::Stop (MilliSeconds (200));
+  Simulator::Run ();
+
+  std::vector<uint64_t> histogram = impl->GetDriftHistogram ();
+  Time maxDrift = impl->GetMaxDrift ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_events, REALTIME_TEST_EVENTS, "Events lost");
+  if (m_batchSlack.IsZero ())
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_early, 0, "Events run before their time");
+    }
+  else
+    {
+      // the events are all due within the slack, so none waits for its time
+      NS_TEST_EXPECT_MSG_LT (m_latestRealtime, MilliSeconds (100), "Events not run as a batch");
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (histogram.size (), RealtimeSimulatorImpl::DRIFT_HISTOGRAM_BUCKETS, "Wrong number of buckets");
+  uint64_t count = 0;
+  uint32_t highest = 0;
+  for (uint32_t i = 0; i < histogram.size (); i++)
+    {
+      count += histogram[i];
+      highest = (histogram[i] > 0 ? i : highest);
+    }
+  NS_TEST_EXPECT_MSG_EQ (count, REALTIME_TEST_EVENTS + 1, "Events missing from the drift histogram (with the stop event)");
+  uint64_t maxDriftUs = maxDrift.GetMicroSeconds ();
+  uint32_t maxDriftBucket = 0;
+  for (; maxDriftUs > 0; maxDriftUs >>= 1)
+    {
+      maxDriftBucket++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (highest, std::min (maxDriftBucket, RealtimeSimulatorImpl::DRIFT_HISTOGRAM_BUCKETS - 1),
+                         "Maximum drift not in the highest bucket");
+}
+
+/**
+ * \ingroup core-tests
+ * \ingroup tests
+ *
+ * \brief RealtimeSimulatorImpl TestSuite
+ */
+class RealtimeSimulatorTestSuite : public TestSuite
+{
+public:
+  RealtimeSimulatorTestSuite () : TestSuite ("realtime-simulator", UNIT)
+  {
+    AddTestCase (new RealtimeSimulatorTestCase (Seconds (0), Seconds (0)), TestCase::QUICK);
+    AddTestCase (new RealtimeSimulatorTestCase (MicroSeconds (200), Seconds (0)), TestCase::QUICK);
+    AddTestCase (new RealtimeSimulatorTestCase (Seconds (0), Seconds (1)), TestCase::QUICK);
+  }
+};
+
+static RealtimeSimulatorTestSuite g_realtimeSimulatorTestSuite; //!< Static variable for test initialization
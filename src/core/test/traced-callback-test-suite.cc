@@ -108,6 +108,71 @@ BasicTracedCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_two, true, "Callback CbTwo not called");
 }
 
+class ChainTracedCallbackTestCase : public TestCase
+{
+public:
+  ChainTracedCallbackTestCase ();
+  virtual ~ChainTracedCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  void CbConnect (uint8_t a, double b);
+  void CbCount (uint8_t a, double b);
+
+  TracedCallback<uint8_t, double> m_trace;
+  uint32_t m_count;
+};
+
+ChainTracedCallbackTestCase::ChainTracedCallbackTestCase ()
+  : TestCase ("Check TracedCallback chain emptiness and growth")
+{
+}
+
+void
+ChainTracedCallbackTestCase::CbConnect (uint8_t a, double b)
+{
+  // Each call connects several callbacks, so that the chain
+  // must grow while it is invoked
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      m_trace.ConnectWithoutContext (MakeCallback (&ChainTracedCallbackTestCase::CbCount, this));
+    }
+}
+
+void
+ChainTracedCallbackTestCase::CbCount (uint8_t a, double b)
+{
+  m_count++;
+}
+
+void
+ChainTracedCallbackTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "New chain is not empty");
+
+  m_trace.ConnectWithoutContext (MakeCallback (&ChainTracedCallbackTestCase::CbConnect, this));
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), false, "Chain with a callback is empty");
+
+  //
+  // The callbacks connected while the chain is invoked are invoked too.
+  //
+  m_count = 0;
+  m_trace (1, 2);
+  NS_TEST_ASSERT_MSG_EQ (m_count, 8, "Callbacks connected by CbConnect not called");
+
+  //
+  // Once CbConnect and all the callbacks it connected are
+  // disconnected, the chain is empty again.
+  //
+  m_trace.DisconnectWithoutContext (MakeCallback (&ChainTracedCallbackTestCase::CbConnect, this));
+  m_trace.DisconnectWithoutContext (MakeCallback (&ChainTracedCallbackTestCase::CbCount, this));
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "Chain is not empty after disconnection");
+  m_count = 0;
+  m_trace (1, 2);
+  NS_TEST_ASSERT_MSG_EQ (m_count, 0, "Callback CbCount unexpectedly called");
+}
+
 class TracedCallbackTestSuite : public TestSuite
 {
 public:
@@ -118,6 +183,7 @@ TracedCallbackTestSuite::TracedCallbackTestSuite ()
   : TestSuite ("traced-callback", UNIT)
 {
   AddTestCase (new BasicTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new ChainTracedCallbackTestCase, TestCase::QUICK);
 }
 
 static TracedCallbackTestSuite tracedCallbackTestSuite;
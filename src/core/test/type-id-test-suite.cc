@@ -21,6 +21,7 @@
 #include <iostream>
 #include <iomanip>
 #include <ctime>
+#include <sstream>
 
 #include "ns3/integer.h"
 #include "ns3/double.h"
@@ -325,6 +326,146 @@ DeprecatedAttributeTestCase::DoRun (void)
        << endl;
 }
 
+
+//----------------------------
+//
+// Test for the parent checks
+
+class IsChildOfTestCase : public TestCase
+{
+public:
+  IsChildOfTestCase ();
+  virtual ~IsChildOfTestCase ();
+private:
+  virtual void DoRun (void);
+
+};
+
+IsChildOfTestCase::IsChildOfTestCase ()
+  : TestCase ("Check IsChildOf")
+{
+}
+
+IsChildOfTestCase::~IsChildOfTestCase ()
+{
+}
+
+void
+IsChildOfTestCase::DoRun (void)
+{
+  TypeId parent = TypeId ("IsChildOfTest:Parent").SetParent<Object> ();
+  TypeId child = TypeId ("IsChildOfTest:Child").SetParent (parent);
+
+  NS_TEST_ASSERT_MSG_EQ (child.IsChildOf (parent), true, "parent");
+  NS_TEST_ASSERT_MSG_EQ (child.IsChildOf (Object::GetTypeId ()), true, "grandparent");
+  NS_TEST_ASSERT_MSG_EQ (child.IsChildOf (ObjectBase::GetTypeId ()), true, "root");
+  NS_TEST_ASSERT_MSG_EQ (child.IsChildOf (child), false, "self");
+  NS_TEST_ASSERT_MSG_EQ (parent.IsChildOf (child), false, "child");
+  NS_TEST_ASSERT_MSG_EQ (ObjectBase::GetTypeId ().IsChildOf (Object::GetTypeId ()), false, "root child");
+
+  // the types registered later are not ancestors
+  TypeId later = TypeId ("IsChildOfTest:Later").SetParent<Object> ();
+  NS_TEST_ASSERT_MSG_EQ (child.IsChildOf (later), false, "later type");
+
+  // changing a parent changes the ancestors of the subclasses
+  parent.SetParent (later);
+  NS_TEST_ASSERT_MSG_EQ (child.IsChildOf (later), true, "new grandparent");
+  NS_TEST_ASSERT_MSG_EQ (child.IsChildOf (Object::GetTypeId ()), true, "grandparent after change");
+}
+
+
+
+//----------------------------
+//
+// Test for the deferred registrations
+
+/**
+ * A class registered with a deferred registration.
+ */
+template <int N>
+class DeferredTestObject : public Object
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId (GetName ().c_str ())
+      .SetParent<Object> ()
+      .HideFromDocumentation ();
+    return tid;
+  }
+  /**
+   * \return The name of this type.
+   */
+  static std::string GetName (void)
+  {
+    std::ostringstream oss;
+    oss << (N == 1 ? "DeferredTest:Renamed" : "ns3::DeferredTestObject") << N;
+    return oss.str ();
+  }
+  /** Run the registration of this type. */
+  static void Register (void)
+  {
+    m_registered = true;
+    GetTypeId ();
+  }
+  static bool m_registered; //!< Whether Register has been run.
+};
+
+template <int N>
+bool DeferredTestObject<N>::m_registered = false;
+
+class DeferredRegistrationTestCase : public TestCase
+{
+public:
+  DeferredRegistrationTestCase ();
+  virtual ~DeferredRegistrationTestCase ();
+private:
+  virtual void DoRun (void);
+
+};
+
+DeferredRegistrationTestCase::DeferredRegistrationTestCase ()
+  : TestCase ("Check deferred registrations")
+{
+}
+
+DeferredRegistrationTestCase::~DeferredRegistrationTestCase ()
+{
+}
+
+void
+DeferredRegistrationTestCase::DoRun (void)
+{
+  TypeId::DeferRegistration ("DeferredTestObject0", &DeferredTestObject<0>::Register);
+  TypeId::DeferRegistration ("DeferredTestObject1", &DeferredTestObject<1>::Register);
+  NS_TEST_ASSERT_MSG_EQ (DeferredTestObject<0>::m_registered, false, "registered early");
+  NS_TEST_ASSERT_MSG_EQ (DeferredTestObject<1>::m_registered, false, "registered early");
+
+  // a lookup only registers the class named after the type id
+  TypeId tid;
+  NS_TEST_ASSERT_MSG_EQ (TypeId::LookupByNameFailSafe ("ns3::DeferredTestObject0", &tid),
+                         true, "lookup by class name");
+  NS_TEST_ASSERT_MSG_EQ (tid, DeferredTestObject<0>::GetTypeId (), "type id");
+  NS_TEST_ASSERT_MSG_EQ (DeferredTestObject<0>::m_registered, true, "class name");
+  NS_TEST_ASSERT_MSG_EQ (DeferredTestObject<1>::m_registered, false, "other class name");
+
+  // a type id which is not named after its class is still found
+  NS_TEST_ASSERT_MSG_EQ (TypeId::LookupByNameFailSafe ("DeferredTest:Renamed1", &tid),
+                         true, "lookup by other name");
+  NS_TEST_ASSERT_MSG_EQ (DeferredTestObject<1>::m_registered, true, "other name");
+
+  // the enumeration of the type ids registers all the classes
+  TypeId::DeferRegistration ("DeferredTestObject2", &DeferredTestObject<2>::Register);
+  uint32_t n = TypeId::GetRegisteredN ();
+  NS_TEST_ASSERT_MSG_EQ (DeferredTestObject<2>::m_registered, true, "enumeration");
+  NS_TEST_ASSERT_MSG_EQ (TypeId::GetRegistered (n - 1), DeferredTestObject<2>::GetTypeId (),
+                         "last type id");
+}
+
   
 //----------------------------
 //
@@ -437,6 +578,8 @@ TypeIdTestSuite::TypeIdTestSuite ()
   AddTestCase (new UniqueTypeIdTestCase, QUICK);
   AddTestCase (new CollisionTestCase, QUICK);
   AddTestCase (new DeprecatedAttributeTestCase, QUICK);
+  AddTestCase (new IsChildOfTestCase, QUICK);
+  AddTestCase (new DeferredRegistrationTestCase, QUICK);
 }
 
 static TypeIdTestSuite g_TypeIdTestSuite;  
@@ -112,6 +112,29 @@ CsmaHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool prom
     }
 }
 
+void
+CsmaHelper::EnablePcapNgInternal (Ptr<PcapNgFileWrapper> file, Ptr<NetDevice> nd, bool promiscuous)
+{
+  Ptr<CsmaNetDevice> device = nd->GetObject<CsmaNetDevice> ();
+  if (device == 0)
+    {
+      NS_LOG_INFO ("CsmaHelper::EnablePcapNgInternal(): Device " << device << " not of type ns3::CsmaNetDevice");
+      return;
+    }
+
+  PcapHelper pcapHelper;
+  uint32_t interfaceId = file->AddInterface (PcapHelper::DLT_EN10MB,
+                                             pcapHelper.GetInterfaceNameFromDevice (device));
+  if (promiscuous)
+    {
+      pcapHelper.HookNgSink<CsmaNetDevice> (device, "PromiscSniffer", file, interfaceId);
+    }
+  else
+    {
+      pcapHelper.HookNgSink<CsmaNetDevice> (device, "Sniffer", file, interfaceId);
+    }
+}
+
 void 
 CsmaHelper::EnableAsciiInternal (
   Ptr<OutputStreamWrapper> stream, 
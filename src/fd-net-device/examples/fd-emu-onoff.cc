@@ -74,6 +74,18 @@
 //       
 // client host: $ ./waf --run="fd-emu-onoff"
 //
+// The frames can also be read and written in batches, with the
+// --ioMode=Mmsg option (recvmmsg/sendmmsg) or the --ioMode=PacketMmap
+// option (PACKET_MMAP rings shared with the kernel).
+//
+// Both sides can also be run on a single host, connected by a veth pair:
+//
+// $ sudo ip link add vethA type veth peer name vethB
+// $ sudo ip link set vethA up promisc on
+// $ sudo ip link set vethB up promisc on
+// $ ./waf --run="fd-emu-onoff --serverMode=1 --deviceName=vethB --ioMode=PacketMmap" &
+// $ ./waf --run="fd-emu-onoff --deviceName=vethA --ioMode=PacketMmap"
+//
 
 #include <iostream>
 #include <fstream>
@@ -98,6 +110,7 @@ main (int argc, char *argv[])
   uint32_t packetSize = 10000; // bytes
   std::string dataRate("1000Mb/s");
   bool serverMode = false;
+  std::string ioMode ("Read");
 
   std::string deviceName ("eth0");
   std::string client ("10.1.1.1");
@@ -115,6 +128,7 @@ main (int argc, char *argv[])
   cmd.AddValue ("mac-client", "Mac Address for Server Client : 00:00:00:00:00:01", macClient);
   cmd.AddValue ("mac-server", "Mac Address for Server Default : 00:00:00:00:00:02", macServer);
   cmd.AddValue ("data-rate", "Data rate defaults to 1000Mb/s", dataRate);
+  cmd.AddValue ("ioMode", "FdNetDevice I/O mode: Read, Mmsg or PacketMmap", ioMode);
   cmd.Parse (argc, argv);
 
   Ipv4Address remoteIp;
@@ -146,6 +160,7 @@ main (int argc, char *argv[])
   NS_LOG_INFO ("Create Device");
   EmuFdNetDeviceHelper emu;
   emu.SetDeviceName (deviceName);
+  emu.SetAttribute ("IoMode", StringValue (ioMode));
   NetDeviceContainer devices = emu.Install (node);
   Ptr<NetDevice> device = devices.Get (0);
   device->SetAttribute ("Address", localMac);
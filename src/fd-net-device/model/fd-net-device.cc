@@ -37,8 +37,17 @@
 #include "ns3/uinteger.h"
 
 #include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
 #include <arpa/inet.h>
 #include <net/ethernet.h>
+#include <algorithm>
+
+#ifdef __linux__
+#include <linux/if_packet.h>
+#endif
 
 namespace ns3 {
 
@@ -75,6 +84,166 @@ FdReader::Data FdNetDeviceFdReader::DoRead (void)
   return FdReader::Data (buf, len);
 }
 
+/**
+ * \ingroup fd-net-device
+ * \brief Append a frame to a batch of frames
+ *
+ * The frame may overlap the batch, provided that it starts after the
+ * position where it is appended.
+ *
+ * \param batch the position where the frame is appended
+ * \param frame the frame
+ * \param len the length of the frame
+ * \returns the position after the appended frame
+ */
+static uint8_t *
+AppendToBatch (uint8_t *batch, const uint8_t *frame, uint32_t len)
+{
+  memcpy (batch, &len, sizeof (len));
+  memmove (batch + sizeof (len), frame, len);
+  return batch + sizeof (len) + len;
+}
+
+FdNetDeviceMmsgReader::FdNetDeviceMmsgReader ()
+  : m_bufferSize (65536),
+    m_batchSize (64)
+{
+}
+
+void
+FdNetDeviceMmsgReader::SetBufferSize (uint32_t bufferSize)
+{
+  NS_LOG_FUNCTION (this << bufferSize);
+  m_bufferSize = bufferSize;
+}
+
+void
+FdNetDeviceMmsgReader::SetBatchSize (uint32_t batchSize)
+{
+  NS_LOG_FUNCTION (this << batchSize);
+  m_batchSize = batchSize;
+}
+
+FdReader::Data FdNetDeviceMmsgReader::DoRead (void)
+{
+  NS_LOG_FUNCTION (this);
+
+#ifdef __linux__
+  // each frame is received into its own slot, after room for its length
+  uint32_t slotSize = sizeof (uint32_t) + m_bufferSize;
+  uint8_t *buf = (uint8_t *)malloc (slotSize * m_batchSize);
+  NS_ABORT_MSG_IF (buf == 0, "malloc() failed");
+
+  std::vector<struct mmsghdr> msgs (m_batchSize);
+  std::vector<struct iovec> iovs (m_batchSize);
+  for (uint32_t i = 0; i < m_batchSize; i++)
+    {
+      iovs[i].iov_base = buf + i * slotSize + sizeof (uint32_t);
+      iovs[i].iov_len = m_bufferSize;
+      memset (&msgs[i], 0, sizeof (msgs[i]));
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+  NS_LOG_LOGIC ("Calling recvmmsg on fd " << m_fd);
+  int n = recvmmsg (m_fd, &msgs[0], m_batchSize, MSG_DONTWAIT, 0);
+  if (n <= 0)
+    {
+      free (buf);
+      if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+        {
+          return FdReader::Data (0, -1);
+        }
+      return FdReader::Data (0, 0);
+    }
+
+  // pack the frames at the start of the buffer
+  uint8_t *end = buf;
+  for (int i = 0; i < n; i++)
+    {
+      end = AppendToBatch (end, (uint8_t *)iovs[i].iov_base, msgs[i].msg_len);
+    }
+  NS_LOG_LOGIC ("Read " << n << " frames on fd " << m_fd);
+  return FdReader::Data (buf, end - buf);
+#else
+  return FdReader::Data (0, 0);
+#endif
+}
+
+FdNetDeviceRingReader::FdNetDeviceRingReader ()
+  : m_ring (0),
+    m_blockSize (0),
+    m_blockCount (0),
+    m_block (0)
+{
+}
+
+void
+FdNetDeviceRingReader::SetRing (uint8_t *ring, uint32_t blockSize, uint32_t blockCount)
+{
+  NS_LOG_FUNCTION (this << static_cast<void *> (ring) << blockSize << blockCount);
+  m_ring = ring;
+  m_blockSize = blockSize;
+  m_blockCount = blockCount;
+  m_block = 0;
+}
+
+FdReader::Data FdNetDeviceRingReader::DoRead (void)
+{
+  NS_LOG_FUNCTION (this);
+
+#ifdef __linux__
+  // count the blocks handed over by the kernel, and bound the size of
+  // their frames
+  uint32_t nBlocks = 0;
+  size_t size = 0;
+  while (nBlocks < m_blockCount)
+    {
+      struct tpacket_block_desc *block =
+        (struct tpacket_block_desc *)(m_ring + ((m_block + nBlocks) % m_blockCount) * m_blockSize);
+      if ((block->hdr.bh1.block_status & TP_STATUS_USER) == 0)
+        {
+          break;
+        }
+      size += block->hdr.bh1.blk_len + block->hdr.bh1.num_pkts * sizeof (uint32_t);
+      nBlocks++;
+    }
+  if (nBlocks == 0)
+    {
+      return FdReader::Data (0, -1);
+    }
+  __sync_synchronize ();
+
+  uint8_t *buf = (uint8_t *)malloc (size);
+  NS_ABORT_MSG_IF (buf == 0, "malloc() failed");
+  uint8_t *end = buf;
+  for (uint32_t b = 0; b < nBlocks; b++)
+    {
+      struct tpacket_block_desc *block = (struct tpacket_block_desc *)(m_ring + m_block * m_blockSize);
+      struct tpacket3_hdr *hdr = (struct tpacket3_hdr *)((uint8_t *)block + block->hdr.bh1.offset_to_first_pkt);
+      for (uint32_t i = 0; i < block->hdr.bh1.num_pkts; i++)
+        {
+          end = AppendToBatch (end, (uint8_t *)hdr + hdr->tp_mac, hdr->tp_snaplen);
+          hdr = (struct tpacket3_hdr *)((uint8_t *)hdr + hdr->tp_next_offset);
+        }
+      // give the block back to the kernel
+      __sync_synchronize ();
+      block->hdr.bh1.block_status = TP_STATUS_KERNEL;
+      m_block = (m_block + 1) % m_blockCount;
+    }
+
+  if (end == buf)
+    {
+      free (buf);
+      return FdReader::Data (0, -1);
+    }
+  NS_LOG_LOGIC ("Read " << nBlocks << " blocks on fd " << m_fd);
+  return FdReader::Data (buf, end - buf);
+#else
+  return FdReader::Data (0, 0);
+#endif
+}
+
 NS_OBJECT_ENSURE_REGISTERED (FdNetDevice);
 
 TypeId
@@ -109,12 +278,48 @@ FdNetDevice::GetTypeId (void)
                                     LLC, "Llc",
                                     DIXPI, "DixPi"))
     .AddAttribute ("RxQueueSize", "Maximum size of the read queue.  "
-                   "This value limits number of packets that have been read "
-                   "from the network into a memory buffer but have not yet "
-                   "been processed by the simulator.",
+                   "This value limits number of packets (or batches of "
+                   "packets, in the Mmsg and PacketMmap I/O modes) that have "
+                   "been read from the network into a memory buffer but have "
+                   "not yet been processed by the simulator.",
                    UintegerValue (1000),
                    MakeUintegerAccessor (&FdNetDevice::m_maxPendingReads),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("IoMode",
+                   "The way frames are read from and written to the file "
+                   "descriptor: one frame per system call, batches of frames "
+                   "with recvmmsg/sendmmsg, or PACKET_MMAP rings (packet "
+                   "sockets only).",
+                   EnumValue (READ),
+                   MakeEnumAccessor (&FdNetDevice::m_ioMode),
+                   MakeEnumChecker (READ, "Read",
+                                    MMSG, "Mmsg",
+                                    PACKET_MMAP, "PacketMmap"))
+    .AddAttribute ("BatchSize",
+                   "The maximum number of frames read or written by a single "
+                   "system call in the Mmsg I/O mode, and the number of frames "
+                   "queued in the transmit ring before the kernel is asked to "
+                   "send them in the PacketMmap I/O mode.",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&FdNetDevice::m_batchSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("RingBlockSize",
+                   "The size of each block of the PACKET_MMAP rings, "
+                   "a multiple of the page size.",
+                   UintegerValue (1 << 18),
+                   MakeUintegerAccessor (&FdNetDevice::m_ringBlockSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("RingBlockCount",
+                   "The number of blocks of each PACKET_MMAP ring.",
+                   UintegerValue (16),
+                   MakeUintegerAccessor (&FdNetDevice::m_ringBlockCount),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("RingBlockTimeout",
+                   "The time after which the kernel hands over a block of "
+                   "the receive ring that is not full (rounded to milliseconds).",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&FdNetDevice::m_ringBlockTimeout),
+                   MakeTimeChecker ())
     //
     // Trace sources at the "top" of the net device, where packets transition
     // to/from higher layers.  These points do not really correspond to the
@@ -174,6 +379,15 @@ FdNetDevice::FdNetDevice ()
     m_fdReader (0),
     m_isBroadcast (true),
     m_isMulticast (false),
+    m_rxIoMode (READ),
+    m_txIoMode (READ),
+    m_ring (0),
+    m_ringSize (0),
+    m_txRing (0),
+    m_txFrameSize (0),
+    m_txFrameCount (0),
+    m_txFrame (0),
+    m_txQueued (0),
     m_startEvent (),
     m_stopEvent ()
 {
@@ -259,9 +473,52 @@ FdNetDevice::StartDevice (void)
   //
   m_nodeId = GetNode ()->GetId ();
 
-  m_fdReader = Create<FdNetDeviceFdReader> ();
+  //
+  // Fall back to the best I/O mode supported by the file descriptor.
+  //
+  m_rxIoMode = m_ioMode;
+  m_txIoMode = m_ioMode;
+  if (m_ioMode == PACKET_MMAP && !SetupPacketRings ())
+    {
+      NS_LOG_WARN ("FdNetDevice::Start(): PACKET_MMAP rings not available, using recvmmsg/sendmmsg");
+      m_rxIoMode = MMSG;
+      m_txIoMode = MMSG;
+    }
+  int type;
+  socklen_t typeLen = sizeof (type);
+#ifdef __linux__
+  bool isSocket = (getsockopt (m_fd, SOL_SOCKET, SO_TYPE, &type, &typeLen) == 0);
+#else
+  bool isSocket = false;
+#endif
+  if (!isSocket && (m_rxIoMode == MMSG || m_txIoMode == MMSG))
+    {
+      NS_LOG_WARN ("FdNetDevice::Start(): recvmmsg/sendmmsg not available, using read/write");
+      m_rxIoMode = (m_rxIoMode == MMSG ? READ : m_rxIoMode);
+      m_txIoMode = (m_txIoMode == MMSG ? READ : m_txIoMode);
+    }
+
   // 22 bytes covers 14 bytes Ethernet header with possible 8 bytes LLC/SNAP
-  m_fdReader->SetBufferSize (m_mtu + 22);
+  uint32_t bufferSize = m_mtu + 22;
+  if (m_rxIoMode == PACKET_MMAP)
+    {
+      Ptr<FdNetDeviceRingReader> reader = Create<FdNetDeviceRingReader> ();
+      reader->SetRing (m_ring, m_ringBlockSize, m_ringBlockCount);
+      m_fdReader = reader;
+    }
+  else if (m_rxIoMode == MMSG)
+    {
+      Ptr<FdNetDeviceMmsgReader> reader = Create<FdNetDeviceMmsgReader> ();
+      reader->SetBufferSize (bufferSize);
+      reader->SetBatchSize (m_batchSize);
+      m_fdReader = reader;
+    }
+  else
+    {
+      Ptr<FdNetDeviceFdReader> reader = Create<FdNetDeviceFdReader> ();
+      reader->SetBufferSize (bufferSize);
+      m_fdReader = reader;
+    }
   m_fdReader->Start (m_fd, MakeCallback (&FdNetDevice::ReceiveCallback, this));
 
   NotifyLinkUp ();
@@ -280,11 +537,127 @@ FdNetDevice::StopDevice (void)
 
   if (m_fd != -1)
     {
+      // write the frames still pending
+      FlushTxBatch ();
+      if (m_txQueued > 0)
+        {
+          KickTxRing ();
+        }
+      ReleasePacketRings ();
+
       close (m_fd);
       m_fd = -1;
     }
 }
 
+bool
+FdNetDevice::SetupPacketRings (void)
+{
+  NS_LOG_FUNCTION (this);
+
+#ifdef __linux__
+  int version = TPACKET_V3;
+  if (setsockopt (m_fd, SOL_PACKET, PACKET_VERSION, &version, sizeof (version)) == -1)
+    {
+      NS_LOG_LOGIC ("Can't set TPACKET_V3: " << strerror (errno));
+      return false;
+    }
+
+  // malformed transmit frames are skipped rather than blocking the ring;
+  // this must be set before the rings
+  int loss = 1;
+  if (setsockopt (m_fd, SOL_PACKET, PACKET_LOSS, &loss, sizeof (loss)) == -1)
+    {
+      NS_LOG_LOGIC ("Can't set PACKET_LOSS: " << strerror (errno));
+      return false;
+    }
+
+  struct tpacket_req3 rx;
+  memset (&rx, 0, sizeof (rx));
+  rx.tp_block_size = m_ringBlockSize;
+  rx.tp_block_nr = m_ringBlockCount;
+  // with TPACKET_V3 the frames have a variable size; the frame size
+  // is only used to check the geometry of the ring
+  rx.tp_frame_size = TPACKET_ALIGNMENT << 7;
+  rx.tp_frame_nr = (m_ringBlockSize / rx.tp_frame_size) * m_ringBlockCount;
+  rx.tp_retire_blk_tov = std::max<int64_t> (1, m_ringBlockTimeout.GetMilliSeconds ());
+  if (setsockopt (m_fd, SOL_PACKET, PACKET_RX_RING, &rx, sizeof (rx)) == -1)
+    {
+      NS_LOG_LOGIC ("Can't set up the receive ring: " << strerror (errno));
+      return false;
+    }
+
+  // each frame of the transmit ring holds a header and the largest frame
+  uint32_t offset = TPACKET3_HDRLEN - sizeof (struct sockaddr_ll);
+  struct tpacket_req3 tx;
+  memset (&tx, 0, sizeof (tx));
+  tx.tp_block_size = m_ringBlockSize;
+  tx.tp_block_nr = m_ringBlockCount;
+  tx.tp_frame_size = TPACKET_ALIGN (offset + m_mtu + 22);
+  tx.tp_frame_nr = (m_ringBlockSize / tx.tp_frame_size) * m_ringBlockCount;
+  bool txRing = false;
+  if (tx.tp_frame_size > m_ringBlockSize)
+    {
+      NS_LOG_LOGIC ("The transmit frames don't fit in a block");
+    }
+  else if (setsockopt (m_fd, SOL_PACKET, PACKET_TX_RING, &tx, sizeof (tx)) == -1)
+    {
+      NS_LOG_LOGIC ("Can't set up the transmit ring: " << strerror (errno));
+    }
+  else
+    {
+      txRing = true;
+    }
+
+  size_t rxSize = (size_t) m_ringBlockSize * m_ringBlockCount;
+  size_t size = txRing ? 2 * rxSize : rxSize;
+  void *ring = mmap (0, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+  if (ring == MAP_FAILED)
+    {
+      NS_LOG_LOGIC ("Can't map the rings: " << strerror (errno));
+      memset (&rx, 0, sizeof (rx));
+      setsockopt (m_fd, SOL_PACKET, PACKET_RX_RING, &rx, sizeof (rx));
+      if (txRing)
+        {
+          setsockopt (m_fd, SOL_PACKET, PACKET_TX_RING, &rx, sizeof (rx));
+        }
+      return false;
+    }
+  m_ring = (uint8_t *)ring;
+  m_ringSize = size;
+
+  if (txRing)
+    {
+      m_txRing = m_ring + rxSize;
+      m_txFrameSize = tx.tp_frame_size;
+      m_txFrameCount = tx.tp_frame_nr;
+      m_txFrame = 0;
+      m_txQueued = 0;
+    }
+  else
+    {
+      NS_LOG_WARN ("FdNetDevice::Start(): PACKET_MMAP transmit ring not available, using sendmmsg");
+      m_txIoMode = MMSG;
+    }
+  return true;
+#else
+  return false;
+#endif
+}
+
+void
+FdNetDevice::ReleasePacketRings (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_ring != 0)
+    {
+      munmap (m_ring, m_ringSize);
+      m_ring = 0;
+      m_ringSize = 0;
+      m_txRing = 0;
+    }
+}
+
 void
 FdNetDevice::ReceiveCallback (uint8_t *buf, ssize_t len)
 {
@@ -363,24 +736,6 @@ AddPIHeader (uint8_t *&buf, size_t &len)
   buf = buf2;
 }
 
-/**
- * \ingroup fd-net-device
- * \brief Removes PI header
- * \param buf the buffer to add the header to
- * \param len the buffer length
- */
-static void
-RemovePIHeader (uint8_t *&buf, ssize_t &len)
-{
-  // strip PI header if present, shrink buffer
-  if (len >= 4)
-    {
-      len -= 4;
-      memmove (buf, buf + 4, len);
-      buf = (uint8_t*)realloc (buf, len);
-    }
-}
-
 void
 FdNetDevice::ForwardUp (void)
 {
@@ -399,18 +754,42 @@ FdNetDevice::ForwardUp (void)
 
   NS_LOG_FUNCTION (this << buf << len);
 
+  if (m_rxIoMode == READ)
+    {
+      ReceiveFrame (buf, len);
+    }
+  else
+    {
+      // a batch of frames, each preceded by its length
+      const uint8_t *frame = buf;
+      while (frame + sizeof (uint32_t) <= buf + len)
+        {
+          uint32_t frameLen;
+          memcpy (&frameLen, frame, sizeof (frameLen));
+          frame += sizeof (frameLen);
+          ReceiveFrame (frame, frameLen);
+          frame += frameLen;
+        }
+    }
+  free (buf);
+}
+
+void
+FdNetDevice::ReceiveFrame (const uint8_t *buf, ssize_t len)
+{
+  NS_LOG_FUNCTION (this << buf << len);
+
   // We need to remove the PI header and ignore it
-  if (m_encapMode == DIXPI)
+  if (m_encapMode == DIXPI && len >= 4)
     {
-      RemovePIHeader (buf, len);
+      buf += 4;
+      len -= 4;
     }
 
   //
-  // Create a packet out of the buffer we received and free that buffer.
+  // Create a packet out of the buffer we received.
   //
-  Ptr<Packet> packet = Create<Packet> (reinterpret_cast<const uint8_t *> (buf), len);
-  free (buf);
-  buf = 0;
+  Ptr<Packet> packet = Create<Packet> (buf, len);
 
   //
   // Trace sinks will expect complete packets, not packets without some of the
@@ -574,6 +953,25 @@ FdNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address& de
   m_promiscSnifferTrace (packet);
   m_snifferTrace (packet);
 
+  if (m_txIoMode == PACKET_MMAP)
+    {
+      return WriteTxRing (packet);
+    }
+  if (m_txIoMode == MMSG)
+    {
+      // the frames sent in the same time step are written together
+      m_txBatch.push_back (packet);
+      if (m_txBatch.size () >= m_batchSize)
+        {
+          FlushTxBatch ();
+        }
+      else if (!m_txFlushEvent.IsRunning ())
+        {
+          m_txFlushEvent = Simulator::ScheduleNow (&FdNetDevice::FlushTxBatch, this);
+        }
+      return true;
+    }
+
   NS_LOG_LOGIC ("calling write");
 
 
@@ -599,6 +997,144 @@ FdNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address& de
   return true;
 }
 
+void
+FdNetDevice::FlushTxBatch (void)
+{
+  NS_LOG_FUNCTION (this << m_txBatch.size ());
+  Simulator::Cancel (m_txFlushEvent);
+  if (m_txBatch.empty ())
+    {
+      return;
+    }
+
+#ifdef __linux__
+  uint32_t n = m_txBatch.size ();
+  std::vector<struct mmsghdr> msgs (n);
+  std::vector<struct iovec> iovs (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      size_t len = (size_t) m_txBatch[i]->GetSize ();
+      uint8_t *buffer = (uint8_t*)malloc (len);
+      m_txBatch[i]->CopyData (buffer, len);
+
+      // We need to add the PI header
+      if (m_encapMode == DIXPI)
+        {
+          AddPIHeader (buffer, len);
+        }
+
+      iovs[i].iov_base = buffer;
+      iovs[i].iov_len = len;
+      memset (&msgs[i], 0, sizeof (msgs[i]));
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+  NS_LOG_LOGIC ("calling sendmmsg with " << n << " frames");
+  uint32_t sent = 0;
+  while (sent < n)
+    {
+      int written = sendmmsg (m_fd, &msgs[sent], n - sent, 0);
+      if (written <= 0)
+        {
+          NS_LOG_WARN ("sendmmsg() failed: " << strerror (errno));
+          break;
+        }
+      sent += written;
+    }
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      if (i >= sent || msgs[i].msg_len != iovs[i].iov_len)
+        {
+          m_macTxDropTrace (m_txBatch[i]);
+        }
+      free (iovs[i].iov_base);
+    }
+#endif
+  m_txBatch.clear ();
+}
+
+bool
+FdNetDevice::WriteTxRing (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+
+#ifdef __linux__
+  uint32_t framesPerBlock = m_ringBlockSize / m_txFrameSize;
+  uint8_t *frame = m_txRing + (m_txFrame / framesPerBlock) * m_ringBlockSize
+    + (m_txFrame % framesPerBlock) * m_txFrameSize;
+  volatile struct tpacket3_hdr *hdr = (struct tpacket3_hdr *)frame;
+
+  if (hdr->tp_status & (TP_STATUS_SEND_REQUEST | TP_STATUS_SENDING))
+    {
+      // the ring is full: wait for the kernel to send the queued frames,
+      // as write () would block
+      NS_LOG_LOGIC ("Transmit ring full");
+      Simulator::Cancel (m_txFlushEvent);
+      m_txQueued = 0;
+      send (m_fd, 0, 0, 0);
+      if (hdr->tp_status & (TP_STATUS_SEND_REQUEST | TP_STATUS_SENDING))
+        {
+          m_macTxDropTrace (p);
+          return false;
+        }
+    }
+  __sync_synchronize ();
+
+  uint32_t offset = TPACKET3_HDRLEN - sizeof (struct sockaddr_ll);
+  uint32_t len = p->GetSize ();
+  if (offset + len > m_txFrameSize)
+    {
+      m_macTxDropTrace (p);
+      return false;
+    }
+  p->CopyData (frame + offset, len);
+  hdr->tp_len = len;
+  hdr->tp_next_offset = 0;
+  __sync_synchronize ();
+  hdr->tp_status = TP_STATUS_SEND_REQUEST;
+  m_txFrame = (m_txFrame + 1) % m_txFrameCount;
+
+  // the frames queued in the same time step are sent together
+  if (++m_txQueued >= m_batchSize)
+    {
+      KickTxRing ();
+    }
+  else if (!m_txFlushEvent.IsRunning ())
+    {
+      m_txFlushEvent = Simulator::ScheduleNow (&FdNetDevice::KickTxRing, this);
+    }
+  return true;
+#else
+  return false;
+#endif
+}
+
+void
+FdNetDevice::KickTxRing (void)
+{
+  NS_LOG_FUNCTION (this << m_txQueued);
+  Simulator::Cancel (m_txFlushEvent);
+  m_txQueued = 0;
+  if (send (m_fd, 0, 0, MSG_DONTWAIT) == -1 && errno != EAGAIN && errno != EWOULDBLOCK)
+    {
+      NS_LOG_WARN ("send() failed: " << strerror (errno));
+    }
+}
+
+FdNetDevice::IoMode
+FdNetDevice::GetRxIoMode (void) const
+{
+  return m_rxIoMode;
+}
+
+FdNetDevice::IoMode
+FdNetDevice::GetTxIoMode (void) const
+{
+  return m_txIoMode;
+}
+
 void
 FdNetDevice::SetFileDescriptor (int fd)
 {
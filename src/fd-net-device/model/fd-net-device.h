@@ -38,6 +38,7 @@
 
 #include <utility>
 #include <queue>
+#include <vector>
 
 namespace ns3 {
 
@@ -68,6 +69,69 @@ private:
   uint32_t m_bufferSize; //!< size of the read buffer
 };
 
+/**
+ * \ingroup fd-net-device
+ * \brief This class reads batches of frames from a socket with recvmmsg ().
+ *
+ * Each read returns a single buffer holding all the frames received by
+ * a recvmmsg () call, each frame preceded by its length as a uint32_t in
+ * host byte order.
+ */
+class FdNetDeviceMmsgReader : public FdReader
+{
+public:
+  FdNetDeviceMmsgReader ();
+
+  /**
+   * Set size of the read buffer of each frame.
+   */
+  void SetBufferSize (uint32_t bufferSize);
+
+  /**
+   * Set the maximum number of frames read by each recvmmsg () call.
+   */
+  void SetBatchSize (uint32_t batchSize);
+
+private:
+  FdReader::Data DoRead (void);
+
+  uint32_t m_bufferSize; //!< size of the read buffer of each frame
+  uint32_t m_batchSize;  //!< maximum number of frames per read
+};
+
+/**
+ * \ingroup fd-net-device
+ * \brief This class reads the frames of a PACKET_MMAP (TPACKET_V3) receive ring.
+ *
+ * The kernel fills the blocks of the ring with frames and hands them over
+ * to user space when they are full or when their timeout expires. Each
+ * read copies the frames of all the blocks handed over into a single
+ * buffer, in the same format as FdNetDeviceMmsgReader, and gives the
+ * blocks back to the kernel.
+ */
+class FdNetDeviceRingReader : public FdReader
+{
+public:
+  FdNetDeviceRingReader ();
+
+  /**
+   * Set the receive ring.
+   *
+   * \param ring the start of the mapped ring
+   * \param blockSize the size of each block
+   * \param blockCount the number of blocks
+   */
+  void SetRing (uint8_t *ring, uint32_t blockSize, uint32_t blockCount);
+
+private:
+  FdReader::Data DoRead (void);
+
+  uint8_t *m_ring;       //!< the start of the mapped ring
+  uint32_t m_blockSize;  //!< the size of each block
+  uint32_t m_blockCount; //!< the number of blocks
+  uint32_t m_block;      //!< the index of the next block to read
+};
+
 class Node;
 
 /**
@@ -105,6 +169,22 @@ public:
                       Raw protocol(IP, IPv6, etc) frame. */
   };
 
+  /**
+   * Enumeration of the ways frames are read from and written to the file
+   * descriptor.
+   */
+  enum IoMode
+  {
+    READ,        /**< One read () and one write () per frame */
+    MMSG,        /**< Batches of frames with recvmmsg () and sendmmsg ();
+                      falls back to READ if the file descriptor is not
+                      a socket */
+    PACKET_MMAP, /**< PACKET_MMAP (TPACKET_V3) receive and transmit
+                      rings; falls back to MMSG if the file descriptor
+                      is not a packet socket or the rings cannot be
+                      set up */
+  };
+
   /**
    * Constructor for the FdNetDevice.
    */
@@ -136,6 +216,22 @@ public:
    */
   void SetFileDescriptor (int fd);
 
+  /**
+   * Get the I/O mode used to receive frames, which differs from the IoMode
+   * attribute if the file descriptor does not support the latter.
+   *
+   * \returns The receive I/O mode, valid once the device has started.
+   */
+  FdNetDevice::IoMode GetRxIoMode (void) const;
+
+  /**
+   * Get the I/O mode used to transmit frames, which differs from the
+   * IoMode attribute if the file descriptor does not support the latter.
+   *
+   * \returns The transmit I/O mode, valid once the device has started.
+   */
+  FdNetDevice::IoMode GetTxIoMode (void) const;
+
   /**
    * Set a start time for the device.
    *
@@ -215,10 +311,46 @@ private:
   void ReceiveCallback (uint8_t *buf, ssize_t len);
 
   /**
-   * Forward the frame to the appropriate callback for processing
+   * Forward the next frame, or batch of frames, of the pending queue to
+   * ReceiveFrame ()
    */
   void ForwardUp (void);
 
+  /**
+   * Forward a frame to the appropriate callback for processing
+   * \param buf the frame
+   * \param len the length of the frame
+   */
+  void ReceiveFrame (const uint8_t *buf, ssize_t len);
+
+  /**
+   * Set up the PACKET_MMAP rings on the file descriptor and map them
+   * \returns true if at least the receive ring could be set up
+   */
+  bool SetupPacketRings (void);
+
+  /**
+   * Unmap the PACKET_MMAP rings, if any
+   */
+  void ReleasePacketRings (void);
+
+  /**
+   * Copy a frame into the next frame of the transmit ring
+   * \param p the frame to send
+   * \returns true if the frame was queued in the ring
+   */
+  bool WriteTxRing (Ptr<Packet> p);
+
+  /**
+   * Ask the kernel to transmit the frames queued in the transmit ring
+   */
+  void KickTxRing (void);
+
+  /**
+   * Write the frames of the transmit batch with sendmmsg ()
+   */
+  void FlushTxBatch (void);
+
   /**
    * Start Sending a Packet Down the Wire.
    * @param p packet to send
@@ -261,7 +393,7 @@ private:
   /**
    * Reader for the file descriptor.
    */
-  Ptr<FdNetDeviceFdReader> m_fdReader;
+  Ptr<FdReader> m_fdReader;
 
   /**
    * The net device mac address.
@@ -306,6 +438,88 @@ private:
    */
   uint32_t m_maxPendingReads;
 
+  /**
+   * The I/O mode requested with the IoMode attribute.
+   */
+  IoMode m_ioMode;
+
+  /**
+   * The I/O mode actually used to receive frames.
+   */
+  IoMode m_rxIoMode;
+
+  /**
+   * The I/O mode actually used to transmit frames.
+   */
+  IoMode m_txIoMode;
+
+  /**
+   * Maximum number of frames read or written by a single system call.
+   */
+  uint32_t m_batchSize;
+
+  /**
+   * Size of each block of the PACKET_MMAP rings.
+   */
+  uint32_t m_ringBlockSize;
+
+  /**
+   * Number of blocks of each PACKET_MMAP ring.
+   */
+  uint32_t m_ringBlockCount;
+
+  /**
+   * Time after which the kernel hands over a receive block which is not full.
+   */
+  Time m_ringBlockTimeout;
+
+  /**
+   * The mapped PACKET_MMAP rings: the receive ring, followed by the
+   * transmit ring if any.
+   */
+  uint8_t *m_ring;
+
+  /**
+   * The size of the mapping of the rings.
+   */
+  size_t m_ringSize;
+
+  /**
+   * The start of the transmit ring, or 0 if there is none.
+   */
+  uint8_t *m_txRing;
+
+  /**
+   * The size of each frame of the transmit ring.
+   */
+  uint32_t m_txFrameSize;
+
+  /**
+   * The number of frames of the transmit ring.
+   */
+  uint32_t m_txFrameCount;
+
+  /**
+   * The index of the next frame of the transmit ring.
+   */
+  uint32_t m_txFrame;
+
+  /**
+   * The number of frames queued in the transmit ring since the last kick.
+   */
+  uint32_t m_txQueued;
+
+  /**
+   * The frames waiting to be written by sendmmsg ().
+   */
+  std::vector<Ptr<Packet> > m_txBatch;
+
+  /**
+   * The event that writes the pending transmit batch, or kicks the
+   * transmit ring, later in the current time step.
+   */
+  EventId m_txFlushEvent;
+
   /**
    * Mutex to increase pending read counter.
    */
@@ -0,0 +1,196 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sys/socket.h>
+#include <errno.h>
+#include <string.h>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/fd-net-device.h"
+#include "ns3/fd-net-device-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup fd-net-device
+ * \defgroup fd-net-device-test FdNetDevice module tests
+ */
+
+/**
+ * \ingroup fd-net-device-test
+ * \ingroup tests
+ *
+ * \brief FdNetDevice I/O mode test
+ *
+ * Two FdNetDevices are connected by a datagram socket pair, and the
+ * first one sends numbered frames to the second one. All the frames must
+ * be received, in order and with their size, whatever the I/O mode.
+ * The I/O modes that are not supported by the socket pair must fall back
+ * to the best supported mode.
+ */
+class FdNetDeviceIoModeTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param ioMode the I/O mode requested
+   * \param expected the I/O mode expected after the fallbacks
+   */
+  FdNetDeviceIoModeTestCase (std::string ioMode, FdNetDevice::IoMode expected);
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * \brief Send a numbered frame
+   * \param device the sending device
+   * \param to the destination
+   * \param seq the frame number
+   */
+  void Send (Ptr<NetDevice> device, Address to, uint32_t seq);
+  /**
+   * \brief Receive a frame
+   * \param device the receiving device
+   * \param packet the frame payload
+   * \param protocol the protocol number
+   * \param from the source address
+   * \param to the destination address
+   * \param type the packet type
+   */
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType type);
+
+  std::string m_ioMode;           //!< the I/O mode requested
+  FdNetDevice::IoMode m_expected; //!< the I/O mode expected
+  uint32_t m_received;            //!< number of frames received
+  bool m_inOrder;                 //!< whether the frames were received in order
+  bool m_sized;                   //!< whether the frames were received with their size
+};
+
+/// The protocol number of the test frames (local experimental)
+static const uint16_t TEST_PROTOCOL = 0x88B5;
+/// The number of test frames
+static const uint32_t TEST_FRAMES = 200;
+/// The size of the test frames
+static const uint32_t TEST_FRAME_SIZE = 1000;
+
+FdNetDeviceIoModeTestCase::FdNetDeviceIoModeTestCase (std::string ioMode, FdNetDevice::IoMode expected)
+  : TestCase ("FdNetDevice IO mode " + ioMode),
+    m_ioMode (ioMode),
+    m_expected (expected),
+    m_received (0),
+    m_inOrder (true),
+    m_sized (true)
+{
+}
+
+void
+FdNetDeviceIoModeTestCase::DoSetup (void)
+{
+  // the frames are read by another thread
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::RealtimeSimulatorImpl"));
+}
+
+void
+FdNetDeviceIoModeTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+void
+FdNetDeviceIoModeTestCase::Send (Ptr<NetDevice> device, Address to, uint32_t seq)
+{
+  uint8_t buffer[TEST_FRAME_SIZE];
+  memset (buffer, 0, sizeof (buffer));
+  memcpy (buffer, &seq, sizeof (seq));
+  NS_TEST_EXPECT_MSG_EQ (device->Send (Create<Packet> (buffer, sizeof (buffer)), to, TEST_PROTOCOL),
+                         true, "Frame " << seq << " not sent");
+}
+
+void
+FdNetDeviceIoModeTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                    const Address &from, const Address &to, NetDevice::PacketType type)
+{
+  uint32_t seq;
+  packet->CopyData ((uint8_t *)&seq, sizeof (seq));
+  m_inOrder = m_inOrder && (seq == m_received);
+  m_sized = m_sized && (packet->GetSize () == TEST_FRAME_SIZE);
+  m_received++;
+}
+
+void
+FdNetDeviceIoModeTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  FdNetDeviceHelper fd;
+  fd.SetAttribute ("IoMode", StringValue (m_ioMode));
+  NetDeviceContainer devices = fd.Install (nodes);
+
+  int sv[2];
+  NS_TEST_ASSERT_MSG_EQ (socketpair (AF_UNIX, SOCK_DGRAM, 0, sv), 0, "socketpair() failed: " << strerror (errno));
+  Ptr<FdNetDevice> txDevice = devices.Get (0)->GetObject<FdNetDevice> ();
+  Ptr<FdNetDevice> rxDevice = devices.Get (1)->GetObject<FdNetDevice> ();
+  txDevice->SetFileDescriptor (sv[0]);
+  rxDevice->SetFileDescriptor (sv[1]);
+
+  nodes.Get (1)->RegisterProtocolHandler (MakeCallback (&FdNetDeviceIoModeTestCase::Receive, this),
+                                          TEST_PROTOCOL, rxDevice);
+
+  for (uint32_t i = 0; i < TEST_FRAMES; i++)
+    {
+      Simulator::Schedule (MilliSeconds (10) + MicroSeconds (50 * i),
+                           &FdNetDeviceIoModeTestCase::Send, this, txDevice, rxDevice->GetAddress (), i);
+    }
+  Simulator::Stop (MilliSeconds (500));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (rxDevice->GetRxIoMode (), m_expected, "Wrong receive I/O mode");
+  NS_TEST_EXPECT_MSG_EQ (txDevice->GetTxIoMode (), m_expected, "Wrong transmit I/O mode");
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received, TEST_FRAMES, "Frames lost");
+  NS_TEST_ASSERT_MSG_EQ (m_inOrder, true, "Frames out of order");
+  NS_TEST_ASSERT_MSG_EQ (m_sized, true, "Frames with the wrong size");
+}
+
+/**
+ * \ingroup fd-net-device-test
+ * \ingroup tests
+ *
+ * \brief FdNetDevice TestSuite
+ */
+class FdNetDeviceTestSuite : public TestSuite
+{
+public:
+  FdNetDeviceTestSuite () : TestSuite ("fd-net-device", UNIT)
+  {
+    AddTestCase (new FdNetDeviceIoModeTestCase ("Read", FdNetDevice::READ), TestCase::QUICK);
+    AddTestCase (new FdNetDeviceIoModeTestCase ("Mmsg", FdNetDevice::MMSG), TestCase::QUICK);
+    // a socket pair has no PACKET_MMAP rings
+    AddTestCase (new FdNetDeviceIoModeTestCase ("PacketMmap", FdNetDevice::MMSG), TestCase::QUICK);
+  }
+};
+
+static FdNetDeviceTestSuite g_fdNetDeviceTestSuite; //!< Static variable for test initialization
@@ -82,6 +82,10 @@ public:
    * Users must first call PopulateRoutingTables() and then may subsequently
    * call RecomputeRoutingTables() at any later time in the simulation.
    *
+   * Only the routes of the nodes that can reach a router or network whose
+   * link state advertisement changed are actually recomputed (see
+   * GlobalRouteManager::RecomputeRoutes ()).
+   *
    */
   static void RecomputeRoutingTables (void);
 private:
@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "neighbor-cache-helper.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/arp-cache.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/ndisc-cache.h"
+#include <set>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NeighborCacheHelper");
+
+NeighborCacheHelper::NeighborCacheHelper ()
+{
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::set<Ptr<Channel> > visited;
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); node++)
+    {
+      for (uint32_t i = 0; i < (*node)->GetNDevices (); i++)
+        {
+          Ptr<Channel> channel = (*node)->GetDevice (i)->GetChannel ();
+          if (channel != 0 && visited.insert (channel).second)
+            {
+              PopulateNeighborCache (channel);
+            }
+        }
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (Ptr<Channel> channel) const
+{
+  NS_LOG_FUNCTION (this << channel);
+  // look up the addresses and the caches once per device, as every device
+  // is the neighbor of all the others
+  std::vector<Neighbor> neighbors;
+  std::vector<Caches> caches;
+  for (uint32_t i = 0; i < channel->GetNDevices (); i++)
+    {
+      neighbors.push_back (GetNeighbor (channel->GetDevice (i)));
+      caches.push_back (GetCaches (channel->GetDevice (i)));
+    }
+  for (uint32_t i = 0; i < caches.size (); i++)
+    {
+      for (uint32_t j = 0; j < neighbors.size (); j++)
+        {
+          if (j != i)
+            {
+              AddEntries (caches[i], neighbors[j]);
+            }
+        }
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (const NetDeviceContainer &devices) const
+{
+  NS_LOG_FUNCTION (this);
+  for (NetDeviceContainer::Iterator it = devices.Begin (); it != devices.End (); it++)
+    {
+      Ptr<Channel> channel = (*it)->GetChannel ();
+      if (channel == 0)
+        {
+          continue;
+        }
+      Caches deviceCaches = GetCaches (*it);
+      for (uint32_t j = 0; j < channel->GetNDevices (); j++)
+        {
+          Ptr<NetDevice> neighbor = channel->GetDevice (j);
+          if (neighbor != *it)
+            {
+              AddEntries (deviceCaches, GetNeighbor (neighbor));
+            }
+        }
+    }
+}
+
+NeighborCacheHelper::Neighbor
+NeighborCacheHelper::GetNeighbor (Ptr<NetDevice> device)
+{
+  Neighbor neighbor;
+  neighbor.mac = device->GetAddress ();
+
+  Ptr<Ipv4L3Protocol> ipv4 = device->GetNode ()->GetObject<Ipv4L3Protocol> ();
+  int32_t interface = ipv4 != 0 ? ipv4->GetInterfaceForDevice (device) : -1;
+  if (interface != -1)
+    {
+      for (uint32_t i = 0; i < ipv4->GetNAddresses (interface); i++)
+        {
+          Ipv4Address address = ipv4->GetAddress (interface, i).GetLocal ();
+          if (address != Ipv4Address::GetLoopback ())
+            {
+              neighbor.ipv4.push_back (address);
+            }
+        }
+    }
+
+  Ptr<Ipv6L3Protocol> ipv6 = device->GetNode ()->GetObject<Ipv6L3Protocol> ();
+  interface = ipv6 != 0 ? ipv6->GetInterfaceForDevice (device) : -1;
+  if (interface != -1)
+    {
+      for (uint32_t i = 0; i < ipv6->GetNAddresses (interface); i++)
+        {
+          Ipv6Address address = ipv6->GetAddress (interface, i).GetAddress ();
+          if (!address.IsLocalhost () && !address.IsAny ())
+            {
+              neighbor.ipv6.push_back (address);
+            }
+        }
+    }
+  return neighbor;
+}
+
+NeighborCacheHelper::Caches
+NeighborCacheHelper::GetCaches (Ptr<NetDevice> device)
+{
+  Caches caches;
+
+  Ptr<Ipv4L3Protocol> ipv4 = device->GetNode ()->GetObject<Ipv4L3Protocol> ();
+  int32_t interface = ipv4 != 0 ? ipv4->GetInterfaceForDevice (device) : -1;
+  if (interface != -1)
+    {
+      caches.arp = ipv4->GetInterface (interface)->GetArpCache ();
+    }
+
+  Ptr<Ipv6L3Protocol> ipv6 = device->GetNode ()->GetObject<Ipv6L3Protocol> ();
+  interface = ipv6 != 0 ? ipv6->GetInterfaceForDevice (device) : -1;
+  if (interface != -1)
+    {
+      caches.ndisc = ipv6->GetInterface (interface)->GetNdiscCache ();
+    }
+  return caches;
+}
+
+void
+NeighborCacheHelper::AddEntries (const Caches &caches, const Neighbor &neighbor)
+{
+  if (caches.arp != 0)
+    {
+      for (std::vector<Ipv4Address>::const_iterator it = neighbor.ipv4.begin (); it != neighbor.ipv4.end (); it++)
+        {
+          ArpCache::Entry *entry = caches.arp->Lookup (*it);
+          if (entry == 0)
+            {
+              entry = caches.arp->Add (*it);
+            }
+          entry->SetMacAddress (neighbor.mac);
+          entry->MarkPermanent ();
+        }
+    }
+  if (caches.ndisc != 0)
+    {
+      for (std::vector<Ipv6Address>::const_iterator it = neighbor.ipv6.begin (); it != neighbor.ipv6.end (); it++)
+        {
+          NdiscCache::Entry *entry = caches.ndisc->Lookup (*it);
+          if (entry == 0)
+            {
+              entry = caches.ndisc->Add (*it);
+            }
+          entry->SetMacAddress (neighbor.mac);
+          entry->MarkPermanent ();
+        }
+    }
+}
+
+} // namespace ns3
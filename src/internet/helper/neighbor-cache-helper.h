@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NEIGHBOR_CACHE_HELPER_H
+#define NEIGHBOR_CACHE_HELPER_H
+
+#include <vector>
+#include "ns3/ptr.h"
+#include "ns3/address.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/net-device-container.h"
+
+namespace ns3 {
+
+class ArpCache;
+class NdiscCache;
+
+/**
+ * \ingroup internet
+ *
+ * \brief Helper class that populates the ARP and NDISC caches statically
+ *
+ * The helper looks at the devices attached to each channel and, for every
+ * pair of devices, adds to the ARP cache (IPv4) and to the NDISC cache
+ * (IPv6) of the first device a permanent entry mapping each address of
+ * the second device to its MAC address. Permanent entries never expire and
+ * have no timers, so the nodes send no ARP requests or neighbor
+ * solicitations to resolve their neighbors, and the address resolution
+ * adds no events to the simulation.
+ *
+ * The caches must be populated after the addresses have been assigned.
+ * Devices that do not need address resolution (e.g., point-to-point
+ * devices) have no cache and are skipped.
+ *
+ * Note that the ARP cache is flushed, permanent entries included, when
+ * the link state of its device changes. Also, the addresses of IPv6
+ * interfaces are still checked by Duplicate Address Detection, unless
+ * the ns3::Icmpv6L4Protocol::DAD attribute is set to false.
+ */
+class NeighborCacheHelper
+{
+public:
+  NeighborCacheHelper ();
+
+  /**
+   * \brief Populate the caches of all the devices in the simulation
+   *
+   * Each channel is visited once.
+   */
+  void PopulateNeighborCache (void) const;
+
+  /**
+   * \brief Populate the caches of the devices attached to a channel
+   * \param channel the channel
+   */
+  void PopulateNeighborCache (Ptr<Channel> channel) const;
+
+  /**
+   * \brief Populate the caches of some devices
+   *
+   * The caches of the given devices are filled with the addresses of all
+   * the other devices attached to their channels; the caches of the
+   * other devices are not modified.
+   *
+   * \param devices the devices
+   */
+  void PopulateNeighborCache (const NetDeviceContainer &devices) const;
+
+private:
+  /// The addresses of a device, as seen by its neighbors
+  struct Neighbor
+  {
+    Address mac;                    //!< the MAC address
+    std::vector<Ipv4Address> ipv4;  //!< the IPv4 addresses
+    std::vector<Ipv6Address> ipv6;  //!< the IPv6 addresses
+  };
+
+  /// The caches of a device
+  struct Caches
+  {
+    Ptr<ArpCache> arp;     //!< the ARP cache, if any
+    Ptr<NdiscCache> ndisc; //!< the NDISC cache, if any
+  };
+
+  /**
+   * \param device a device
+   * \returns the addresses of the device
+   */
+  static Neighbor GetNeighbor (Ptr<NetDevice> device);
+  /**
+   * \param device a device
+   * \returns the caches of the device
+   */
+  static Caches GetCaches (Ptr<NetDevice> device);
+  /**
+   * \brief Add permanent entries for the addresses of a neighbor to some caches
+   * \param caches the caches
+   * \param neighbor the neighbor
+   */
+  static void AddEntries (const Caches &caches, const Neighbor &neighbor);
+};
+
+} // namespace ns3
+
+#endif /* NEIGHBOR_CACHE_HELPER_H */
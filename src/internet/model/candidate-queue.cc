@@ -49,24 +49,28 @@ operator<< (std::ostream& os, const SPFVertex::VertexType& t)
 std::ostream& 
 operator<< (std::ostream& os, const CandidateQueue& q)
 {
-  typedef CandidateQueue::CandidateList_t List_t;
-  typedef List_t::const_iterator CIter_t;
-  const CandidateQueue::CandidateList_t& list = q.m_candidates;
+  typedef CandidateQueue::CandidateHeap_t Heap_t;
+  typedef Heap_t::const_iterator CIter_t;
+  // print the candidates in the order they will be popped
+  Heap_t sorted = q.m_candidates;
+  std::sort (sorted.begin (), sorted.end (), &CandidateQueue::CompareCandidates);
 
   os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
-  for (CIter_t iter = list.begin (); iter != list.end (); iter++)
+  for (CIter_t iter = sorted.begin (); iter != sorted.end (); iter++)
     {
       os << "<" 
-      << (*iter)->GetVertexId () << ", "
-      << (*iter)->GetDistanceFromRoot () << ", "
-      << (*iter)->GetVertexType () << ">" << std::endl;
+      << iter->first->GetVertexId () << ", "
+      << iter->first->GetDistanceFromRoot () << ", "
+      << iter->first->GetVertexType () << ">" << std::endl;
     }
   os << "*** CandidateQueue End ***";
   return os;
 }
 
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_candidates (),
+    m_positions (),
+    m_nextSeq (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -94,11 +98,9 @@ CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+  m_candidates.push_back (Candidate_t (vNew, m_nextSeq++));
+  m_positions[vNew->GetVertexId ()] = m_candidates.size () - 1;
+  SiftUp (m_candidates.size () - 1);
 }
 
 SPFVertex *
@@ -110,8 +112,14 @@ CandidateQueue::Pop (void)
       return 0;
     }
 
-  SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *v = m_candidates.front ().first;
+  Swap (0, m_candidates.size () - 1);
+  m_candidates.pop_back ();
+  m_positions.erase (v->GetVertexId ());
+  if (!m_candidates.empty ())
+    {
+      SiftDown (0);
+    }
   return v;
 }
 
@@ -124,7 +132,7 @@ CandidateQueue::Top (void) const
       return 0;
     }
 
-  return m_candidates.front ();
+  return m_candidates.front ().first;
 }
 
 bool
@@ -145,18 +153,28 @@ SPFVertex *
 CandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this);
-  CandidateList_t::const_iterator i = m_candidates.begin ();
+  std::map<Ipv4Address, uint32_t>::const_iterator i = m_positions.find (addr);
 
-  for (; i != m_candidates.end (); i++)
+  if (i == m_positions.end ())
     {
-      SPFVertex *v = *i;
-      if (v->GetVertexId () == addr)
-        {
-          return v;
-        }
+      return 0;
     }
 
-  return 0;
+  return m_candidates[i->second].first;
+}
+
+void
+CandidateQueue::Update (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+  std::map<Ipv4Address, uint32_t>::const_iterator i = m_positions.find (v->GetVertexId ());
+  NS_ASSERT_MSG (i != m_positions.end () && m_candidates[i->second].first == v,
+                 "CandidateQueue::Update (): vertex not in the queue");
+
+  uint32_t pos = i->second;
+  m_candidates[pos].second = m_nextSeq++;
+  SiftUp (pos);
+  SiftDown (m_positions[v->GetVertexId ()]);
 }
 
 void
@@ -164,11 +182,64 @@ CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  for (uint32_t i = m_candidates.size () / 2; i > 0; i--)
+    {
+      SiftDown (i - 1);
+    }
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+bool
+CandidateQueue::Before (uint32_t i, uint32_t j) const
+{
+  return CompareCandidates (m_candidates[i], m_candidates[j]);
+}
+
+void
+CandidateQueue::Swap (uint32_t i, uint32_t j)
+{
+  std::swap (m_candidates[i], m_candidates[j]);
+  m_positions[m_candidates[i].first->GetVertexId ()] = i;
+  m_positions[m_candidates[j].first->GetVertexId ()] = j;
+}
+
+void
+CandidateQueue::SiftUp (uint32_t i)
+{
+  while (i > 0 && Before (i, (i - 1) / 2))
+    {
+      Swap (i, (i - 1) / 2);
+      i = (i - 1) / 2;
+    }
+}
+
+void
+CandidateQueue::SiftDown (uint32_t i)
+{
+  uint32_t size = m_candidates.size ();
+  while (true)
+    {
+      uint32_t first = i;
+      uint32_t left = 2 * i + 1;
+      uint32_t right = 2 * i + 2;
+      if (left < size && Before (left, first))
+        {
+          first = left;
+        }
+      if (right < size && Before (right, first))
+        {
+          first = right;
+        }
+      if (first == i)
+        {
+          return;
+        }
+      Swap (i, first);
+      i = first;
+    }
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
@@ -197,4 +268,18 @@ CandidateQueue::CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2)
   return result;
 }
 
+bool
+CandidateQueue::CompareCandidates (const Candidate_t &c1, const Candidate_t &c2)
+{
+  if (CompareSPFVertex (c1.first, c2.first))
+    {
+      return true;
+    }
+  if (CompareSPFVertex (c2.first, c1.first))
+    {
+      return false;
+    }
+  return c1.second < c2.second;
+}
+
 } // namespace ns3
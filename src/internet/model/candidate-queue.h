@@ -22,7 +22,8 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <vector>
+#include <map>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -45,8 +46,17 @@ class SPFVertex;
  *
  * Although a STL priority_queue almost does what we want, the requirement
  * for a Find () operation, the dynamic nature of the data and the derived
- * requirement for a Reorder () operation led us to implement this simple 
+ * requirement for an Update () operation led us to implement this simple 
  * enhanced priority queue.
+ *
+ * The vertices are stored in a binary heap, so that Push (), Pop () and
+ * Update () take a time logarithmic in the number of candidates; an index
+ * from the vertex ID to the position in the heap makes Find () logarithmic
+ * as well.  Vertices with the same distance and type are popped in the order
+ * they were pushed (or last updated), as the sorted list used by previous
+ * versions of this class did, so the routes computed are unchanged.  Find ()
+ * and Update () assume that the vertices in the queue have distinct IDs, as
+ * they do in the SPF calculation.
  */
 class CandidateQueue
 {
@@ -139,6 +149,18 @@ public:
  */
   SPFVertex* Find (const Ipv4Address addr) const;
 
+/**
+ * @brief Restore the position of a vertex in the Candidate Queue after its
+ * m_distanceFromRoot has changed.
+ *
+ * The vertex is placed after all the vertices having the same distance and
+ * type, as if it had just been pushed.
+ *
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex, which must be in the queue.
+ */
+  void Update (SPFVertex *v);
+
 /**
  * @brief Reorders the Candidate Queue according to the priority scheme.
  * 
@@ -148,7 +170,8 @@ public:
  * increasing distance.
  *
  * This method is provided in case the values of m_distanceFromRoot change
- * during the routing calculations.
+ * during the routing calculations.  If the distance of a single vertex
+ * changed, Update () is cheaper.
  *
  * @see SPFVertex
  */
@@ -184,8 +207,51 @@ private:
  */
   static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-  CandidateList_t m_candidates;  //!< SPFVertex candidates
+  /// A vertex in the heap, along with the sequence number of its last push or update
+  typedef std::pair<SPFVertex*, uint64_t> Candidate_t;
+
+  /**
+   * \brief return true if c1 < c2
+   *
+   * Candidates are ordered by CompareSPFVertex, then by sequence number.
+   *
+   * \param c1 first operand
+   * \param c2 second operand
+   * \return True if c1 should be popped before c2; false otherwise
+   */
+  static bool CompareCandidates (const Candidate_t &c1, const Candidate_t &c2);
+
+  /**
+   * \brief return true if the candidate at position i must be popped before
+   * the one at position j
+   * \param i the position of the first candidate in the heap
+   * \param j the position of the second candidate in the heap
+   * \return True if candidate i should be popped before candidate j
+   */
+  bool Before (uint32_t i, uint32_t j) const;
+  /**
+   * \brief Exchange two candidates in the heap
+   * \param i the position of the first candidate in the heap
+   * \param j the position of the second candidate in the heap
+   */
+  void Swap (uint32_t i, uint32_t j);
+  /**
+   * \brief Move a candidate towards the top of the heap until its parent
+   * comes before it
+   * \param i the position of the candidate in the heap
+   */
+  void SiftUp (uint32_t i);
+  /**
+   * \brief Move a candidate towards the bottom of the heap until it comes
+   * before its children
+   * \param i the position of the candidate in the heap
+   */
+  void SiftDown (uint32_t i);
+
+  typedef std::vector<Candidate_t> CandidateHeap_t; //!< binary heap of SPFVertex pointers
+  CandidateHeap_t m_candidates;  //!< SPFVertex candidates
+  std::map<Ipv4Address, uint32_t> m_positions; //!< position in the heap of each vertex ID
+  uint64_t m_nextSeq; //!< sequence number of the next push or update
 
   /**
    * \brief Stream insertion operator.
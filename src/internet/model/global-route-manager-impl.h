@@ -26,6 +26,7 @@
 #include <list>
 #include <queue>
 #include <map>
+#include <set>
 #include <vector>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -606,6 +607,9 @@ public:
  *
  * @see GlobalRoutingLSA
  * @see Ipv4Address
+ * The link records of the LSA must not change after the insertion, since
+ * the database indexes the LinkData field of its TransitNetwork records.
+ *
  * @param addr The IP address associated with the LSA.  Typically the Router 
  * ID.
  * @param lsa A pointer to the Link State Advertisement for the router.
@@ -674,12 +678,21 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+  /**
+   * @brief Get the link state IDs of all the Link State Advertisements,
+   * except the External ones.
+   *
+   * @param ids the vector where the link state IDs are appended, in
+   * increasing order.
+   */
+  void GetLinkStateIds (std::vector<Ipv4Address> &ids) const;
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
   typedef std::pair<Ipv4Address, GlobalRoutingLSA*> LSDBPair_t; //!< pair of IPv4 addresses / Link State Advertisements
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
+  std::map<Ipv4Address, Ipv4Address> m_linkDataIndex; //!< address of the LSA with a TransitNetwork link record, by LinkData of the record
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
 
 /**
@@ -735,6 +748,20 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and recompute the routes of the
+ * routers affected by the changes.
+ *
+ * This gives the same routes as DeleteGlobalRoutes (),
+ * BuildGlobalRoutingDatabase () and InitializeRoutes (), but the routes of
+ * a router are only deleted and recomputed if its SPF calculation reads a
+ * Link State Advertisement that was added, removed or modified since the
+ * previous routing database was built; that is, if the router can reach a
+ * router or network whose LSA changed.  A change of the AS External LSAs
+ * affects all the routers.
+ */
+  virtual void RecomputeRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -768,6 +795,57 @@ private:
 
   SPFVertex* m_spfroot; //!< the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  std::map<Ipv4Address, Ptr<Node> > m_routerNodes; //!< nodes with a GlobalRouter interface, by router ID
+
+  /**
+   * \brief Get the node with a given router ID
+   *
+   * During InitializeRoutes () and RecomputeRoutes () the node is looked up
+   * in an index built once, instead of walking the list of nodes for every
+   * route added.
+   *
+   * \param routerId the router ID
+   * \returns the node, or 0 if no node has a GlobalRouter interface with
+   * that router ID
+   */
+  Ptr<Node> GetRouterNode (Ipv4Address routerId);
+
+  /**
+   * \brief Index the nodes with a GlobalRouter interface by router ID
+   */
+  void IndexRouterNodes (void);
+
+  /**
+   * \brief Delete the routes of a GlobalRouter
+   *
+   * \param router the GlobalRouter
+   */
+  void DeleteRoutes (Ptr<GlobalRouter> router);
+
+  /**
+   * \brief Find the routers whose SPF calculation is affected by the
+   * differences between two routing databases
+   *
+   * \param oldLsdb the previous routing database
+   * \param newLsdb the new routing database
+   * \param routers the set where the router IDs of the affected routers are
+   * inserted (along with the IDs of the affected network LSAs)
+   * \returns true if all the routers are affected
+   */
+  bool FindAffectedRouters (const GlobalRouteManagerLSDB* oldLsdb,
+                            const GlobalRouteManagerLSDB* newLsdb,
+                            std::set<Ipv4Address> &routers) const;
+
+  /**
+   * \brief Test if two Link State Advertisements have the same contents
+   *
+   * The SPF status of the LSAs is not compared.
+   *
+   * \param lsa1 the first LSA
+   * \param lsa2 the second LSA
+   * \returns true if the LSAs are equal
+   */
+  static bool IsSameLSA (const GlobalRoutingLSA* lsa1, const GlobalRoutingLSA* lsa2);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef GSO_TAG_H
+#define GSO_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4
+ *
+ * \brief Marks a TCP super-segment for generic segmentation offload (GSO)
+ *
+ * This is the equivalent of the Linux skb_shinfo gso_size field. A TCP
+ * socket may hand down to IPv4 a segment carrying several times the
+ * maximum segment size. The tag tells IPv4 not to fragment it: the
+ * packet goes through routing and the queue disc as a single object, and
+ * it is split into segments of the given size just before being passed
+ * to the device (see Ipv4QueueDiscItem::Segment), so that the packets
+ * on the wire are the same as without GSO.
+ */
+class GsoTag : public Tag
+{
+public:
+  GsoTag ();
+
+  /**
+   * \brief Set the size of the segments to cut the payload into
+   *
+   * \param segmentSize the segment size, in bytes
+   */
+  void SetSegmentSize (uint16_t segmentSize);
+  /**
+   * \brief Get the size of the segments to cut the payload into
+   *
+   * \returns the segment size, in bytes
+   */
+  uint16_t GetSegmentSize (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  uint16_t m_segmentSize; //!< size of the segments on the wire
+};
+
+} // namespace ns3
+
+#endif /* GSO_TAG_H */
@@ -22,6 +22,8 @@
 #include "ipv4-end-point.h"
 #include "ipv4-interface-address.h"
 #include "ns3/log.h"
+#include <algorithm>
+#include <iterator>
 
 
 namespace ns3 {
@@ -29,7 +31,8 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemux");
 
 Ipv4EndPointDemux::Ipv4EndPointDemux ()
-  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152)
+  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152),
+    m_nextSeq (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -43,20 +46,80 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux ()
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_index.clear ();
+  m_info.clear ();
+  m_localPorts.clear ();
+}
+
+Ipv4EndPointDemux::IndexKey
+Ipv4EndPointDemux::GetKey (uint16_t localPort, Ipv4Address peerAddress, uint16_t peerPort)
+{
+  return (static_cast<uint64_t> (localPort) << 48)
+         | (static_cast<uint64_t> (peerAddress.Get ()) << 16)
+         | peerPort;
+}
+
+void
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  EndPointInfo info;
+  info.seq = m_nextSeq++;
+  info.key = GetKey (endPoint->GetLocalPort (), endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+  info.position = m_endPoints.insert (m_endPoints.end (), endPoint);
+  m_info[endPoint] = info;
+  m_localPorts[endPoint->GetLocalPort ()]++;
+  AddToIndex (endPoint, info);
+  endPoint->m_demux = this;
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+}
+
+void
+Ipv4EndPointDemux::AddToIndex (Ipv4EndPoint *endPoint, const EndPointInfo &info)
+{
+  // an endpoint changing peer may be older than the ones already in its
+  // new bucket
+  IndexBucket &bucket = m_index[info.key];
+  IndexedEndPoint entry (info.seq, endPoint);
+  bucket.insert (std::upper_bound (bucket.begin (), bucket.end (), entry), entry);
+}
+
+void
+Ipv4EndPointDemux::RemoveFromIndex (Ipv4EndPoint *endPoint, const EndPointInfo &info)
+{
+  std::unordered_map<IndexKey, IndexBucket>::iterator it = m_index.find (info.key);
+  NS_ASSERT (it != m_index.end ());
+  IndexBucket &bucket = it->second;
+  IndexBucket::iterator pos = std::lower_bound (bucket.begin (), bucket.end (),
+                                                IndexedEndPoint (info.seq, endPoint));
+  NS_ASSERT (pos != bucket.end () && pos->second == endPoint);
+  bucket.erase (pos);
+  if (bucket.empty ())
+    {
+      m_index.erase (it);
+    }
+}
+
+void
+Ipv4EndPointDemux::Reindex (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  std::unordered_map<Ipv4EndPoint *, EndPointInfo>::iterator it = m_info.find (endPoint);
+  NS_ASSERT (it != m_info.end ());
+  IndexKey key = GetKey (endPoint->GetLocalPort (), endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+  if (key != it->second.key)
+    {
+      RemoveFromIndex (endPoint, it->second);
+      it->second.key = key;
+      AddToIndex (endPoint, it->second);
+    }
 }
 
 bool
 Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if ((*i)->GetLocalPort  () == port) 
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_localPorts.find (port) != m_localPorts.end ();
 }
 
 bool
@@ -85,8 +148,7 @@ Ipv4EndPointDemux::Allocate (void)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -101,8 +163,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -124,8 +185,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address, uint16_t port)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -134,24 +194,23 @@ Ipv4EndPointDemux::Allocate (Ipv4Address localAddress, uint16_t localPort,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::unordered_map<IndexKey, IndexBucket>::const_iterator it =
+    m_index.find (GetKey (localPort, peerAddress, peerPort));
+  if (it != m_index.end ())
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress) 
+      for (IndexBucket::const_iterator i = it->second.begin (); i != it->second.end (); i++)
         {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
+          if (i->second->GetLocalAddress () == localAddress)
+            {
+              NS_LOG_WARN ("No way we can allocate this end-point.");
+              /* no way we can allocate this end-point. */
+              return 0;
+            }
         }
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -159,15 +218,20 @@ void
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::unordered_map<Ipv4EndPoint *, EndPointInfo>::iterator it = m_info.find (endPoint);
+  if (it == m_info.end ())
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      return;
+    }
+  RemoveFromIndex (endPoint, it->second);
+  m_endPoints.erase (it->second.position);
+  std::unordered_map<uint16_t, uint32_t>::iterator port = m_localPorts.find (endPoint->GetLocalPort ());
+  if (--port->second == 0)
+    {
+      m_localPorts.erase (port);
     }
+  m_info.erase (it);
+  delete endPoint;
 }
 
 /*
@@ -192,6 +256,10 @@ Ipv4EndPointDemux::GetAllEndPoints (void)
  * If we have an exact match, we return it.
  * Otherwise, if we find a generic match, we return it.
  * Otherwise, we return 0.
+ *
+ * Only the endpoints whose peer is the source of the packet or is
+ * unspecified can match: they are taken from the index, in allocation
+ * order, and the matching rules are applied to them.
  */
 Ipv4EndPointDemux::EndPoints
 Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport, 
@@ -206,9 +274,35 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  IndexBucket candidates;
+  IndexKey exactKey = GetKey (dport, saddr, sport);
+  IndexKey wildKey = GetKey (dport, Ipv4Address::GetAny (), 0);
+  std::unordered_map<IndexKey, IndexBucket>::const_iterator exact = m_index.find (exactKey);
+  std::unordered_map<IndexKey, IndexBucket>::const_iterator wild =
+    exactKey != wildKey ? m_index.find (wildKey) : m_index.end ();
+  if (exact != m_index.end () && wild != m_index.end ())
     {
-      Ipv4EndPoint* endP = *i;
+      std::merge (exact->second.begin (), exact->second.end (),
+                  wild->second.begin (), wild->second.end (),
+                  std::back_inserter (candidates));
+    }
+  else if (exact != m_index.end ())
+    {
+      candidates = exact->second;
+    }
+  else if (wild != m_index.end ())
+    {
+      candidates = wild->second;
+    }
+
+  // the broadcast status of the destination does not depend on the
+  // endpoint: it is computed once, for the first endpoint which needs it
+  bool broadcastChecked = false;
+  bool subnetDirected = false;
+  Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
+  for (IndexBucket::const_iterator i = candidates.begin (); i != candidates.end (); i++)
+    {
+      Ipv4EndPoint* endP = i->second;
 
       NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
                                                  << " daddr=" << endP->GetLocalAddress ()
@@ -241,17 +335,19 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
               continue;
             }
         }
-      bool subnetDirected = false;
-      Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
-      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+      if (!broadcastChecked)
         {
-          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
-          if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
-              daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
+          for (uint32_t j = 0; j < incomingInterface->GetNAddresses (); j++)
             {
-              subnetDirected = true;
-              incomingInterfaceAddr = addr.GetLocal ();
+              Ipv4InterfaceAddress addr = incomingInterface->GetAddress (j);
+              if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
+                  daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
+                {
+                  subnetDirected = true;
+                  incomingInterfaceAddr = addr.GetLocal ();
+                }
             }
+          broadcastChecked = true;
         }
       bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
       NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
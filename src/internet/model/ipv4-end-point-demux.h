@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <list>
+#include <vector>
+#include <unordered_map>
 #include "ns3/ipv4-address.h"
 #include "ipv4-interface.h"
 
@@ -40,6 +42,14 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * Besides the list, the endpoints are indexed in a hash table by local
+ * port, peer address and peer port.  An endpoint can only match a packet if
+ * its peer is the source of the packet or is unspecified, so Lookup ()
+ * only has to examine two buckets of the table: the connected endpoints
+ * and the listening (or unconnected) endpoints on the destination port.
+ * The cost of delivering a packet hence does not depend on the number of
+ * endpoints.
  */
 
 class Ipv4EndPointDemux {
@@ -163,6 +173,68 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief Key of the endpoint index: local port, peer address and peer port.
+   */
+  typedef uint64_t IndexKey;
+
+  /**
+   * \brief An indexed endpoint, along with its allocation sequence number.
+   */
+  typedef std::pair<uint64_t, Ipv4EndPoint *> IndexedEndPoint;
+
+  /**
+   * \brief The endpoints with the same key, in allocation order.
+   */
+  typedef std::vector<IndexedEndPoint> IndexBucket;
+
+  /**
+   * \brief Where an endpoint is stored in the demux.
+   */
+  struct EndPointInfo
+  {
+    uint64_t seq;         //!< allocation sequence number
+    IndexKey key;         //!< key of the endpoint in the index
+    EndPointsI position;  //!< position of the endpoint in the list
+  };
+
+  /**
+   * \brief Build the index key of a four-tuple.
+   * \param localPort local port
+   * \param peerAddress peer address
+   * \param peerPort peer port
+   * \returns the key
+   */
+  static IndexKey GetKey (uint16_t localPort, Ipv4Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Add a newly allocated end point to the list and to the index.
+   * \param endPoint the end point
+   */
+  void Insert (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Add an end point to the bucket of its key.
+   * \param endPoint the end point
+   * \param info where the end point is stored
+   */
+  void AddToIndex (Ipv4EndPoint *endPoint, const EndPointInfo &info);
+
+  /**
+   * \brief Remove an end point from the bucket of its key.
+   * \param endPoint the end point
+   * \param info where the end point is stored
+   */
+  void RemoveFromIndex (Ipv4EndPoint *endPoint, const EndPointInfo &info);
+
+  /**
+   * \brief Move an end point to the bucket of its new key, after its peer
+   * changed.  Called by Ipv4EndPoint::SetPeer.
+   * \param endPoint the end point
+   */
+  void Reindex (Ipv4EndPoint *endPoint);
 
   /**
    * \brief Allocate an ephemeral port.
@@ -189,6 +261,26 @@ private:
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The end points, by local port, peer address and peer port.
+   */
+  std::unordered_map<IndexKey, IndexBucket> m_index;
+
+  /**
+   * \brief Where each end point is stored.
+   */
+  std::unordered_map<Ipv4EndPoint *, EndPointInfo> m_info;
+
+  /**
+   * \brief The number of end points bound to each local port.
+   */
+  std::unordered_map<uint16_t, uint32_t> m_localPorts;
+
+  /**
+   * \brief The sequence number of the next allocated end point.
+   */
+  uint64_t m_nextSeq;
 };
 
 } // namespace ns3
@@ -28,6 +28,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ipv4-route-trie.h"
 
 namespace ns3 {
 
@@ -272,6 +273,13 @@ private:
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  /// Index of the routes by destination prefix
+  typedef Ipv4RouteTrie<Ipv4RoutingTableEntry *> RouteTrie;
+
+  RouteTrie m_hostRoutesTrie;          //!< Index of m_hostRoutes
+  RouteTrie m_networkRoutesTrie;       //!< Index of m_networkRoutes
+  RouteTrie m_ASexternalRoutesTrie;    //!< Index of m_ASexternalRoutes
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
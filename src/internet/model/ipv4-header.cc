@@ -41,6 +41,7 @@ Ipv4Header::Ipv4Header ()
     m_fragmentOffset (0),
     m_checksum (0),
     m_goodChecksum (true),
+    m_checksumValid (false),
     m_headerSize(5*4)
 {
 }
@@ -57,6 +58,7 @@ Ipv4Header::SetPayloadSize (uint16_t size)
 {
   NS_LOG_FUNCTION (this << size);
   m_payloadSize = size;
+  m_checksumValid = false;
 }
 uint16_t
 Ipv4Header::GetPayloadSize (void) const
@@ -76,29 +78,36 @@ Ipv4Header::SetIdentification (uint16_t identification)
 {
   NS_LOG_FUNCTION (this << identification);
   m_identification = identification;
+  m_checksumValid = false;
 }
 
 void 
 Ipv4Header::SetTos (uint8_t tos)
 {
   NS_LOG_FUNCTION (this << static_cast<uint32_t> (tos));
+  uint8_t oldTos = m_tos;
   m_tos = tos;
+  UpdateChecksum (oldTos, m_ttl);
 }
 
 void
 Ipv4Header::SetDscp (DscpType dscp)
 {
   NS_LOG_FUNCTION (this << dscp);
+  uint8_t oldTos = m_tos;
   m_tos &= 0x3; // Clear out the DSCP part, retain 2 bits of ECN
   m_tos |= (dscp << 2);
+  UpdateChecksum (oldTos, m_ttl);
 }
 
 void
 Ipv4Header::SetEcn (EcnType ecn)
 {
   NS_LOG_FUNCTION (this << ecn);
+  uint8_t oldTos = m_tos;
   m_tos &= 0xFC; // Clear out the ECN part, retain 6 bits of DSCP
   m_tos |= ecn;
+  UpdateChecksum (oldTos, m_ttl);
 }
 
 Ipv4Header::DscpType 
@@ -201,12 +210,14 @@ Ipv4Header::SetMoreFragments (void)
 {
   NS_LOG_FUNCTION (this);
   m_flags |= MORE_FRAGMENTS;
+  m_checksumValid = false;
 }
 void
 Ipv4Header::SetLastFragment (void)
 {
   NS_LOG_FUNCTION (this);
   m_flags &= ~MORE_FRAGMENTS;
+  m_checksumValid = false;
 }
 bool 
 Ipv4Header::IsLastFragment (void) const
@@ -220,12 +231,14 @@ Ipv4Header::SetDontFragment (void)
 {
   NS_LOG_FUNCTION (this);
   m_flags |= DONT_FRAGMENT;
+  m_checksumValid = false;
 }
 void 
 Ipv4Header::SetMayFragment (void)
 {
   NS_LOG_FUNCTION (this);
   m_flags &= ~DONT_FRAGMENT;
+  m_checksumValid = false;
 }
 bool 
 Ipv4Header::IsDontFragment (void) const
@@ -241,6 +254,7 @@ Ipv4Header::SetFragmentOffset (uint16_t offsetBytes)
   // check if the user is trying to set an invalid offset
   NS_ABORT_MSG_IF ((offsetBytes & 0x7), "offsetBytes must be multiple of 8 bytes");
   m_fragmentOffset = offsetBytes;
+  m_checksumValid = false;
 }
 uint16_t 
 Ipv4Header::GetFragmentOffset (void) const
@@ -259,7 +273,9 @@ void
 Ipv4Header::SetTtl (uint8_t ttl)
 {
   NS_LOG_FUNCTION (this << static_cast<uint32_t> (ttl));
+  uint8_t oldTtl = m_ttl;
   m_ttl = ttl;
+  UpdateChecksum (m_tos, oldTtl);
 }
 uint8_t 
 Ipv4Header::GetTtl (void) const
@@ -279,6 +295,7 @@ Ipv4Header::SetProtocol (uint8_t protocol)
 {
   NS_LOG_FUNCTION (this << static_cast<uint32_t> (protocol));
   m_protocol = protocol;
+  m_checksumValid = false;
 }
 
 void 
@@ -286,6 +303,7 @@ Ipv4Header::SetSource (Ipv4Address source)
 {
   NS_LOG_FUNCTION (this << source);
   m_source = source;
+  m_checksumValid = false;
 }
 Ipv4Address
 Ipv4Header::GetSource (void) const
@@ -299,6 +317,7 @@ Ipv4Header::SetDestination (Ipv4Address dst)
 {
   NS_LOG_FUNCTION (this << dst);
   m_destination = dst;
+  m_checksumValid = false;
 }
 Ipv4Address
 Ipv4Header::GetDestination (void) const
@@ -315,6 +334,34 @@ Ipv4Header::IsChecksumOk (void) const
   return m_goodChecksum;
 }
 
+uint16_t
+Ipv4Header::UpdateChecksum (uint16_t checksum, uint16_t oldWord, uint16_t newWord)
+{
+  NS_LOG_FUNCTION (checksum << oldWord << newWord);
+  // HC' = ~(~HC + ~m + m')
+  uint32_t sum = static_cast<uint16_t> (~checksum);
+  sum += static_cast<uint16_t> (~oldWord);
+  sum += newWord;
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  return ~sum;
+}
+
+void
+Ipv4Header::UpdateChecksum (uint8_t oldTos, uint8_t oldTtl)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (oldTos) << static_cast<uint32_t> (oldTtl));
+  if (!m_checksumValid)
+    {
+      return;
+    }
+  // the words are in the byte order of Buffer::Iterator::ReadU16,
+  // as m_checksum: the first byte is the low-order byte.
+  uint8_t verIhl = (4 << 4) | (5);
+  m_checksum = UpdateChecksum (m_checksum, verIhl | (oldTos << 8), verIhl | (m_tos << 8));
+  m_checksum = UpdateChecksum (m_checksum, oldTtl | (m_protocol << 8), m_ttl | (m_protocol << 8));
+}
+
 TypeId 
 Ipv4Header::GetTypeId (void)
 {
@@ -409,7 +456,15 @@ Ipv4Header::Serialize (Buffer::Iterator start) const
   i.WriteHtonU32 (m_source.Get ());
   i.WriteHtonU32 (m_destination.Get ());
 
-  if (m_calcChecksum) 
+  if (m_calcChecksum && m_checksumValid)
+    {
+      // the checksum received with the header was updated along
+      // with the TOS and TTL, there is no need to compute it again.
+      i = start;
+      i.Next (10);
+      i.WriteU16 (m_checksum);
+    }
+  else if (m_calcChecksum) 
     {
       i = start;
       uint16_t checksum = i.CalculateIpChecksum (20);
@@ -470,6 +525,9 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
 
       m_goodChecksum = (checksum == 0);
     }
+  // the options are not serialized, so the checksum can be reused
+  // only for headers without options.
+  m_checksumValid = m_calcChecksum && m_goodChecksum && headerSize == 5*4;
   return GetSerializedSize ();
 }
 
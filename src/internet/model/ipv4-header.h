@@ -236,6 +236,24 @@ public:
   virtual void Serialize (Buffer::Iterator start) const;
   virtual uint32_t Deserialize (Buffer::Iterator start);
 private:
+  /**
+   * \brief Update a checksum after one of the 16 bit words it covers changed.
+   *
+   * See RFC 1624, equation 3.
+   *
+   * \param checksum the checksum, as read by Buffer::Iterator::ReadU16
+   * \param oldWord the old value of the word, in the same byte order
+   * \param newWord the new value of the word, in the same byte order
+   * \returns the updated checksum
+   */
+  static uint16_t UpdateChecksum (uint16_t checksum, uint16_t oldWord, uint16_t newWord);
+  /**
+   * \brief Update m_checksum after the TOS or the TTL changed, or
+   * invalidate it if it is not up to date.
+   * \param oldTos the previous TOS
+   * \param oldTtl the previous TTL
+   */
+  void UpdateChecksum (uint8_t oldTos, uint8_t oldTtl);
 
   /// flags related to IP fragmentation
   enum FlagsE {
@@ -256,6 +274,7 @@ private:
   Ipv4Address m_destination; //!< destination address
   uint16_t m_checksum; //!< checksum
   bool m_goodChecksum; //!< true if checksum is correct
+  bool m_checksumValid; //!< true if m_checksum matches the fields of the header
   uint16_t m_headerSize; //!< IP header size
 };
 
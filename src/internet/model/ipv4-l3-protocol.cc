@@ -41,6 +41,9 @@
 #include "icmpv4-l4-protocol.h"
 #include "ipv4-interface.h"
 #include "ipv4-raw-socket-impl.h"
+#include "tcp-header.h"
+#include "gso-tag.h"
+#include <limits>
 
 namespace ns3 {
 
@@ -925,12 +928,33 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
   Ptr<Ipv4Interface> outInterface = GetInterface (interface);
   NS_LOG_LOGIC ("Send via NetDevice ifIndex " << outDev->GetIfIndex () << " ipv4InterfaceIndex " << interface);
 
+  // A GSO super-segment is not fragmented: it is split into segments which
+  // fit the MTU just before reaching the device. Each of them is sent as a
+  // datagram with its own identification, hence reserve the ones following
+  // the identification of the header.
+  uint32_t mtu = outInterface->GetDevice ()->GetMtu ();
+  GsoTag gsoTag;
+  if (packet->PeekPacketTag (gsoTag))
+    {
+      TcpHeader tcpHeader;
+      packet->PeekHeader (tcpHeader);
+      uint32_t payloadSize = packet->GetSize () - tcpHeader.GetSerializedSize ();
+      uint32_t nDatagrams = (payloadSize + gsoTag.GetSegmentSize () - 1) / gsoTag.GetSegmentSize ();
+      uint64_t srcDst = ipHeader.GetDestination ().Get () | (static_cast<uint64_t> (ipHeader.GetSource ().Get ()) << 32);
+      std::pair<uint64_t, uint8_t> key = std::make_pair (srcDst, ipHeader.GetProtocol ());
+      if (nDatagrams > 1)
+        {
+          m_identification[key] += nDatagrams - 1;
+        }
+      mtu = std::numeric_limits<uint32_t>::max ();
+    }
+
   if (!route->GetGateway ().IsEqual (Ipv4Address ("0.0.0.0")))
     {
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to gateway " << route->GetGateway ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if ( packet->GetSize () + ipHeader.GetSerializedSize () > mtu )
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -957,7 +981,7 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
       if (outInterface->IsUp ())
         {
           NS_LOG_LOGIC ("Send to destination " << ipHeader.GetDestination ());
-          if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+          if ( packet->GetSize () + ipHeader.GetSerializedSize () > mtu )
             {
               std::list<Ipv4PayloadHeaderPair> listFragments;
               DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
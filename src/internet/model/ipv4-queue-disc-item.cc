@@ -17,7 +17,11 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/node.h"
 #include "ipv4-queue-disc-item.h"
+#include "tcp-header.h"
+#include "tcp-l4-protocol.h"
+#include "gso-tag.h"
 
 namespace ns3 {
 
@@ -66,6 +70,18 @@ void Ipv4QueueDiscItem::AddHeader (void)
   m_headerAdded = true;
 }
 
+Ptr<Packet>
+Ipv4QueueDiscItem::GetPacketWithHeader (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<Packet> p = GetPacket ()->Copy ();
+  if (!m_headerAdded)
+    {
+      p->AddHeader (m_header);
+    }
+  return p;
+}
+
 void
 Ipv4QueueDiscItem::Print (std::ostream& os) const
 {
@@ -92,6 +108,66 @@ Ipv4QueueDiscItem::Mark (void)
   return false;
 }
 
+bool
+Ipv4QueueDiscItem::Segment (std::list<Ptr<QueueDiscItem> > &segments) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (!m_headerAdded, "The header has been already added to the packet");
+
+  GsoTag gsoTag;
+  if (m_header.GetProtocol () != TcpL4Protocol::PROT_NUMBER
+      || !GetPacket ()->PeekPacketTag (gsoTag))
+    {
+      return false;
+    }
+
+  Ptr<Packet> p = GetPacket ()->Copy ();
+  p->RemovePacketTag (gsoTag);
+  TcpHeader tcpHeader;
+  p->RemoveHeader (tcpHeader);
+  uint32_t segmentSize = gsoTag.GetSegmentSize ();
+  uint32_t size = p->GetSize ();
+  NS_ASSERT (segmentSize > 0);
+
+  uint16_t id = m_header.GetIdentification ();
+  for (uint32_t offset = 0; offset < size; offset += segmentSize)
+    {
+      uint32_t length = std::min (segmentSize, size - offset);
+      Ptr<Packet> segment = p->CreateFragment (offset, length);
+
+      TcpHeader header = tcpHeader;
+      header.SetSequenceNumber (tcpHeader.GetSequenceNumber () + SequenceNumber32 (offset));
+      uint8_t flags = tcpHeader.GetFlags ();
+      if (offset > 0)
+        {
+          flags &= ~TcpHeader::CWR;
+        }
+      if (offset + length < size)
+        {
+          flags &= ~(TcpHeader::FIN | TcpHeader::PSH);
+        }
+      header.SetFlags (flags);
+      if (Node::ChecksumEnabled ())
+        {
+          header.EnableChecksums ();
+          header.InitializeChecksum (m_header.GetSource (), m_header.GetDestination (),
+                                     TcpL4Protocol::PROT_NUMBER);
+        }
+      segment->AddHeader (header);
+
+      Ipv4Header ipHeader = m_header;
+      ipHeader.SetPayloadSize (segment->GetSize ());
+      ipHeader.SetIdentification (id++);
+
+      Ptr<Ipv4QueueDiscItem> item = Create<Ipv4QueueDiscItem> (segment, GetAddress (),
+                                                                GetProtocol (), ipHeader);
+      item->SetTxQueueIndex (GetTxQueueIndex ());
+      segments.push_back (item);
+    }
+  NS_LOG_LOGIC ("Super-segment of " << size << " bytes split into " << segments.size ()
+                << " segments of " << segmentSize << " bytes");
+  return true;
+}
 
 bool
 Ipv4QueueDiscItem::GetUint8Value (QueueItem::Uint8Values field, uint8_t& value) const
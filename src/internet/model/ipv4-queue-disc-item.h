@@ -61,6 +61,12 @@ public:
    */
   virtual void AddHeader (void);
 
+  /**
+   * \brief Get a copy of the packet with the IPv4 header added
+   * \return a copy of the packet, including the header
+   */
+  virtual Ptr<Packet> GetPacketWithHeader (void) const;
+
   /**
    * \brief Print the item contents.
    * \param os output stream in which the data should be printed.
@@ -82,6 +88,20 @@ public:
    */
   virtual bool Mark (void);
 
+  /**
+   * \brief Split a TCP super-segment carrying a GsoTag
+   *
+   * The payload is cut into segments of the size given by the tag. Each
+   * segment gets a copy of the TCP header, with its sequence number advanced
+   * and the FIN and PSH flags kept only on the last segment and the CWR flag
+   * only on the first one, and a copy of the IPv4 header, with its own
+   * payload size and identification.
+   *
+   * \param segments the list to which the segments are appended
+   * \return true if the item was a super-segment and has been split
+   */
+  virtual bool Segment (std::list<Ptr<QueueDiscItem> > &segments) const;
+
 private:
   /**
    * \brief Default constructor
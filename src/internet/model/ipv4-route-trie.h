@@ -0,0 +1,412 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_ROUTE_TRIE_H
+#define IPV4_ROUTE_TRIE_H
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <stdint.h>
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Path-compressed binary trie indexing routes by destination prefix.
+ *
+ * The trie is an index over a routing table kept elsewhere (usually a
+ * std::list of routes): the routing protocol inserts every route it adds to
+ * its table and removes every route it erases. Lookup returns every route
+ * whose prefix matches the destination address, in the order the routes
+ * were inserted, which is the order in which a linear scan of the table
+ * would find them. Hence the routing protocol can apply its own selection
+ * rules (longest prefix, metric, ECMP) to the matching routes and obtain
+ * exactly the result of the linear scan, while visiting at most 33 nodes
+ * instead of the whole table.
+ *
+ * Each node of the trie stores a prefix and its length; nodes with a
+ * single child and no routes are not created (path compression), so the
+ * trie has fewer than twice as many nodes as distinct prefixes.
+ *
+ * Routes whose mask is not contiguous cannot be stored in the trie; they
+ * are kept in a separate vector which is scanned by every lookup.
+ *
+ * \tparam T the type of the route, which must be copyable and comparable
+ *         for equality (e.g., a pointer to a routing table entry).
+ */
+template <typename T>
+class Ipv4RouteTrie
+{
+public:
+  Ipv4RouteTrie ();
+  ~Ipv4RouteTrie ();
+
+  /**
+   * \brief Add a route to the trie
+   * \param network the destination network of the route
+   * \param mask the network mask of the route
+   * \param route the route
+   */
+  void Insert (Ipv4Address network, Ipv4Mask mask, const T &route);
+
+  /**
+   * \brief Remove a route from the trie
+   * \param network the destination network the route was inserted with
+   * \param mask the network mask the route was inserted with
+   * \param route the route
+   * \returns true if the route was found and removed
+   */
+  bool Remove (Ipv4Address network, Ipv4Mask mask, const T &route);
+
+  /**
+   * \brief Remove all the routes
+   */
+  void Clear (void);
+
+  /**
+   * \brief Get the routes matching a destination
+   *
+   * The routes are appended to the given vector in insertion order.
+   *
+   * \param dest the destination address
+   * \param routes the vector where the matching routes are appended
+   */
+  void Lookup (Ipv4Address dest, std::vector<T> &routes) const;
+
+  /**
+   * \returns the number of routes in the trie
+   */
+  uint32_t GetNRoutes (void) const;
+
+private:
+  /// A route along with its insertion sequence number
+  typedef std::pair<uint64_t, T> Route;
+
+  /// A trie node
+  struct Node
+  {
+    uint32_t prefix;            //!< the prefix, with the bits beyond length cleared
+    uint8_t length;             //!< the prefix length
+    std::vector<Route> routes;  //!< the routes to this prefix
+    Node *child[2];             //!< the children, by value of the bit after the prefix
+  };
+
+  /// A route with a non-contiguous mask
+  struct OtherRoute
+  {
+    uint32_t network;  //!< the destination network
+    uint32_t mask;     //!< the network mask
+    Route route;       //!< the route
+  };
+
+  /// Copy constructor, not implemented
+  Ipv4RouteTrie (const Ipv4RouteTrie &);
+  /// Assignment operator, not implemented
+  Ipv4RouteTrie &operator= (const Ipv4RouteTrie &);
+
+  /**
+   * \brief Create a node without children and routes
+   * \param prefix the prefix
+   * \param length the prefix length
+   * \returns the new node
+   */
+  static Node *CreateNode (uint32_t prefix, uint8_t length);
+  /**
+   * \brief Delete a node and all its descendants
+   * \param node the node
+   */
+  static void DeleteNode (Node *node);
+  /**
+   * \param length a prefix length
+   * \returns the mask with the first length bits set
+   */
+  static uint32_t PrefixMask (uint8_t length);
+  /**
+   * \param address an address
+   * \param position the position of the bit, starting from the most significant
+   * \returns the bit of the address at the given position
+   */
+  static uint32_t Bit (uint32_t address, uint8_t position);
+  /**
+   * \brief Compare the sequence numbers of two routes
+   * \param a the first route
+   * \param b the second route
+   * \returns true if a was inserted before b
+   */
+  static bool InsertedBefore (const Route &a, const Route &b);
+
+  Node *m_root;                 //!< the root of the trie
+  std::vector<OtherRoute> m_others; //!< the routes with a non-contiguous mask
+  uint64_t m_nextSeq;           //!< the sequence number of the next route
+  uint32_t m_nRoutes;           //!< the number of routes
+};
+
+template <typename T>
+Ipv4RouteTrie<T>::Ipv4RouteTrie ()
+  : m_root (0),
+    m_nextSeq (0),
+    m_nRoutes (0)
+{
+}
+
+template <typename T>
+Ipv4RouteTrie<T>::~Ipv4RouteTrie ()
+{
+  DeleteNode (m_root);
+}
+
+template <typename T>
+typename Ipv4RouteTrie<T>::Node *
+Ipv4RouteTrie<T>::CreateNode (uint32_t prefix, uint8_t length)
+{
+  Node *node = new Node;
+  node->prefix = prefix;
+  node->length = length;
+  node->child[0] = 0;
+  node->child[1] = 0;
+  return node;
+}
+
+template <typename T>
+void
+Ipv4RouteTrie<T>::DeleteNode (Node *node)
+{
+  if (node != 0)
+    {
+      DeleteNode (node->child[0]);
+      DeleteNode (node->child[1]);
+      delete node;
+    }
+}
+
+template <typename T>
+uint32_t
+Ipv4RouteTrie<T>::PrefixMask (uint8_t length)
+{
+  return length == 0 ? 0 : 0xffffffff << (32 - length);
+}
+
+template <typename T>
+uint32_t
+Ipv4RouteTrie<T>::Bit (uint32_t address, uint8_t position)
+{
+  return (address >> (31 - position)) & 1;
+}
+
+template <typename T>
+bool
+Ipv4RouteTrie<T>::InsertedBefore (const Route &a, const Route &b)
+{
+  return a.first < b.first;
+}
+
+template <typename T>
+void
+Ipv4RouteTrie<T>::Insert (Ipv4Address network, Ipv4Mask mask, const T &route)
+{
+  Route entry (m_nextSeq++, route);
+  m_nRoutes++;
+
+  uint8_t length = mask.GetPrefixLength ();
+  if (mask.Get () != PrefixMask (length))
+    {
+      OtherRoute other;
+      other.network = network.Get () & mask.Get ();
+      other.mask = mask.Get ();
+      other.route = entry;
+      m_others.push_back (other);
+      return;
+    }
+  uint32_t prefix = network.Get () & mask.Get ();
+
+  Node **link = &m_root;
+  while (true)
+    {
+      Node *node = *link;
+      if (node == 0)
+        {
+          node = CreateNode (prefix, length);
+          node->routes.push_back (entry);
+          *link = node;
+          return;
+        }
+
+      // length of the prefix shared by the node and the new route
+      uint8_t common = std::min (node->length, length);
+      uint32_t diff = (node->prefix ^ prefix) & PrefixMask (common);
+      if (diff != 0)
+        {
+          common = 0;
+          while (Bit (diff, common) == 0)
+            {
+              common++;
+            }
+        }
+
+      if (common == node->length)
+        {
+          if (length == node->length)
+            {
+              node->routes.push_back (entry);
+              return;
+            }
+          // the new route is below the node
+          link = &node->child[Bit (prefix, node->length)];
+          continue;
+        }
+
+      Node *parent = CreateNode (prefix & PrefixMask (common), common);
+      parent->child[Bit (node->prefix, common)] = node;
+      if (common == length)
+        {
+          // the new route is an ancestor of the node
+          parent->routes.push_back (entry);
+        }
+      else
+        {
+          // the node and the new route branch off
+          Node *leaf = CreateNode (prefix, length);
+          leaf->routes.push_back (entry);
+          parent->child[Bit (prefix, common)] = leaf;
+        }
+      *link = parent;
+      return;
+    }
+}
+
+template <typename T>
+bool
+Ipv4RouteTrie<T>::Remove (Ipv4Address network, Ipv4Mask mask, const T &route)
+{
+  uint8_t length = mask.GetPrefixLength ();
+  if (mask.Get () != PrefixMask (length))
+    {
+      for (typename std::vector<OtherRoute>::iterator it = m_others.begin (); it != m_others.end (); it++)
+        {
+          if (it->route.second == route)
+            {
+              m_others.erase (it);
+              m_nRoutes--;
+              return true;
+            }
+        }
+      return false;
+    }
+  uint32_t prefix = network.Get () & mask.Get ();
+
+  Node **parentLink = 0;
+  Node **link = &m_root;
+  while (*link != 0 && (*link)->length < length
+         && (((*link)->prefix ^ prefix) & PrefixMask ((*link)->length)) == 0)
+    {
+      parentLink = link;
+      link = &(*link)->child[Bit (prefix, (*link)->length)];
+    }
+  Node *node = *link;
+  if (node == 0 || node->length != length || node->prefix != prefix)
+    {
+      return false;
+    }
+
+  typename std::vector<Route>::iterator it = node->routes.begin ();
+  while (it != node->routes.end () && !(it->second == route))
+    {
+      it++;
+    }
+  if (it == node->routes.end ())
+    {
+      return false;
+    }
+  node->routes.erase (it);
+  m_nRoutes--;
+
+  if (!node->routes.empty () || (node->child[0] != 0 && node->child[1] != 0))
+    {
+      return true;
+    }
+  // the node is no longer needed: replace it with its only child, if any
+  *link = node->child[0] != 0 ? node->child[0] : node->child[1];
+  bool leaf = (*link == 0);
+  delete node;
+
+  // the parent may have been left with a single child and no routes
+  if (leaf && parentLink != 0)
+    {
+      Node *parent = *parentLink;
+      if (parent->routes.empty () && (parent->child[0] == 0 || parent->child[1] == 0))
+        {
+          *parentLink = parent->child[0] != 0 ? parent->child[0] : parent->child[1];
+          delete parent;
+        }
+    }
+  return true;
+}
+
+template <typename T>
+void
+Ipv4RouteTrie<T>::Clear (void)
+{
+  DeleteNode (m_root);
+  m_root = 0;
+  m_others.clear ();
+  m_nRoutes = 0;
+}
+
+template <typename T>
+void
+Ipv4RouteTrie<T>::Lookup (Ipv4Address dest, std::vector<T> &routes) const
+{
+  uint32_t address = dest.Get ();
+  std::vector<Route> found;
+
+  const Node *node = m_root;
+  while (node != 0 && ((address ^ node->prefix) & PrefixMask (node->length)) == 0)
+    {
+      found.insert (found.end (), node->routes.begin (), node->routes.end ());
+      if (node->length == 32)
+        {
+          break;
+        }
+      node = node->child[Bit (address, node->length)];
+    }
+  for (typename std::vector<OtherRoute>::const_iterator it = m_others.begin (); it != m_others.end (); it++)
+    {
+      if ((address & it->mask) == it->network)
+        {
+          found.push_back (it->route);
+        }
+    }
+
+  std::sort (found.begin (), found.end (), InsertedBefore);
+  for (typename std::vector<Route>::const_iterator it = found.begin (); it != found.end (); it++)
+    {
+      routes.push_back (it->second);
+    }
+}
+
+template <typename T>
+uint32_t
+Ipv4RouteTrie<T>::GetNRoutes (void) const
+{
+  return m_nRoutes;
+}
+
+} // namespace ns3
+
+#endif /* IPV4_ROUTE_TRIE_H */
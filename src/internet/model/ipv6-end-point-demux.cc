@@ -21,6 +21,8 @@
 #include "ipv6-end-point-demux.h"
 #include "ipv6-end-point.h"
 #include "ns3/log.h"
+#include <algorithm>
+#include <iterator>
 
 namespace ns3 {
 
@@ -29,7 +31,8 @@ NS_LOG_COMPONENT_DEFINE ("Ipv6EndPointDemux");
 Ipv6EndPointDemux::Ipv6EndPointDemux ()
   : m_ephemeral (49152),
     m_portFirst (49152),
-    m_portLast (65535)
+    m_portLast (65535),
+    m_nextSeq (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -43,19 +46,108 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux ()
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_index.clear ();
+  m_info.clear ();
+  m_localPorts.clear ();
 }
 
-bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+bool Ipv6EndPointDemux::IndexKey::operator== (const IndexKey &other) const
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  return localPort == other.localPort
+         && peerPort == other.peerPort
+         && peerAddress == other.peerAddress;
+}
+
+size_t Ipv6EndPointDemux::IndexKeyHash::operator() (const IndexKey &key) const
+{
+  size_t hash = Ipv6AddressHash () (key.peerAddress);
+  return hash ^ ((static_cast<size_t> (key.localPort) << 16 | key.peerPort) * 0x9e3779b1);
+}
+
+Ipv6EndPointDemux::IndexKey Ipv6EndPointDemux::GetKey (uint16_t localPort, Ipv6Address peerAddress, uint16_t peerPort)
+{
+  IndexKey key;
+  key.localPort = localPort;
+  key.peerAddress = peerAddress;
+  key.peerPort = peerPort;
+  return key;
+}
+
+void Ipv6EndPointDemux::Insert (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  EndPointInfo info;
+  info.seq = m_nextSeq++;
+  info.key = GetKey (endPoint->GetLocalPort (), endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+  info.position = m_endPoints.insert (m_endPoints.end (), endPoint);
+  m_info[endPoint] = info;
+  AddLocalPort (info.key.localPort);
+  AddToIndex (endPoint, info);
+  endPoint->m_demux = this;
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+}
+
+void Ipv6EndPointDemux::AddToIndex (Ipv6EndPoint *endPoint, const EndPointInfo &info)
+{
+  /* a reindexed end point may be older than the ones already in its bucket */
+  IndexBucket &bucket = m_index[info.key];
+  IndexedEndPoint entry (info.seq, endPoint);
+  bucket.insert (std::upper_bound (bucket.begin (), bucket.end (), entry), entry);
+}
+
+void Ipv6EndPointDemux::RemoveFromIndex (Ipv6EndPoint *endPoint, const EndPointInfo &info)
+{
+  Index::iterator it = m_index.find (info.key);
+  NS_ASSERT (it != m_index.end ());
+  IndexBucket &bucket = it->second;
+  IndexBucket::iterator pos = std::lower_bound (bucket.begin (), bucket.end (),
+                                                IndexedEndPoint (info.seq, endPoint));
+  NS_ASSERT (pos != bucket.end () && pos->second == endPoint);
+  bucket.erase (pos);
+  if (bucket.empty ())
     {
-      if ((*i)->GetLocalPort  () == port)
+      m_index.erase (it);
+    }
+}
+
+void Ipv6EndPointDemux::AddLocalPort (uint16_t port)
+{
+  m_localPorts[port]++;
+}
+
+void Ipv6EndPointDemux::RemoveLocalPort (uint16_t port)
+{
+  std::unordered_map<uint16_t, uint32_t>::iterator it = m_localPorts.find (port);
+  NS_ASSERT (it != m_localPorts.end ());
+  if (--it->second == 0)
+    {
+      m_localPorts.erase (it);
+    }
+}
+
+void Ipv6EndPointDemux::Reindex (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  std::unordered_map<Ipv6EndPoint *, EndPointInfo>::iterator it = m_info.find (endPoint);
+  NS_ASSERT (it != m_info.end ());
+  IndexKey key = GetKey (endPoint->GetLocalPort (), endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+  if (!(key == it->second.key))
+    {
+      RemoveFromIndex (endPoint, it->second);
+      if (key.localPort != it->second.key.localPort)
         {
-          return true;
+          RemoveLocalPort (it->second.key.localPort);
+          AddLocalPort (key.localPort);
         }
+      it->second.key = key;
+      AddToIndex (endPoint, it->second);
     }
-  return false;
+}
+
+bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_localPorts.find (port) != m_localPorts.end ();
 }
 
 bool Ipv6EndPointDemux::LookupLocal (Ipv6Address addr, uint16_t port)
@@ -82,8 +174,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -97,8 +188,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -118,8 +208,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address, uint16_t port)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -127,45 +216,48 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address localAddress, uint16_t lo
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  Index::const_iterator it = m_index.find (GetKey (localPort, peerAddress, peerPort));
+  if (it != m_index.end ())
     {
-      if ((*i)->GetLocalPort () == localPort
-          && (*i)->GetLocalAddress () == localAddress
-          && (*i)->GetPeerPort () == peerPort
-          && (*i)->GetPeerAddress () == peerAddress)
+      for (IndexBucket::const_iterator i = it->second.begin (); i != it->second.end (); i++)
         {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
+          if (i->second->GetLocalAddress () == localAddress)
+            {
+              NS_LOG_WARN ("No way we can allocate this end-point.");
+              /* no way we can allocate this end-point. */
+              return 0;
+            }
         }
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
+  Insert (endPoint);
   return endPoint;
 }
 
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::unordered_map<Ipv6EndPoint *, EndPointInfo>::iterator it = m_info.find (endPoint);
+  if (it == m_info.end ())
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      return;
     }
+  RemoveFromIndex (endPoint, it->second);
+  RemoveLocalPort (it->second.key.localPort);
+  m_endPoints.erase (it->second.position);
+  m_info.erase (it);
+  delete endPoint;
 }
 
 /*
  * If we have an exact match, we return it.
  * Otherwise, if we find a generic match, we return it.
  * Otherwise, we return 0.
+ *
+ * Only the end points whose peer is the source of the packet or is
+ * unspecified can match: they are taken from the index, in allocation
+ * order, and the matching rules are applied to them.
  */
 Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint16_t dport,
                                                         Ipv6Address saddr, uint16_t sport,
@@ -179,9 +271,29 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
   EndPoints retval4; /* Exact match on all 4 */
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  IndexBucket candidates;
+  IndexKey exactKey = GetKey (dport, saddr, sport);
+  IndexKey wildKey = GetKey (dport, Ipv6Address::GetAny (), 0);
+  Index::const_iterator exact = m_index.find (exactKey);
+  Index::const_iterator wild = exactKey == wildKey ? m_index.end () : m_index.find (wildKey);
+  if (exact != m_index.end () && wild != m_index.end ())
+    {
+      std::merge (exact->second.begin (), exact->second.end (),
+                  wild->second.begin (), wild->second.end (),
+                  std::back_inserter (candidates));
+    }
+  else if (exact != m_index.end ())
+    {
+      candidates = exact->second;
+    }
+  else if (wild != m_index.end ())
+    {
+      candidates = wild->second;
+    }
+
+  for (IndexBucket::const_iterator i = candidates.begin (); i != candidates.end (); i++)
     {
-      Ipv6EndPoint* endP = *i;
+      Ipv6EndPoint* endP = i->second;
 
       NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
                                                  << " daddr=" << endP->GetLocalAddress ()
@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <list>
+#include <vector>
+#include <unordered_map>
 #include "ns3/ipv6-address.h"
 #include "ipv6-interface.h"
 
@@ -34,6 +36,11 @@ class Ipv6EndPoint;
  * \ingroup ipv6
  *
  * \brief Demultiplexer for end points.
+ *
+ * The end points are also indexed in a hash table by local port, peer
+ * address and peer port, so that Lookup () only examines the end points
+ * connected to the source of the packet and the ones with an unspecified
+ * peer, as Ipv4EndPointDemux does.
  */
 class Ipv6EndPointDemux
 {
@@ -147,6 +154,112 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief Key of the end point index.
+   */
+  struct IndexKey
+  {
+    uint16_t localPort;       //!< local port
+    Ipv6Address peerAddress;  //!< peer address
+    uint16_t peerPort;        //!< peer port
+
+    /**
+     * \brief Equality operator.
+     * \param other the key to compare with
+     * \returns true if the keys are equal
+     */
+    bool operator== (const IndexKey &other) const;
+  };
+
+  /**
+   * \brief Hash function of the index keys.
+   */
+  struct IndexKeyHash
+  {
+    /**
+     * \brief Hash a key.
+     * \param key the key
+     * \returns the hash of the key
+     */
+    size_t operator() (const IndexKey &key) const;
+  };
+
+  /**
+   * \brief An indexed end point, along with its allocation sequence number.
+   */
+  typedef std::pair<uint64_t, Ipv6EndPoint *> IndexedEndPoint;
+
+  /**
+   * \brief The end points with the same key, in allocation order.
+   */
+  typedef std::vector<IndexedEndPoint> IndexBucket;
+
+  /**
+   * \brief Container of the index.
+   */
+  typedef std::unordered_map<IndexKey, IndexBucket, IndexKeyHash> Index;
+
+  /**
+   * \brief Where an end point is stored in the demux.
+   */
+  struct EndPointInfo
+  {
+    uint64_t seq;         //!< allocation sequence number
+    IndexKey key;         //!< key of the end point in the index
+    EndPointsI position;  //!< position of the end point in the list
+  };
+
+  /**
+   * \brief Build the index key of a four-tuple.
+   * \param localPort local port
+   * \param peerAddress peer address
+   * \param peerPort peer port
+   * \return the key
+   */
+  static IndexKey GetKey (uint16_t localPort, Ipv6Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Add a newly allocated end point to the list and to the index.
+   * \param endPoint the end point
+   */
+  void Insert (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Add an end point to the bucket of its key.
+   * \param endPoint the end point
+   * \param info where the end point is stored
+   */
+  void AddToIndex (Ipv6EndPoint *endPoint, const EndPointInfo &info);
+
+  /**
+   * \brief Remove an end point from the bucket of its key.
+   * \param endPoint the end point
+   * \param info where the end point is stored
+   */
+  void RemoveFromIndex (Ipv6EndPoint *endPoint, const EndPointInfo &info);
+
+  /**
+   * \brief Count an end point bound to a local port.
+   * \param port the local port
+   */
+  void AddLocalPort (uint16_t port);
+
+  /**
+   * \brief Forget an end point bound to a local port.
+   * \param port the local port
+   */
+  void RemoveLocalPort (uint16_t port);
+
+  /**
+   * \brief Move an end point to the bucket of its new key, after its local
+   * port or its peer changed.  Called by Ipv6EndPoint::SetLocalPort and
+   * Ipv6EndPoint::SetPeer.
+   * \param endPoint the end point
+   */
+  void Reindex (Ipv6EndPoint *endPoint);
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -172,6 +285,26 @@ private:
    * \brief A list of IPv6 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The end points, by local port, peer address and peer port.
+   */
+  Index m_index;
+
+  /**
+   * \brief Where each end point is stored.
+   */
+  std::unordered_map<Ipv6EndPoint *, EndPointInfo> m_info;
+
+  /**
+   * \brief The number of end points bound to each local port.
+   */
+  std::unordered_map<uint16_t, uint32_t> m_localPorts;
+
+  /**
+   * \brief The sequence number of the next allocated end point.
+   */
+  uint64_t m_nextSeq;
 };
 
 } /* namespace ns3 */
@@ -66,6 +66,18 @@ void Ipv6QueueDiscItem::AddHeader (void)
   m_headerAdded = true;
 }
 
+Ptr<Packet>
+Ipv6QueueDiscItem::GetPacketWithHeader (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<Packet> p = GetPacket ()->Copy ();
+  if (!m_headerAdded)
+    {
+      p->AddHeader (m_header);
+    }
+  return p;
+}
+
 void
 Ipv6QueueDiscItem::Print (std::ostream& os) const
 {
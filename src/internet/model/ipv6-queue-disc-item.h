@@ -61,6 +61,12 @@ public:
    */
   virtual void AddHeader (void);
 
+  /**
+   * \brief Get a copy of the packet with the IPv6 header added
+   * \return a copy of the packet, including the header
+   */
+  virtual Ptr<Packet> GetPacketWithHeader (void) const;
+
   /**
    * \brief Print the item contents.
    * \param os output stream in which the data should be printed.
@@ -0,0 +1,211 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-dctcp.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-header.h"
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/trace-source-accessor.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpDctcp");
+NS_OBJECT_ENSURE_REGISTERED (TcpDctcp);
+
+TypeId
+TcpDctcp::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpDctcp")
+    .SetParent<TcpNewReno> ()
+    .AddConstructor<TcpDctcp> ()
+    .SetGroupName ("Internet")
+    .AddAttribute ("DctcpG",
+                   "Gain g of the moving average which estimates the fraction of "
+                   "marked bytes; Linux sets it with dctcp_shift_g, which is -log2 (g)",
+                   DoubleValue (0.0625),
+                   MakeDoubleAccessor (&TcpDctcp::m_g),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("DctcpAlphaOnInit",
+                   "Initial value of the estimate of the fraction of marked bytes",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&TcpDctcp::m_alpha),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddTraceSource ("CongestionEstimate",
+                     "Update of the estimate of the fraction of marked bytes",
+                     MakeTraceSourceAccessor (&TcpDctcp::m_traceCongestionEstimate),
+                     "ns3::TcpDctcp::CongestionEstimateTracedCallback")
+  ;
+  return tid;
+}
+
+TcpDctcp::TcpDctcp (void)
+  : TcpNewReno (),
+    m_ackedBytesEcn (0),
+    m_ackedBytesTotal (0),
+    m_nextSeq (0),
+    m_nextSeqFlag (false),
+    m_ceState (false),
+    m_delayedAckReserved (false),
+    m_alpha (1.0),
+    m_g (0.0625)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpDctcp::TcpDctcp (const TcpDctcp& sock)
+  : TcpNewReno (sock),
+    m_ackedBytesEcn (sock.m_ackedBytesEcn),
+    m_ackedBytesTotal (sock.m_ackedBytesTotal),
+    m_nextSeq (sock.m_nextSeq),
+    m_nextSeqFlag (sock.m_nextSeqFlag),
+    m_ceState (sock.m_ceState),
+    m_delayedAckReserved (sock.m_delayedAckReserved),
+    m_alpha (sock.m_alpha),
+    m_g (sock.m_g)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpDctcp::~TcpDctcp (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ptr<TcpCongestionOps>
+TcpDctcp::Fork (void)
+{
+  return CopyObject<TcpDctcp> (this);
+}
+
+std::string
+TcpDctcp::GetName () const
+{
+  return "TcpDctcp";
+}
+
+double
+TcpDctcp::GetAlpha (void) const
+{
+  return m_alpha;
+}
+
+uint32_t
+TcpDctcp::GetSsThresh (Ptr<const TcpSocketState> tcb,
+                       uint32_t bytesInFlight)
+{
+  NS_LOG_FUNCTION (this << tcb << bytesInFlight);
+
+  uint32_t ssThresh = static_cast<uint32_t> ((1 - m_alpha / 2.0) * tcb->m_cWnd);
+
+  NS_LOG_DEBUG ("alpha=" << m_alpha << " resulting ssThresh=" << ssThresh);
+
+  return std::max (ssThresh, 2 * tcb->m_segmentSize);
+}
+
+void
+TcpDctcp::PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                     const Time &rtt)
+{
+  NS_LOG_FUNCTION (this << tcb << segmentsAcked << rtt);
+
+  uint32_t bytesAcked = segmentsAcked * tcb->m_segmentSize;
+  m_ackedBytesTotal += bytesAcked;
+  if (tcb->m_ackHasEce)
+    {
+      m_ackedBytesEcn += bytesAcked;
+    }
+
+  if (!m_nextSeqFlag)
+    {
+      m_nextSeq = tcb->m_nextTxSequence;
+      m_nextSeqFlag = true;
+    }
+
+  if (tcb->m_lastAckedSeq >= m_nextSeq)
+    {
+      double fraction = 0.0;
+      if (m_ackedBytesTotal > 0)
+        {
+          fraction = static_cast<double> (m_ackedBytesEcn) / m_ackedBytesTotal;
+        }
+      m_alpha = (1.0 - m_g) * m_alpha + m_g * fraction;
+      NS_LOG_INFO (this << " bytesEcn " << m_ackedBytesEcn << " bytesTotal " <<
+                   m_ackedBytesTotal << " alpha " << m_alpha);
+      m_traceCongestionEstimate (m_ackedBytesTotal, m_ackedBytesEcn, m_alpha);
+
+      m_ackedBytesEcn = 0;
+      m_ackedBytesTotal = 0;
+      m_nextSeq = tcb->m_nextTxSequence;
+    }
+}
+
+void
+TcpDctcp::UpdateCeState (Ptr<TcpSocketState> tcb, bool ce)
+{
+  NS_LOG_FUNCTION (this << tcb << ce);
+
+  if (m_ceState != ce && m_delayedAckReserved)
+    {
+      // Acknowledge what was received so far with its own ECN state; the
+      // socket has not yet accounted the segment carrying the new codepoint.
+      NS_LOG_INFO (this << " CE state changed, sending an immediate ACK");
+      if (!tcb->m_sendEmptyPacketCallback.IsNull ())
+        {
+          tcb->m_sendEmptyPacketCallback (TcpHeader::ACK);
+        }
+      m_delayedAckReserved = false;
+    }
+
+  m_ceState = ce;
+  if (ce)
+    {
+      tcb->m_ecnState = TcpSocketState::ECN_CE_RCVD;
+    }
+  else if (tcb->m_ecnState == TcpSocketState::ECN_CE_RCVD
+           || tcb->m_ecnState == TcpSocketState::ECN_SENDING_ECE)
+    {
+      // Unlike RFC 3168, ECN-Echo is only set on the ACKs of marked segments
+      tcb->m_ecnState = TcpSocketState::ECN_IDLE;
+    }
+}
+
+void
+TcpDctcp::CwndEvent (Ptr<TcpSocketState> tcb,
+                     const TcpSocketState::TcpCAEvent_t event)
+{
+  NS_LOG_FUNCTION (this << tcb << event);
+
+  switch (event)
+    {
+    case TcpSocketState::CA_EVENT_ECN_IS_CE:
+      UpdateCeState (tcb, true);
+      break;
+    case TcpSocketState::CA_EVENT_ECN_NO_CE:
+      UpdateCeState (tcb, false);
+      break;
+    case TcpSocketState::CA_EVENT_DELAYED_ACK:
+      m_delayedAckReserved = true;
+      break;
+    case TcpSocketState::CA_EVENT_NON_DELAYED_ACK:
+      m_delayedAckReserved = false;
+      break;
+    default:
+      break;
+    }
+}
+
+} // namespace ns3
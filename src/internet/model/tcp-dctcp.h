@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCPDCTCP_H
+#define TCPDCTCP_H
+
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup congestionOps
+ *
+ * \brief An implementation of DCTCP (RFC 8257)
+ *
+ * DCTCP reacts to the extent of the congestion rather than to its mere
+ * presence. The sender keeps an estimate alpha of the fraction of bytes
+ * which were marked with CE by the network; once per window of data
+ * (roughly one RTT) the estimate is updated as
+ *
+ *         alpha = (1 - g) * alpha + g * F         (1)
+ *
+ * where F is the fraction of the bytes acknowledged in the last window
+ * which carried the ECN-Echo flag. When an ECN-Echo is received the
+ * congestion window is reduced, at most once per window, to
+ *
+ *         cwnd = cwnd * (1 - alpha / 2)           (2)
+ *
+ * The receiver must echo the CE codepoint of each segment as precisely
+ * as possible. When the codepoint of the received segments changes, and
+ * a delayed ACK is pending, an ACK carrying the previous ECN state is sent
+ * immediately, so that the ECN-Echo flag covers exactly the marked bytes.
+ *
+ * Window growth and loss recovery are the ones of NewReno.
+ *
+ * DCTCP needs ECN (attribute ns3::TcpSocketBase::UseEcn) to be enabled at
+ * both ends, and an AQM marking on the instantaneous queue length, such as
+ * RioQueueDisc with its KIn and KOut attributes set.
+ */
+class TcpDctcp : public TcpNewReno
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * Create an unbound tcp socket.
+   */
+  TcpDctcp (void);
+
+  /**
+   * \brief Copy constructor
+   * \param sock the object to copy
+   */
+  TcpDctcp (const TcpDctcp& sock);
+  virtual ~TcpDctcp (void);
+
+  virtual std::string GetName () const;
+
+  /**
+   * \brief Get slow start threshold following DCTCP principle (Equation 2)
+   *
+   * \param tcb internal congestion state
+   * \param bytesInFlight bytes in flight
+   *
+   * \return the slow start threshold value
+   */
+  virtual uint32_t GetSsThresh (Ptr<const TcpSocketState> tcb,
+                                uint32_t bytesInFlight);
+
+  /**
+   * \brief Account the acknowledged bytes and update alpha once per window
+   * (Equation 1)
+   *
+   * \param tcb internal congestion state
+   * \param segmentsAcked count of segments acked
+   * \param rtt last rtt
+   */
+  virtual void PktsAcked (Ptr<TcpSocketState> tcb, uint32_t segmentsAcked,
+                          const Time &rtt);
+
+  /**
+   * \brief Track the CE codepoint of the received segments and the
+   * delayed ACK state of the receiver
+   *
+   * \param tcb internal congestion state
+   * \param event the event which triggered this function
+   */
+  virtual void CwndEvent (Ptr<TcpSocketState> tcb,
+                          const TcpSocketState::TcpCAEvent_t event);
+
+  virtual Ptr<TcpCongestionOps> Fork ();
+
+  /**
+   * \returns the current estimate of the fraction of marked bytes
+   */
+  double GetAlpha (void) const;
+
+  /**
+   * TracedCallback signature for the congestion estimate update.
+   *
+   * \param [in] bytesAcked bytes acknowledged in the last window
+   * \param [in] bytesMarked bytes acknowledged with ECN-Echo in the last window
+   * \param [in] alpha the updated estimate
+   */
+  typedef void (* CongestionEstimateTracedCallback)(uint32_t bytesAcked,
+                                                    uint32_t bytesMarked,
+                                                    double alpha);
+
+private:
+  /**
+   * \brief Update the CE state of the receiver, sending an immediate ACK
+   * if the codepoint changed while a delayed ACK is pending
+   *
+   * \param tcb internal congestion state
+   * \param ce true if the segment being received carries CE
+   */
+  void UpdateCeState (Ptr<TcpSocketState> tcb, bool ce);
+
+  uint32_t m_ackedBytesEcn;        //!< Bytes acked with ECN-Echo in the current window
+  uint32_t m_ackedBytesTotal;      //!< Bytes acked in the current window
+  SequenceNumber32 m_nextSeq;      //!< End of the current observation window
+  bool m_nextSeqFlag;              //!< m_nextSeq has been initialized
+  bool m_ceState;                  //!< CE codepoint of the last received segment
+  bool m_delayedAckReserved;       //!< A delayed ACK is pending at the receiver
+  double m_alpha;                  //!< Estimate of the fraction of marked bytes
+  double m_g;                      //!< Estimation gain
+  TracedCallback<uint32_t, uint32_t, double> m_traceCongestionEstimate; //!< Trace of the alpha updates
+};
+
+} // namespace ns3
+
+#endif // TCPDCTCP_H
@@ -18,7 +18,10 @@
  * Author: Adrian Sai-wah Tam <adrian.sw.tam@gmail.com>
  */
 
+#include <algorithm>
+#include <cstring>
 #include "ns3/packet.h"
+#include "ns3/boolean.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 #include "tcp-rx-buffer.h"
@@ -36,6 +39,13 @@ TcpRxBuffer::GetTypeId (void)
     .SetParent<Object> ()
     .SetGroupName ("Internet")
     .AddConstructor<TcpRxBuffer> ()
+    .AddAttribute ("RingBuffer",
+                   "Coalesce the received data into a contiguous byte ring "
+                   "instead of keeping one packet per segment",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpRxBuffer::SetRingBuffer,
+                                        &TcpRxBuffer::IsRingBuffer),
+                   MakeBooleanChecker ())
     .AddTraceSource ("NextRxSequence",
                      "Next sequence number expected (RCV.NXT)",
                      MakeTraceSourceAccessor (&TcpRxBuffer::m_nextRxSeq),
@@ -52,7 +62,8 @@ TcpRxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpRxBuffer::TcpRxBuffer (uint32_t n)
-  : m_nextRxSeq (n), m_gotFin (false), m_size (0), m_maxBuffer (32768), m_availBytes (0)
+  : m_nextRxSeq (n), m_gotFin (false), m_size (0), m_maxBuffer (32768), m_availBytes (0),
+    m_ringMode (false), m_ringHead (0), m_ringSeq (n)
 {
 }
 
@@ -82,6 +93,10 @@ void
 TcpRxBuffer::SetMaxBufferSize (uint32_t s)
 {
   m_maxBuffer = s;
+  if (m_ringMode && !m_ring.empty ())
+    {
+      ResizeRing (s);
+    }
 }
 
 uint32_t
@@ -114,6 +129,10 @@ TcpRxBuffer::MaxRxSequence (void) const
     { // No data allowed beyond FIN
       return m_finSeq;
     }
+  else if (m_ringMode && m_availBytes > 0)
+    { // No data allowed beyond Rx window allowed
+      return m_ringSeq + SequenceNumber32 (m_maxBuffer);
+    }
   else if (m_data.size () && m_nextRxSeq > m_data.begin ()->first)
     { // No data allowed beyond Rx window allowed
       return m_data.begin ()->first + SequenceNumber32 (m_maxBuffer);
@@ -137,11 +156,34 @@ TcpRxBuffer::Finished (void)
   return (m_gotFin && m_finSeq < m_nextRxSeq);
 }
 
+void
+TcpRxBuffer::SetRingBuffer (bool enable)
+{
+  NS_LOG_FUNCTION (this << enable);
+  NS_ASSERT_MSG (m_size == 0, "Cannot change the buffer mode while data is buffered");
+  m_ringMode = enable;
+  if (!enable)
+    {
+      std::vector<uint8_t> ().swap (m_ring);
+    }
+}
+
+bool
+TcpRxBuffer::IsRingBuffer (void) const
+{
+  return m_ringMode;
+}
+
 bool
 TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
 {
   NS_LOG_FUNCTION (this << p << tcph);
 
+  if (m_ringMode)
+    {
+      return AddToRing (p, tcph);
+    }
+
   uint32_t pktSize = p->GetSize ();
   SequenceNumber32 headSeq = tcph.GetSequenceNumber ();
   SequenceNumber32 tailSeq = headSeq + SequenceNumber32 (pktSize);
@@ -338,8 +380,8 @@ TcpRxBuffer::ClearSackList (const SequenceNumber32 &seq)
 {
   NS_LOG_FUNCTION (this << seq);
 
-  TcpOptionSack::SackList::iterator it;
-  for (it = m_sackList.begin (); it != m_sackList.end (); ++it)
+  TcpOptionSack::SackList::iterator it = m_sackList.begin ();
+  while (it != m_sackList.end ())
     {
       TcpOptionSack::SackBlock block = *it;
       NS_ASSERT (block.first < block.second);
@@ -348,6 +390,10 @@ TcpRxBuffer::ClearSackList (const SequenceNumber32 &seq)
         {
           it = m_sackList.erase (it);
         }
+      else
+        {
+          ++it;
+        }
     }
 }
 
@@ -362,6 +408,11 @@ TcpRxBuffer::Extract (uint32_t maxSize)
 {
   NS_LOG_FUNCTION (this << maxSize);
 
+  if (m_ringMode)
+    {
+      return ExtractFromRing (maxSize);
+    }
+
   uint32_t extractSize = std::min (maxSize, m_availBytes);
   NS_LOG_LOGIC ("Requested to extract " << extractSize << " bytes from TcpRxBuffer of size=" << m_size);
   if (extractSize == 0) return 0;  // No contiguous block to return
@@ -402,4 +453,199 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   return outPkt;
 }
 
+
+bool
+TcpRxBuffer::AddToRing (Ptr<Packet> p, TcpHeader const& tcph)
+{
+  NS_LOG_FUNCTION (this << p << tcph);
+
+  uint32_t pktSize = p->GetSize ();
+  SequenceNumber32 headSeq = tcph.GetSequenceNumber ();
+  SequenceNumber32 tailSeq = headSeq + SequenceNumber32 (pktSize);
+  NS_LOG_LOGIC ("Add pkt " << p << " len=" << pktSize << " seq=" << headSeq
+                           << ", when NextRxSeq=" << m_nextRxSeq << ", buffsize=" << m_size);
+
+  if (m_size == 0)
+    { // Nothing buffered: anchor the ring to the next expected byte
+      m_ringSeq = m_nextRxSeq;
+      m_ringHead = 0;
+    }
+  if (m_ring.empty ())
+    {
+      m_ring.resize (m_maxBuffer);
+    }
+
+  // Trim packet to fit Rx window specification
+  if (headSeq < m_nextRxSeq) headSeq = m_nextRxSeq;
+  SequenceNumber32 maxSeq = m_ringSeq + SequenceNumber32 (m_maxBuffer);
+  if (maxSeq < tailSeq) tailSeq = maxSeq;
+  if (tailSeq < headSeq) headSeq = tailSeq;
+
+  // Remove overlapped bytes from packet, starting from the last block
+  // which begins at or before its head
+  BlockIterator i = m_oooBlocks.upper_bound (headSeq);
+  if (i != m_oooBlocks.begin ())
+    {
+      --i;
+    }
+  while (i != m_oooBlocks.end () && i->first <= tailSeq)
+    {
+      if (i->second > headSeq)
+        {
+          if (i->first > headSeq && i->second < tailSeq)
+            { // Existing block is embedded fully in the new packet
+              m_size -= i->second - i->first;
+              m_oooBlocks.erase (i++);
+              continue;
+            }
+          if (i->first <= headSeq)
+            { // Incoming head is overlapped
+              headSeq = i->second;
+            }
+          if (i->second >= tailSeq)
+            { // Incoming tail is overlapped
+              tailSeq = i->first;
+            }
+        }
+      ++i;
+    }
+  if (headSeq >= tailSeq)
+    {
+      NS_LOG_LOGIC ("Nothing to buffer");
+      return false; // Nothing to buffer anyway
+    }
+
+  uint32_t length = tailSeq - headSeq;
+  CopyToRing (p, headSeq - tcph.GetSequenceNumber (), headSeq, length);
+  m_size += length;
+  NS_LOG_LOGIC ("Buffered " << length << " bytes of seqno=" << headSeq);
+
+  if (headSeq > m_nextRxSeq)
+    {
+      // Generate a new SACK block
+      UpdateSackList (headSeq, tailSeq);
+
+      // Store the block, merging it with the adjacent ones
+      SequenceNumber32 blockHead = headSeq;
+      BlockIterator next = m_oooBlocks.lower_bound (headSeq);
+      if (next != m_oooBlocks.end () && next->first == tailSeq)
+        {
+          tailSeq = next->second;
+          m_oooBlocks.erase (next++);
+        }
+      if (next != m_oooBlocks.begin ())
+        {
+          BlockIterator prev = next;
+          --prev;
+          if (prev->second == headSeq)
+            {
+              blockHead = prev->first;
+            }
+        }
+      m_oooBlocks[blockHead] = tailSeq;
+    }
+  else
+    {
+      // In-order data, which may fill the hole before the first block
+      m_nextRxSeq = tailSeq;
+      m_availBytes += length;
+      ClearSackList (m_nextRxSeq);
+      BlockIterator first = m_oooBlocks.begin ();
+      if (first != m_oooBlocks.end () && first->first == m_nextRxSeq)
+        {
+          m_availBytes += first->second - first->first;
+          m_nextRxSeq = first->second;
+          m_oooBlocks.erase (first);
+          ClearSackList (m_nextRxSeq);
+        }
+    }
+
+  NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
+  if (m_gotFin && m_nextRxSeq == m_finSeq)
+    { // Account for the FIN packet
+      ++m_nextRxSeq;
+    };
+  return true;
+}
+
+Ptr<Packet>
+TcpRxBuffer::ExtractFromRing (uint32_t maxSize)
+{
+  NS_LOG_FUNCTION (this << maxSize);
+
+  uint32_t extractSize = std::min (maxSize, m_availBytes);
+  NS_LOG_LOGIC ("Requested to extract " << extractSize << " bytes from TcpRxBuffer of size=" << m_size);
+  if (extractSize == 0)
+    {
+      NS_LOG_LOGIC ("Nothing extracted.");
+      return 0;
+    }
+
+  uint32_t capacity = m_ring.size ();
+  uint32_t first = std::min (extractSize, capacity - m_ringHead);
+  Ptr<Packet> outPkt = Create<Packet> (&m_ring[m_ringHead], first);
+  if (first < extractSize)
+    { // The data wraps around the end of the ring
+      outPkt->AddAtEnd (Create<Packet> (&m_ring[0], extractSize - first));
+    }
+  m_ringHead = (m_ringHead + extractSize) % capacity;
+  m_ringSeq += extractSize;
+  m_size -= extractSize;
+  m_availBytes -= extractSize;
+
+  NS_LOG_LOGIC ("Extracted " << outPkt->GetSize ( ) << " bytes, bufsize=" << m_size
+                             << ", num blocks in buffer=" << m_oooBlocks.size ());
+  return outPkt;
+}
+
+void
+TcpRxBuffer::CopyToRing (Ptr<const Packet> p, uint32_t offset,
+                         const SequenceNumber32 &seq, uint32_t length)
+{
+  NS_LOG_FUNCTION (this << p << offset << seq << length);
+
+  uint32_t capacity = m_ring.size ();
+  NS_ASSERT (seq >= m_ringSeq && seq - m_ringSeq + length <= capacity);
+  uint32_t index = (m_ringHead + (seq - m_ringSeq)) % capacity;
+  Ptr<const Packet> data = p;
+  if (offset > 0 || length < p->GetSize ())
+    {
+      data = p->CreateFragment (offset, length);
+    }
+  uint32_t first = std::min (length, capacity - index);
+  if (first == length)
+    {
+      data->CopyData (&m_ring[index], length);
+    }
+  else
+    { // The data wraps around the end of the ring
+      data->CreateFragment (0, first)->CopyData (&m_ring[index], first);
+      data->CreateFragment (first, length - first)->CopyData (&m_ring[0], length - first);
+    }
+}
+
+void
+TcpRxBuffer::ResizeRing (uint32_t s)
+{
+  NS_LOG_FUNCTION (this << s);
+
+  uint32_t used = 0;
+  if (m_size > 0)
+    {
+      used = m_oooBlocks.empty () ? m_availBytes : m_oooBlocks.rbegin ()->second - m_ringSeq;
+    }
+  std::vector<uint8_t> ring (std::max (s, used));
+  uint32_t first = std::min (used, static_cast<uint32_t> (m_ring.size ()) - m_ringHead);
+  if (first > 0)
+    {
+      std::memcpy (&ring[0], &m_ring[m_ringHead], first);
+    }
+  if (used > first)
+    {
+      std::memcpy (&ring[first], &m_ring[0], used - first);
+    }
+  m_ring.swap (ring);
+  m_ringHead = 0;
+}
+
 } //namepsace ns3
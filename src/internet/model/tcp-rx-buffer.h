@@ -22,6 +22,7 @@
 #define TCP_RX_BUFFER_H
 
 #include <map>
+#include <vector>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/sequence-number.h"
@@ -69,6 +70,18 @@ class Packet;
  *
  * \see GetSackList
  * \see UpdateSackList
+ *
+ * Ring buffer mode
+ * ----------------
+ *
+ * By default every received segment is kept as a separate Packet, and
+ * Extract concatenates them. When the attribute RingBuffer is set, the
+ * payload bytes are instead copied into a contiguous ring of MaxBufferSize
+ * bytes, at the offset given by their sequence number. In-order data is then
+ * just a range of the ring, and only the out-of-order blocks are tracked, as
+ * an interval set; the cost of Add and Extract does not depend anymore on the
+ * number of segments in the buffer. Since only the bytes are stored, the
+ * packets returned by Extract do not carry the tags of the received segments.
  */
 class TcpRxBuffer : public Object
 {
@@ -136,6 +149,20 @@ public:
    */
   bool Finished (void);
 
+  /**
+   * \brief Enable or disable the ring buffer mode
+   *
+   * The mode can be changed only while the buffer is empty.
+   *
+   * \param enable true to store the data in a contiguous byte ring
+   */
+  void SetRingBuffer (bool enable);
+  /**
+   * \brief Check if the ring buffer mode is enabled
+   * \returns true if the data is stored in a contiguous byte ring
+   */
+  bool IsRingBuffer (void) const;
+
   /**
    * Insert a packet into the buffer and update the availBytes counter to
    * reflect the number of bytes ready to send to the application. This
@@ -209,6 +236,40 @@ private:
    */
   void ClearSackList (const SequenceNumber32 &seq);
 
+  /**
+   * \brief Insert a packet into the ring, in ring buffer mode
+   * \param p packet
+   * \param tcph packet's TCP header
+   * \return True when success, false otherwise.
+   */
+  bool AddToRing (Ptr<Packet> p, TcpHeader const& tcph);
+
+  /**
+   * \brief Extract in-order data from the ring, in ring buffer mode
+   * \param maxSize maximum number of bytes to extract
+   * \returns a packet
+   */
+  Ptr<Packet> ExtractFromRing (uint32_t maxSize);
+
+  /**
+   * \brief Copy a part of a packet into the ring
+   * \param p the packet
+   * \param offset offset of the first byte to copy in the packet
+   * \param seq sequence number of the first byte to copy
+   * \param length number of bytes to copy
+   */
+  void CopyToRing (Ptr<const Packet> p, uint32_t offset,
+                   const SequenceNumber32 &seq, uint32_t length);
+
+  /**
+   * \brief Change the capacity of the ring, keeping the data stored
+   *
+   * The ring is never made smaller than the data it holds.
+   *
+   * \param s the new capacity
+   */
+  void ResizeRing (uint32_t s);
+
   TcpOptionSack::SackList m_sackList; //!< Sack list (updated constantly)
 
   /// container for data stored in the buffer
@@ -220,6 +281,14 @@ private:
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
   std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+
+  /// out-of-order blocks stored in the ring, from head to tail sequence
+  typedef std::map<SequenceNumber32, SequenceNumber32>::iterator BlockIterator;
+  bool m_ringMode;                           //!< Store the data in m_ring instead of m_data
+  std::vector<uint8_t> m_ring;               //!< Ring of data bytes, allocated on first use
+  uint32_t m_ringHead;                       //!< Index in m_ring of the byte at m_ringSeq
+  SequenceNumber32 m_ringSeq;                //!< Seqnum of the first byte not yet extracted
+  std::map<SequenceNumber32, SequenceNumber32> m_oooBlocks; //!< Out-of-order blocks in the ring
 };
 
 } //namepsace ns3
@@ -51,6 +51,7 @@
 #include "tcp-option-ts.h"
 #include "tcp-option-sack-permitted.h"
 #include "tcp-option-sack.h"
+#include "gso-tag.h"
 #include "rtt-estimator.h"
 #include "tcp-congestion-ops.h"
 
@@ -135,6 +136,32 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_limitedTx),
                    MakeBooleanChecker ())
+    .AddAttribute ("UseEcn", "Negotiate Explicit Congestion Notification (RFC 3168)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_useEcn),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Pacing", "Spread the transmissions over the RTT",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_pacing),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxPacingRate", "Upper bound of the pacing rate",
+                   DataRateValue (DataRate ("4Gb/s")),
+                   MakeDataRateAccessor (&TcpSocketBase::m_maxPacingRate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("PacingSsRatio", "Pacing rate in slow start, in percent of cWnd/RTT",
+                   UintegerValue (200),
+                   MakeUintegerAccessor (&TcpSocketBase::m_pacingSsRatio),
+                   MakeUintegerChecker<uint16_t> (1))
+    .AddAttribute ("PacingCaRatio", "Pacing rate in congestion avoidance, in percent of cWnd/RTT",
+                   UintegerValue (120),
+                   MakeUintegerAccessor (&TcpSocketBase::m_pacingCaRatio),
+                   MakeUintegerChecker<uint16_t> (1))
+    .AddAttribute ("GsoMaxSegments",
+                   "Maximum number of segments handed down to IPv4 at once, as a "
+                   "super-segment split at the device (1 disables GSO)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&TcpSocketBase::m_gsoMaxSegments),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddTraceSource ("RTO",
                      "Retransmission timeout",
                      MakeTraceSourceAccessor (&TcpSocketBase::m_rto),
@@ -159,6 +186,10 @@ TcpSocketBase::GetTypeId (void)
                      "TCP Congestion machine state",
                      MakeTraceSourceAccessor (&TcpSocketBase::m_congStateTrace),
                      "ns3::TcpSocketState::TcpCongStatesTracedValueCallback")
+    .AddTraceSource ("EcnState",
+                     "TCP ECN machine state",
+                     MakeTraceSourceAccessor (&TcpSocketBase::m_ecnStateTrace),
+                     "ns3::TcpSocketState::EcnStatesTracedValueCallback")
     .AddTraceSource ("AdvWND",
                      "Advertised Window Size",
                      MakeTraceSourceAccessor (&TcpSocketBase::m_advWnd),
@@ -225,6 +256,10 @@ TcpSocketState::GetTypeId (void)
                      "TCP Congestion machine state",
                      MakeTraceSourceAccessor (&TcpSocketState::m_congState),
                      "ns3::TracedValue::TcpCongStatesTracedValueCallback")
+    .AddTraceSource ("EcnState",
+                     "TCP ECN machine state",
+                     MakeTraceSourceAccessor (&TcpSocketState::m_ecnState),
+                     "ns3::TcpSocketState::EcnStatesTracedValueCallback")
     .AddTraceSource ("HighestSequence",
                      "Highest sequence number received from peer",
                      MakeTraceSourceAccessor (&TcpSocketState::m_highTxMark),
@@ -246,11 +281,14 @@ TcpSocketState::TcpSocketState (void)
     m_segmentSize (0),
     m_lastAckedSeq (0),
     m_congState (CA_OPEN),
+    m_ecnState (ECN_DISABLED),
+    m_ackHasEce (false),
     m_highTxMark (0),
     // Change m_nextTxSequence for non-zero initial sequence number
     m_nextTxSequence (0),
     m_rcvTimestampValue (0),
-    m_rcvTimestampEchoReply (0)
+    m_rcvTimestampEchoReply (0),
+    m_pacingRate (0)
 {
 }
 
@@ -263,10 +301,13 @@ TcpSocketState::TcpSocketState (const TcpSocketState &other)
     m_segmentSize (other.m_segmentSize),
     m_lastAckedSeq (other.m_lastAckedSeq),
     m_congState (other.m_congState),
+    m_ecnState (other.m_ecnState),
+    m_ackHasEce (other.m_ackHasEce),
     m_highTxMark (other.m_highTxMark),
     m_nextTxSequence (other.m_nextTxSequence),
     m_rcvTimestampValue (other.m_rcvTimestampValue),
-    m_rcvTimestampEchoReply (other.m_rcvTimestampEchoReply)
+    m_rcvTimestampEchoReply (other.m_rcvTimestampEchoReply),
+    m_pacingRate (other.m_pacingRate)
 {
 }
 
@@ -276,6 +317,13 @@ TcpSocketState::TcpCongStateName[TcpSocketState::CA_LAST_STATE] =
   "CA_OPEN", "CA_DISORDER", "CA_CWR", "CA_RECOVERY", "CA_LOSS"
 };
 
+const char* const
+TcpSocketState::EcnStateName[TcpSocketState::ECN_LAST_STATE] =
+{
+  "ECN_DISABLED", "ECN_IDLE", "ECN_CE_RCVD", "ECN_SENDING_ECE", "ECN_ECE_RCVD",
+  "ECN_CWR_SENT"
+};
+
 TcpSocketBase::TcpSocketBase (void)
   : TcpSocket (),
     m_retxEvent (),
@@ -331,6 +379,14 @@ TcpSocketBase::TcpSocketBase (void)
     m_recover (0),
     m_retxThresh (3),
     m_limitedTx (false),
+    m_useEcn (false),
+    m_ecnCESeq (0),
+    m_ecnCWRSeq (0),
+    m_pacing (false),
+    m_pacingSsRatio (200),
+    m_pacingCaRatio (120),
+    m_pacingEvent (),
+    m_gsoMaxSegments (1),
     m_congestionControl (0),
     m_isFirstPartialAck (true)
 {
@@ -353,6 +409,12 @@ TcpSocketBase::TcpSocketBase (void)
                                           MakeCallback (&TcpSocketBase::UpdateCongState, this));
   NS_ASSERT (ok == true);
 
+  ok = m_tcb->TraceConnectWithoutContext ("EcnState",
+                                          MakeCallback (&TcpSocketBase::UpdateEcnState, this));
+  NS_ASSERT (ok == true);
+
+  m_tcb->m_sendEmptyPacketCallback = MakeCallback (&TcpSocketBase::SendEmptyPacket, this);
+
   ok = m_tcb->TraceConnectWithoutContext ("NextTxSequence",
                                           MakeCallback (&TcpSocketBase::UpdateNextTxSequence, this));
   NS_ASSERT (ok == true);
@@ -407,6 +469,14 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_recover (sock.m_recover),
     m_retxThresh (sock.m_retxThresh),
     m_limitedTx (sock.m_limitedTx),
+    m_useEcn (sock.m_useEcn),
+    m_ecnCESeq (sock.m_ecnCESeq),
+    m_ecnCWRSeq (sock.m_ecnCWRSeq),
+    m_pacing (sock.m_pacing),
+    m_maxPacingRate (sock.m_maxPacingRate),
+    m_pacingSsRatio (sock.m_pacingSsRatio),
+    m_pacingCaRatio (sock.m_pacingCaRatio),
+    m_gsoMaxSegments (sock.m_gsoMaxSegments),
     m_isFirstPartialAck (sock.m_isFirstPartialAck),
     m_txTrace (sock.m_txTrace),
     m_rxTrace (sock.m_rxTrace)
@@ -448,6 +518,12 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
                                           MakeCallback (&TcpSocketBase::UpdateCongState, this));
   NS_ASSERT (ok == true);
 
+  ok = m_tcb->TraceConnectWithoutContext ("EcnState",
+                                          MakeCallback (&TcpSocketBase::UpdateEcnState, this));
+  NS_ASSERT (ok == true);
+
+  m_tcb->m_sendEmptyPacketCallback = MakeCallback (&TcpSocketBase::SendEmptyPacket, this);
+
   ok = m_tcb->TraceConnectWithoutContext ("NextTxSequence",
                                           MakeCallback (&TcpSocketBase::UpdateNextTxSequence, this));
   NS_ASSERT (ok == true);
@@ -1161,6 +1237,7 @@ TcpSocketBase::ForwardUp (Ptr<Packet> packet, Ipv4Header header, uint16_t port,
   Address toAddress = InetSocketAddress (header.GetDestination (),
                                          m_endPoint->GetLocalPort ());
 
+  ProcessEcn (packet, header.GetEcn ());
   DoForwardUp (packet, fromAddress, toAddress);
 }
 
@@ -1178,9 +1255,61 @@ TcpSocketBase::ForwardUp6 (Ptr<Packet> packet, Ipv6Header header, uint16_t port,
   Address toAddress = Inet6SocketAddress (header.GetDestinationAddress (),
                                           m_endPoint6->GetLocalPort ());
 
+  ProcessEcn (packet, header.GetEcn ());
   DoForwardUp (packet, fromAddress, toAddress);
 }
 
+void
+TcpSocketBase::ProcessEcn (Ptr<const Packet> packet, uint8_t ecn)
+{
+  NS_LOG_FUNCTION (this << packet << static_cast<uint32_t> (ecn));
+
+  if (m_tcb->m_ecnState == TcpSocketState::ECN_DISABLED)
+    {
+      return;
+    }
+
+  TcpHeader tcpHeader;
+  uint32_t headerSize = packet->PeekHeader (tcpHeader);
+  if (headerSize == 0 || (tcpHeader.GetFlags () & TcpHeader::SYN))
+    {
+      return;
+    }
+
+  // The sender has reduced its window: stop echoing (RFC 3168, section 6.1.3)
+  if ((tcpHeader.GetFlags () & TcpHeader::CWR)
+      && m_tcb->m_ecnState == TcpSocketState::ECN_SENDING_ECE)
+    {
+      NS_LOG_INFO ("Received CWR, ECN_SENDING_ECE -> ECN_IDLE");
+      m_tcb->m_ecnState = TcpSocketState::ECN_IDLE;
+    }
+
+  // Pure ACKs are never ECN-capable
+  if (packet->GetSize () == headerSize)
+    {
+      return;
+    }
+
+  // The congestion control is notified first, so that it can acknowledge
+  // the previous segments according to the ECN state they were received in
+  if (ecn == Ipv4Header::ECN_CE)
+    {
+      m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_ECN_IS_CE);
+      if (tcpHeader.GetSequenceNumber () > m_ecnCESeq)
+        {
+          NS_LOG_INFO ("Received CE on seq " << tcpHeader.GetSequenceNumber () <<
+                       ", " << TcpSocketState::EcnStateName[m_tcb->m_ecnState] <<
+                       " -> ECN_CE_RCVD");
+          m_ecnCESeq = tcpHeader.GetSequenceNumber ();
+          m_tcb->m_ecnState = TcpSocketState::ECN_CE_RCVD;
+        }
+    }
+  else if (ecn != Ipv4Header::ECN_NotECT)
+    {
+      m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_ECN_NO_CE);
+    }
+}
+
 void
 TcpSocketBase::ForwardIcmp (Ipv4Address icmpSource, uint8_t icmpTtl,
                             uint8_t icmpType, uint8_t icmpCode,
@@ -1279,6 +1408,24 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
           m_timestampEnabled = false;
         }
 
+      // ECN negotiation, RFC 3168 section 6.1.1: a ECN-setup SYN carries
+      // ECE and CWR, a ECN-setup SYN-ACK carries only ECE
+      uint8_t ecnFlags = tcpHeader.GetFlags () & (TcpHeader::ECE | TcpHeader::CWR);
+      if (m_useEcn
+          && ((!(tcpHeader.GetFlags () & TcpHeader::ACK)
+               && ecnFlags == (TcpHeader::ECE | TcpHeader::CWR))
+              || ((tcpHeader.GetFlags () & TcpHeader::ACK)
+                  && ecnFlags == TcpHeader::ECE)))
+        {
+          NS_LOG_INFO ("ECN negotiated, " <<
+                       TcpSocketState::EcnStateName[m_tcb->m_ecnState] << " -> ECN_IDLE");
+          m_tcb->m_ecnState = TcpSocketState::ECN_IDLE;
+        }
+      else
+        {
+          m_tcb->m_ecnState = TcpSocketState::ECN_DISABLED;
+        }
+
       // Initialize cWnd and ssThresh
       m_tcb->m_cWnd = GetInitialCwnd () * GetSegSize ();
       m_tcb->m_ssThresh = GetInitialSSThresh ();
@@ -1363,7 +1510,7 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
       break;
     case CLOSED:
       // Send RST if the incoming packet is not a RST
-      if ((tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG)) != TcpHeader::RST)
+      if ((tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG | TcpHeader::CWR | TcpHeader::ECE)) != TcpHeader::RST)
         { // Since m_endPoint is not configured yet, we cannot use SendRST here
           TcpHeader h;
           Ptr<Packet> p = Create<Packet> ();
@@ -1416,8 +1563,9 @@ TcpSocketBase::ProcessEstablished (Ptr<Packet> packet, const TcpHeader& tcpHeade
 {
   NS_LOG_FUNCTION (this << tcpHeader);
 
-  // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  // Extract the flags. PSH and URG are not honoured, ECE and CWR
+  // are handled by the ECN state machine.
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG | TcpHeader::CWR | TcpHeader::ECE);
 
   // Different flags are different events
   if (tcpflags == TcpHeader::ACK)
@@ -1554,13 +1702,20 @@ TcpSocketBase::EnterRecovery ()
   // (4.1) RecoveryPoint = HighData
   m_recover = m_tcb->m_highTxMark;
 
+  // The window was already reduced in this window of data in response to
+  // an ECN-Echo: it must not be reduced twice (RFC 3168, section 6.1.2)
+  bool reduceWindow = m_tcb->m_congState != TcpSocketState::CA_CWR;
+
   m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_RECOVERY);
   m_tcb->m_congState = TcpSocketState::CA_RECOVERY;
 
   // (4.2) ssthresh = cwnd = (FlightSize / 2)
-  m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (m_tcb,
-                                                        BytesInFlight ());
-  m_tcb->m_cWnd = m_tcb->m_ssThresh;
+  if (reduceWindow)
+    {
+      m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (m_tcb,
+                                                            BytesInFlight ());
+      m_tcb->m_cWnd = m_tcb->m_ssThresh;
+    }
 
   NS_LOG_INFO (m_dupAckCount << " dupack. Enter fast recovery mode." <<
                "Reset cwnd to " << m_tcb->m_cWnd << ", ssthresh to " <<
@@ -1573,6 +1728,32 @@ TcpSocketBase::EnterRecovery ()
   // the step C is done after the ProcessAck function (SendPendingData)
 }
 
+void
+TcpSocketBase::EnterCwr ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_tcb->m_congState == TcpSocketState::CA_OPEN
+             || m_tcb->m_congState == TcpSocketState::CA_DISORDER);
+
+  NS_LOG_DEBUG (TcpSocketState::TcpCongStateName[m_tcb->m_congState] <<
+                " -> CA_CWR");
+
+  // The reduction lasts for one window of data
+  m_recover = m_tcb->m_highTxMark;
+
+  m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_CWR);
+  m_tcb->m_congState = TcpSocketState::CA_CWR;
+
+  // React as to a loss, without retransmitting anything
+  m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (m_tcb,
+                                                        BytesInFlight ());
+  m_tcb->m_cWnd = m_tcb->m_ssThresh;
+  m_tcb->m_ecnState = TcpSocketState::ECN_ECE_RCVD;
+
+  NS_LOG_INFO ("ECN-Echo received. Reset cwnd to " << m_tcb->m_cWnd <<
+               ", ssthresh to " << m_tcb->m_ssThresh << " until seqnum " << m_recover);
+}
+
 void
 TcpSocketBase::DupAck ()
 {
@@ -1594,12 +1775,16 @@ TcpSocketBase::DupAck ()
       NS_LOG_DEBUG ("OPEN -> DISORDER");
     }
 
-  if (m_tcb->m_congState == TcpSocketState::CA_DISORDER)
+  // In CA_CWR the window has been reduced, but a loss must be repaired anyway
+  if (m_tcb->m_congState == TcpSocketState::CA_DISORDER
+      || m_tcb->m_congState == TcpSocketState::CA_CWR)
     {
       // RFC 6675, Section 5, continuing:
       // ... and take the following steps:
       // (1) If DupAcks >= DupThresh, go to step (4).
-      if ((m_dupAckCount == m_retxThresh) && (m_highRxAckMark >= m_recover))
+      if ((m_dupAckCount == m_retxThresh)
+          && (m_highRxAckMark >= m_recover
+              || m_tcb->m_congState == TcpSocketState::CA_CWR))
         {
           EnterRecovery ();
           NS_ASSERT (m_tcb->m_congState == TcpSocketState::CA_RECOVERY);
@@ -1656,6 +1841,32 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
 
   SequenceNumber32 ackNumber = tcpHeader.GetAckNumber ();
 
+  // RFC 3168, section 6.1.2: react to an ECN-Echo at most once per window
+  // of data. Until the segment carrying CWR is acknowledged, the receiver
+  // may still be echoing the previous congestion indication.
+  m_tcb->m_ackHasEce = false;
+  if (m_tcb->m_ecnState != TcpSocketState::ECN_DISABLED
+      && !(tcpHeader.GetFlags () & TcpHeader::SYN))
+    {
+      m_tcb->m_ackHasEce = (tcpHeader.GetFlags () & TcpHeader::ECE) != 0;
+      bool cwrAcked = m_tcb->m_ecnState == TcpSocketState::ECN_CWR_SENT
+        && ackNumber > m_ecnCWRSeq;
+      if (tcpHeader.GetFlags () & TcpHeader::ECE)
+        {
+          if ((m_tcb->m_ecnState == TcpSocketState::ECN_IDLE || cwrAcked)
+              && (m_tcb->m_congState == TcpSocketState::CA_OPEN
+                  || m_tcb->m_congState == TcpSocketState::CA_DISORDER))
+            {
+              EnterCwr ();
+            }
+        }
+      else if (cwrAcked)
+        {
+          NS_LOG_INFO ("CWR acknowledged, ECN_CWR_SENT -> ECN_IDLE");
+          m_tcb->m_ecnState = TcpSocketState::ECN_IDLE;
+        }
+    }
+
   // RFC 6675 Section 5: 2nd, 3rd paragraph and point (A), (B) implementation
   // are inside the function ProcessAck
   ProcessAck (ackNumber, scoreboardUpdated);
@@ -1827,6 +2038,26 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
               NS_LOG_DEBUG (segsAcked << " segments acked in CA_DISORDER, ack of " <<
                             ackNumber << " exiting CA_DISORDER -> CA_OPEN");
             }
+          // The window stays reduced until the data outstanding when the
+          // ECN-Echo was received has been acknowledged
+          else if (m_tcb->m_congState == TcpSocketState::CA_CWR)
+            {
+              m_congestionControl->PktsAcked (m_tcb, segsAcked, m_lastRtt);
+
+              if (ackNumber >= m_recover)
+                {
+                  m_congestionControl->CongestionStateSet (m_tcb, TcpSocketState::CA_OPEN);
+                  m_tcb->m_congState = TcpSocketState::CA_OPEN;
+                  m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_COMPLETE_CWR);
+                  NS_LOG_DEBUG (segsAcked << " segments acked in CA_CWR, ack of " <<
+                                ackNumber << ", exiting CA_CWR -> CA_OPEN");
+                }
+              else
+                {
+                  NS_LOG_DEBUG (segsAcked << " segments acked in CA_CWR, ack of " <<
+                                ackNumber << ", cWnd is not increased");
+                }
+            }
           // RFC 6675, Section 5:
           // Once a TCP is in the loss recovery phase, the following procedure
           // MUST be used for each arriving ACK:
@@ -1869,7 +2100,10 @@ TcpSocketBase::ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpd
                             ackNumber << ", exiting CA_LOSS -> CA_OPEN");
             }
 
-          m_congestionControl->IncreaseWindow (m_tcb, segsAcked);
+          if (m_tcb->m_congState != TcpSocketState::CA_CWR)
+            {
+              m_congestionControl->IncreaseWindow (m_tcb, segsAcked);
+            }
           m_dupAckCount = 0;
 
           NS_LOG_LOGIC ("Congestion control called: " <<
@@ -1888,8 +2122,9 @@ TcpSocketBase::ProcessListen (Ptr<Packet> packet, const TcpHeader& tcpHeader,
 {
   NS_LOG_FUNCTION (this << tcpHeader);
 
-  // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  // Extract the flags. PSH and URG are not honoured, ECE and CWR
+  // are handled by the ECN state machine.
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG | TcpHeader::CWR | TcpHeader::ECE);
 
   // Fork a socket if received a SYN. Do nothing otherwise.
   // C.f.: the LISTEN part in tcp_v4_do_rcv() in tcp_ipv4.c in Linux kernel
@@ -1917,8 +2152,9 @@ TcpSocketBase::ProcessSynSent (Ptr<Packet> packet, const TcpHeader& tcpHeader)
 {
   NS_LOG_FUNCTION (this << tcpHeader);
 
-  // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  // Extract the flags. PSH and URG are not honoured, ECE and CWR
+  // are handled by the ECN state machine.
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG | TcpHeader::CWR | TcpHeader::ECE);
 
   if (tcpflags == 0)
     { // Bare data, accept it and move to ESTABLISHED state. This is not a normal behaviour. Remove this?
@@ -1979,8 +2215,9 @@ TcpSocketBase::ProcessSynRcvd (Ptr<Packet> packet, const TcpHeader& tcpHeader,
 {
   NS_LOG_FUNCTION (this << tcpHeader);
 
-  // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  // Extract the flags. PSH and URG are not honoured, ECE and CWR
+  // are handled by the ECN state machine.
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG | TcpHeader::CWR | TcpHeader::ECE);
 
   if (tcpflags == 0
       || (tcpflags == TcpHeader::ACK
@@ -2070,8 +2307,9 @@ TcpSocketBase::ProcessWait (Ptr<Packet> packet, const TcpHeader& tcpHeader)
 {
   NS_LOG_FUNCTION (this << tcpHeader);
 
-  // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  // Extract the flags. PSH and URG are not honoured, ECE and CWR
+  // are handled by the ECN state machine.
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG | TcpHeader::CWR | TcpHeader::ECE);
 
   if (packet->GetSize () > 0 && tcpflags != TcpHeader::ACK)
     { // Bare data, accept it
@@ -2142,8 +2380,9 @@ TcpSocketBase::ProcessClosing (Ptr<Packet> packet, const TcpHeader& tcpHeader)
 {
   NS_LOG_FUNCTION (this << tcpHeader);
 
-  // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  // Extract the flags. PSH and URG are not honoured, ECE and CWR
+  // are handled by the ECN state machine.
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG | TcpHeader::CWR | TcpHeader::ECE);
 
   if (tcpflags == TcpHeader::ACK)
     {
@@ -2174,8 +2413,9 @@ TcpSocketBase::ProcessLastAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
 {
   NS_LOG_FUNCTION (this << tcpHeader);
 
-  // Extract the flags. PSH and URG are not honoured.
-  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG);
+  // Extract the flags. PSH and URG are not honoured, ECE and CWR
+  // are handled by the ECN state machine.
+  uint8_t tcpflags = tcpHeader.GetFlags () & ~(TcpHeader::PSH | TcpHeader::URG | TcpHeader::CWR | TcpHeader::ECE);
 
   if (tcpflags == 0)
     {
@@ -2312,6 +2552,44 @@ TcpSocketBase::Destroy6 (void)
 }
 
 /* Send an empty packet with specified TCP flags */
+uint8_t
+TcpSocketBase::AddEcnFlags (uint8_t flags)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (flags));
+
+  if (flags & TcpHeader::RST)
+    {
+      return flags;
+    }
+
+  if (flags & TcpHeader::SYN)
+    {
+      // ECN-setup SYN and SYN-ACK, RFC 3168 section 6.1.1
+      if (!(flags & TcpHeader::ACK) && m_useEcn)
+        {
+          flags |= TcpHeader::ECE | TcpHeader::CWR;
+        }
+      else if ((flags & TcpHeader::ACK)
+               && m_tcb->m_ecnState == TcpSocketState::ECN_IDLE)
+        {
+          flags |= TcpHeader::ECE;
+        }
+      return flags;
+    }
+
+  // Keep echoing the congestion indication until a CWR is received
+  if ((flags & TcpHeader::ACK)
+      && (m_tcb->m_ecnState == TcpSocketState::ECN_CE_RCVD
+          || m_tcb->m_ecnState == TcpSocketState::ECN_SENDING_ECE))
+    {
+      NS_LOG_INFO (TcpSocketState::EcnStateName[m_tcb->m_ecnState] <<
+                   " -> ECN_SENDING_ECE");
+      m_tcb->m_ecnState = TcpSocketState::ECN_SENDING_ECE;
+      flags |= TcpHeader::ECE;
+    }
+  return flags;
+}
+
 void
 TcpSocketBase::SendEmptyPacket (uint8_t flags)
 {
@@ -2376,6 +2654,8 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
       ++s;
     }
 
+  flags = AddEcnFlags (flags);
+
   header.SetFlags (flags);
   header.SetSequenceNumber (s);
   header.SetAckNumber (m_rxBuffer->NextRxSequence ());
@@ -2441,6 +2721,7 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
     { // If sending an ACK, cancel the delay ACK as well
       m_delAckEvent.Cancel ();
       m_delAckCount = 0;
+      m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_NON_DELAYED_ACK);
       if (m_highTxAck < header.GetAckNumber ())
         {
           m_highTxAck = header.GetAckNumber ();
@@ -2632,7 +2913,20 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       isRetransmission = true;
     }
 
-  Ptr<Packet> p = m_txBuffer->CopyFromSequence (maxSize, seq);
+  // A super-segment is taken from the buffer one segment at a time, so that
+  // each segment is a sent item of its own: the receiver sees MSS-sized
+  // segments, and its SACK blocks must match the items of the scoreboard.
+  Ptr<Packet> p = m_txBuffer->CopyFromSequence (std::min (maxSize, m_tcb->m_segmentSize), seq);
+  while (p->GetSize () < maxSize)
+    {
+      uint32_t size = std::min (maxSize - p->GetSize (), m_tcb->m_segmentSize);
+      Ptr<Packet> segment = m_txBuffer->CopyFromSequence (size, seq + p->GetSize ());
+      if (segment->GetSize () == 0)
+        {
+          break;
+        }
+      p->AddAtEnd (segment);
+    }
   uint32_t sz = p->GetSize (); // Size of packet
   uint8_t flags = withAck ? TcpHeader::ACK : 0;
   uint32_t remainingData = m_txBuffer->SizeFromSequence (seq + SequenceNumber32 (sz));
@@ -2641,25 +2935,31 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
     {
       m_delAckEvent.Cancel ();
       m_delAckCount = 0;
+      m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_NON_DELAYED_ACK);
     }
 
+  // RFC 3168, section 6.1.5: retransmitted segments are not ECN-capable
+  bool isEct = m_tcb->m_ecnState != TcpSocketState::ECN_DISABLED && !isRetransmission;
+
   /*
    * Add tags for each socket option.
    * Note that currently the socket adds both IPv4 tag and IPv6 tag
    * if both options are set. Once the packet got to layer three, only
    * the corresponding tags will be read.
    */
-  if (GetIpTos ())
+  uint8_t tos = isEct ? (GetIpTos () & 0xfc) | Ipv4Header::ECN_ECT0 : GetIpTos ();
+  if (tos)
     {
       SocketIpTosTag ipTosTag;
-      ipTosTag.SetTos (GetIpTos ());
+      ipTosTag.SetTos (tos);
       p->AddPacketTag (ipTosTag);
     }
 
-  if (IsManualIpv6Tclass ())
+  if (IsManualIpv6Tclass () || isEct)
     {
+      uint8_t tclass = isEct ? (GetIpv6Tclass () & 0xfc) | Ipv6Header::ECN_ECT0 : GetIpv6Tclass ();
       SocketIpv6TclassTag ipTclassTag;
-      ipTclassTag.SetTclass (GetIpv6Tclass ());
+      ipTclassTag.SetTclass (tclass);
       p->AddPacketTag (ipTclassTag);
     }
 
@@ -2685,6 +2985,25 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
       p->ReplacePacketTag (priorityTag);
     }
 
+  if (sz > m_tcb->m_segmentSize)
+    {
+      // GSO super-segment, split at the device
+      GsoTag gsoTag;
+      gsoTag.SetSegmentSize (m_tcb->m_segmentSize);
+      p->AddPacketTag (gsoTag);
+    }
+
+  // Signal the window reduction on the first new segment after an
+  // ECN-Echo (RFC 3168, section 6.1.2)
+  if (isEct && m_tcb->m_ecnState == TcpSocketState::ECN_ECE_RCVD)
+    {
+      NS_LOG_INFO ("Sending CWR on seq " << seq << ", ECN_ECE_RCVD -> ECN_CWR_SENT");
+      flags |= TcpHeader::CWR;
+      m_ecnCWRSeq = seq;
+      m_tcb->m_ecnState = TcpSocketState::ECN_CWR_SENT;
+    }
+  flags = AddEcnFlags (flags);
+
   if (m_closeOnEmpty && (remainingData == 0))
     {
       flags |= TcpHeader::FIN;
@@ -2798,6 +3117,16 @@ TcpSocketBase::SendPendingData (bool withAck)
       return false; // Is this the right way to handle this condition?
     }
 
+  if (m_pacing)
+    {
+      if (m_pacingEvent.IsRunning ())
+        {
+          NS_LOG_LOGIC ("Pacing: wait for the next transmission slot");
+          return 0;
+        }
+      UpdatePacingRate ();
+    }
+
   uint32_t nPacketsSent = 0;
   uint32_t availableWindow = AvailableWindow ();
 
@@ -2848,6 +3177,11 @@ TcpSocketBase::SendPendingData (bool withAck)
             }
 
           uint32_t s = std::min (availableWindow, m_tcb->m_segmentSize);
+          if (m_gsoMaxSegments > 1 && m_endPoint != 0 && next >= m_tcb->m_highTxMark)
+            {
+              // new data may be sent as a super-segment
+              s = GetGsoSize (availableWindow, availableData);
+            }
 
           // (C.2) If any of the data octets sent in (C.1) are below HighData,
           //       HighRxt MUST be set to the highest sequence number of the
@@ -2878,6 +3212,17 @@ TcpSocketBase::SendPendingData (bool withAck)
                         " size " << sz);
 
           ++nPacketsSent;
+
+          if (m_pacing)
+            {
+              // Hold the next transmission for the time this one takes at
+              // the pacing rate
+              Time gap = m_tcb->m_pacingRate.CalculateBytesTxTime (sz);
+              NS_LOG_LOGIC ("Pacing: next transmission in " << gap.As (Time::US));
+              m_pacingEvent = Simulator::Schedule (gap, &TcpSocketBase::SendPendingData,
+                                                   this, m_connected);
+              break;
+            }
         }
 
       // (C.4) The estimate of the amount of data outstanding in the
@@ -2898,6 +3243,46 @@ TcpSocketBase::SendPendingData (bool withAck)
   return nPacketsSent;
 }
 
+void
+TcpSocketBase::UpdatePacingRate (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Time srtt = m_rtt->GetEstimate ();
+  if (m_rtt->GetNSamples () == 0 || srtt.IsZero ())
+    {
+      // Nothing to pace against yet
+      m_tcb->m_pacingRate = m_maxPacingRate;
+      return;
+    }
+  uint16_t ratio = m_tcb->m_cWnd < m_tcb->m_ssThresh / 2 ? m_pacingSsRatio : m_pacingCaRatio;
+  double rate = m_tcb->m_cWnd * 8.0 * ratio / 100 / srtt.GetSeconds ();
+  m_tcb->m_pacingRate = std::min (DataRate (static_cast<uint64_t> (rate)), m_maxPacingRate);
+  NS_LOG_LOGIC ("Pacing rate " << m_tcb->m_pacingRate);
+}
+
+uint32_t
+TcpSocketBase::GetGsoSize (uint32_t availableWindow, uint32_t availableData) const
+{
+  NS_LOG_FUNCTION (this << availableWindow << availableData);
+
+  uint32_t segmentSize = m_tcb->m_segmentSize;
+  // the IPv4 total length must fit in 16 bits, with IP and TCP headers
+  uint32_t maxSegments = std::min (m_gsoMaxSegments, (65535U - 20 - 60) / segmentSize);
+  uint32_t size = std::min (std::min (availableWindow, availableData),
+                            std::max (maxSegments, 1U) * segmentSize);
+  if (size <= segmentSize)
+    {
+      return std::min (availableWindow, segmentSize);
+    }
+  uint32_t tail = size % segmentSize;
+  if (tail > 0 && (size < availableData || !m_noDelay))
+    {
+      size -= tail;
+    }
+  return size;
+}
+
 uint32_t
 TcpSocketBase::UnAckDataCount () const
 {
@@ -3034,12 +3419,16 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
           m_delAckCount = 0;
           SendEmptyPacket (TcpHeader::ACK);
         }
-      else if (m_delAckEvent.IsExpired ())
+      else
         {
-          m_delAckEvent = Simulator::Schedule (m_delAckTimeout,
-                                               &TcpSocketBase::DelAckTimeout, this);
-          NS_LOG_LOGIC (this << " scheduled delayed ACK at " <<
-                        (Simulator::Now () + Simulator::GetDelayLeft (m_delAckEvent)).GetSeconds ());
+          if (m_delAckEvent.IsExpired ())
+            {
+              m_delAckEvent = Simulator::Schedule (m_delAckTimeout,
+                                                   &TcpSocketBase::DelAckTimeout, this);
+              NS_LOG_LOGIC (this << " scheduled delayed ACK at " <<
+                            (Simulator::Now () + Simulator::GetDelayLeft (m_delAckEvent)).GetSeconds ());
+            }
+          m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_DELAYED_ACK);
         }
     }
 }
@@ -3373,6 +3762,7 @@ TcpSocketBase::CancelAllTimers ()
   m_lastAckEvent.Cancel ();
   m_timewaitEvent.Cancel ();
   m_sendPendingDataEvent.Cancel ();
+  m_pacingEvent.Cancel ();
 }
 
 /* Move TCP to Time_Wait state and schedule a transition to Closed state */
@@ -3820,6 +4210,13 @@ TcpSocketBase::UpdateCongState (TcpSocketState::TcpCongState_t oldValue,
   m_congStateTrace (oldValue, newValue);
 }
 
+void
+TcpSocketBase::UpdateEcnState (TcpSocketState::EcnState_t oldValue,
+                               TcpSocketState::EcnState_t newValue)
+{
+  m_ecnStateTrace (oldValue, newValue);
+}
+
 void
 TcpSocketBase::UpdateNextTxSequence (SequenceNumber32 oldValue,
                                      SequenceNumber32 newValue)
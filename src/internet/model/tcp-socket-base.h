@@ -33,6 +33,7 @@
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-interface.h"
 #include "ns3/event-id.h"
+#include "ns3/data-rate.h"
 #include "tcp-tx-buffer.h"
 #include "tcp-rx-buffer.h"
 #include "rtt-estimator.h"
@@ -129,7 +130,7 @@ public:
                     *  we see some SACKs or dupacks. It is split of "Open" */
     CA_CWR,       /**< cWnd was reduced due to some Congestion Notification event.
                     *  It can be ECN, ICMP source quench, local device congestion.
-                    *  Not used in NS-3 right now. */
+                    *  In ns-3 it is entered when an ECN-Echo is received. */
     CA_RECOVERY,  /**< CWND was reduced, we are fast-retransmitting. */
     CA_LOSS,      /**< CWND was reduced due to RTO timeout or SACK reneging. */
     CA_LAST_STATE /**< Used only in debug messages */
@@ -150,6 +151,55 @@ public:
    */
   static const char* const TcpCongStateName[TcpSocketState::CA_LAST_STATE];
 
+  /**
+   * \brief Definition of the ECN state machine (RFC 3168)
+   *
+   * The same socket plays the role of data sender and data receiver, so
+   * the states of both sides are kept in a single variable, as in Linux.
+   */
+  typedef enum
+  {
+    ECN_DISABLED = 0, /**< ECN was not negotiated for this connection */
+    ECN_IDLE,         /**< ECN is in use, no congestion has been signalled */
+    ECN_CE_RCVD,      /**< Receiver got a CE-marked segment */
+    ECN_SENDING_ECE,  /**< Receiver sets ECE on every ACK until it receives CWR */
+    ECN_ECE_RCVD,     /**< Sender got an ECE and reduced its window */
+    ECN_CWR_SENT,     /**< Sender set CWR on the first new data segment */
+    ECN_LAST_STATE    /**< Used only in debug messages */
+  } EcnState_t;
+
+  /**
+   * \ingroup tcp
+   * TracedValue Callback signature for EcnState_t
+   *
+   * \param [in] oldValue original value of the traced variable
+   * \param [in] newValue new value of the traced variable
+   */
+  typedef void (* EcnStatesTracedValueCallback)(const EcnState_t oldValue,
+                                                const EcnState_t newValue);
+
+  /**
+   * \brief Literal names of ECN states for use in log messages
+   */
+  static const char* const EcnStateName[TcpSocketState::ECN_LAST_STATE];
+
+  /**
+   * \brief Congestion avoidance events notified to TcpCongestionOps::CwndEvent
+   *
+   * Taken from enum tcp_ca_event in Linux.
+   */
+  typedef enum
+  {
+    CA_EVENT_TX_START,        /**< first transmit when no packets in flight */
+    CA_EVENT_CWND_RESTART,    /**< congestion window restart */
+    CA_EVENT_COMPLETE_CWR,    /**< end of congestion recovery */
+    CA_EVENT_LOSS,            /**< loss timeout */
+    CA_EVENT_ECN_NO_CE,       /**< ECT set, but not CE marked */
+    CA_EVENT_ECN_IS_CE,       /**< received CE marked IP packet */
+    CA_EVENT_DELAYED_ACK,     /**< delayed ack is sent */
+    CA_EVENT_NON_DELAYED_ACK  /**< non-delayed ack is sent */
+  } TcpCAEvent_t;
+
   // Congestion control
   TracedValue<uint32_t>  m_cWnd;            //!< Congestion window
   TracedValue<uint32_t>  m_ssThresh;        //!< Slow start threshold
@@ -161,12 +211,26 @@ public:
   SequenceNumber32       m_lastAckedSeq;    //!< Last sequence ACKed
 
   TracedValue<TcpCongState_t> m_congState;    //!< State in the Congestion state machine
+  TracedValue<EcnState_t> m_ecnState;         //!< State in the ECN state machine
+  bool                   m_ackHasEce;         //!< The ACK being processed carries ECN-Echo
   TracedValue<SequenceNumber32> m_highTxMark; //!< Highest seqno ever sent, regardless of ReTx
   TracedValue<SequenceNumber32> m_nextTxSequence; //!< Next seqnum to be sent (SND.NXT), ReTx pushes it back
 
   uint32_t               m_rcvTimestampValue;     //!< Receiver Timestamp value 
   uint32_t               m_rcvTimestampEchoReply; //!< Sender Timestamp echoed by the receiver
 
+  DataRate               m_pacingRate;      //!< Current pacing rate, when pacing is enabled
+
+  /**
+   * \brief Send an empty segment (e.g. an ACK) with the given flags
+   *
+   * Set by the owning socket, it allows congestion controls such as DCTCP
+   * to acknowledge the data received so far before the ECN codepoint of
+   * the segment being processed is taken into account. It is not copied
+   * with the TcpSocketState.
+   */
+  Callback<void, uint8_t> m_sendEmptyPacketCallback;
+
   /**
    * \brief Get cwnd in segments rather than bytes
    *
@@ -219,12 +283,27 @@ public:
  *
  * - CA_OPEN
  * - CA_DISORDER
+ * - CA_CWR
  * - CA_RECOVERY
  * - CA_LOSS
  *
- * Another one (CA_CWR) is present but not used. For more information, see
+ * CA_CWR is entered only when ECN is in use. For more information, see
  * the TcpCongState_t documentation.
  *
+ * Explicit Congestion Notification
+ * ---------------------------
+ *
+ * When the attribute UseEcn is true, ECN is negotiated during the
+ * three-way handshake as described in RFC 3168. If both ends agree, data
+ * segments (but not pure ACKs, nor retransmissions) are sent with the
+ * ECT(0) codepoint. A receiver which gets a CE-marked segment sets the
+ * ECE flag on its ACKs until a segment with the CWR flag arrives. The
+ * sender reacts to the first ECE of a window by reducing the window
+ * through TcpCongestionOps::GetSsThresh, entering CA_CWR and setting CWR
+ * on the next new data segment. Congestion control algorithms are told
+ * about the ECN codepoint of every data segment received, and about the
+ * end of the window reduction, through TcpCongestionOps::CwndEvent.
+ *
  * Congestion control interface
  * ---------------------------
  *
@@ -405,6 +484,11 @@ public:
    */
   TracedCallback<TcpSocketState::TcpCongState_t, TcpSocketState::TcpCongState_t> m_congStateTrace;
 
+  /**
+   * \brief Callback pointer for ECN state trace chaining
+   */
+  TracedCallback<TcpSocketState::EcnState_t, TcpSocketState::EcnState_t> m_ecnStateTrace;
+
   /**
    * \brief Callback pointer for high tx mark chaining
    */
@@ -437,6 +521,14 @@ public:
   void UpdateCongState (TcpSocketState::TcpCongState_t oldValue,
                         TcpSocketState::TcpCongState_t newValue);
 
+  /**
+   * \brief Callback function to hook to TcpSocketState ECN state
+   * \param oldValue old ECN state value
+   * \param newValue new ECN state value
+   */
+  void UpdateEcnState (TcpSocketState::EcnState_t oldValue,
+                       TcpSocketState::EcnState_t newValue);
+
   /**
    * \brief Callback function to hook to TcpSocketState high tx mark
    * \param oldValue old high tx mark
@@ -612,6 +704,30 @@ protected:
   virtual void DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
                             const Address &toAddress);
 
+  /**
+   * \brief Process the ECN codepoint of an incoming segment (RFC 3168).
+   *
+   * Called by ForwardUp{,6}() before DoForwardUp, as the codepoint is
+   * carried in the IP header. It updates the receiver side of the ECN
+   * state machine and notifies the congestion control of CE and ECT
+   * data segments through TcpCongestionOps::CwndEvent.
+   *
+   * \param packet the incoming packet, starting with the TCP header
+   * \param ecn the ECN codepoint of the IP header
+   */
+  void ProcessEcn (Ptr<const Packet> packet, uint8_t ecn);
+
+  /**
+   * \brief Add the ECN flags (ECE, CWR) required by the ECN state machine.
+   *
+   * Takes care of the ECN-setup SYN and SYN-ACK, and of the ECN-Echo set
+   * on every ACK after a CE-marked segment has been received.
+   *
+   * \param flags the flags of the segment about to be sent
+   * \returns the flags, with ECE and CWR added where needed
+   */
+  uint8_t AddEcnFlags (uint8_t flags);
+
   /**
    * \brief Called by the L3 protocol when it received an ICMP packet to pass on to TCP.
    *
@@ -644,6 +760,28 @@ protected:
    */
   uint32_t SendPendingData (bool withAck = false);
 
+  /**
+   * \brief Update the pacing rate from the congestion window and the RTT
+   *
+   * As in Linux, the rate is a ratio of cWnd/SRTT, larger in slow start
+   * to let the window grow, bounded by the MaxPacingRate attribute.
+   */
+  void UpdatePacingRate (void);
+
+  /**
+   * \brief Get the size of the next segment to send, when GSO is enabled
+   *
+   * The super-segment is made of whole segments, except at the end of the
+   * data when the Nagle algorithm would not hold the last one back, so that
+   * it is split at the device into the segments which would have been sent
+   * without GSO.
+   *
+   * \param availableWindow the available window
+   * \param availableData the data available from the sequence to send
+   * \returns the number of bytes to send
+   */
+  uint32_t GetGsoSize (uint32_t availableWindow, uint32_t availableData) const;
+
   /**
    * \brief Extract at most maxSize bytes from the TxBuffer at sequence seq, add the
    *        TCP header, and send to TcpL4Protocol
@@ -925,6 +1063,12 @@ protected:
    */
   void EnterRecovery ();
 
+  /**
+   * \brief Enter the CA_CWR state upon the reception of an ECN-Echo,
+   * and reduce the window once (RFC 3168, section 6.1.2)
+   */
+  void EnterCwr ();
+
   /**
    * \brief An RTO event happened
    */
@@ -1145,6 +1289,19 @@ protected:
   uint32_t               m_retxThresh;   //!< Fast Retransmit threshold
   bool                   m_limitedTx;    //!< perform limited transmit
 
+  // Explicit Congestion Notification (RFC 3168)
+  bool                   m_useEcn;       //!< Negotiate ECN during the handshake
+  SequenceNumber32       m_ecnCESeq;     //!< Highest sequence number received with CE
+  SequenceNumber32       m_ecnCWRSeq;    //!< Sequence number of the last segment sent with CWR
+
+  // Pacing and generic segmentation offload
+  bool                   m_pacing;         //!< Pace the transmissions over the RTT
+  DataRate               m_maxPacingRate;  //!< Upper bound of the pacing rate
+  uint16_t               m_pacingSsRatio;  //!< Pacing rate in slow start, in percent of cWnd/RTT
+  uint16_t               m_pacingCaRatio;  //!< Pacing rate in congestion avoidance, in percent of cWnd/RTT
+  EventId                m_pacingEvent;    //!< Transmissions are held until it expires
+  uint32_t               m_gsoMaxSegments; //!< Maximum number of segments in a GSO super-segment
+
   // Transmission Control Block
   Ptr<TcpSocketState>    m_tcb;               //!< Congestion control informations
   Ptr<TcpCongestionOps>  m_congestionControl; //!< Congestion control
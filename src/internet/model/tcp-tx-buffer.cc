@@ -112,7 +112,9 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n)
+  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n),
+    m_sackedOut (0), m_notLostOut (0), m_lostBoundary (n), m_cleanBelow (0),
+    m_rtxBelow (0)
 {
 }
 
@@ -179,7 +181,7 @@ TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
 
   // if you change the head with data already sent, something bad will happen
   NS_ASSERT (m_sentList.size () == 0);
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  ScoreboardClear ();
 }
 
 bool
@@ -249,7 +251,9 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
       // already sent this block completely
       outItem = GetTransmittedSegment (s, seq);
       NS_ASSERT (outItem != 0);
+      ScoreboardRemove (outItem, seq);
       outItem->m_retrans = true;
+      ScoreboardAdd (outItem, seq);
 
       NS_LOG_DEBUG ("Retransmitting [" << seq << ";" << seq + s << "|" << s <<
                     "] from " << *this);
@@ -284,7 +288,12 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
       return CopyFromSequence (numBytes, seq);
     }
 
-  outItem->m_lost = false;
+  if (outItem->m_lost)
+    {
+      ScoreboardRemove (outItem, seq);
+      outItem->m_lost = false;
+      ScoreboardAdd (outItem, seq);
+    }
   outItem->m_lastSent = Simulator::Now ();
   Ptr<Packet> toRet = outItem->m_packet->Copy ();
 
@@ -311,7 +320,9 @@ TcpTxBuffer::GetNewSegment (uint32_t numBytes)
   NS_ASSERT (it != m_appList.end ());
 
   m_appList.erase (it);
-  m_sentList.insert (m_sentList.end (), item);
+  PacketList::iterator sentIt = m_sentList.insert (m_sentList.end (), item);
+  m_sentIndex[startOfAppList] = sentIt;
+  ScoreboardAdd (item, startOfAppList);
   m_sentSize += item->m_packet->GetSize ();
 
   return item;
@@ -324,42 +335,191 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   NS_ASSERT (seq >= m_firstByteSeq);
   NS_ASSERT (numBytes <= m_sentSize);
 
+  // Only the items overlapping the requested block can be fragmented or
+  // merged: take them out of the SentList (and of the scoreboard), so that
+  // GetPacketFromList does not need to walk the list from the head.
+  SentIndex::iterator idx = m_sentIndex.upper_bound (seq);
+  NS_ASSERT (idx != m_sentIndex.begin ());
+  --idx;
+
+  SequenceNumber32 beginOfRange = idx->first;
+  SequenceNumber32 endOfRange = beginOfRange;
+  PacketList::iterator first = idx->second;
+  PacketList::iterator last = first;
+  while (last != m_sentList.end () && endOfRange < seq + numBytes)
+    {
+      ScoreboardRemove (*last, endOfRange);
+      m_sentIndex.erase (endOfRange);
+      endOfRange += (*last)->m_packet->GetSize ();
+      ++last;
+    }
+
+  PacketList range;
+  range.splice (range.begin (), m_sentList, first, last);
+
   bool listEdited = false;
+  TcpTxItem *item = GetPacketFromList (range, beginOfRange, numBytes, seq, &listEdited);
 
-  TcpTxItem *item = GetPacketFromList (m_sentList, m_firstByteSeq, numBytes, seq, &listEdited);
+  (void) listEdited;
 
-  if (listEdited && m_highestSack.second >= m_firstByteSeq)
+  // Put the items back; the iterators stay valid after the splice
+  for (PacketList::iterator it = range.begin (); it != range.end (); ++it)
     {
-      m_highestSack = GetHighestSacked ();
+      m_sentIndex[beginOfRange] = it;
+      ScoreboardAdd (*it, beginOfRange);
+      beginOfRange += (*it)->m_packet->GetSize ();
     }
+  m_sentList.splice (last, range);
 
   return item;
 }
 
-std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
+SequenceNumber32
 TcpTxBuffer::GetHighestSacked () const
 {
   NS_LOG_FUNCTION (this);
 
-  PacketList::const_iterator it;
-  std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32> ret;
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
+  if (m_sackedSeqs.empty ())
+    {
+      return m_firstByteSeq;
+    }
 
-  ret = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  SequenceNumber32 highest = *m_sackedSeqs.rbegin ();
+  return highest + GetSentItem (highest)->m_packet->GetSize ();
+}
 
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+TcpTxItem*
+TcpTxBuffer::GetSentItem (const SequenceNumber32 &seq) const
+{
+  SentIndex::const_iterator idx = m_sentIndex.find (seq);
+  NS_ASSERT (idx != m_sentIndex.end ());
+  return *(idx->second);
+}
+
+void
+TcpTxBuffer::ScoreboardAdd (const TcpTxItem *item, const SequenceNumber32 &seq)
+{
+  uint32_t size = item->m_packet->GetSize ();
+
+  if (item->m_sacked)
+    {
+      m_sackedOut += size;
+      m_sackedSeqs.insert (seq);
+      return;
+    }
+
+  m_unsackedSeqs.insert (seq);
+  if (!item->m_lost)
+    {
+      m_notLostOut += size;
+      if (seq < m_lostBoundary)
+        {
+          (item->m_retrans ? m_rtxBelow : m_cleanBelow) += size;
+        }
+    }
+  if (!item->m_retrans)
+    {
+      m_rtxCandidates.insert (seq);
+      if (item->m_lost)
+        {
+          m_lostCandidates.insert (seq);
+        }
+    }
+}
+
+void
+TcpTxBuffer::ScoreboardRemove (const TcpTxItem *item, const SequenceNumber32 &seq)
+{
+  uint32_t size = item->m_packet->GetSize ();
+
+  if (item->m_sacked)
+    {
+      m_sackedOut -= size;
+      m_sackedSeqs.erase (seq);
+      return;
+    }
+
+  m_unsackedSeqs.erase (seq);
+  if (!item->m_lost)
     {
-      const TcpTxItem *item = *it;
-      if (item->m_sacked)
+      m_notLostOut -= size;
+      if (seq < m_lostBoundary)
         {
-          ret = std::make_pair (it, beginOfCurrentPacket);
+          (item->m_retrans ? m_rtxBelow : m_cleanBelow) -= size;
         }
-      beginOfCurrentPacket += item->m_packet->GetSize ();
     }
+  if (!item->m_retrans)
+    {
+      m_rtxCandidates.erase (seq);
+      m_lostCandidates.erase (seq);
+    }
+}
 
-  return ret;
+void
+TcpTxBuffer::ScoreboardClear (void)
+{
+  m_sentIndex.clear ();
+  m_sackedSeqs.clear ();
+  m_unsackedSeqs.clear ();
+  m_rtxCandidates.clear ();
+  m_lostCandidates.clear ();
+  m_sackedOut = 0;
+  m_notLostOut = 0;
+  m_lostBoundary = m_firstByteSeq;
+  m_cleanBelow = 0;
+  m_rtxBelow = 0;
 }
 
+void
+TcpTxBuffer::UpdateLostBoundary (uint32_t dupThresh, uint32_t segmentSize) const
+{
+  // Walk the SACKed segments downwards until the RFC 6675 IsLost condition
+  // holds for the segments below the current one.
+  SequenceNumber32 boundary = m_firstByteSeq;
+  uint32_t count = 0;
+  uint32_t bytes = 0;
+  SequenceSet::const_reverse_iterator rit;
+  for (rit = m_sackedSeqs.rbegin (); rit != m_sackedSeqs.rend (); ++rit)
+    {
+      ++count;
+      bytes += GetSentItem (*rit)->m_packet->GetSize ();
+      if ((count >= dupThresh) || (bytes > (dupThresh - 1) * segmentSize))
+        {
+          boundary = *rit;
+          break;
+        }
+    }
+
+  if (boundary == m_lostBoundary)
+    {
+      return;
+    }
+
+  // Account the un-SACKed items the boundary moves over
+  bool up = boundary > m_lostBoundary;
+  SequenceSet::const_iterator it = m_unsackedSeqs.lower_bound (up ? m_lostBoundary : boundary);
+  SequenceSet::const_iterator end = m_unsackedSeqs.lower_bound (up ? boundary : m_lostBoundary);
+  for (; it != end; ++it)
+    {
+      const TcpTxItem *item = GetSentItem (*it);
+      if (item->m_lost)
+        {
+          continue;
+        }
+      uint32_t &below = item->m_retrans ? m_rtxBelow : m_cleanBelow;
+      if (up)
+        {
+          below += item->m_packet->GetSize ();
+        }
+      else
+        {
+          below -= item->m_packet->GetSize ();
+        }
+    }
+
+  NS_LOG_LOGIC ("Lost boundary moved from " << m_lostBoundary << " to " << boundary);
+  m_lostBoundary = boundary;
+}
 
 void
 TcpTxBuffer::SplitItems (TcpTxItem &t1, TcpTxItem &t2, uint32_t size) const
@@ -605,6 +765,8 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
 
       if (offset >= pktSize)
         { // This packet is behind the seqnum. Remove this packet from the buffer
+          ScoreboardRemove (item, m_firstByteSeq);
+          m_sentIndex.erase (m_firstByteSeq);
           m_size -= pktSize;
           m_sentSize -= pktSize;
           offset -= pktSize;
@@ -619,11 +781,15 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
       else if (offset > 0)
         { // Part of the packet is behind the seqnum. Fragment
           pktSize -= offset;
+          ScoreboardRemove (item, m_firstByteSeq);
+          m_sentIndex.erase (m_firstByteSeq);
           // PacketTags are preserved when fragmenting
           item->m_packet = item->m_packet->CreateFragment (offset, pktSize);
           m_size -= offset;
           m_sentSize -= offset;
           m_firstByteSeq += offset;
+          m_sentIndex[m_firstByteSeq] = i;
+          ScoreboardAdd (item, m_firstByteSeq);
           NS_LOG_INFO ("Fragmented one packet by size " << offset <<
                        ", new size=" << pktSize);
           break;
@@ -643,13 +809,17 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           // It is not possible to have the UNA sacked; otherwise, it would
           // have been ACKed. This is, most likely, our wrong guessing
           // when crafting the SACK option for a non-SACK receiver.
+          ScoreboardRemove (head, m_firstByteSeq);
           head->m_sacked = false;
+          ScoreboardAdd (head, m_firstByteSeq);
         }
     }
 
-  if (m_highestSack.second <= m_firstByteSeq)
+  if (m_lostBoundary < m_firstByteSeq)
     {
-      m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+      // Nothing is left below the boundary; keep it inside the window
+      NS_ASSERT (m_cleanBelow == 0 && m_rtxBelow == 0);
+      m_lostBoundary = m_firstByteSeq;
     }
 
   NS_LOG_DEBUG ("Discarded up to " << seq);
@@ -667,58 +837,53 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
   NS_LOG_INFO ("Updating scoreboard, got " << list.size () << " blocks to analyze");
   for (option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      Ptr<Packet> current;
-      TcpTxItem *item;
       const TcpOptionSack::SackBlock b = (*option_it);
 
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
+      // Only the segments precisely mapped over the option are marked as
+      // sacked. The block maps some segment if the first segment starting
+      // inside it also ends inside it.
+      SentIndex::const_iterator idx = m_sentIndex.lower_bound (b.first);
+      if (idx != m_sentIndex.end ()
+          && idx->first + (*idx->second)->m_packet->GetSize () <= b.second)
+        {
+          modified = true;
+        }
+      else
+        {
+          NS_LOG_INFO ("Received block [" << b.first << ";" << b.second <<
+                       "], not found in the sackboard");
+          continue;
+        }
 
-      while (item_it != m_sentList.end ())
+      // Walk only the segments which are not sacked yet
+      SequenceSet::iterator it = m_unsackedSeqs.lower_bound (b.first);
+      while (it != m_unsackedSeqs.end () && *it < b.second)
         {
-          item = *item_it;
-          current = item->m_packet;
+          SequenceNumber32 beginOfCurrentPacket = *it;
+          TcpTxItem *item = GetSentItem (beginOfCurrentPacket);
+          uint32_t size = item->m_packet->GetSize ();
 
-          // Check the boundary of this packet ... only mark as sacked if
-          // it is precisely mapped over the option
-          if (beginOfCurrentPacket >= b.first
-              && beginOfCurrentPacket + current->GetSize () <= b.second)
-            {
-              if (item->m_sacked)
-                {
-                  NS_LOG_INFO ("Received block [" << b.first << ";" << b.second <<
-                               ", checking sentList for block " << beginOfCurrentPacket <<
-                               ";" << beginOfCurrentPacket + current->GetSize () <<
-                               "], found in the sackboard already sacked");
-                }
-              else
-                {
-                  item->m_sacked = true;
-                  NS_LOG_INFO ("Received block [" << b.first << ";" << b.second <<
-                               ", checking sentList for block " << beginOfCurrentPacket <<
-                               ";" << beginOfCurrentPacket + current->GetSize () <<
-                               "], found in the sackboard, sacking");
-                  if (m_highestSack.second <= beginOfCurrentPacket + current->GetSize ())
-                    {
-                      PacketList::iterator new_it = item_it;
-                      m_highestSack = std::make_pair (++new_it, beginOfCurrentPacket+current->GetSize ());
-                    }
-                }
-              modified = true;
-            }
-          else if (beginOfCurrentPacket + current->GetSize () > b.second)
+          if (beginOfCurrentPacket + size > b.second)
             {
               // we missed the block. It's useless to iterate again; Say "ciao"
               // to the loop for optimization purposes
               NS_LOG_INFO ("Received block [" << b.first << ";" << b.second <<
                            ", checking sentList for block " << beginOfCurrentPacket <<
-                           ";" << beginOfCurrentPacket + current->GetSize () <<
+                           ";" << beginOfCurrentPacket + size <<
                            "], not found, breaking loop");
               break;
             }
 
-          beginOfCurrentPacket += current->GetSize ();
-          ++item_it;
+          // the set changes below; move on first
+          ++it;
+
+          ScoreboardRemove (item, beginOfCurrentPacket);
+          item->m_sacked = true;
+          ScoreboardAdd (item, beginOfCurrentPacket);
+          NS_LOG_INFO ("Received block [" << b.first << ";" << b.second <<
+                       ", checking sentList for block " << beginOfCurrentPacket <<
+                       ";" << beginOfCurrentPacket + size <<
+                       "], found in the sackboard, sacking");
         }
     }
 
@@ -728,26 +893,20 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
 }
 
 bool
-TcpTxBuffer::IsLost (const SequenceNumber32 &seq, const PacketList::const_iterator &segment,
+TcpTxBuffer::IsLost (const SequenceNumber32 &seq, const TcpTxItem *item,
                      uint32_t dupThresh, uint32_t segmentSize) const
 {
   NS_LOG_FUNCTION (this << seq << dupThresh << segmentSize);
-  uint32_t count = 0;
-  uint32_t bytes = 0;
-  PacketList::const_iterator it;
-  TcpTxItem *item;
-  Ptr<const Packet> current;
-  SequenceNumber32 beginOfCurrentPacket = seq;
 
   NS_LOG_INFO ("Checking if seq=" << seq << " is lost from the buffer ");
 
-  if ((*segment)->m_lost == true)
+  if (item->m_lost == true)
     {
       NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
       return true;
     }
 
-  if ((*segment)->m_sacked == true)
+  if (item->m_sacked == true)
     {
       NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
       return false;
@@ -758,34 +917,16 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq, const PacketList::const_iterat
   // > sequences have arrived above 'seq' or more than (dupThresh - 1) * SMSS bytes
   // > with sequence numbers greater than 'SeqNum' have been SACKed.  Otherwise, the
   // > routine returns false.
-  for (it = segment; it != m_highestSack.first; ++it)
+  // The segments for which this holds are the ones below m_lostBoundary.
+  UpdateLostBoundary (dupThresh, segmentSize);
+  if (seq < m_lostBoundary)
     {
-      if (beginOfCurrentPacket >= m_highestSack.second)
-        {
-          NS_LOG_INFO ("seq=" << seq << " is not lost because there are no sacked segment ahead");
-          return false;
-        }
-
-      item = *it;
-      current = item->m_packet;
-
-      if (item->m_sacked)
-        {
-          NS_LOG_INFO ("Segment [" << beginOfCurrentPacket << ", " <<
-                       beginOfCurrentPacket+item->m_packet->GetSize () <<
-                       "] found to be SACKed");
-          ++count;
-          bytes += current->GetSize ();
-          if ((count >= dupThresh) || (bytes > (dupThresh-1) * segmentSize))
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of 3 sacked blocks ahead");
-              return true;
-            }
-        }
-
-      beginOfCurrentPacket += current->GetSize ();
+      NS_LOG_INFO ("seq=" << seq << " is lost because of " << dupThresh <<
+                   " sacked blocks ahead");
+      return true;
     }
 
+  NS_LOG_INFO ("seq=" << seq << " is not lost, not enough sacked segments ahead");
   return false;
 }
 
@@ -795,28 +936,19 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq, uint32_t dupThresh,
 {
   NS_LOG_FUNCTION (this << seq << dupThresh);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  PacketList::const_iterator it;
-
-  if (seq >= m_highestSack.second)
+  if (m_sackedSeqs.empty () || seq >= GetHighestSacked ())
     {
       return false;
     }
 
-  // This O(n) method is called only once, and outside this class.
-  // It should not harm the performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // The first segment starting at or after seq
+  SentIndex::const_iterator idx = m_sentIndex.lower_bound (seq);
+  if (idx == m_sentIndex.end ())
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
-        {
-          return IsLost (beginOfCurrentPacket, it, dupThresh, segmentSize);
-        }
-
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+      return false;
     }
 
-  return false;
+  return IsLost (idx->first, *(idx->second), dupThresh, segmentSize);
 }
 
 bool
@@ -839,33 +971,24 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, uint32_t dupThresh,
    *
    *     (1.c) IsLost (S2) returns true.
    */
-  PacketList::const_iterator it;
-  TcpTxItem *item;
-  SequenceNumber32 seqPerRule3;
-  bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
+  // The candidates are the un-SACKed segments never retransmitted. The first
+  // one is lost if it is below the lost boundary; otherwise, only the
+  // candidates marked as lost are.
+  UpdateLostBoundary (dupThresh, segmentSize);
 
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  if (!m_rtxCandidates.empty ())
     {
-      item = *it;
-
-      // Condition 1.a , 1.b , and 1.c
-      if (item->m_retrans == false && item->m_sacked == false)
+      SequenceNumber32 first = *m_rtxCandidates.begin ();
+      if (first < m_lostBoundary)
         {
-          if (IsLost (beginOfCurrentPkt, it, dupThresh, segmentSize))
-            {
-              *seq = beginOfCurrentPkt;
-              return true;
-            }
-          else if (seqPerRule3.GetValue () == 0 && isRecovery)
-            {
-              isSeqPerRule3Valid = true;
-              seqPerRule3 = beginOfCurrentPkt;
-            }
+          *seq = first;
+          return true;
+        }
+      if (!m_lostCandidates.empty ())
+        {
+          *seq = *m_lostCandidates.begin ();
+          return true;
         }
-
-      // Nothing found, iterate
-      beginOfCurrentPkt += item->m_packet->GetSize ();
     }
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
@@ -886,9 +1009,9 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, uint32_t dupThresh,
    *     (specifically excluding step (1.c)), then one segment of up to
    *     SMSS octets starting with S3 SHOULD be returned.
    */
-  if (isSeqPerRule3Valid)
+  if (isRecovery && !m_rtxCandidates.empty ())
     {
-      *seq = seqPerRule3;
+      *seq = *m_rtxCandidates.begin ();
       return true;
     }
 
@@ -910,36 +1033,34 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, uint32_t dupThresh,
 uint32_t
 TcpTxBuffer::BytesInFlight (uint32_t dupThresh, uint32_t segmentSize) const
 {
-  PacketList::const_iterator it;
-  TcpTxItem *item;
-  uint32_t size = 0; // "pipe" in RFC
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
-
   // After initializing pipe to zero, the following steps are taken for each
   // octet 'S1' in the sequence space between HighACK and HighData that has not
   // been SACKed:
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
-    {
-      item = *it;
-      if (!item->m_sacked)
-        {
-          // (a) If IsLost (S1) returns false: Pipe is incremented by 1 octet.
-          if (!IsLost (beginOfCurrentPkt, it, dupThresh, segmentSize))
-            {
-              size += item->m_packet->GetSize ();
-            }
-          // (b) If S1 <= HighRxt: Pipe is incremented by 1 octet.
-          // (NOTE: we use the m_retrans flag instead of keeping and updating
-          // another variable). Only if the item is not marked as lost
-          else if (item->m_retrans && !item->m_lost)
-            {
-              size += item->m_packet->GetSize ();
-            }
-        }
-      beginOfCurrentPkt += item->m_packet->GetSize ();
-    }
+  // (a) If IsLost (S1) returns false: Pipe is incremented by 1 octet.
+  // (b) If S1 <= HighRxt: Pipe is incremented by 1 octet.
+  // (NOTE: we use the m_retrans flag instead of keeping and updating
+  // another variable). Only if the item is not marked as lost
+  //
+  // The un-SACKed octets not marked as lost are counted; the ones below the
+  // lost boundary are lost, and they are in the pipe only if retransmitted.
+  UpdateLostBoundary (dupThresh, segmentSize);
+
+  return m_notLostOut - m_cleanBelow;
+}
 
-  return size;
+uint32_t
+TcpTxBuffer::GetSacked (void) const
+{
+  return m_sackedOut;
+}
+
+uint32_t
+TcpTxBuffer::GetLost (uint32_t dupThresh, uint32_t segmentSize) const
+{
+  UpdateLostBoundary (dupThresh, segmentSize);
+
+  // marked as lost, plus the ones lost because of SACKs
+  return (m_sentSize - m_sackedOut - m_notLostOut) + m_cleanBelow + m_rtxBelow;
 }
 
 void
@@ -947,16 +1068,14 @@ TcpTxBuffer::ResetScoreboard ()
 {
   NS_LOG_FUNCTION (this);
 
-  PacketList::iterator it;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
-
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  while (!m_sackedSeqs.empty ())
     {
-      (*it)->m_sacked = false;
-      beginOfCurrentPkt += (*it)->m_packet->GetSize ();
+      SequenceNumber32 beginOfCurrentPkt = *m_sackedSeqs.begin ();
+      TcpTxItem *item = GetSentItem (beginOfCurrentPkt);
+      ScoreboardRemove (item, beginOfCurrentPkt);
+      item->m_sacked = false;
+      ScoreboardAdd (item, beginOfCurrentPkt);
     }
-
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
 }
 
 void
@@ -965,6 +1084,8 @@ TcpTxBuffer::ResetSentList ()
   NS_LOG_FUNCTION (this);
   TcpTxItem *item;
 
+  ScoreboardClear ();
+
   // Keep the head; it will then marked as retransmitted.
   while (m_sentList.size () > 1)
     {
@@ -981,13 +1102,13 @@ TcpTxBuffer::ResetSentList ()
       item->m_sacked = false;
       item->m_retrans = false;
       m_sentSize = item->m_packet->GetSize ();
+      m_sentIndex[m_firstByteSeq] = m_sentList.begin ();
+      ScoreboardAdd (item, m_firstByteSeq);
     }
   else
     {
       m_sentSize = 0;
     }
-
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
 }
 
 void
@@ -997,7 +1118,10 @@ TcpTxBuffer::ResetLastSegmentSent ()
   if (!m_sentList.empty ())
     {
       TcpTxItem *item = m_sentList.back ();
+      SequenceNumber32 beginOfItem = m_firstByteSeq + m_sentSize - item->m_packet->GetSize ();
 
+      ScoreboardRemove (item, beginOfItem);
+      m_sentIndex.erase (beginOfItem);
       m_sentList.pop_back ();
       m_sentSize -= item->m_packet->GetSize ();
       m_appList.insert (m_appList.begin (), item);
@@ -1010,10 +1134,14 @@ TcpTxBuffer::SetSentListLost ()
   NS_LOG_FUNCTION (this);
 
   PacketList::iterator it;
+  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
 
   for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
+      ScoreboardRemove (*it, beginOfCurrentPkt);
       (*it)->m_lost = true;
+      ScoreboardAdd (*it, beginOfCurrentPkt);
+      beginOfCurrentPkt += (*it)->m_packet->GetSize ();
     }
 }
 
@@ -1043,15 +1171,19 @@ TcpTxBuffer::CraftSackOption (const SequenceNumber32 &seq, uint8_t available) co
   NS_LOG_INFO ("Crafting a SACK block, available bytes: " << (uint32_t) available <<
                " from seq: " << seq << " buffer starts at seq " << m_firstByteSeq);
 
-  PacketList::const_iterator it;
-  if (m_highestSack.first == m_sentList.end ())
+  // Start from the highest SACKed segment, or from the first one starting at
+  // seq if it is higher: the segments before are not usable anyway
+  PacketList::const_iterator it = m_sentList.begin ();
+  if (!m_sackedSeqs.empty ())
     {
-      it = m_sentList.begin ();
+      beginOfCurrentPacket = *m_sackedSeqs.rbegin ();
+      it = m_sentIndex.find (beginOfCurrentPacket)->second;
     }
-  else
+  SentIndex::const_iterator idx = m_sentIndex.lower_bound (seq);
+  if (idx != m_sentIndex.end () && idx->first > beginOfCurrentPacket)
     {
-      it = m_highestSack.first;
-      beginOfCurrentPacket = m_highestSack.second;
+      beginOfCurrentPacket = idx->first;
+      it = idx->second;
     }
 
   while (it != m_sentList.end ())
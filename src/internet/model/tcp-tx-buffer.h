@@ -28,6 +28,9 @@
 #include "ns3/nstime.h"
 #include "ns3/tcp-option-sack.h"
 
+#include <map>
+#include <set>
+
 namespace ns3 {
 class Packet;
 
@@ -103,21 +106,30 @@ public:
  * associated with every segment sent. This is done through the use of the
  * class TcpTxItem: instead of storing a list of packets, we store a list of
  * TcpTxItem. Each item has different flags (check the corresponding
- * documentation) and maintaining the scoreboard is a matter of travelling the
- * list and set the SACK flag on the corresponding segment sent.
+ * documentation).
+ *
+ * Scoreboard indexes
+ * ------------------
  *
- * Inefficiencies
- * --------------
+ * Traveling the whole SentList to answer the RFC 6675 queries makes the cost
+ * of every ACK linear (and of IsLost, called for every segment, quadratic) in
+ * the number of segments in flight. Instead, the sent items are indexed by
+ * their first sequence number, and the sequences of the items are kept in
+ * ordered sets according to their state (SACKed, un-SACKed, retransmission
+ * candidates, candidates marked as lost). The bytes SACKed and the bytes
+ * not marked as lost are counted as the items change state.
  *
- * The algorithms outlined in RFC 6675 are full of inefficiencies. In
- * particular, traveling all the sent list each time it is needed to compute
- * the bytes in flight is expensive. We try to overcome the issue by
- * maintaining a pointer to the highest sequence SACKed; in this way, we can
- * avoid traveling all the list in some cases. Another option could be keeping
- * a count of each critical value (e.g., the number of packets sacked).
- * However, this would be different from the algorithms in RFC. There are some
- * other possible improvements; if you wish, take a look and try  to add some
- * earlier exit conditions in the loops.
+ * IsLost (S) is true for an un-SACKed segment S when the SACKed segments above
+ * S are at least dupThresh, or carry more than (dupThresh - 1) * SMSS bytes.
+ * Both quantities decrease as S grows, so the segments lost because of SACKs
+ * are exactly the ones below a boundary: the first sequence of the SACKed
+ * segment at which, walking the SACKed segments downwards from the highest
+ * one, the condition becomes true. Finding it takes at most dupThresh steps.
+ * The bytes of the un-SACKed segments below the boundary are counted as
+ * well, and updated only for the segments the boundary moves over. This way,
+ * Update, IsLost, NextSeg and BytesInFlight take a time logarithmic in the
+ * number of segments in flight, plus the segments actually SACKed or passed
+ * over by the boundary.
  *
  * \see Size
  * \see SizeFromSequence
@@ -316,22 +328,77 @@ public:
    */
   Ptr<const TcpOptionSack> CraftSackOption (const SequenceNumber32 &seq, uint8_t available) const;
 
+  /**
+   * \brief Get the number of bytes SACKed
+   * \returns the bytes of the sent segments which are SACKed
+   */
+  uint32_t GetSacked (void) const;
+
+  /**
+   * \brief Get the number of bytes lost, per RFC 6675 IsLost
+   *
+   * \param dupThresh duplicate ACK threshold
+   * \param segmentSize segment size
+   * \returns the bytes of the un-SACKed sent segments which are lost
+   */
+  uint32_t GetLost (uint32_t dupThresh, uint32_t segmentSize) const;
+
 private:
   friend std::ostream & operator<< (std::ostream & os, TcpTxBuffer const & tcpTxBuf);
 
   typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
+  typedef std::map<SequenceNumber32, PacketList::iterator> SentIndex; //!< sent items by first sequence
+  typedef std::set<SequenceNumber32> SequenceSet; //!< first sequences of a set of sent items
 
   /**
    * \brief Check if a segment is lost per RFC 6675
    * \param seq sequence to check
-   * \param segment Iterator pointing at seq
+   * \param item the item starting at seq
    * \param dupThresh dupAck threshold
    * \param segmentSize segment size
    * \return true if the sequence is supposed to be lost, false otherwise
    */
-  bool IsLost (const SequenceNumber32 &seq, const PacketList::const_iterator &segment, uint32_t dupThresh,
+  bool IsLost (const SequenceNumber32 &seq, const TcpTxItem *item, uint32_t dupThresh,
                uint32_t segmentSize) const;
 
+  /**
+   * \brief Account a sent item in the scoreboard, according to its flags
+   * \param item the item
+   * \param seq the first sequence of the item
+   */
+  void ScoreboardAdd (const TcpTxItem *item, const SequenceNumber32 &seq);
+
+  /**
+   * \brief Remove a sent item from the scoreboard
+   *
+   * It must be called with the item in the same state it was added with;
+   * it is then possible to change its flags, size or sequence and add it again.
+   *
+   * \param item the item
+   * \param seq the first sequence of the item
+   */
+  void ScoreboardRemove (const TcpTxItem *item, const SequenceNumber32 &seq);
+
+  /**
+   * \brief Remove everything from the scoreboard and the sent index
+   */
+  void ScoreboardClear (void);
+
+  /**
+   * \brief Move the boundary below which the un-SACKed segments are lost,
+   * per RFC 6675 IsLost, to reflect the current SACKed segments
+   *
+   * \param dupThresh dupAck threshold
+   * \param segmentSize segment size
+   */
+  void UpdateLostBoundary (uint32_t dupThresh, uint32_t segmentSize) const;
+
+  /**
+   * \param seq the first sequence of a sent item
+   * \returns the sent item starting at seq
+   */
+  TcpTxItem* GetSentItem (const SequenceNumber32 &seq) const;
+
   /**
    * \brief Get a block of data not transmitted yet and move it into SentList
    *
@@ -463,10 +530,10 @@ private:
 
   /**
    * \brief Find the highest SACK byte
-   * \return a pair with the highest byte and an iterator inside m_sentList
+   * \return the sequence following the highest SACKed byte, or the head
+   * sequence if nothing is SACKed
    */
-  std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
-  GetHighestSacked () const;
+  SequenceNumber32 GetHighestSacked () const;
 
   PacketList m_appList;  //!< Buffer for application data
   PacketList m_sentList; //!< Buffer for sent (but not acked) data
@@ -476,7 +543,17 @@ private:
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
 
-  std::pair <PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
+  SentIndex m_sentIndex;          //!< Items of the SentList, by first sequence
+  SequenceSet m_sackedSeqs;       //!< Sequences of the SACKed items
+  SequenceSet m_unsackedSeqs;     //!< Sequences of the un-SACKed items
+  SequenceSet m_rtxCandidates;    //!< Sequences of the un-SACKed items never retransmitted
+  SequenceSet m_lostCandidates;   //!< Sequences of the m_rtxCandidates marked as lost
+  uint32_t m_sackedOut;           //!< Bytes SACKed
+  uint32_t m_notLostOut;          //!< Bytes un-SACKed and not marked as lost
+
+  mutable SequenceNumber32 m_lostBoundary; //!< un-SACKed items below it are lost because of SACKs
+  mutable uint32_t m_cleanBelow;  //!< Bytes un-SACKed, not marked as lost, never retransmitted, below m_lostBoundary
+  mutable uint32_t m_rtxBelow;    //!< Bytes un-SACKed, not marked as lost, retransmitted, below m_lostBoundary
 
 };
 
@@ -0,0 +1,385 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/ipv6-end-point-demux.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4EndPointDemux test against a linear scan of the endpoints
+ *
+ * Endpoints are randomly allocated, connected, disabled and deallocated,
+ * and random packets are looked up. The demux must return the same
+ * endpoints, in the same order, as the matching rules applied to every
+ * endpoint in allocation order.
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Reference lookup, scanning all the endpoints
+   * \param endPoints the endpoints, in allocation order
+   * \param daddr destination address
+   * \param dport destination port
+   * \param saddr source address
+   * \param sport source port
+   * \returns the matching endpoints
+   */
+  static Ipv4EndPointDemux::EndPoints Scan (const Ipv4EndPointDemux::EndPoints &endPoints,
+                                            Ipv4Address daddr, uint16_t dport,
+                                            Ipv4Address saddr, uint16_t sport);
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Ipv4EndPointDemux lookup against a linear scan")
+{
+}
+
+Ipv4EndPointDemux::EndPoints
+Ipv4EndPointDemuxTestCase::Scan (const Ipv4EndPointDemux::EndPoints &endPoints,
+                                 Ipv4Address daddr, uint16_t dport,
+                                 Ipv4Address saddr, uint16_t sport)
+{
+  // the incoming interface is 10.0.0.1/24
+  bool isBroadcast = daddr.IsBroadcast () || daddr == Ipv4Address ("10.0.0.255");
+  Ipv4Address incomingInterfaceAddr = daddr == Ipv4Address ("10.0.0.255") ? Ipv4Address ("10.0.0.1") : daddr;
+  Ipv4EndPointDemux::EndPoints retval[4];
+  for (Ipv4EndPointDemux::EndPoints::const_iterator i = endPoints.begin (); i != endPoints.end (); i++)
+    {
+      Ipv4EndPoint *endP = *i;
+      if (!endP->IsRxEnabled () || endP->GetLocalPort () != dport)
+        {
+          continue;
+        }
+      bool localWild = endP->GetLocalAddress () == Ipv4Address::GetAny ();
+      bool localExact = endP->GetLocalAddress () == (isBroadcast && !localWild ? incomingInterfaceAddr : daddr);
+      bool portExact = endP->GetPeerPort () == sport;
+      bool portWild = endP->GetPeerPort () == 0;
+      bool addrExact = endP->GetPeerAddress () == saddr;
+      bool addrWild = endP->GetPeerAddress () == Ipv4Address::GetAny ();
+      if (!(localExact || localWild) || !(portExact || portWild) || !(addrExact || addrWild))
+        {
+          continue;
+        }
+      if (localWild && portWild && addrWild)
+        {
+          retval[0].push_back (endP);
+        }
+      if ((localExact || (isBroadcast && localWild)) && portWild && addrWild)
+        {
+          retval[1].push_back (endP);
+        }
+      if (localWild && portExact && addrExact)
+        {
+          retval[2].push_back (endP);
+        }
+      if (localExact && portExact && addrExact)
+        {
+          retval[3].push_back (endP);
+        }
+    }
+  for (int i = 3; i > 0; i--)
+    {
+      if (!retval[i].empty ())
+        {
+          return retval[i];
+        }
+    }
+  return retval[0];
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  interface->AddAddress (Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask ("255.255.255.0")));
+  const Ipv4Address local[] = { Ipv4Address::GetAny (), Ipv4Address ("10.0.0.1"), Ipv4Address ("10.0.0.255") };
+  const Ipv4Address peer[] = { Ipv4Address ("10.0.0.2"), Ipv4Address ("10.0.0.3"), Ipv4Address ("10.0.1.2") };
+
+  Ipv4EndPointDemux demux;
+  std::vector<Ipv4EndPoint *> allocated;
+  for (uint32_t step = 0; step < 5000; step++)
+    {
+      uint32_t action = rand->GetInteger (0, 9);
+      Ipv4EndPoint *endPoint = 0;
+      if (action == 0)
+        {
+          // listening endpoint on a well-known port
+          endPoint = demux.Allocate (local[rand->GetInteger (0, 1)], rand->GetInteger (1, 4));
+        }
+      else if (action == 1)
+        {
+          // accepted connection
+          endPoint = demux.Allocate (local[rand->GetInteger (0, 1)], rand->GetInteger (1, 4),
+                                     peer[rand->GetInteger (0, 2)], rand->GetInteger (0, 3));
+        }
+      else if (action == 2)
+        {
+          // active open: ephemeral port, then connect
+          endPoint = demux.Allocate ();
+          if (endPoint != 0)
+            {
+              endPoint->SetPeer (peer[rand->GetInteger (0, 2)], rand->GetInteger (1, 4));
+            }
+        }
+      else if (action == 3 && !allocated.empty ())
+        {
+          uint32_t index = rand->GetInteger (0, allocated.size () - 1);
+          allocated[index]->SetPeer (peer[rand->GetInteger (0, 2)], rand->GetInteger (0, 3));
+        }
+      else if (action == 4 && !allocated.empty ())
+        {
+          uint32_t index = rand->GetInteger (0, allocated.size () - 1);
+          allocated[index]->SetRxEnabled (rand->GetInteger (0, 3) == 0);
+        }
+      else if (action == 5 && !allocated.empty ())
+        {
+          uint32_t index = rand->GetInteger (0, allocated.size () - 1);
+          demux.DeAllocate (allocated[index]);
+          allocated.erase (allocated.begin () + index);
+        }
+      else
+        {
+          Ipv4Address daddr = local[rand->GetInteger (1, 2)];
+          uint16_t dport = rand->GetInteger (1, 4);
+          Ipv4Address saddr = peer[rand->GetInteger (0, 2)];
+          uint16_t sport = rand->GetInteger (1, 3);
+          Ipv4EndPointDemux::EndPoints expected = Scan (demux.GetAllEndPoints (), daddr, dport, saddr, sport);
+          Ipv4EndPointDemux::EndPoints found = demux.Lookup (daddr, dport, saddr, sport, interface);
+          NS_TEST_ASSERT_MSG_EQ ((found == expected), true,
+                                 "Wrong endpoints for " << saddr << ":" << sport
+                                 << " -> " << daddr << ":" << dport);
+        }
+      if (endPoint != 0)
+        {
+          allocated.push_back (endPoint);
+        }
+    }
+
+  // LookupPortLocal must agree with the allocated endpoints
+  for (uint16_t port = 1; port <= 4; port++)
+    {
+      bool used = false;
+      for (uint32_t i = 0; i < allocated.size (); i++)
+        {
+          used |= allocated[i]->GetLocalPort () == port;
+        }
+      NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (port), used, "Wrong local port " << port);
+    }
+  NS_TEST_ASSERT_MSG_EQ (demux.GetAllEndPoints ().size (), allocated.size (), "Wrong number of endpoints");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv6EndPointDemux test against a linear scan of the endpoints
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Reference lookup, scanning all the endpoints
+   * \param endPoints the endpoints, in allocation order
+   * \param daddr destination address
+   * \param dport destination port
+   * \param saddr source address
+   * \param sport source port
+   * \returns the matching endpoints
+   */
+  static Ipv6EndPointDemux::EndPoints Scan (const Ipv6EndPointDemux::EndPoints &endPoints,
+                                            Ipv6Address daddr, uint16_t dport,
+                                            Ipv6Address saddr, uint16_t sport);
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Ipv6EndPointDemux lookup against a linear scan")
+{
+}
+
+Ipv6EndPointDemux::EndPoints
+Ipv6EndPointDemuxTestCase::Scan (const Ipv6EndPointDemux::EndPoints &endPoints,
+                                 Ipv6Address daddr, uint16_t dport,
+                                 Ipv6Address saddr, uint16_t sport)
+{
+  Ipv6EndPointDemux::EndPoints retval[4];
+  for (Ipv6EndPointDemux::EndPoints::const_iterator i = endPoints.begin (); i != endPoints.end (); i++)
+    {
+      Ipv6EndPoint *endP = *i;
+      if (!endP->IsRxEnabled () || endP->GetLocalPort () != dport)
+        {
+          continue;
+        }
+      bool localWild = endP->GetLocalAddress () == Ipv6Address::GetAny ();
+      bool localExact = endP->GetLocalAddress () == daddr;
+      bool localAllRouters = endP->GetLocalAddress () == Ipv6Address::GetAllRoutersMulticast ();
+      bool portExact = endP->GetPeerPort () == sport;
+      bool portWild = endP->GetPeerPort () == 0;
+      bool addrExact = endP->GetPeerAddress () == saddr;
+      bool addrWild = endP->GetPeerAddress () == Ipv6Address::GetAny ();
+      if (!(localExact || localWild) || !(portExact || portWild) || !(addrExact || addrWild))
+        {
+          continue;
+        }
+      if (localWild && portWild && addrWild)
+        {
+          retval[0].push_back (endP);
+        }
+      if ((localExact || localAllRouters) && portWild && addrWild)
+        {
+          retval[1].push_back (endP);
+        }
+      if (localWild && portExact && addrExact)
+        {
+          retval[2].push_back (endP);
+        }
+      if (localExact && portExact && addrExact)
+        {
+          retval[3].push_back (endP);
+        }
+    }
+  for (int i = 3; i > 0; i--)
+    {
+      if (!retval[i].empty ())
+        {
+          return retval[i];
+        }
+    }
+  return retval[0];
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  const Ipv6Address local[] = { Ipv6Address::GetAny (), Ipv6Address ("2001:db8::1"), Ipv6Address ("2001:db8::2") };
+  const Ipv6Address peer[] = { Ipv6Address ("2001:db8::3"), Ipv6Address ("2001:db8::4"), Ipv6Address ("2001:db8:1::3") };
+
+  Ipv6EndPointDemux demux;
+  std::vector<Ipv6EndPoint *> allocated;
+  for (uint32_t step = 0; step < 5000; step++)
+    {
+      uint32_t action = rand->GetInteger (0, 9);
+      Ipv6EndPoint *endPoint = 0;
+      if (action == 0)
+        {
+          endPoint = demux.Allocate (local[rand->GetInteger (0, 2)], rand->GetInteger (1, 4));
+        }
+      else if (action == 1)
+        {
+          endPoint = demux.Allocate (local[rand->GetInteger (0, 2)], rand->GetInteger (1, 4),
+                                     peer[rand->GetInteger (0, 2)], rand->GetInteger (0, 3));
+        }
+      else if (action == 2)
+        {
+          endPoint = demux.Allocate ();
+          if (endPoint != 0)
+            {
+              endPoint->SetPeer (peer[rand->GetInteger (0, 2)], rand->GetInteger (1, 4));
+            }
+        }
+      else if (action == 3 && !allocated.empty ())
+        {
+          uint32_t index = rand->GetInteger (0, allocated.size () - 1);
+          if (rand->GetInteger (0, 1) == 0)
+            {
+              allocated[index]->SetPeer (peer[rand->GetInteger (0, 2)], rand->GetInteger (0, 3));
+            }
+          else
+            {
+              allocated[index]->SetLocalPort (rand->GetInteger (1, 4));
+            }
+        }
+      else if (action == 4 && !allocated.empty ())
+        {
+          uint32_t index = rand->GetInteger (0, allocated.size () - 1);
+          allocated[index]->SetRxEnabled (rand->GetInteger (0, 3) == 0);
+        }
+      else if (action == 5 && !allocated.empty ())
+        {
+          uint32_t index = rand->GetInteger (0, allocated.size () - 1);
+          demux.DeAllocate (allocated[index]);
+          allocated.erase (allocated.begin () + index);
+        }
+      else
+        {
+          Ipv6Address daddr = local[rand->GetInteger (1, 2)];
+          uint16_t dport = rand->GetInteger (1, 4);
+          Ipv6Address saddr = peer[rand->GetInteger (0, 2)];
+          uint16_t sport = rand->GetInteger (1, 3);
+          Ipv6EndPointDemux::EndPoints expected = Scan (demux.GetEndPoints (), daddr, dport, saddr, sport);
+          Ipv6EndPointDemux::EndPoints found = demux.Lookup (daddr, dport, saddr, sport, 0);
+          NS_TEST_ASSERT_MSG_EQ ((found == expected), true,
+                                 "Wrong endpoints for " << saddr << ":" << sport
+                                 << " -> " << daddr << ":" << dport);
+        }
+      if (endPoint != 0)
+        {
+          allocated.push_back (endPoint);
+        }
+    }
+
+  for (uint16_t port = 1; port <= 4; port++)
+    {
+      bool used = false;
+      for (uint32_t i = 0; i < allocated.size (); i++)
+        {
+          used |= allocated[i]->GetLocalPort () == port;
+        }
+      NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (port), used, "Wrong local port " << port);
+    }
+  NS_TEST_ASSERT_MSG_EQ (demux.GetEndPoints ().size (), allocated.size (), "Wrong number of endpoints");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4EndPointDemux and Ipv6EndPointDemux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite () : TestSuite ("end-point-demux", UNIT)
+  {
+    AddTestCase (new Ipv4EndPointDemuxTestCase (), TestCase::QUICK);
+    AddTestCase (new Ipv6EndPointDemuxTestCase (), TestCase::QUICK);
+  }
+};
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
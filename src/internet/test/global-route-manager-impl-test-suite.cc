@@ -27,6 +27,8 @@
 #include "ns3/candidate-queue.h"
 #include "ns3/simulator.h"
 #include <cstdlib> // for rand()
+#include <list>
+#include <algorithm>
 
 using namespace ns3;
 
@@ -226,6 +228,97 @@ GlobalRouteManagerImplTestCase::DoRun (void)
 }
 
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief CandidateQueue test against a sorted list
+ *
+ * Vertices are randomly pushed, popped and moved closer to the root.  The
+ * queue must pop them in the same order as a list kept sorted by upper_bound
+ * insertion and stable sorting, the implementation the SPF calculation was
+ * written against.
+ */
+class CandidateQueueTestCase : public TestCase
+{
+public:
+  CandidateQueueTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief The order of the candidates in the reference list
+   * \param v1 first vertex
+   * \param v2 second vertex
+   * \returns true if v1 should be popped before v2
+   */
+  static bool Before (const SPFVertex* v1, const SPFVertex* v2);
+};
+
+CandidateQueueTestCase::CandidateQueueTestCase ()
+  : TestCase ("CandidateQueue pops vertices in the order of a sorted list")
+{
+}
+
+bool
+CandidateQueueTestCase::Before (const SPFVertex* v1, const SPFVertex* v2)
+{
+  if (v1->GetDistanceFromRoot () != v2->GetDistanceFromRoot ())
+    {
+      return v1->GetDistanceFromRoot () < v2->GetDistanceFromRoot ();
+    }
+  return v1->GetVertexType () == SPFVertex::VertexNetwork
+         && v2->GetVertexType () == SPFVertex::VertexRouter;
+}
+
+void
+CandidateQueueTestCase::DoRun (void)
+{
+  CandidateQueue candidate;
+  std::list<SPFVertex*> reference;
+  uint32_t nextId = 1;
+
+  for (int i = 0; i < 5000; ++i)
+    {
+      int action = std::rand () % 10;
+      if (action < 4 || reference.empty ())
+        {
+          SPFVertex *v = new SPFVertex;
+          v->SetVertexId (Ipv4Address (nextId++));
+          v->SetVertexType (std::rand () % 2 ? SPFVertex::VertexRouter : SPFVertex::VertexNetwork);
+          // few distinct distances, so that many vertices tie
+          v->SetDistanceFromRoot (10 + std::rand () % 20);
+          candidate.Push (v);
+          reference.insert (std::upper_bound (reference.begin (), reference.end (), v, &Before), v);
+        }
+      else if (action < 7)
+        {
+          std::list<SPFVertex*>::iterator it = reference.begin ();
+          std::advance (it, std::rand () % reference.size ());
+          SPFVertex *v = *it;
+          NS_TEST_ASSERT_MSG_EQ (candidate.Find (v->GetVertexId ()), v, "Vertex not found");
+          // a shorter path to the vertex was found
+          uint32_t distance = v->GetDistanceFromRoot ();
+          if (distance > 0)
+            {
+              v->SetDistanceFromRoot (distance - 1 - std::rand () % std::min (distance, 9u));
+              candidate.Update (v);
+              reference.sort (&Before);
+            }
+        }
+      else
+        {
+          SPFVertex *v = candidate.Pop ();
+          NS_TEST_ASSERT_MSG_EQ (v, reference.front (), "Wrong vertex popped");
+          NS_TEST_ASSERT_MSG_EQ (candidate.Find (v->GetVertexId ()), 0, "Popped vertex found");
+          reference.pop_front ();
+          delete v;
+        }
+      NS_TEST_ASSERT_MSG_EQ (candidate.Size (), reference.size (), "Wrong number of candidates");
+    }
+  // the remaining vertices are deleted by the queue
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -243,6 +336,7 @@ GlobalRouteManagerImplTestSuite::GlobalRouteManagerImplTestSuite ()
   : TestSuite ("global-route-manager-impl", UNIT)
 {
   AddTestCase (new GlobalRouteManagerImplTestCase (), TestCase::QUICK);
+  AddTestCase (new CandidateQueueTestCase (), TestCase::QUICK);
 }
 
 static GlobalRouteManagerImplTestSuite g_globalRoutingManagerImplTestSuite; //!< Static variable for test initialization
@@ -42,6 +42,9 @@
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
 #include "ns3/bridge-helper.h"
+#include "ns3/global-route-manager.h"
+#include "ns3/output-stream-wrapper.h"
+#include <sstream>
 
 using namespace ns3;
 
@@ -1244,6 +1247,132 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting incremental recomputation test
+ *
+ * Two disconnected networks:
+ *
+ *      n0 <---> n1 <===LAN===> n2, n3 <---> n4      n5 <---> n6 <---> n7
+ *
+ * After the link between n3 and n4 goes down, RecomputeRoutingTables ()
+ * must give the routes that a full recomputation gives, without touching
+ * the routes of n5, n6 and n7.
+ */
+class Ipv4GlobalRoutingRecomputeTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingRecomputeTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Print the global routing tables of the nodes
+   * \param nodes the nodes
+   * \returns the routing table of each node
+   */
+  std::vector<std::string> GetRoutingTables (NodeContainer nodes);
+};
+
+Ipv4GlobalRoutingRecomputeTestCase::Ipv4GlobalRoutingRecomputeTestCase ()
+  : TestCase ("Global routing recomputes the routes of the affected nodes only")
+{
+}
+
+std::vector<std::string>
+Ipv4GlobalRoutingRecomputeTestCase::GetRoutingTables (NodeContainer nodes)
+{
+  std::vector<std::string> tables;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      std::ostringstream oss;
+      Ptr<OutputStreamWrapper> stream = Create<OutputStreamWrapper> (&oss);
+      Ptr<Ipv4GlobalRouting> gr = nodes.Get (i)->GetObject<Ipv4> ()->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+      gr->PrintRoutingTable (stream);
+      tables.push_back (oss.str ());
+    }
+  return tables;
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (8);
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper p2pHelper;
+  p2pHelper.SetNetDevicePointToPointMode (true);
+  SimpleNetDeviceHelper lanHelper;
+  Ipv4AddressHelper ipv4;
+
+  ipv4.SetBase ("10.1.1.0", "255.255.255.252");
+  ipv4.Assign (p2pHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1))));
+  ipv4.SetBase ("10.1.2.0", "255.255.255.0");
+  ipv4.Assign (lanHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2), nodes.Get (3))));
+  ipv4.SetBase ("10.1.3.0", "255.255.255.252");
+  NetDeviceContainer d3d4 = p2pHelper.Install (NodeContainer (nodes.Get (3), nodes.Get (4)));
+  ipv4.Assign (d3d4);
+  ipv4.SetBase ("10.2.1.0", "255.255.255.252");
+  ipv4.Assign (p2pHelper.Install (NodeContainer (nodes.Get (5), nodes.Get (6))));
+  ipv4.SetBase ("10.2.2.0", "255.255.255.252");
+  ipv4.Assign (p2pHelper.Install (NodeContainer (nodes.Get (6), nodes.Get (7))));
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::vector<std::string> before = GetRoutingTables (nodes);
+
+  // a route that a full recomputation would delete
+  Ptr<Ipv4GlobalRouting> gr6 = nodes.Get (6)->GetObject<Ipv4> ()->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+  uint32_t nRoutes6 = gr6->GetNRoutes ();
+  gr6->AddHostRouteTo (Ipv4Address ("192.168.1.1"), Ipv4Address ("10.2.1.1"), 1);
+
+  Ptr<Ipv4> ipv43 = nodes.Get (3)->GetObject<Ipv4> ();
+  ipv43->SetDown (ipv43->GetInterfaceForDevice (d3d4.Get (0)));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+
+  NS_TEST_ASSERT_MSG_EQ (gr6->GetNRoutes (), nRoutes6 + 1, "Routes of an unaffected node recomputed");
+  // the host routes come first
+  uint32_t marker = 0;
+  while (gr6->GetRoute (marker)->IsHost ()
+         && gr6->GetRoute (marker)->GetDest () != Ipv4Address ("192.168.1.1"))
+    {
+      marker++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (gr6->GetRoute (marker)->GetDest (), Ipv4Address ("192.168.1.1"),
+                         "Routes of an unaffected node recomputed");
+  gr6->RemoveRoute (marker);
+
+  std::vector<std::string> incremental = GetRoutingTables (nodes);
+  NS_TEST_ASSERT_MSG_NE (incremental[1], before[1], "Routes of n1 not recomputed");
+
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  GlobalRouteManager::InitializeRoutes ();
+  std::vector<std::string> full = GetRoutingTables (nodes);
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (incremental[i], full[i], "Wrong routes for node " << i);
+    }
+
+  // nothing changed: no route is recomputed
+  gr6->AddHostRouteTo (Ipv4Address ("192.168.1.1"), Ipv4Address ("10.2.1.1"), 1);
+  Ptr<Ipv4GlobalRouting> gr0 = nodes.Get (0)->GetObject<Ipv4> ()->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+  uint32_t nRoutes0 = gr0->GetNRoutes ();
+  gr0->AddHostRouteTo (Ipv4Address ("192.168.1.1"), Ipv4Address ("10.1.1.2"), 1);
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_ASSERT_MSG_EQ (gr6->GetNRoutes (), nRoutes6 + 1, "Routes recomputed without changes");
+  NS_TEST_ASSERT_MSG_EQ (gr0->GetNRoutes (), nRoutes0 + 1, "Routes recomputed without changes");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1396,7 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingRecomputeTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
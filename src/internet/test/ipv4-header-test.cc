@@ -265,6 +265,103 @@ Ipv4HeaderTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 Header incremental checksum Test
+ *
+ * A received header whose TTL and TOS are rewritten must be serialized
+ * with the same checksum as a header built from scratch.
+ */
+class Ipv4HeaderChecksumTest : public TestCase
+{
+public:
+  virtual void DoRun (void);
+  Ipv4HeaderChecksumTest ();
+
+private:
+  /**
+   * \brief Build a header with checksum enabled.
+   * \param ttl The TTL field.
+   * \param tos The TOS field.
+   * \return The header.
+   */
+  Ipv4Header MakeHeader (uint8_t ttl, uint8_t tos);
+  /**
+   * \brief Serialize a header.
+   * \param header The header.
+   * \return The header bytes.
+   */
+  std::string Serialize (const Ipv4Header &header);
+};
+
+Ipv4HeaderChecksumTest::Ipv4HeaderChecksumTest ()
+  : TestCase ("IPv4 Header incremental checksum Test")
+{
+}
+
+Ipv4Header
+Ipv4HeaderChecksumTest::MakeHeader (uint8_t ttl, uint8_t tos)
+{
+  Ipv4Header header;
+  header.EnableChecksum ();
+  header.SetSource (Ipv4Address ("10.1.2.3"));
+  header.SetDestination (Ipv4Address ("192.168.200.1"));
+  header.SetProtocol (6);
+  header.SetPayloadSize (1000);
+  header.SetIdentification (0xbeef);
+  header.SetDontFragment ();
+  header.SetTtl (ttl);
+  header.SetTos (tos);
+  return header;
+}
+
+std::string
+Ipv4HeaderChecksumTest::Serialize (const Ipv4Header &header)
+{
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (header);
+  uint8_t buf[20];
+  p->CopyData (buf, 20);
+  return std::string (reinterpret_cast<char *> (buf), 20);
+}
+
+void
+Ipv4HeaderChecksumTest::DoRun (void)
+{
+  uint8_t toses[] = { 0x00, 0x01, 0x02, 0x03, 0xb8, 0xff };
+  for (uint32_t ttl = 1; ttl < 256; ttl++)
+    {
+      for (uint32_t j = 0; j < sizeof (toses); j++)
+        {
+          Ptr<Packet> p = Create<Packet> ();
+          p->AddHeader (MakeHeader (ttl, toses[j]));
+
+          Ipv4Header received;
+          received.EnableChecksum ();
+          p->RemoveHeader (received);
+          NS_TEST_ASSERT_MSG_EQ (received.IsChecksumOk (), true, "Bad checksum");
+
+          // forwarding, then ECN marking by a queue disc.
+          received.SetTtl (ttl - 1);
+          received.SetEcn (Ipv4Header::ECN_CE);
+          received.SetDscp (Ipv4Header::DSCP_AF11);
+          Ipv4Header expected = MakeHeader (ttl - 1, toses[j]);
+          expected.SetEcn (Ipv4Header::ECN_CE);
+          expected.SetDscp (Ipv4Header::DSCP_AF11);
+          NS_TEST_ASSERT_MSG_EQ (Serialize (received), Serialize (expected),
+                                 "Bad updated checksum, TTL " << ttl << " TOS " << (uint32_t) toses[j]);
+
+          // other fields are not updated incrementally.
+          received.SetIdentification (0x1234);
+          expected.SetIdentification (0x1234);
+          NS_TEST_ASSERT_MSG_EQ (Serialize (received), Serialize (expected),
+                                 "Bad recomputed checksum");
+        }
+    }
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -277,6 +374,7 @@ public:
   Ipv4HeaderTestSuite () : TestSuite ("ipv4-header", UNIT)
   {
     AddTestCase (new Ipv4HeaderTest, TestCase::QUICK);
+    AddTestCase (new Ipv4HeaderChecksumTest, TestCase::QUICK);
   }
 };
 
@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <list>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-route-trie.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4RouteTrie test on a few overlapping prefixes
+ */
+class Ipv4RouteTrieBasicTestCase : public TestCase
+{
+public:
+  Ipv4RouteTrieBasicTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4RouteTrieBasicTestCase::Ipv4RouteTrieBasicTestCase ()
+  : TestCase ("Lookup of overlapping prefixes")
+{
+}
+
+void
+Ipv4RouteTrieBasicTestCase::DoRun (void)
+{
+  Ipv4RouteTrie<uint32_t> trie;
+  trie.Insert (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), 1);
+  trie.Insert (Ipv4Address ("0.0.0.0"), Ipv4Mask::GetZero (), 2);
+  trie.Insert (Ipv4Address ("10.1.2.3"), Ipv4Mask::GetOnes (), 3);
+  trie.Insert (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.0.0.0"), 4);
+  trie.Insert (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), 5);
+  trie.Insert (Ipv4Address ("10.1.2.0"), Ipv4Mask ("255.0.255.0"), 6);
+  NS_TEST_ASSERT_MSG_EQ (trie.GetNRoutes (), 6, "Wrong number of routes");
+
+  std::vector<uint32_t> routes;
+  trie.Lookup (Ipv4Address ("10.1.2.3"), routes);
+  NS_TEST_ASSERT_MSG_EQ (routes.size (), 6, "All the routes match 10.1.2.3");
+  for (uint32_t i = 0; i < routes.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (routes[i], i + 1, "Routes not in insertion order");
+    }
+
+  routes.clear ();
+  trie.Lookup (Ipv4Address ("10.2.2.3"), routes);
+  NS_TEST_ASSERT_MSG_EQ (routes.size (), 3, "Three routes match 10.2.2.3");
+  NS_TEST_ASSERT_MSG_EQ (routes[0], 2, "Default route not found");
+  NS_TEST_ASSERT_MSG_EQ (routes[1], 4, "10.0.0.0/8 not found");
+  NS_TEST_ASSERT_MSG_EQ (routes[2], 6, "Non-contiguous mask not matched");
+
+  NS_TEST_ASSERT_MSG_EQ (trie.Remove (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), 1),
+                         true, "Route not removed");
+  NS_TEST_ASSERT_MSG_EQ (trie.Remove (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), 1),
+                         false, "Route removed twice");
+  NS_TEST_ASSERT_MSG_EQ (trie.Remove (Ipv4Address ("10.1.2.3"), Ipv4Mask::GetOnes (), 3),
+                         true, "Route not removed");
+  NS_TEST_ASSERT_MSG_EQ (trie.Remove (Ipv4Address ("10.1.2.0"), Ipv4Mask ("255.0.255.0"), 6),
+                         true, "Route not removed");
+
+  routes.clear ();
+  trie.Lookup (Ipv4Address ("10.1.2.3"), routes);
+  NS_TEST_ASSERT_MSG_EQ (routes.size (), 3, "Three routes left for 10.1.2.3");
+  NS_TEST_ASSERT_MSG_EQ (routes[0], 2, "Default route not found");
+  NS_TEST_ASSERT_MSG_EQ (routes[1], 4, "10.0.0.0/8 not found");
+  NS_TEST_ASSERT_MSG_EQ (routes[2], 5, "10.1.0.0/16 not found");
+
+  trie.Clear ();
+  routes.clear ();
+  trie.Lookup (Ipv4Address ("10.1.2.3"), routes);
+  NS_TEST_ASSERT_MSG_EQ (routes.size (), 0, "Routes left after Clear");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4RouteTrie test against a linear scan of a route list
+ *
+ * Routes are randomly added and removed, and random destinations are
+ * looked up. The trie must return the same routes, in the same order, as
+ * a scan of the list with Ipv4Mask::IsMatch.
+ */
+class Ipv4RouteTrieRandomTestCase : public TestCase
+{
+public:
+  Ipv4RouteTrieRandomTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// A route in the reference list
+  struct Route
+  {
+    Ipv4Address network; //!< destination network
+    Ipv4Mask mask;       //!< network mask
+    uint32_t id;         //!< route identifier
+  };
+};
+
+Ipv4RouteTrieRandomTestCase::Ipv4RouteTrieRandomTestCase ()
+  : TestCase ("Lookup of random routes against a linear scan")
+{
+}
+
+void
+Ipv4RouteTrieRandomTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  Ipv4RouteTrie<uint32_t> trie;
+  std::list<Route> list;
+  uint32_t nextId = 0;
+
+  for (uint32_t step = 0; step < 4000; step++)
+    {
+      // addresses are drawn from a small space so that prefixes overlap
+      uint32_t address = (10 << 24) | rand->GetInteger (0, 0x3ff) << 10 | rand->GetInteger (0, 3);
+      uint32_t action = rand->GetInteger (0, 9);
+      if (action < 5 || list.empty ())
+        {
+          Route route;
+          uint32_t length = rand->GetInteger (0, 32);
+          route.mask = Ipv4Mask (length == 0 ? 0 : 0xffffffff << (32 - length));
+          if (rand->GetInteger (0, 49) == 0)
+            {
+              route.mask = Ipv4Mask ("255.0.255.0");
+            }
+          route.network = Ipv4Address (address).CombineMask (route.mask);
+          route.id = nextId++;
+          list.push_back (route);
+          trie.Insert (route.network, route.mask, route.id);
+        }
+      else if (action < 7)
+        {
+          std::list<Route>::iterator it = list.begin ();
+          std::advance (it, rand->GetInteger (0, list.size () - 1));
+          NS_TEST_ASSERT_MSG_EQ (trie.Remove (it->network, it->mask, it->id), true,
+                                 "Route " << it->id << " not found");
+          list.erase (it);
+        }
+      else
+        {
+          std::vector<uint32_t> expected;
+          for (std::list<Route>::const_iterator it = list.begin (); it != list.end (); it++)
+            {
+              if (it->mask.IsMatch (Ipv4Address (address), it->network))
+                {
+                  expected.push_back (it->id);
+                }
+            }
+          std::vector<uint32_t> routes;
+          trie.Lookup (Ipv4Address (address), routes);
+          NS_TEST_ASSERT_MSG_EQ (routes.size (), expected.size (),
+                                 "Wrong number of routes for " << Ipv4Address (address));
+          for (uint32_t i = 0; i < routes.size (); i++)
+            {
+              NS_TEST_ASSERT_MSG_EQ (routes[i], expected[i], "Wrong route for " << Ipv4Address (address));
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (trie.GetNRoutes (), list.size (), "Wrong number of routes");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4RouteTrie TestSuite
+ */
+class Ipv4RouteTrieTestSuite : public TestSuite
+{
+public:
+  Ipv4RouteTrieTestSuite () : TestSuite ("ipv4-route-trie", UNIT)
+  {
+    AddTestCase (new Ipv4RouteTrieBasicTestCase (), TestCase::QUICK);
+    AddTestCase (new Ipv4RouteTrieRandomTestCase (), TestCase::QUICK);
+  }
+};
+
+static Ipv4RouteTrieTestSuite g_ipv4RouteTrieTestSuite; //!< Static variable for test initialization
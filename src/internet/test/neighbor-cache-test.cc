@@ -0,0 +1,226 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/neighbor-cache-helper.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/arp-cache.h"
+#include "ns3/arp-l3-protocol.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/ndisc-cache.h"
+#include "ns3/icmpv6-l4-protocol.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief NeighborCacheHelper test on a LAN
+ *
+ * A few dual-stack nodes share a channel, and the first node sends UDP
+ * datagrams to the second one over IPv4 and IPv6, once at the beginning
+ * of the simulation and once after all the ARP and NDISC timeouts. The
+ * frames received by the nodes are counted by protocol.
+ *
+ * When the caches are populated by the helper (and Duplicate Address
+ * Detection is disabled) the entries must be permanent, and the only
+ * frames on the LAN must be the datagrams. Otherwise, address resolution
+ * must take place, which checks that the test can detect it.
+ */
+class NeighborCacheTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param populate whether the caches are populated by the helper
+   */
+  NeighborCacheTestCase (bool populate);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Count a received frame
+   * \param device the receiving device
+   * \param packet the frame payload
+   * \param protocol the protocol number
+   * \param from the source address
+   * \param to the destination address
+   * \param type the packet type
+   */
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType type);
+  /**
+   * \brief Send a datagram
+   * \param socket the sending socket
+   * \param to the destination
+   */
+  void Send (Ptr<Socket> socket, Address to);
+
+  bool m_populate;       //!< whether the caches are populated by the helper
+  uint32_t m_arpFrames;  //!< number of ARP frames received
+  uint32_t m_ipv4Frames; //!< number of IPv4 frames received
+  uint32_t m_ipv6Frames; //!< number of IPv6 frames received
+};
+
+NeighborCacheTestCase::NeighborCacheTestCase (bool populate)
+  : TestCase (populate ? "Static neighbor caches" : "Dynamic neighbor caches"),
+    m_populate (populate),
+    m_arpFrames (0),
+    m_ipv4Frames (0),
+    m_ipv6Frames (0)
+{
+}
+
+void
+NeighborCacheTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                const Address &from, const Address &to, NetDevice::PacketType type)
+{
+  if (protocol == ArpL3Protocol::PROT_NUMBER)
+    {
+      m_arpFrames++;
+    }
+  else if (protocol == Ipv4L3Protocol::PROT_NUMBER)
+    {
+      m_ipv4Frames++;
+    }
+  else if (protocol == Ipv6L3Protocol::PROT_NUMBER)
+    {
+      m_ipv6Frames++;
+    }
+}
+
+void
+NeighborCacheTestCase::Send (Ptr<Socket> socket, Address to)
+{
+  NS_TEST_EXPECT_MSG_EQ (socket->SendTo (Create<Packet> (100), 0, to), 100, "Datagram not sent");
+}
+
+void
+NeighborCacheTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      nodes.Get (i)->GetObject<Icmpv6L4Protocol> ()->SetAttribute ("DAD", BooleanValue (!m_populate));
+    }
+
+  SimpleNetDeviceHelper simple;
+  NetDeviceContainer devices = simple.Install (nodes);
+
+  Ipv4AddressHelper ipv4Address ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer ipv4Interfaces = ipv4Address.Assign (devices);
+  Ipv6AddressHelper ipv6Address (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  Ipv6InterfaceContainer ipv6Interfaces = ipv6Address.Assign (devices);
+
+  if (m_populate)
+    {
+      NeighborCacheHelper neighborCache;
+      neighborCache.PopulateNeighborCache ();
+
+      Ptr<Ipv4L3Protocol> ipv4 = nodes.Get (0)->GetObject<Ipv4L3Protocol> ();
+      Ptr<ArpCache> arpCache = ipv4->GetInterface (ipv4->GetInterfaceForDevice (devices.Get (0)))->GetArpCache ();
+      Ptr<Ipv6L3Protocol> ipv6 = nodes.Get (0)->GetObject<Ipv6L3Protocol> ();
+      Ptr<NdiscCache> ndiscCache = ipv6->GetInterface (ipv6->GetInterfaceForDevice (devices.Get (0)))->GetNdiscCache ();
+      for (uint32_t i = 1; i < nodes.GetN (); i++)
+        {
+          ArpCache::Entry *arpEntry = arpCache->Lookup (ipv4Interfaces.GetAddress (i));
+          NS_TEST_ASSERT_MSG_NE (arpEntry, 0, "No ARP entry for node " << i);
+          NS_TEST_ASSERT_MSG_EQ (arpEntry->IsPermanent (), true, "ARP entry not permanent");
+          NS_TEST_ASSERT_MSG_EQ (arpEntry->GetMacAddress (), devices.Get (i)->GetAddress (), "Wrong MAC address");
+
+          // the global and the link-local addresses
+          for (uint32_t j = 0; j < 2; j++)
+            {
+              NdiscCache::Entry *ndiscEntry = ndiscCache->Lookup (ipv6Interfaces.GetAddress (i, j));
+              NS_TEST_ASSERT_MSG_NE (ndiscEntry, 0, "No NDISC entry for node " << i);
+              NS_TEST_ASSERT_MSG_EQ (ndiscEntry->IsPermanent (), true, "NDISC entry not permanent");
+              NS_TEST_ASSERT_MSG_EQ (ndiscEntry->GetMacAddress (), devices.Get (i)->GetAddress (), "Wrong MAC address");
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (arpCache->Lookup (ipv4Interfaces.GetAddress (0)), 0, "Entry for the node itself");
+    }
+
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      nodes.Get (i)->RegisterProtocolHandler (MakeCallback (&NeighborCacheTestCase::Receive, this), 0, 0);
+    }
+
+  Ptr<Socket> rxSocket = Socket::CreateSocket (nodes.Get (1), UdpSocketFactory::GetTypeId ());
+  rxSocket->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), 1234));
+  Ptr<Socket> rxSocket4 = Socket::CreateSocket (nodes.Get (1), UdpSocketFactory::GetTypeId ());
+  rxSocket4->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+  Ptr<Socket> txSocket = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  Ptr<Socket> txSocket6 = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+
+  Address to4 = InetSocketAddress (ipv4Interfaces.GetAddress (1), 1234);
+  Address to6 = Inet6SocketAddress (ipv6Interfaces.GetAddress (1, 1), 1234);
+  // the second datagrams are sent after the entries would have expired
+  Simulator::Schedule (Seconds (1), &NeighborCacheTestCase::Send, this, txSocket, to4);
+  Simulator::Schedule (Seconds (1), &NeighborCacheTestCase::Send, this, txSocket6, to6);
+  Simulator::Schedule (Seconds (300), &NeighborCacheTestCase::Send, this, txSocket, to4);
+  Simulator::Schedule (Seconds (300), &NeighborCacheTestCase::Send, this, txSocket6, to6);
+  Simulator::Stop (Seconds (301));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_ipv4Frames, 2, "Wrong number of IPv4 frames");
+  if (m_populate)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_arpFrames, 0, "ARP frames with static caches");
+      NS_TEST_ASSERT_MSG_EQ (m_ipv6Frames, 2, "NDISC frames with static caches");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_GT (m_arpFrames, 0, "No ARP frames with dynamic caches");
+      NS_TEST_ASSERT_MSG_GT (m_ipv6Frames, 2, "No NDISC frames with dynamic caches");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief NeighborCacheHelper TestSuite
+ */
+class NeighborCacheTestSuite : public TestSuite
+{
+public:
+  NeighborCacheTestSuite () : TestSuite ("neighbor-cache", UNIT)
+  {
+    AddTestCase (new NeighborCacheTestCase (false), TestCase::QUICK);
+    AddTestCase (new NeighborCacheTestCase (true), TestCase::QUICK);
+  }
+};
+
+static NeighborCacheTestSuite g_neighborCacheTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-dctcp.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpDctcpTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Testing the estimate of the fraction of marked bytes on TcpDctcp
+ */
+class TcpDctcpAlphaTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor.
+   * \param segmentsMarked Segments ACKed with ECN-Echo in the window.
+   * \param segmentsAcked Segments ACKed in the window.
+   * \param name Test description.
+   */
+  TcpDctcpAlphaTest (uint32_t segmentsMarked, uint32_t segmentsAcked,
+                     const std::string &name);
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_segmentsMarked; //!< Segments ACKed with ECN-Echo.
+  uint32_t m_segmentsAcked;  //!< Segments ACKed.
+};
+
+TcpDctcpAlphaTest::TcpDctcpAlphaTest (uint32_t segmentsMarked,
+                                      uint32_t segmentsAcked,
+                                      const std::string &name)
+  : TestCase (name),
+    m_segmentsMarked (segmentsMarked),
+    m_segmentsAcked (segmentsAcked)
+{
+}
+
+void
+TcpDctcpAlphaTest::DoRun ()
+{
+  uint32_t segmentSize = 1000;
+  Ptr<TcpSocketState> state = CreateObject<TcpSocketState> ();
+  state->m_segmentSize = segmentSize;
+  state->m_cWnd = 10 * segmentSize;
+  state->m_nextTxSequence = SequenceNumber32 (1 + m_segmentsAcked * segmentSize);
+
+  Ptr<TcpDctcp> cong = CreateObject <TcpDctcp> ();
+  DoubleValue g;
+  cong->GetAttribute ("DctcpG", g);
+  double alpha = cong->GetAlpha ();
+
+  // one ACK per segment; the window ends with the last one
+  for (uint32_t i = 1; i <= m_segmentsAcked; ++i)
+    {
+      state->m_ackHasEce = (i <= m_segmentsMarked);
+      state->m_lastAckedSeq = SequenceNumber32 (1 + i * segmentSize);
+      cong->PktsAcked (state, 1, Time (0));
+      if (i < m_segmentsAcked)
+        {
+          NS_TEST_ASSERT_MSG_EQ_TOL (cong->GetAlpha (), alpha, 1e-9,
+                                     "Alpha updated before the end of the window");
+        }
+    }
+
+  double fraction = static_cast<double> (m_segmentsMarked) / m_segmentsAcked;
+  alpha = (1 - g.Get ()) * alpha + g.Get () * fraction;
+  NS_TEST_ASSERT_MSG_EQ_TOL (cong->GetAlpha (), alpha, 1e-9,
+                             "Alpha not updated at the end of the window");
+
+  uint32_t ssThresh = std::max (static_cast<uint32_t> ((1 - alpha / 2) * state->m_cWnd),
+                                2 * segmentSize);
+  NS_TEST_ASSERT_MSG_EQ (cong->GetSsThresh (state, state->m_cWnd), ssThresh,
+                         "DCTCP decrement fn not used");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Testing the receiver side of TcpDctcp: a change of the CE
+ * codepoint with a delayed ACK pending triggers an immediate ACK which
+ * echoes the previous codepoint.
+ */
+class TcpDctcpCeStateTest : public TestCase
+{
+public:
+  TcpDctcpCeStateTest ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Record an ACK sent through the TcpSocketState callback.
+   * \param flags the flags of the empty segment
+   */
+  void SendEmptyPacket (uint8_t flags);
+
+  Ptr<TcpSocketState> m_state;  //!< TCP socket state.
+  uint32_t m_acks;              //!< Number of ACKs sent.
+  bool m_lastAckEce;            //!< The last ACK would have carried ECN-Echo.
+};
+
+TcpDctcpCeStateTest::TcpDctcpCeStateTest ()
+  : TestCase ("DCTCP immediate ACK on CE state change"),
+    m_acks (0),
+    m_lastAckEce (false)
+{
+}
+
+void
+TcpDctcpCeStateTest::SendEmptyPacket (uint8_t flags)
+{
+  NS_TEST_ASSERT_MSG_EQ (flags, TcpHeader::ACK, "Only ACKs are expected");
+  m_acks++;
+  m_lastAckEce = (m_state->m_ecnState == TcpSocketState::ECN_CE_RCVD
+                  || m_state->m_ecnState == TcpSocketState::ECN_SENDING_ECE);
+}
+
+void
+TcpDctcpCeStateTest::DoRun ()
+{
+  m_state = CreateObject<TcpSocketState> ();
+  m_state->m_ecnState = TcpSocketState::ECN_IDLE;
+  m_state->m_sendEmptyPacketCallback = MakeCallback (&TcpDctcpCeStateTest::SendEmptyPacket, this);
+
+  Ptr<TcpDctcp> cong = CreateObject <TcpDctcp> ();
+
+  // No delayed ACK pending: no immediate ACK
+  cong->CwndEvent (m_state, TcpSocketState::CA_EVENT_ECN_IS_CE);
+  NS_TEST_ASSERT_MSG_EQ (m_acks, 0, "Unexpected ACK");
+  NS_TEST_ASSERT_MSG_EQ (m_state->m_ecnState.Get (), TcpSocketState::ECN_CE_RCVD, "CE not recorded");
+  cong->CwndEvent (m_state, TcpSocketState::CA_EVENT_NON_DELAYED_ACK);
+
+  // Same codepoint with a delayed ACK pending: no immediate ACK
+  cong->CwndEvent (m_state, TcpSocketState::CA_EVENT_DELAYED_ACK);
+  cong->CwndEvent (m_state, TcpSocketState::CA_EVENT_ECN_IS_CE);
+  NS_TEST_ASSERT_MSG_EQ (m_acks, 0, "Unexpected ACK");
+
+  // CE -> not CE with a delayed ACK pending: ACK echoing CE
+  cong->CwndEvent (m_state, TcpSocketState::CA_EVENT_ECN_NO_CE);
+  NS_TEST_ASSERT_MSG_EQ (m_acks, 1, "Missing immediate ACK");
+  NS_TEST_ASSERT_MSG_EQ (m_lastAckEce, true, "The ACK should echo CE");
+  NS_TEST_ASSERT_MSG_EQ (m_state->m_ecnState.Get (), TcpSocketState::ECN_IDLE, "ECN-Echo not cleared");
+
+  // not CE -> CE with a delayed ACK pending: ACK without ECN-Echo
+  cong->CwndEvent (m_state, TcpSocketState::CA_EVENT_DELAYED_ACK);
+  cong->CwndEvent (m_state, TcpSocketState::CA_EVENT_ECN_IS_CE);
+  NS_TEST_ASSERT_MSG_EQ (m_acks, 2, "Missing immediate ACK");
+  NS_TEST_ASSERT_MSG_EQ (m_lastAckEce, false, "The ACK should not echo CE");
+  NS_TEST_ASSERT_MSG_EQ (m_state->m_ecnState.Get (), TcpSocketState::ECN_CE_RCVD, "CE not recorded");
+
+  m_state->m_sendEmptyPacketCallback.Nullify ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TcpDctcp TestSuite.
+ */
+class TcpDctcpTestSuite : public TestSuite
+{
+public:
+  TcpDctcpTestSuite () : TestSuite ("tcp-dctcp-test", UNIT)
+  {
+    AddTestCase (new TcpDctcpAlphaTest (0, 10, "DCTCP alpha update, no marks"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpDctcpAlphaTest (5, 10, "DCTCP alpha update, half of the bytes marked"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpDctcpAlphaTest (10, 10, "DCTCP alpha update, all the bytes marked"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpDctcpCeStateTest (), TestCase::QUICK);
+  }
+};
+
+static TcpDctcpTestSuite g_tcpDctcpTest; //!< Static variable for test initialization
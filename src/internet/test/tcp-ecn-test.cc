@@ -0,0 +1,321 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-general-test.h"
+#include "ns3/error-model.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/boolean.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpEcnTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Error model which never drops, but sets CE on a data segment
+ *
+ * It behaves as an ECN-capable AQM would do: the segment is marked only
+ * if it is ECN-capable. The ECN codepoint of every data segment is counted.
+ */
+class TcpEcnMarkingErrorModel : public ErrorModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  TcpEcnMarkingErrorModel ();
+
+  /**
+   * \brief Set the sequence number of the segment to mark
+   * \param seq sequence number
+   */
+  void SetSeqToMark (SequenceNumber32 seq)
+  {
+    m_seqToMark = seq;
+  }
+
+  uint32_t m_ectData;    //!< Data segments received with ECT(0)
+  uint32_t m_notEctData; //!< Data segments received with Not-ECT
+  uint32_t m_marked;     //!< Data segments marked with CE
+
+private:
+  virtual bool DoCorrupt (Ptr<Packet> p);
+  virtual void DoReset (void);
+
+  SequenceNumber32 m_seqToMark; //!< Sequence number of the segment to mark
+};
+
+NS_OBJECT_ENSURE_REGISTERED (TcpEcnMarkingErrorModel);
+
+TypeId
+TcpEcnMarkingErrorModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpEcnMarkingErrorModel")
+    .SetParent<ErrorModel> ()
+    .AddConstructor<TcpEcnMarkingErrorModel> ()
+  ;
+  return tid;
+}
+
+TcpEcnMarkingErrorModel::TcpEcnMarkingErrorModel ()
+  : m_ectData (0),
+    m_notEctData (0),
+    m_marked (0),
+    m_seqToMark (0)
+{
+}
+
+bool
+TcpEcnMarkingErrorModel::DoCorrupt (Ptr<Packet> p)
+{
+  Ipv4Header ipHeader;
+  TcpHeader tcpHeader;
+  p->RemoveHeader (ipHeader);
+  uint32_t tcpSize = p->PeekHeader (tcpHeader);
+
+  if (p->GetSize () > tcpSize)
+    {
+      if (ipHeader.GetEcn () == Ipv4Header::ECN_ECT0)
+        {
+          ++m_ectData;
+          if (tcpHeader.GetSequenceNumber () == m_seqToMark && m_marked == 0)
+            {
+              ipHeader.SetEcn (Ipv4Header::ECN_CE);
+              ++m_marked;
+            }
+        }
+      else
+        {
+          ++m_notEctData;
+        }
+    }
+
+  p->AddHeader (ipHeader);
+  return false;
+}
+
+void
+TcpEcnMarkingErrorModel::DoReset (void)
+{
+  m_ectData = 0;
+  m_notEctData = 0;
+  m_marked = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the ECN negotiation and the reaction to a CE mark (RFC 3168)
+ *
+ * A single data segment is marked with CE on its way to the receiver. If
+ * ECN is negotiated, the receiver must echo ECE until the sender sets CWR,
+ * and the sender must reduce its window exactly once, without any
+ * retransmission. If ECN is not negotiated by both ends, no segment is
+ * ECN-capable and the window is never reduced.
+ */
+class TcpEcnTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor.
+   * \param senderEcn the sender has UseEcn set
+   * \param receiverEcn the receiver has UseEcn set
+   * \param desc Test description.
+   */
+  TcpEcnTest (bool senderEcn, bool receiverEcn, const std::string &desc);
+
+protected:
+  virtual Ptr<ErrorModel> CreateReceiverErrorModel ();
+  virtual void ConfigureEnvironment ();
+  virtual void ConfigureProperties ();
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void Rx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void CongStateTrace (const TcpSocketState::TcpCongState_t oldValue,
+                               const TcpSocketState::TcpCongState_t newValue);
+  virtual void FinalChecks ();
+
+private:
+  bool m_senderEcn;     //!< UseEcn on the sender
+  bool m_receiverEcn;   //!< UseEcn on the receiver
+  bool m_cwrReceived;   //!< The receiver got a segment with CWR
+  uint32_t m_eceSent;   //!< ACKs sent by the receiver with ECE
+  uint32_t m_cwrSent;   //!< Segments sent by the sender with CWR
+  uint32_t m_cwrEntered; //!< Times the sender entered CA_CWR
+  uint32_t m_lossEntered; //!< Times the sender entered CA_RECOVERY or CA_LOSS
+  SequenceNumber32 m_seqToMark; //!< Sequence number of the marked segment
+  Ptr<TcpEcnMarkingErrorModel> m_errorModel; //!< Marking error model
+};
+
+TcpEcnTest::TcpEcnTest (bool senderEcn, bool receiverEcn, const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_senderEcn (senderEcn),
+    m_receiverEcn (receiverEcn),
+    m_cwrReceived (false),
+    m_eceSent (0),
+    m_cwrSent (0),
+    m_cwrEntered (0),
+    m_lossEntered (0),
+    m_seqToMark (1 + 500 * 3)
+{
+}
+
+void
+TcpEcnTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktCount (20);
+}
+
+void
+TcpEcnTest::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  GetSenderSocket ()->SetAttribute ("UseEcn", BooleanValue (m_senderEcn));
+  GetReceiverSocket ()->SetAttribute ("UseEcn", BooleanValue (m_receiverEcn));
+}
+
+Ptr<ErrorModel>
+TcpEcnTest::CreateReceiverErrorModel ()
+{
+  m_errorModel = CreateObject<TcpEcnMarkingErrorModel> ();
+  m_errorModel->SetSeqToMark (m_seqToMark);
+  return m_errorModel;
+}
+
+void
+TcpEcnTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  uint8_t flags = h.GetFlags ();
+  bool negotiated = m_senderEcn && m_receiverEcn;
+
+  if (who == SENDER && (flags & TcpHeader::SYN))
+    {
+      NS_TEST_ASSERT_MSG_EQ (((flags & TcpHeader::ECE) && (flags & TcpHeader::CWR)), m_senderEcn,
+                             "SYN is an ECN-setup SYN only if UseEcn is set");
+    }
+  else if (who == RECEIVER && (flags & TcpHeader::SYN))
+    {
+      NS_TEST_ASSERT_MSG_EQ (((flags & TcpHeader::ECE) != 0), negotiated,
+                             "SYN-ACK must carry ECE only when ECN is negotiated");
+      NS_TEST_ASSERT_MSG_EQ ((flags & TcpHeader::CWR), 0, "SYN-ACK must not carry CWR");
+    }
+  else if (who == RECEIVER && (flags & TcpHeader::ECE))
+    {
+      NS_TEST_ASSERT_MSG_EQ (negotiated, true, "ECE sent without ECN");
+      NS_TEST_ASSERT_MSG_EQ (m_cwrReceived, false, "ECE sent after CWR was received");
+      ++m_eceSent;
+    }
+  else if (who == SENDER && (flags & TcpHeader::CWR))
+    {
+      NS_TEST_ASSERT_MSG_EQ (negotiated, true, "CWR sent without ECN");
+      NS_TEST_ASSERT_MSG_GT (h.GetSequenceNumber (), m_seqToMark,
+                             "CWR must be set on new data");
+      ++m_cwrSent;
+    }
+}
+
+void
+TcpEcnTest::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == RECEIVER && (h.GetFlags () & TcpHeader::CWR)
+      && !(h.GetFlags () & TcpHeader::SYN))
+    {
+      m_cwrReceived = true;
+    }
+}
+
+void
+TcpEcnTest::CongStateTrace (const TcpSocketState::TcpCongState_t oldValue,
+                            const TcpSocketState::TcpCongState_t newValue)
+{
+  if (newValue == TcpSocketState::CA_CWR)
+    {
+      ++m_cwrEntered;
+    }
+  else if (newValue == TcpSocketState::CA_RECOVERY || newValue == TcpSocketState::CA_LOSS)
+    {
+      ++m_lossEntered;
+    }
+}
+
+void
+TcpEcnTest::FinalChecks ()
+{
+  bool negotiated = m_senderEcn && m_receiverEcn;
+  uint32_t dataSegments = GetPktCount ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_lossEntered, 0, "No loss recovery expected");
+
+  if (negotiated)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_errorModel->m_notEctData, 0,
+                             "All data segments must be ECN-capable");
+      NS_TEST_ASSERT_MSG_EQ (m_errorModel->m_ectData, dataSegments,
+                             "All data segments must be ECN-capable");
+      NS_TEST_ASSERT_MSG_EQ (m_errorModel->m_marked, 1, "One segment should be marked");
+      NS_TEST_ASSERT_MSG_GT (m_eceSent, 0, "The receiver never echoed the mark");
+      NS_TEST_ASSERT_MSG_EQ (m_cwrSent, 1, "CWR must be sent exactly once");
+      NS_TEST_ASSERT_MSG_EQ (m_cwrReceived, true, "CWR never received");
+      NS_TEST_ASSERT_MSG_EQ (m_cwrEntered, 1, "The window must be reduced exactly once");
+      NS_TEST_ASSERT_MSG_LT (GetTcb (SENDER)->m_ssThresh.Get (), UINT32_MAX,
+                             "ssThresh not reduced");
+      NS_TEST_ASSERT_MSG_NE (GetTcb (SENDER)->m_ecnState.Get (),
+                             TcpSocketState::ECN_DISABLED, "ECN not negotiated");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_errorModel->m_ectData, 0,
+                             "Data segments are ECN-capable without ECN");
+      NS_TEST_ASSERT_MSG_EQ (m_errorModel->m_notEctData, dataSegments,
+                             "Missing data segments");
+      NS_TEST_ASSERT_MSG_EQ (m_eceSent + m_cwrSent + m_cwrEntered, 0,
+                             "ECN signals without ECN");
+      NS_TEST_ASSERT_MSG_EQ (GetTcb (SENDER)->m_ssThresh.Get (), UINT32_MAX,
+                             "ssThresh reduced without congestion");
+      NS_TEST_ASSERT_MSG_EQ (GetTcb (SENDER)->m_ecnState.Get (),
+                             TcpSocketState::ECN_DISABLED, "ECN wrongly negotiated");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP ECN TestSuite
+ */
+class TcpEcnTestSuite : public TestSuite
+{
+public:
+  TcpEcnTestSuite () : TestSuite ("tcp-ecn-test", UNIT)
+  {
+    AddTestCase (new TcpEcnTest (true, true, "ECN negotiated, CE echoed and CWR sent"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpEcnTest (true, false, "ECN not supported by the receiver"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpEcnTest (false, true, "ECN not requested by the sender"),
+                 TestCase::QUICK);
+  }
+};
+
+static TcpEcnTestSuite g_tcpEcnTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,506 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "tcp-general-test.h"
+#include "tcp-error-model.h"
+#include "ns3/error-model.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/node.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/log.h"
+#include <set>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpPacingGsoTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Error model which never drops, but checks the segments on the wire
+ *
+ * Every packet sent by the sender must fit the segment size, data must
+ * arrive in sequence and the IP identification must grow by one for each
+ * datagram.
+ */
+class TcpGsoCheckErrorModel : public ErrorModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  TcpGsoCheckErrorModel ();
+
+  uint32_t m_segmentSize;   //!< Expected segment size
+  uint32_t m_dataSegments;  //!< Data segments received
+  uint32_t m_dataBytes;     //!< Data bytes received
+  uint32_t m_tooBig;        //!< Segments larger than the segment size
+  uint32_t m_outOfOrder;    //!< Data segments not in sequence
+  uint32_t m_badId;         //!< Datagrams with an unexpected identification
+
+private:
+  virtual bool DoCorrupt (Ptr<Packet> p);
+  virtual void DoReset (void);
+
+  bool m_first;                  //!< No datagram received yet
+  uint16_t m_lastId;             //!< Identification of the last datagram
+  SequenceNumber32 m_nextSeq;    //!< Next expected data sequence number
+};
+
+NS_OBJECT_ENSURE_REGISTERED (TcpGsoCheckErrorModel);
+
+TypeId
+TcpGsoCheckErrorModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpGsoCheckErrorModel")
+    .SetParent<ErrorModel> ()
+    .AddConstructor<TcpGsoCheckErrorModel> ()
+  ;
+  return tid;
+}
+
+TcpGsoCheckErrorModel::TcpGsoCheckErrorModel ()
+  : m_segmentSize (500),
+    m_dataSegments (0),
+    m_dataBytes (0),
+    m_tooBig (0),
+    m_outOfOrder (0),
+    m_badId (0),
+    m_first (true),
+    m_lastId (0),
+    m_nextSeq (1)
+{
+}
+
+bool
+TcpGsoCheckErrorModel::DoCorrupt (Ptr<Packet> p)
+{
+  Ipv4Header ipHeader;
+  TcpHeader tcpHeader;
+  p->RemoveHeader (ipHeader);
+  uint32_t tcpSize = p->PeekHeader (tcpHeader);
+  uint32_t dataSize = p->GetSize () - tcpSize;
+
+  if (!m_first && ipHeader.GetIdentification () != static_cast<uint16_t> (m_lastId + 1))
+    {
+      ++m_badId;
+    }
+  m_first = false;
+  m_lastId = ipHeader.GetIdentification ();
+
+  if (dataSize > 0)
+    {
+      ++m_dataSegments;
+      m_dataBytes += dataSize;
+      if (dataSize > m_segmentSize)
+        {
+          ++m_tooBig;
+        }
+      if (tcpHeader.GetSequenceNumber () != m_nextSeq)
+        {
+          ++m_outOfOrder;
+        }
+      m_nextSeq = tcpHeader.GetSequenceNumber () + dataSize;
+    }
+
+  p->AddHeader (ipHeader);
+  return false;
+}
+
+void
+TcpGsoCheckErrorModel::DoReset (void)
+{
+  m_dataSegments = 0;
+  m_dataBytes = 0;
+  m_tooBig = 0;
+  m_outOfOrder = 0;
+  m_badId = 0;
+  m_first = true;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the emission of GSO super-segments
+ *
+ * The sender is allowed to build super-segments of up to four segments.
+ * They must be seen as such by the TCP Tx trace, but they must be split,
+ * by the traffic control layer or by the root queue disc, before reaching
+ * the device, so that the receiver only gets MSS-sized segments, in
+ * sequence, each in its own datagram.
+ */
+class TcpGsoTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor.
+   * \param queueDisc keep the root queue disc on the sender device
+   * \param desc Test description.
+   */
+  TcpGsoTest (bool queueDisc, const std::string &desc);
+
+protected:
+  virtual Ptr<ErrorModel> CreateReceiverErrorModel ();
+  virtual void ConfigureEnvironment ();
+  virtual void ConfigureProperties ();
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void FinalChecks ();
+
+private:
+  bool m_queueDisc;          //!< Keep the root queue disc on the sender device
+  uint32_t m_superSegments;  //!< Super-segments sent
+  uint32_t m_maxSize;        //!< Largest segment sent
+  Ptr<TcpGsoCheckErrorModel> m_errorModel; //!< Checking error model
+};
+
+TcpGsoTest::TcpGsoTest (bool queueDisc, const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_queueDisc (queueDisc),
+    m_superSegments (0),
+    m_maxSize (0)
+{
+}
+
+void
+TcpGsoTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktSize (5000);
+  SetAppPktCount (10);
+}
+
+void
+TcpGsoTest::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetInitialCwnd (SENDER, 10);
+  GetSenderSocket ()->SetAttribute ("GsoMaxSegments", UintegerValue (4));
+
+  // a root queue disc is installed on the devices by the address helper
+  if (!m_queueDisc)
+    {
+      TrafficControlHelper tch;
+      tch.Uninstall (GetSenderSocket ()->GetNode ()->GetDevice (1));
+    }
+}
+
+Ptr<ErrorModel>
+TcpGsoTest::CreateReceiverErrorModel ()
+{
+  m_errorModel = CreateObject<TcpGsoCheckErrorModel> ();
+  return m_errorModel;
+}
+
+void
+TcpGsoTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == SENDER)
+    {
+      uint32_t size = p->GetSize ();
+      m_maxSize = std::max (m_maxSize, size);
+      if (size > GetSegSize (SENDER))
+        {
+          ++m_superSegments;
+        }
+    }
+}
+
+void
+TcpGsoTest::FinalChecks ()
+{
+  uint32_t bytes = GetPktSize () * GetPktCount ();
+
+  NS_TEST_ASSERT_MSG_GT (m_superSegments, 0, "No super-segment sent");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (m_maxSize, 4 * GetSegSize (SENDER),
+                               "Super-segment larger than GsoMaxSegments");
+  NS_TEST_ASSERT_MSG_EQ (m_errorModel->m_tooBig, 0,
+                         "Super-segment not split before the device");
+  NS_TEST_ASSERT_MSG_EQ (m_errorModel->m_outOfOrder, 0, "Data not in sequence");
+  NS_TEST_ASSERT_MSG_EQ (m_errorModel->m_badId, 0,
+                         "IP identification not increased by one per datagram");
+  NS_TEST_ASSERT_MSG_EQ (m_errorModel->m_dataBytes, bytes, "Data bytes lost");
+  NS_TEST_ASSERT_MSG_EQ (m_errorModel->m_dataSegments, bytes / GetSegSize (SENDER),
+                         "Unexpected number of segments on the wire");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the recovery of segments lost from a GSO super-segment
+ *
+ * The second and the fourth segments of the first super-segment are lost.
+ * The SACK blocks of the receiver, which only sees MSS-sized segments,
+ * must be matched against the scoreboard of the sender, so that the lost
+ * segments are retransmitted during the fast recovery, and none of the
+ * segments which the receiver already got.
+ */
+class TcpGsoSackTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor.
+   * \param desc Test description.
+   */
+  TcpGsoSackTest (const std::string &desc);
+
+protected:
+  virtual Ptr<ErrorModel> CreateReceiverErrorModel ();
+  virtual void ConfigureEnvironment ();
+  virtual void ConfigureProperties ();
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void Rx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void AfterRTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who);
+  virtual void FinalChecks ();
+
+private:
+  uint32_t m_segmentSize;      //!< Segment size
+  uint32_t m_firstSize;        //!< Size of the first data segment sent
+  uint32_t m_retxBytes;        //!< Bytes retransmitted
+  uint32_t m_spuriousRetx;     //!< Segments retransmitted after being received
+  std::set<SequenceNumber32> m_received; //!< Segments received by the receiver
+  uint32_t m_rtoExpired;       //!< Retransmission timeouts
+  SequenceNumber32 m_highTx;   //!< Highest sequence number sent
+};
+
+TcpGsoSackTest::TcpGsoSackTest (const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_segmentSize (500),
+    m_firstSize (0),
+    m_retxBytes (0),
+    m_spuriousRetx (0),
+    m_rtoExpired (0),
+    m_highTx (0)
+{
+}
+
+void
+TcpGsoSackTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktSize (5000);
+  SetAppPktCount (10);
+}
+
+void
+TcpGsoSackTest::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetSegmentSize (SENDER, m_segmentSize);
+  SetSegmentSize (RECEIVER, m_segmentSize);
+  SetInitialCwnd (SENDER, 10);
+  GetSenderSocket ()->SetAttribute ("GsoMaxSegments", UintegerValue (4));
+}
+
+Ptr<ErrorModel>
+TcpGsoSackTest::CreateReceiverErrorModel ()
+{
+  Ptr<TcpSeqErrorModel> errorModel = CreateObject<TcpSeqErrorModel> ();
+  errorModel->AddSeqToKill (SequenceNumber32 (1 + m_segmentSize));
+  errorModel->AddSeqToKill (SequenceNumber32 (1 + 3 * m_segmentSize));
+  return errorModel;
+}
+
+void
+TcpGsoSackTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who != SENDER || p->GetSize () == 0)
+    {
+      return;
+    }
+
+  if (m_firstSize == 0)
+    {
+      m_firstSize = p->GetSize ();
+    }
+  SequenceNumber32 end = h.GetSequenceNumber () + p->GetSize ();
+  if (h.GetSequenceNumber () < m_highTx)
+    {
+      m_retxBytes += std::min (end, m_highTx) - h.GetSequenceNumber ();
+      for (SequenceNumber32 seq = h.GetSequenceNumber (); seq < end; seq += m_segmentSize)
+        {
+          if (m_received.count (seq) > 0)
+            {
+              ++m_spuriousRetx;
+            }
+        }
+    }
+  m_highTx = std::max (m_highTx, end);
+}
+
+void
+TcpGsoSackTest::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == RECEIVER && p->GetSize () > 0)
+    {
+      m_received.insert (h.GetSequenceNumber ());
+    }
+}
+
+void
+TcpGsoSackTest::AfterRTOExpired (const Ptr<const TcpSocketState> tcb, SocketWho who)
+{
+  if (who == SENDER)
+    {
+      ++m_rtoExpired;
+    }
+}
+
+void
+TcpGsoSackTest::FinalChecks ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_firstSize, 4 * m_segmentSize, "First data segment not a super-segment");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (m_retxBytes, 2 * m_segmentSize, "Lost segments not retransmitted");
+  NS_TEST_ASSERT_MSG_EQ (m_spuriousRetx, 0, "Segments received by the peer retransmitted");
+  NS_TEST_ASSERT_MSG_EQ (m_rtoExpired, 0, "Losses not recovered by the fast recovery");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that pacing spaces the transmission of data segments
+ *
+ * With pacing each data segment is sent at least size / rate after the
+ * previous one, where rate is the pacing rate in force when the previous
+ * segment was sent. Without pacing, the segments allowed by the initial
+ * window leave back to back.
+ */
+class TcpPacingTest : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor.
+   * \param pacing enable pacing on the sender
+   * \param desc Test description.
+   */
+  TcpPacingTest (bool pacing, const std::string &desc);
+
+protected:
+  virtual void ConfigureEnvironment ();
+  virtual void ConfigureProperties ();
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+  virtual void FinalChecks ();
+
+private:
+  bool m_pacing;            //!< Pacing enabled on the sender
+  uint32_t m_dataSent;      //!< Data segments sent
+  uint32_t m_backToBack;    //!< Data segments sent at the time of the previous one
+  uint32_t m_tooEarly;      //!< Data segments sent before the pacing gap
+  Time m_lastTx;            //!< Time of the last data segment
+  Time m_minGap;            //!< Pacing gap after the last data segment
+};
+
+TcpPacingTest::TcpPacingTest (bool pacing, const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_pacing (pacing),
+    m_dataSent (0),
+    m_backToBack (0),
+    m_tooEarly (0)
+{
+}
+
+void
+TcpPacingTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktSize (500);
+  SetAppPktCount (40);
+  SetAppPktInterval (Time (0));
+  SetPropagationDelay (MilliSeconds (50));
+}
+
+void
+TcpPacingTest::ConfigureProperties ()
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetInitialCwnd (SENDER, 10);
+  GetSenderSocket ()->SetAttribute ("Pacing", BooleanValue (m_pacing));
+}
+
+void
+TcpPacingTest::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who != SENDER || p->GetSize () == 0)
+    {
+      return;
+    }
+
+  if (m_dataSent > 0)
+    {
+      if (Simulator::Now () == m_lastTx)
+        {
+          ++m_backToBack;
+        }
+      if (Simulator::Now () - m_lastTx < m_minGap)
+        {
+          ++m_tooEarly;
+        }
+    }
+
+  ++m_dataSent;
+  m_lastTx = Simulator::Now ();
+  m_minGap = GetTcb (SENDER)->m_pacingRate.CalculateBytesTxTime (p->GetSize ());
+}
+
+void
+TcpPacingTest::FinalChecks ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_dataSent, GetPktCount (), "Unexpected retransmissions");
+
+  if (m_pacing)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_backToBack, 0, "Segments sent back to back with pacing");
+      NS_TEST_ASSERT_MSG_EQ (m_tooEarly, 0, "Segments sent before the pacing gap");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_GT (m_backToBack, 0, "Segments never sent back to back");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TCP pacing and GSO TestSuite
+ */
+class TcpPacingGsoTestSuite : public TestSuite
+{
+public:
+  TcpPacingGsoTestSuite () : TestSuite ("tcp-pacing-gso-test", UNIT)
+  {
+    AddTestCase (new TcpGsoTest (false, "GSO super-segments split by the traffic control layer"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpGsoTest (true, "GSO super-segments split by the root queue disc"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpGsoSackTest ("Segments lost from a GSO super-segment recovered with SACK"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpPacingTest (true, "Pacing spaces data segments"),
+                 TestCase::QUICK);
+    AddTestCase (new TcpPacingTest (false, "No pacing, data segments sent in bursts"),
+                 TestCase::QUICK);
+  }
+};
+
+static TcpPacingGsoTestSuite g_tcpPacingGsoTestSuite; //!< Static variable for test initialization
@@ -18,6 +18,7 @@
 #include "ns3/test.h"
 #include "ns3/packet.h"
 #include "ns3/log.h"
+#include "ns3/random-variable-stream.h"
 
 #include "ns3/tcp-rx-buffer.h"
 
@@ -34,7 +35,11 @@ NS_LOG_COMPONENT_DEFINE ("TcpRxBufferTestSuite");
 class TcpRxBufferTestCase : public TestCase
 {
 public:
-  TcpRxBufferTestCase ();
+  /**
+   * \brief Constructor
+   * \param ringBuffer true to test the ring buffer mode
+   */
+  TcpRxBufferTestCase (bool ringBuffer);
 
 private:
   virtual void DoRun (void);
@@ -44,10 +49,30 @@ private:
    * \brief Test the SACK list update.
    */
   void TestUpdateSACKList ();
+
+  /**
+   * \brief Compare the buffer with one in the other mode, with random segments
+   *
+   * \param aligned true if the segments are always the same, as sent by a
+   * TCP sender with a fixed segment size, false if they overlap partially
+   */
+  void TestRandomSegments (bool aligned);
+
+  /**
+   * \brief Add a segment with known payload to a buffer
+   * \param rxBuf the buffer
+   * \param head the sequence number of the segment
+   * \param length the segment size
+   * \returns the value returned by TcpRxBuffer::Add
+   */
+  bool AddSegment (TcpRxBuffer &rxBuf, SequenceNumber32 head, uint32_t length);
+
+  bool m_ringBuffer; //!< Test the ring buffer mode
 };
 
-TcpRxBufferTestCase::TcpRxBufferTestCase ()
-  : TestCase ("TcpRxBuffer Test")
+TcpRxBufferTestCase::TcpRxBufferTestCase (bool ringBuffer)
+  : TestCase (ringBuffer ? "TcpRxBuffer Test, ring buffer" : "TcpRxBuffer Test"),
+    m_ringBuffer (ringBuffer)
 {
 }
 
@@ -55,12 +80,115 @@ void
 TcpRxBufferTestCase::DoRun ()
 {
   TestUpdateSACKList ();
+  TestRandomSegments (true);
+  TestRandomSegments (false);
+}
+
+bool
+TcpRxBufferTestCase::AddSegment (TcpRxBuffer &rxBuf, SequenceNumber32 head, uint32_t length)
+{
+  // every byte holds the low octet of its sequence number
+  std::vector<uint8_t> data (length);
+  for (uint32_t i = 0; i < length; ++i)
+    {
+      data[i] = static_cast<uint8_t> ((head + SequenceNumber32 (i)).GetValue ());
+    }
+  TcpHeader h;
+  h.SetSequenceNumber (head);
+  return rxBuf.Add (Create<Packet> (&data[0], length), h);
+}
+
+void
+TcpRxBufferTestCase::TestRandomSegments (bool aligned)
+{
+  const uint32_t segSize = 100;
+  const uint32_t maxBuffer = 3000;
+  TcpRxBuffer rxBuf;
+  TcpRxBuffer refBuf;
+  rxBuf.SetRingBuffer (m_ringBuffer);
+  refBuf.SetRingBuffer (!m_ringBuffer);
+  SequenceNumber32 isn (0xfffff000); // wrap around the sequence space
+  rxBuf.SetNextRxSequence (isn);
+  refBuf.SetNextRxSequence (isn);
+  rxBuf.SetMaxBufferSize (maxBuffer);
+  refBuf.SetMaxBufferSize (maxBuffer);
+
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  rand->SetStream (1);
+  SequenceNumber32 delivered = isn;
+  for (uint32_t step = 0; step < 5000; ++step)
+    {
+      NS_TEST_ASSERT_MSG_EQ (rxBuf.MaxRxSequence (), refBuf.MaxRxSequence (),
+                             "Receive windows differ at step " << step);
+      if (rand->GetInteger (0, 3) == 0)
+        {
+          uint32_t maxSize = rand->GetInteger (1, maxBuffer);
+          Ptr<Packet> p = rxBuf.Extract (maxSize);
+          Ptr<Packet> ref = refBuf.Extract (maxSize);
+          uint32_t size = p ? p->GetSize () : 0;
+          NS_TEST_ASSERT_MSG_EQ (size, ref ? ref->GetSize () : 0,
+                                 "Extracted sizes differ at step " << step);
+          if (size > 0)
+            {
+              std::vector<uint8_t> data (size);
+              p->CopyData (&data[0], size);
+              for (uint32_t i = 0; i < size; ++i)
+                {
+                  uint8_t expected = static_cast<uint8_t> ((delivered + SequenceNumber32 (i)).GetValue ());
+                  NS_TEST_ASSERT_MSG_EQ (data[i], expected, "Wrong byte extracted at step " << step);
+                }
+              delivered += size;
+            }
+          continue;
+        }
+
+      // a segment in the receive window, possibly already received
+      uint32_t window = refBuf.MaxRxSequence () - refBuf.NextRxSequence ();
+      if (window == 0)
+        {
+          continue;
+        }
+      SequenceNumber32 head = refBuf.NextRxSequence () + SequenceNumber32 (rand->GetInteger (0, window - 1));
+      uint32_t length;
+      if (aligned)
+        {
+          head = head - SequenceNumber32 ((head - isn) % segSize);
+          length = segSize;
+        }
+      else
+        {
+          head = head - SequenceNumber32 (rand->GetInteger (0, 50));
+          length = rand->GetInteger (1, 3 * segSize);
+        }
+      length = std::min (length, static_cast<uint32_t> (refBuf.MaxRxSequence () - head));
+
+      bool added = AddSegment (rxBuf, head, length);
+      bool refAdded = AddSegment (refBuf, head, length);
+      NS_TEST_ASSERT_MSG_EQ (added, refAdded, "Add results differ at step " << step);
+      NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), refBuf.NextRxSequence (),
+                             "Next sequences differ at step " << step);
+      NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), refBuf.Size (),
+                             "Sizes differ at step " << step);
+      NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), refBuf.Available (),
+                             "Available bytes differ at step " << step);
+      if (aligned)
+        {
+          // partial overlaps may be split differently in the SACK blocks
+          TcpOptionSack::SackList sackList = rxBuf.GetSackList ();
+          TcpOptionSack::SackList refList = refBuf.GetSackList ();
+          NS_TEST_ASSERT_MSG_EQ (sackList.size (), refList.size (),
+                                 "SACK lists differ at step " << step);
+          NS_TEST_ASSERT_MSG_EQ ((sackList == refList), true,
+                                 "SACK lists differ at step " << step);
+        }
+    }
 }
 
 void
 TcpRxBufferTestCase::TestUpdateSACKList ()
 {
   TcpRxBuffer rxBuf;
+  rxBuf.SetRingBuffer (m_ringBuffer);
   TcpOptionSack::SackList sackList;
   TcpOptionSack::SackList::iterator it;
   Ptr<Packet> p = Create<Packet> (100);
@@ -356,7 +484,8 @@ public:
   TcpRxBufferTestSuite ()
     : TestSuite ("tcp-rx-buffer", UNIT)
   {
-    AddTestCase (new TcpRxBufferTestCase, TestCase::QUICK);
+    AddTestCase (new TcpRxBufferTestCase (false), TestCase::QUICK);
+    AddTestCase (new TcpRxBufferTestCase (true), TestCase::QUICK);
   }
 };
 static TcpRxBufferTestSuite  g_tcpRxBufferTestSuite;
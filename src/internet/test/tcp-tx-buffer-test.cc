@@ -20,6 +20,8 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/random-variable-stream.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -49,6 +51,8 @@ private:
   void TestNextSeg ();
   /** \brief Test the scoreboard with emulated SACK */
   void TestUpdateScoreboardWithCraftedSACK ();
+  /** \brief Test the scoreboard counters against the RFC 6675 definitions */
+  void TestScoreboardCounters ();
 };
 
 TcpTxBufferTestCase::TcpTxBufferTestCase ()
@@ -82,6 +86,8 @@ TcpTxBufferTestCase::DoRun ()
                        &TcpTxBufferTestCase::TestNextSeg, this);
   Simulator::Schedule (Seconds (0.0),
                        &TcpTxBufferTestCase::TestUpdateScoreboardWithCraftedSACK, this);
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestScoreboardCounters, this);
 
   Simulator::Run ();
   Simulator::Destroy ();
@@ -395,6 +401,135 @@ TcpTxBufferTestCase::TestTransmittedBlock ()
 {
 }
 
+void
+TcpTxBufferTestCase::TestScoreboardCounters ()
+{
+  TcpTxBuffer txBuf;
+  SequenceNumber32 head (1);
+  uint32_t dupThresh = 3;
+  uint32_t segmentSize = 100;
+  uint32_t nSegments = 200;
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  rand->SetStream (1);
+
+  // Per segment state, as the RFC sees it
+  std::vector<bool> sacked (nSegments, false);
+  std::vector<bool> retrans (nSegments, false);
+  std::vector<bool> lost (nSegments, false);
+  uint32_t first = 0; // first segment not cumulatively ACKed
+
+  txBuf.SetHeadSequence (head);
+  txBuf.Add (Create<Packet> (nSegments * segmentSize));
+  for (uint32_t i = 0; i < nSegments; ++i)
+    {
+      txBuf.CopyFromSequence (segmentSize, head + i * segmentSize);
+    }
+
+  for (uint32_t step = 0; step < 2000 && first < nSegments; ++step)
+    {
+      uint32_t op = rand->GetInteger (0, 99);
+      uint32_t i = rand->GetInteger (first, nSegments - 1);
+      SequenceNumber32 seq = head + i * segmentSize;
+
+      if (op < 60 && i > first)
+        {
+          TcpOptionSack::SackList list;
+          list.push_back (TcpOptionSack::SackBlock (seq, seq + segmentSize));
+          txBuf.Update (list);
+          sacked[i] = true;
+        }
+      else if (op < 90)
+        {
+          txBuf.CopyFromSequence (segmentSize, seq);
+          retrans[i] = true;
+          lost[i] = false;
+        }
+      else if (op < 99)
+        {
+          uint32_t acked = std::min (first + rand->GetInteger (1, 5), nSegments);
+          txBuf.DiscardUpTo (head + acked * segmentSize);
+          first = acked;
+          if (first < nSegments)
+            {
+              sacked[first] = false; // the head can not be SACKed
+            }
+        }
+      else
+        {
+          txBuf.SetSentListLost ();
+          for (uint32_t j = first; j < nSegments; ++j)
+            {
+              lost[j] = true;
+            }
+        }
+
+      // RFC 6675 definitions, computed the slow way
+      uint32_t pipe = 0;
+      uint32_t sackedBytes = 0;
+      uint32_t lostBytes = 0;
+      bool rule1 = false;
+      bool rule3 = false;
+      SequenceNumber32 next;
+      SequenceNumber32 nextPerRule3;
+      for (uint32_t j = first; j < nSegments; ++j)
+        {
+          SequenceNumber32 s = head + j * segmentSize;
+          if (sacked[j])
+            {
+              sackedBytes += segmentSize;
+              continue;
+            }
+          uint32_t count = 0;
+          for (uint32_t k = j + 1; k < nSegments; ++k)
+            {
+              count += sacked[k] ? 1 : 0;
+            }
+          bool isLost = lost[j] || count >= dupThresh
+            || count * segmentSize > (dupThresh - 1) * segmentSize;
+          if (!isLost || (retrans[j] && !lost[j]))
+            {
+              pipe += segmentSize;
+            }
+          if (isLost)
+            {
+              lostBytes += segmentSize;
+            }
+          if (!retrans[j] && !rule1)
+            {
+              if (isLost)
+                {
+                  rule1 = true;
+                  next = s;
+                }
+              else if (!rule3)
+                {
+                  rule3 = true;
+                  nextPerRule3 = s;
+                }
+            }
+          NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (s, dupThresh, segmentSize),
+                                 isLost && count > 0,
+                                 "IsLost differs at step " << step << " for " << s);
+        }
+
+      NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (dupThresh, segmentSize), pipe,
+                             "BytesInFlight differs at step " << step);
+      NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), sackedBytes,
+                             "GetSacked differs at step " << step);
+      NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (dupThresh, segmentSize), lostBytes,
+                             "GetLost differs at step " << step);
+
+      SequenceNumber32 ret;
+      bool found = txBuf.NextSeg (&ret, dupThresh, segmentSize, true);
+      NS_TEST_ASSERT_MSG_EQ (found, rule1 || rule3, "NextSeg differs at step " << step);
+      if (found)
+        {
+          SequenceNumber32 expected = rule1 ? next : nextPerRule3;
+          NS_TEST_ASSERT_MSG_EQ (ret, expected, "NextSeg differs at step " << step);
+        }
+    }
+}
+
 void
 TcpTxBufferTestCase::DoTeardown ()
 {
@@ -28,6 +28,7 @@
 #include "ns3/names.h"
 #include "ns3/net-device.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/pcapng-file-wrapper.h"
 
 #include "trace-helper.h"
 
@@ -159,6 +160,58 @@ PcapHelper::GetFilenameFromInterfacePair (std::string prefix, Ptr<Object> object
   return oss.str ();
 }
 
+std::string
+PcapHelper::GetInterfaceNameFromDevice (Ptr<NetDevice> device, bool useObjectNames)
+{
+  NS_LOG_FUNCTION (device << useObjectNames);
+
+  std::ostringstream oss;
+
+  std::string nodename;
+  std::string devicename;
+
+  Ptr<Node> node = device->GetNode ();
+
+  if (useObjectNames)
+    {
+      nodename = Names::FindName (node);
+      devicename = Names::FindName (device);
+    }
+
+  if (nodename.size ())
+    {
+      oss << nodename;
+    }
+  else
+    {
+      oss << node->GetId ();
+    }
+
+  oss << "-";
+
+  if (devicename.size ())
+    {
+      oss << devicename;
+    }
+  else
+    {
+      oss << device->GetIfIndex ();
+    }
+
+  return oss.str ();
+}
+
+Ptr<PcapNgFileWrapper>
+PcapHelper::CreateNgFile (std::string filename)
+{
+  NS_LOG_FUNCTION (filename);
+
+  Ptr<PcapNgFileWrapper> file = CreateObject<PcapNgFileWrapper> ();
+  file->Open (filename);
+  NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename << " for writing");
+  return file;
+}
+
 //
 // The basic default trace sink.  This one just writes the packet to the pcap
 // file which is good enough for most kinds of captures.
@@ -177,6 +230,13 @@ PcapHelper::SinkWithHeader (Ptr<PcapFileWrapper> file, const Header &header, Ptr
   file->Write (Simulator::Now (), header, p);
 }
 
+void
+PcapHelper::NgSink (Ptr<PcapNgFileWrapper> file, uint32_t interfaceId, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (file << interfaceId << p);
+  file->Write (interfaceId, Simulator::Now (), p);
+}
+
 AsciiTraceHelper::AsciiTraceHelper ()
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -462,6 +522,48 @@ PcapHelperForDevice::EnablePcap (std::string prefix, uint32_t nodeid, uint32_t d
     }
 }
 
+void
+PcapHelperForDevice::EnablePcapNgInternal (Ptr<PcapNgFileWrapper> file, Ptr<NetDevice> nd, bool promiscuous)
+{
+  NS_LOG_WARN ("PcapHelperForDevice::EnablePcapNgInternal(): pcapng output is not supported for device " << nd);
+}
+
+void
+PcapHelperForDevice::EnablePcapNg (Ptr<PcapNgFileWrapper> file, Ptr<NetDevice> nd, bool promiscuous)
+{
+  EnablePcapNgInternal (file, nd, promiscuous);
+}
+
+void
+PcapHelperForDevice::EnablePcapNg (Ptr<PcapNgFileWrapper> file, NetDeviceContainer d, bool promiscuous)
+{
+  for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
+    {
+      EnablePcapNg (file, *i, promiscuous);
+    }
+}
+
+void
+PcapHelperForDevice::EnablePcapNg (Ptr<PcapNgFileWrapper> file, NodeContainer n, bool promiscuous)
+{
+  NetDeviceContainer devs;
+  for (NodeContainer::Iterator i = n.Begin (); i != n.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          devs.Add (node->GetDevice (j));
+        }
+    }
+  EnablePcapNg (file, devs, promiscuous);
+}
+
+void
+PcapHelperForDevice::EnablePcapNgAll (Ptr<PcapNgFileWrapper> file, bool promiscuous)
+{
+  EnablePcapNg (file, NodeContainer::GetGlobal (), promiscuous);
+}
+
 //
 // Public API
 //
@@ -24,6 +24,7 @@
 #include "ns3/node-container.h"
 #include "ns3/simulator.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/pcapng-file-wrapper.h"
 #include "ns3/output-stream-wrapper.h"
 
 namespace ns3 {
@@ -118,6 +119,36 @@ public:
    */
   template <typename T> void HookDefaultSink (Ptr<T> object, std::string traceName, Ptr<PcapFileWrapper> file);
 
+  /**
+   * @brief Let the pcap helper figure out a reasonable name for the
+   * pcapng interface associated with a device.
+   *
+   * @param device NetDevice
+   * @param useObjectNames use node and device names instead of indexes
+   * @returns interface name, "<node>-<device>"
+   */
+  std::string GetInterfaceNameFromDevice (Ptr<NetDevice> device, bool useObjectNames = true);
+
+  /**
+   * @brief Create a pcapng file, ready to receive the interfaces of
+   * many devices.
+   *
+   * @param filename file name
+   * @returns a smart pointer to the pcapng file
+   */
+  Ptr<PcapNgFileWrapper> CreateNgFile (std::string filename);
+
+  /**
+   * @brief Hook a trace source to the default pcapng trace sink
+   *
+   * @param object object
+   * @param traceName trace source name
+   * @param file file wrapper
+   * @param interfaceId the pcapng interface the packets are written to
+   */
+  template <typename T> void HookNgSink (Ptr<T> object, std::string traceName,
+                                         Ptr<PcapNgFileWrapper> file, uint32_t interfaceId);
+
 private:
   /**
    * The basic default trace sink.
@@ -141,6 +172,16 @@ private:
    * @see DefaultSink
    */
   static void SinkWithHeader (Ptr<PcapFileWrapper> file, const Header& header, Ptr<const Packet> p);
+
+  /**
+   * The default pcapng trace sink, which writes the packet on the
+   * given interface of the pcapng file.
+   *
+   * @param file the file to write to
+   * @param interfaceId the interface the packet was captured on
+   * @param p the packet to write
+   */
+  static void NgSink (Ptr<PcapNgFileWrapper> file, uint32_t interfaceId, Ptr<const Packet> p);
 };
 
 template <typename T> void
@@ -151,6 +192,14 @@ PcapHelper::HookDefaultSink (Ptr<T> object, std::string tracename, Ptr<PcapFileW
   NS_ASSERT_MSG (result == true, "PcapHelper::HookDefaultSink():  Unable to hook \"" << tracename << "\"");
 }
 
+template <typename T> void
+PcapHelper::HookNgSink (Ptr<T> object, std::string tracename, Ptr<PcapNgFileWrapper> file, uint32_t interfaceId)
+{
+  bool result =
+    object->TraceConnectWithoutContext (tracename.c_str (), MakeBoundCallback (&NgSink, file, interfaceId));
+  NS_ASSERT_MSG (result == true, "PcapHelper::HookNgSink():  Unable to hook \"" << tracename << "\"");
+}
+
 /**
  * \brief Manage ASCII trace files for device models
  *
@@ -632,6 +681,61 @@ public:
    * @param promiscuous If true capture all possible packets available at the device.
    */
   void EnablePcapAll (std::string prefix, bool promiscuous = false);
+
+  /**
+   * @brief Enable pcapng output the indicated net device.
+   *
+   * Helpers which support pcapng output describe the device as a new
+   * interface of the file and hook their sniffer to it. The default
+   * implementation does nothing.
+   *
+   * @param file the pcapng file shared by all the traced devices.
+   * @param nd Net device for which you want to enable tracing.
+   * @param promiscuous If true capture all possible packets available at the device.
+   */
+  virtual void EnablePcapNgInternal (Ptr<PcapNgFileWrapper> file, Ptr<NetDevice> nd, bool promiscuous);
+
+  /**
+   * @brief Enable pcapng output on the indicated net device.
+   *
+   * Unlike EnablePcap, which creates one file per device, every device
+   * traced with EnablePcapNg is described as an interface of the same
+   * pcapng file (see PcapHelper::CreateNgFile).
+   *
+   * @param file the pcapng file shared by all the traced devices.
+   * @param nd Net device for which you want to enable tracing.
+   * @param promiscuous If true capture all possible packets available at the device.
+   */
+  void EnablePcapNg (Ptr<PcapNgFileWrapper> file, Ptr<NetDevice> nd, bool promiscuous = false);
+
+  /**
+   * @brief Enable pcapng output on each device in the container which is of the
+   * appropriate type.
+   *
+   * @param file the pcapng file shared by all the traced devices.
+   * @param d container of devices
+   * @param promiscuous If true capture all possible packets available at the device.
+   */
+  void EnablePcapNg (Ptr<PcapNgFileWrapper> file, NetDeviceContainer d, bool promiscuous = false);
+
+  /**
+   * @brief Enable pcapng output on each device (which is of the appropriate type)
+   * in the nodes provided in the container.
+   *
+   * @param file the pcapng file shared by all the traced devices.
+   * @param n container of nodes.
+   * @param promiscuous If true capture all possible packets available at the device.
+   */
+  void EnablePcapNg (Ptr<PcapNgFileWrapper> file, NodeContainer n, bool promiscuous = false);
+
+  /**
+   * @brief Enable pcapng output on each device (which is of the appropriate type)
+   * in the set of all nodes created in the simulation.
+   *
+   * @param file the pcapng file shared by all the traced devices.
+   * @param promiscuous If true capture all possible packets available at the device.
+   */
+  void EnablePcapNgAll (Ptr<PcapNgFileWrapper> file, bool promiscuous = false);
 };
 
 /**
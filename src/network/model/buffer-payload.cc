@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "buffer-payload.h"
+#include "ns3/core-config.h"
+#include "ns3/log.h"
+#include <fstream>
+#include <limits>
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BufferPayload");
+
+namespace {
+
+#ifdef HAVE_SYS_MMAN_H
+/**
+ * \ingroup packet
+ * \brief A BufferPayload backed by a read-only file mapping.
+ */
+class MappedFileBufferPayload : public BufferPayload
+{
+public:
+  /**
+   * \param data the start of the mapping
+   * \param size the size of the mapping
+   */
+  MappedFileBufferPayload (uint8_t const *data, uint32_t size)
+    : BufferPayload (data, size)
+  {
+  }
+  virtual ~MappedFileBufferPayload ()
+  {
+    munmap (const_cast<uint8_t *> (PeekData ()), GetSize ());
+  }
+};
+#endif /* HAVE_SYS_MMAN_H */
+
+/**
+ * \ingroup packet
+ * \brief A BufferPayload which owns a heap-allocated copy of its bytes.
+ */
+class HeapBufferPayload : public BufferPayload
+{
+public:
+  /**
+   * \param size the number of bytes to allocate
+   */
+  HeapBufferPayload (uint32_t size)
+    : BufferPayload (0, 0),
+      m_storage (new uint8_t [size])
+  {
+    SetData (m_storage, size);
+  }
+  virtual ~HeapBufferPayload ()
+  {
+    delete [] m_storage;
+  }
+  /**
+   * \returns the writable storage, used to fill the payload once.
+   */
+  uint8_t *GetStorage (void)
+  {
+    return m_storage;
+  }
+private:
+  uint8_t *m_storage; //!< the owned bytes
+};
+
+} // anonymous namespace
+
+BufferPayload::BufferPayload (uint8_t const *data, uint32_t size)
+  : m_data (data),
+    m_size (size)
+{
+  NS_LOG_FUNCTION (this << &data << size);
+}
+
+BufferPayload::~BufferPayload ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint8_t const *
+BufferPayload::PeekData (void) const
+{
+  return m_data;
+}
+
+uint32_t
+BufferPayload::GetSize (void) const
+{
+  return m_size;
+}
+
+void
+BufferPayload::SetData (uint8_t const *data, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << &data << size);
+  m_data = data;
+  m_size = size;
+}
+
+Ptr<BufferPayload>
+BufferPayload::CreateFromFile (std::string filename)
+{
+  NS_LOG_FUNCTION (filename);
+#ifdef HAVE_SYS_MMAN_H
+  int fd = open (filename.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      NS_LOG_WARN ("Unable to open " << filename);
+      return 0;
+    }
+  struct stat st;
+  if (fstat (fd, &st) != 0)
+    {
+      st.st_size = 0;
+    }
+  if (st.st_size > std::numeric_limits<uint32_t>::max ())
+    {
+      NS_LOG_WARN ("File " << filename << " of " << st.st_size << " bytes is too large for a payload");
+      close (fd);
+      return 0;
+    }
+  if (st.st_size > 0)
+    {
+      void *map = mmap (0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+      if (map != MAP_FAILED)
+        {
+          // the mapping stays valid after the descriptor is closed.
+          close (fd);
+          return Ptr<BufferPayload> (new MappedFileBufferPayload (static_cast<uint8_t const *> (map),
+                                                                  st.st_size),
+                                     false);
+        }
+      NS_LOG_LOGIC ("mmap failed for " << filename << ", reading it instead");
+    }
+  close (fd);
+#endif /* HAVE_SYS_MMAN_H */
+
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  if (!is.good ())
+    {
+      NS_LOG_WARN ("Unable to open " << filename);
+      return 0;
+    }
+  is.seekg (0, std::ios::end);
+  std::streamoff end = is.tellg ();
+  if (end < 0 || end > std::numeric_limits<uint32_t>::max ())
+    {
+      NS_LOG_WARN ("File " << filename << " of " << end << " bytes is too large for a payload");
+      return 0;
+    }
+  uint32_t size = end;
+  is.seekg (0, std::ios::beg);
+  HeapBufferPayload *payload = new HeapBufferPayload (size);
+  is.read (reinterpret_cast<char *> (payload->GetStorage ()), size);
+  return Ptr<BufferPayload> (payload, false);
+}
+
+} // namespace ns3
@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef BUFFER_PAYLOAD_H
+#define BUFFER_PAYLOAD_H
+
+#include <stdint.h>
+#include <string>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief read-only, reference-counted block of payload bytes
+ *
+ * A BufferPayload holds bytes which live outside of any Buffer::Data
+ * instance: a region of a shared arena, or a memory-mapped file. A
+ * Buffer can be created to refer to a slice of a BufferPayload
+ * (see Buffer::Buffer (Ptr<const BufferPayload>, uint32_t, uint32_t)),
+ * in which case the slice is used as the content of the "virtual zero
+ * area" of that Buffer instead of zeroes. The payload bytes are never
+ * modified: any operation which needs real, writable bytes (such as
+ * Buffer::PeekData or fragment reassembly) copies them into a private
+ * Buffer::Data first.
+ *
+ * The base class does not own the memory it points to: the caller
+ * must keep it valid for as long as any Buffer references this
+ * payload. Subclasses (such as the one returned by CreateFromFile)
+ * release their memory when the last reference goes away.
+ */
+class BufferPayload : public SimpleRefCount<BufferPayload>
+{
+public:
+  /**
+   * \brief Constructor
+   *
+   * \param data a pointer to the first payload byte. The memory is
+   *        not copied and not owned by this object.
+   * \param size the number of bytes available from data.
+   */
+  BufferPayload (uint8_t const *data, uint32_t size);
+  virtual ~BufferPayload ();
+
+  /**
+   * \return a pointer to the first payload byte.
+   */
+  uint8_t const *PeekData (void) const;
+  /**
+   * \return the number of payload bytes.
+   */
+  uint32_t GetSize (void) const;
+
+  /**
+   * \brief Map the content of a file in memory.
+   *
+   * The file is mapped read-only with mmap when the host supports it
+   * and read into memory otherwise. The mapping is released when the
+   * returned payload is destroyed.
+   *
+   * \param filename the name of the file to map.
+   * \returns the payload, or zero if the file could not be opened or
+   *          is larger than 4 GiB - 1 bytes, the largest payload size.
+   */
+  static Ptr<BufferPayload> CreateFromFile (std::string filename);
+
+protected:
+  /**
+   * \brief Set the memory referenced by this payload.
+   *
+   * \param data a pointer to the first payload byte.
+   * \param size the number of bytes available from data.
+   */
+  void SetData (uint8_t const *data, uint32_t size);
+
+private:
+  /**
+   * \brief Copy constructor, disabled.
+   * \param o the payload to copy
+   */
+  BufferPayload (const BufferPayload &o);
+  /**
+   * \brief Assignment operator, disabled.
+   * \param o the payload to copy
+   * \returns a reference to this payload
+   */
+  BufferPayload &operator = (const BufferPayload &o);
+
+  uint8_t const *m_data; //!< first payload byte
+  uint32_t m_size;       //!< number of payload bytes
+};
+
+} // namespace ns3
+
+#endif /* BUFFER_PAYLOAD_H */
@@ -20,6 +20,13 @@
 #include "buffer.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include <cstring>
+
+#if defined (__AVX2__)
+#include <immintrin.h>
+#elif defined (__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
@@ -43,6 +50,123 @@ static struct Zeroes
   const uint32_t size;  //!< buffer size
 } g_zeroes; //!< Zero-filled buffer
 
+/**
+ * \ingroup packet
+ * \brief Sum the 16 bit words of a block of memory, in host byte order.
+ *
+ * The block is summed as 32 bit words in 64 bit accumulators: since
+ * 2^16 = 1 modulo 0xffff, folding the result to 16 bits yields the same
+ * one's complement sum as adding the 16 bit words (RFC 1071, section 2).
+ * The vector versions are used when the compiler targets SSE2 or AVX2.
+ *
+ * \param data the first byte of the block
+ * \param size the size of the block, which must be even
+ * \returns the one's complement sum of the 16 bit words of the block,
+ *          read in host byte order, folded to 16 bits.
+ */
+uint32_t
+ChecksumBlock (uint8_t const *data, uint32_t size)
+{
+  uint64_t sum = 0;
+  uint32_t i = 0;
+#if defined (__AVX2__)
+  __m256i zero256 = _mm256_setzero_si256 ();
+  __m256i acc256 = zero256;
+  for (; i + 32 <= size; i += 32)
+    {
+      __m256i v = _mm256_loadu_si256 (reinterpret_cast<__m256i const *> (data + i));
+      acc256 = _mm256_add_epi64 (acc256, _mm256_unpacklo_epi32 (v, zero256));
+      acc256 = _mm256_add_epi64 (acc256, _mm256_unpackhi_epi32 (v, zero256));
+    }
+  uint64_t lanes256[4];
+  _mm256_storeu_si256 (reinterpret_cast<__m256i *> (lanes256), acc256);
+  sum += (lanes256[0] + lanes256[1]) + (lanes256[2] + lanes256[3]);
+#endif
+#if defined (__SSE2__)
+  __m128i zero128 = _mm_setzero_si128 ();
+  __m128i acc128 = zero128;
+  for (; i + 16 <= size; i += 16)
+    {
+      __m128i v = _mm_loadu_si128 (reinterpret_cast<__m128i const *> (data + i));
+      acc128 = _mm_add_epi64 (acc128, _mm_unpacklo_epi32 (v, zero128));
+      acc128 = _mm_add_epi64 (acc128, _mm_unpackhi_epi32 (v, zero128));
+    }
+  uint64_t lanes128[2];
+  _mm_storeu_si128 (reinterpret_cast<__m128i *> (lanes128), acc128);
+  sum += lanes128[0] + lanes128[1];
+#endif
+  for (; i + 8 <= size; i += 8)
+    {
+      uint64_t word;
+      std::memcpy (&word, data + i, 8);
+      sum += (word & 0xffffffff) + (word >> 32);
+    }
+  for (; i + 2 <= size; i += 2)
+    {
+      uint16_t word;
+      std::memcpy (&word, data + i, 2);
+      sum += word;
+    }
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return sum;
+}
+
+/**
+ * \ingroup packet
+ * \brief Add a contiguous chunk of bytes to a running checksum.
+ *
+ * The bytes are paired as little-endian 16 bit words, that is, in the
+ * order of Buffer::Iterator::ReadU16. A byte left over at the end of a
+ * chunk is paired with the first byte of the next chunk.
+ *
+ * \param data the first byte of the chunk, or zero for a chunk of zeroes
+ * \param size the size of the chunk
+ * \param sum the running sum
+ * \param pending true if a byte is waiting for its pair
+ * \param pendingByte the byte waiting for its pair
+ */
+void
+ChecksumChunk (uint8_t const *data, uint32_t size,
+               uint64_t &sum, bool &pending, uint8_t &pendingByte)
+{
+  if (size == 0)
+    {
+      return;
+    }
+  if (pending)
+    {
+      uint8_t next = data ? data[0] : 0;
+      sum += pendingByte | (next << 8);
+      pending = false;
+      if (data)
+        {
+          data++;
+        }
+      size--;
+    }
+  if (data)
+    {
+      uint32_t blockSum = ChecksumBlock (data, size & ~1);
+      static const uint16_t endianness = 1;
+      if (*reinterpret_cast<uint8_t const *> (&endianness) == 0)
+        {
+          // big-endian host: the block was summed as big-endian words.
+          blockSum = ((blockSum & 0xff) << 8) | (blockSum >> 8);
+        }
+      sum += blockSum;
+    }
+  if (size & 1)
+    {
+      pending = true;
+      pendingByte = data ? data[size - 1] : 0;
+    }
+}
+
 }
 
 namespace ns3 {
@@ -206,6 +330,18 @@ Buffer::Buffer (uint32_t dataSize, bool initialize)
     }
 }
 
+Buffer::Buffer (Ptr<const BufferPayload> payload, uint32_t start, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << payload << start << size);
+  NS_ASSERT (payload != 0 && start + size <= payload->GetSize ());
+  Initialize (size);
+  if (size > 0)
+    {
+      m_payload = payload;
+      m_payloadStart = start;
+    }
+}
+
 bool
 Buffer::CheckInternalState (void) const
 {
@@ -226,7 +362,10 @@ Buffer::CheckInternalState (void) const
     m_start <= m_data->m_size &&
     m_zeroAreaStart <= m_data->m_size;
 
-  bool ok = m_data->m_count > 0 && offsetsOk && dirtyOk && internalSizeOk;
+  bool payloadOk = m_payload == 0 ||
+    m_payloadStart + (m_zeroAreaEnd - m_zeroAreaStart) <= m_payload->GetSize ();
+
+  bool ok = m_data->m_count > 0 && offsetsOk && dirtyOk && internalSizeOk && payloadOk;
   if (!ok)
     {
       LOG_INTERNAL_STATE ("check " << this << 
@@ -252,6 +391,8 @@ Buffer::Initialize (uint32_t zeroSize)
   m_end = m_zeroAreaEnd;
   m_data->m_dirtyStart = m_start;
   m_data->m_dirtyEnd = m_end;
+  m_payload = 0;
+  m_payloadStart = 0;
   NS_ASSERT (CheckInternalState ());
 }
 
@@ -276,6 +417,8 @@ Buffer::operator = (Buffer const&o)
   m_zeroAreaEnd = o.m_zeroAreaEnd;
   m_start = o.m_start;
   m_end = o.m_end;
+  m_payload = o.m_payload;
+  m_payloadStart = o.m_payloadStart;
   NS_ASSERT (CheckInternalState ());
   return *this;
 }
@@ -305,6 +448,17 @@ Buffer::GetInternalEnd (void) const
   return m_end - (m_zeroAreaEnd - m_zeroAreaStart);
 }
 
+void
+Buffer::ReleaseEmptyPayload (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_zeroAreaStart == m_zeroAreaEnd)
+    {
+      m_payload = 0;
+      m_payloadStart = 0;
+    }
+}
+
 void
 Buffer::AddAtStart (uint32_t start)
 {
@@ -401,6 +555,7 @@ Buffer::AddAtEnd (const Buffer &o)
 {
   NS_LOG_FUNCTION (this << &o);
   if (m_data->m_count == 1 &&
+      m_payload == 0 && o.m_payload == 0 &&
       m_end == m_zeroAreaEnd &&
       m_end == m_data->m_dirtyEnd &&
       o.m_start == o.m_zeroAreaStart &&
@@ -457,6 +612,7 @@ Buffer::RemoveAtStart (uint32_t start)
       m_start = m_zeroAreaStart;
       m_zeroAreaEnd -= delta;
       m_end -= delta;
+      m_payloadStart += delta;
     } 
   else if (newStart <= m_end)
     {
@@ -478,6 +634,7 @@ Buffer::RemoveAtStart (uint32_t start)
       m_zeroAreaEnd = m_end;
       m_zeroAreaStart = m_end;
     }
+  ReleaseEmptyPayload ();
   m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
   LOG_INTERNAL_STATE ("rem start=" << start << ", ");
   NS_ASSERT (CheckInternalState ());
@@ -513,6 +670,7 @@ Buffer::RemoveAtEnd (uint32_t end)
       m_zeroAreaEnd = m_start;
       m_zeroAreaStart = m_start;
     }
+  ReleaseEmptyPayload ();
   m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
   LOG_INTERNAL_STATE ("rem end=" << end << ", ");
   NS_ASSERT (CheckInternalState ());
@@ -539,7 +697,14 @@ Buffer::CreateFullCopy (void) const
     {
       Buffer tmp;
       tmp.AddAtStart (m_zeroAreaEnd - m_zeroAreaStart);
-      tmp.Begin ().WriteU8 (0, m_zeroAreaEnd - m_zeroAreaStart);
+      if (m_payload != 0)
+        {
+          tmp.Begin ().Write (m_payload->PeekData () + m_payloadStart, m_zeroAreaEnd - m_zeroAreaStart);
+        }
+      else
+        {
+          tmp.Begin ().WriteU8 (0, m_zeroAreaEnd - m_zeroAreaStart);
+        }
       uint32_t dataStart = m_zeroAreaStart - m_start;
       tmp.AddAtStart (dataStart);
       tmp.Begin ().Write (m_data->m_data+m_start, dataStart);
@@ -559,6 +724,11 @@ uint32_t
 Buffer::GetSerializedSize (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_payload != 0)
+    {
+      // the payload bytes are not virtual zeroes: serialize them too.
+      return CreateFullCopy ().GetSerializedSize ();
+    }
   uint32_t dataStart = (m_zeroAreaStart - m_start + 3) & (~0x3);
   uint32_t dataEnd = (m_end - m_zeroAreaEnd + 3) & (~0x3);
 
@@ -579,6 +749,10 @@ uint32_t
 Buffer::Serialize (uint8_t* buffer, uint32_t maxSize) const
 {
   NS_LOG_FUNCTION (this << &buffer << maxSize);
+  if (m_payload != 0)
+    {
+      return CreateFullCopy ().Serialize (buffer, maxSize);
+    }
   uint32_t* p = reinterpret_cast<uint32_t *> (buffer);
   uint32_t size = 0;
 
@@ -726,12 +900,19 @@ Buffer::CopyData (std::ostream *os, uint32_t size) const
         { 
           size -= m_zeroAreaStart-m_start;
           tmpsize = std::min (m_zeroAreaEnd - m_zeroAreaStart, size);
-          uint32_t left = tmpsize;
-          while (left > 0)
+          if (m_payload != 0)
+            {
+              os->write ((const char*)(m_payload->PeekData () + m_payloadStart), tmpsize);
+            }
+          else
             {
-              uint32_t toWrite = std::min (left, g_zeroes.size);
-              os->write (g_zeroes.buffer, toWrite);
-              left -= toWrite;
+              uint32_t left = tmpsize;
+              while (left > 0)
+                {
+                  uint32_t toWrite = std::min (left, g_zeroes.size);
+                  os->write (g_zeroes.buffer, toWrite);
+                  left -= toWrite;
+                }
             }
           if (size > tmpsize)
             {
@@ -757,13 +938,21 @@ Buffer::CopyData (uint8_t *buffer, uint32_t size) const
       if (size > 0) 
         { 
           tmpsize = std::min (m_zeroAreaEnd - m_zeroAreaStart, size);
-          uint32_t left = tmpsize;
-          while (left > 0)
+          if (m_payload != 0)
+            {
+              memcpy (buffer, m_payload->PeekData () + m_payloadStart, tmpsize);
+              buffer += tmpsize;
+            }
+          else
             {
-              uint32_t toWrite = std::min (left, g_zeroes.size);
-              memcpy (buffer, g_zeroes.buffer, toWrite);
-              left -= toWrite;
-              buffer += toWrite;
+              uint32_t left = tmpsize;
+              while (left > 0)
+                {
+                  uint32_t toWrite = std::min (left, g_zeroes.size);
+                  memcpy (buffer, g_zeroes.buffer, toWrite);
+                  left -= toWrite;
+                  buffer += toWrite;
+                }
             }
           size -= tmpsize;
           if (size > 0)
@@ -857,7 +1046,14 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   if (start.m_current <= start.m_zeroEnd)
     {
       uint32_t toCopy = std::min (size, start.m_zeroEnd - start.m_current);
-      memset (&m_data[m_current], 0, toCopy);
+      if (start.m_payload != 0)
+        {
+          memcpy (&m_data[m_current], &start.m_payload[start.m_current - start.m_zeroStart], toCopy);
+        }
+      else
+        {
+          memset (&m_data[m_current], 0, toCopy);
+        }
       start.m_current += toCopy;
       m_current += toCopy;
       size -= toCopy;
@@ -1143,17 +1339,47 @@ uint16_t
 Buffer::Iterator::CalculateIpChecksum (uint16_t size, uint32_t initialChecksum)
 {
   NS_LOG_FUNCTION (this << size << initialChecksum);
+  NS_ASSERT_MSG (m_current >= m_dataStart &&
+                 m_current + size <= m_dataEnd,
+                 GetReadErrorMessage ());
   /* see RFC 1071 to understand this code. */
-  uint32_t sum = initialChecksum;
-
-  for (int j = 0; j < size/2; j++)
-    sum += ReadU16 ();
+  uint64_t sum = initialChecksum;
+  bool pending = false;
+  uint8_t pendingByte = 0;
+  uint32_t end = m_current + size;
+
+  // sum each contiguous region (data before the zero area, zero area,
+  // data after the zero area) in a single pass.
+  if (m_current < m_zeroStart)
+    {
+      uint32_t chunkEnd = std::min (end, m_zeroStart);
+      ChecksumChunk (&m_data[m_current], chunkEnd - m_current, sum, pending, pendingByte);
+      m_current = chunkEnd;
+    }
+  if (m_current < end && m_current < m_zeroEnd)
+    {
+      uint32_t chunkEnd = std::min (end, m_zeroEnd);
+      uint8_t const *chunk = m_payload ? &m_payload[m_current - m_zeroStart] : 0;
+      ChecksumChunk (chunk, chunkEnd - m_current, sum, pending, pendingByte);
+      m_current = chunkEnd;
+    }
+  if (m_current < end)
+    {
+      ChecksumChunk (&m_data[m_current - (m_zeroEnd - m_zeroStart)], end - m_current,
+                     sum, pending, pendingByte);
+      m_current = end;
+    }
 
-  if (size & 1)
-    sum += ReadU8 ();
+  // an odd trailing byte is the low-order byte of the last word.
+  if (pending)
+    {
+      sum += pendingByte;
+    }
 
   while (sum >> 16)
-    sum = (sum & 0xffff) + (sum >> 16);
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
   return ~sum;
 }
 
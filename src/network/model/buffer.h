@@ -24,6 +24,8 @@
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
+#include "ns3/ptr.h"
+#include "buffer-payload.h"
 
 #define BUFFER_FREE_LIST 1
 
@@ -88,6 +90,13 @@ namespace ns3 {
  * \endverbatim
  *
  * A simple state invariant is that m_start <= m_zeroStart <= m_zeroEnd <= m_end
+ *
+ * The "virtual zero area" does not have to be made of zeroes: a Buffer
+ * can be created to refer to a slice of an external, read-only
+ * BufferPayload, in which case the bytes of the virtual area are read
+ * from that payload. Since no user can ever write into the virtual
+ * area, the payload bytes are shared by every copy and fragment of the
+ * Buffer and are only copied when a "Real byte buffer" is needed.
  */
 class Buffer 
 {
@@ -481,6 +490,11 @@ private:
      * to this pointer.
      */
     uint8_t *m_data;
+    /**
+     * a pointer to the external payload byte which is located at
+     * m_zeroStart, or zero if the virtual area is made of zeroes.
+     */
+    uint8_t const *m_payload;
   };
 
   /**
@@ -640,6 +654,17 @@ private:
    * \param initialize initialize the buffer with zeroes.
    */
   Buffer (uint32_t dataSize, bool initialize);
+  /**
+   * \brief Constructor
+   *
+   * The buffer will be initialized with a slice of an external payload
+   * which is referenced, not copied.
+   *
+   * \param payload the external payload
+   * \param start offset of the first byte of the slice in the payload
+   * \param size the number of bytes in the slice
+   */
+  Buffer (Ptr<const BufferPayload> payload, uint32_t start, uint32_t size);
   ~Buffer ();
 private:
   /**
@@ -725,6 +750,12 @@ private:
    */
   uint32_t GetInternalEnd (void) const;
 
+  /**
+   * \brief Drop the reference to the external payload once the
+   * virtual zero area is empty.
+   */
+  void ReleaseEmptyPayload (void);
+
   /**
    * \brief Recycle the buffer memory
    * \param data the buffer data storage
@@ -788,6 +819,15 @@ private:
    * instance from the start of m_data->m_data
    */
   uint32_t m_end;
+  /**
+   * external payload which holds the bytes of the virtual zero
+   * area, or zero if the virtual area is made of zeroes.
+   */
+  Ptr<const BufferPayload> m_payload;
+  /**
+   * offset in m_payload of the byte located at m_zeroAreaStart
+   */
+  uint32_t m_payloadStart;
 
 #ifdef BUFFER_FREE_LIST
   /// Container for buffer data
@@ -816,7 +856,8 @@ Buffer::Iterator::Iterator ()
     m_dataStart (0),
     m_dataEnd (0),
     m_current (0),
-    m_data (0)
+    m_data (0),
+    m_payload (0)
 {
 }
 Buffer::Iterator::Iterator (Buffer const*buffer)
@@ -838,6 +879,7 @@ Buffer::Iterator::Construct (const Buffer *buffer)
   m_dataStart = buffer->m_start;
   m_dataEnd = buffer->m_end;
   m_data = buffer->m_data->m_data;
+  m_payload = buffer->m_payload ? buffer->m_payload->PeekData () + buffer->m_payloadStart : 0;
 }
 
 void 
@@ -1007,7 +1049,7 @@ Buffer::Iterator::PeekU8 (void)
     }
   else if (m_current < m_zeroEnd)
     {
-      return 0;
+      return m_payload ? m_payload[m_current - m_zeroStart] : 0;
     }
   else
     {
@@ -1052,7 +1094,9 @@ Buffer::Buffer (Buffer const&o)
     m_zeroAreaStart (o.m_zeroAreaStart),
     m_zeroAreaEnd (o.m_zeroAreaEnd),
     m_start (o.m_start),
-    m_end (o.m_end)
+    m_end (o.m_end),
+    m_payload (o.m_payload),
+    m_payloadStart (o.m_payloadStart)
 {
   m_data->m_count++;
   NS_ASSERT (CheckInternalState ());
@@ -33,6 +33,7 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
+bool PacketMetadata::m_enableCompact = false;
 bool PacketMetadata::m_metadataSkipped = false;
 uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
@@ -70,6 +71,95 @@ PacketMetadata::EnableChecking (void)
   m_enableChecking = true;
 }
 
+void
+PacketMetadata::EnableCompact (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Enable ();
+  m_enableCompact = true;
+}
+
+void
+PacketMetadata::DisableCompact (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_enableCompact = false;
+}
+
+bool
+PacketMetadata::AddCompact (uint32_t typeUid, uint32_t size, uint16_t chunkUid, bool atHead)
+{
+  NS_LOG_FUNCTION (this << typeUid << size << chunkUid << atHead);
+  NS_ASSERT (m_data == 0);
+  if (m_used == COMPACT_ITEMS || size > 0xffff)
+    {
+      Expand ();
+      return false;
+    }
+  struct PacketMetadata::CompactItem item;
+  item.uid = typeUid >> 1;
+  item.size = size;
+  item.chunkUid = chunkUid;
+  if (atHead)
+    {
+      std::copy_backward (m_compact, m_compact + m_used, m_compact + m_used + 1);
+      m_compact[0] = item;
+    }
+  else
+    {
+      m_compact[m_used] = item;
+    }
+  m_used++;
+  m_head = 0;
+  m_tail = m_used - 1;
+  return true;
+}
+
+void
+PacketMetadata::RemoveCompact (bool atHead)
+{
+  NS_LOG_FUNCTION (this << atHead);
+  NS_ASSERT (m_data == 0 && m_used > 0);
+  if (atHead)
+    {
+      std::copy (m_compact + 1, m_compact + m_used, m_compact);
+    }
+  m_used--;
+  if (m_used == 0)
+    {
+      m_head = 0xffff;
+      m_tail = 0xffff;
+    }
+  else
+    {
+      m_tail = m_used - 1;
+    }
+}
+
+void
+PacketMetadata::Expand (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_data == 0);
+  uint16_t n = m_used;
+  m_data = PacketMetadata::Create (10);
+  memset (m_data->m_data, 0xff, 4);
+  m_head = 0xffff;
+  m_tail = 0xffff;
+  m_used = 0;
+  for (uint16_t i = 0; i < n; i++)
+    {
+      struct PacketMetadata::SmallItem item;
+      item.next = 0xffff;
+      item.prev = m_tail;
+      item.typeUid = m_compact[i].uid << 1;
+      item.size = m_compact[i].size;
+      item.chunkUid = m_compact[i].chunkUid;
+      uint16_t written = AddSmall (&item);
+      UpdateTail (written);
+    }
+}
+
 void
 PacketMetadata::ReserveCopy (uint32_t size)
 {
@@ -133,6 +223,12 @@ bool
 PacketMetadata::IsStateOk (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_data == 0)
+    {
+      return m_used <= COMPACT_ITEMS &&
+             (m_used == 0 ? (m_head == 0xffff && m_tail == 0xffff) :
+              (m_head == 0 && m_tail == m_used - 1));
+    }
   bool ok = m_used <= m_data->m_size;
   ok &= IsPointerOk (m_head);
   ok &= IsPointerOk (m_tail);
@@ -374,7 +470,12 @@ uint16_t
 PacketMetadata::AddSmall (const struct PacketMetadata::SmallItem *item)
 {
   NS_LOG_FUNCTION (this << item->next << item->prev << item->typeUid << item->size << item->chunkUid);
-  NS_ASSERT (m_data != 0);
+  if (m_data == 0)
+    {
+      // only reached by empty temporaries created in compact mode.
+      NS_ASSERT (m_used == 0);
+      Expand ();
+    }
   NS_ASSERT (m_used != item->prev && m_used != item->next);
   uint32_t typeUidSize = GetUleb128Size (item->typeUid);
   uint32_t sizeSize = GetUleb128Size (item->size);
@@ -407,7 +508,12 @@ PacketMetadata::AddBig (uint32_t next, uint32_t prev,
   NS_LOG_FUNCTION (this << next << prev <<
                    item->next << item->prev << item->typeUid << item->size << item->chunkUid <<
                    extraItem->fragmentStart << extraItem->fragmentEnd << extraItem->packetUid);
-  NS_ASSERT (m_data != 0);
+  if (m_data == 0)
+    {
+      // only reached by empty temporaries created in compact mode.
+      NS_ASSERT (m_used == 0);
+      Expand ();
+    }
   uint32_t typeUid = ((item->typeUid & 0x1) == 0x1) ? item->typeUid : item->typeUid+1;
   NS_ASSERT (m_used != prev && m_used != next);
 
@@ -532,6 +638,20 @@ PacketMetadata::ReadItems (uint16_t current,
   NS_LOG_FUNCTION (this << current << item->chunkUid << item->prev << item->next << item->size <<
                         item->typeUid << extraItem->fragmentEnd << extraItem->fragmentStart <<
                         extraItem->packetUid);
+  if (m_data == 0)
+    {
+      NS_ASSERT (current < m_used);
+      const struct PacketMetadata::CompactItem *compact = &m_compact[current];
+      item->next = (current + 1 < m_used) ? current + 1 : 0xffff;
+      item->prev = (current > 0) ? current - 1 : 0xffff;
+      item->typeUid = compact->uid << 1;
+      item->size = compact->size;
+      item->chunkUid = compact->chunkUid;
+      extraItem->fragmentStart = 0;
+      extraItem->fragmentEnd = item->size;
+      extraItem->packetUid = m_packetUid;
+      return 1;
+    }
   NS_ASSERT (current <= m_data->m_size);
   const uint8_t *buffer = &m_data->m_data[current];
   item->next = buffer[0];
@@ -668,6 +788,11 @@ PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_data == 0 && AddCompact (uid, size, m_chunkUid, true))
+    {
+      m_chunkUid++;
+      return;
+    }
 
   struct PacketMetadata::SmallItem item;
   item.next = m_head;
@@ -712,6 +837,12 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
         }
       return;
     }
+  if (m_data == 0)
+    {
+      RemoveCompact (true);
+      NS_ASSERT (IsStateOk ());
+      return;
+    }
   if (m_head + read == m_used)
     {
       m_used = m_head;
@@ -738,6 +869,12 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_data == 0 && AddCompact (uid, size, m_chunkUid, false))
+    {
+      m_chunkUid++;
+      NS_ASSERT (IsStateOk ());
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   item.next = 0xffff;
   item.prev = m_tail;
@@ -782,6 +919,12 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
         }
       return;
     }
+  if (m_data == 0)
+    {
+      RemoveCompact (false);
+      NS_ASSERT (IsStateOk ());
+      return;
+    }
   if (m_tail + read == m_used)
     {
       m_used = m_tail;
@@ -822,6 +965,12 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
       return;
     }
   NS_ASSERT (m_head != 0xffff && m_tail != 0xffff);
+  if (m_data == 0)
+    {
+      // the items of o may come from another packet, or be merged
+      // with our tail, neither of which the inline record can hold.
+      Expand ();
+    }
 
   // We read the current tail because we are going to append
   // after this item.
@@ -895,8 +1044,23 @@ PacketMetadata::RemoveAtStart (uint32_t start)
       m_metadataSkipped = true;
       return;
     }
-  NS_ASSERT (m_data != 0);
   uint32_t leftToRemove = start;
+  if (m_data == 0)
+    {
+      while (leftToRemove > 0 && m_used > 0 &&
+             m_compact[0].size <= leftToRemove)
+        {
+          leftToRemove -= m_compact[0].size;
+          RemoveCompact (true);
+        }
+      if (leftToRemove == 0)
+        {
+          NS_ASSERT (IsStateOk ());
+          return;
+        }
+      // the first item becomes a fragment.
+      Expand ();
+    }
   uint16_t current = m_head;
   while (current != 0xffff && leftToRemove > 0)
     {
@@ -958,9 +1122,23 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
       m_metadataSkipped = true;
       return;
     }
-  NS_ASSERT (m_data != 0);
-
   uint32_t leftToRemove = end;
+  if (m_data == 0)
+    {
+      while (leftToRemove > 0 && m_used > 0 &&
+             m_compact[m_used - 1].size <= leftToRemove)
+        {
+          leftToRemove -= m_compact[m_used - 1].size;
+          RemoveCompact (false);
+        }
+      if (leftToRemove == 0)
+        {
+          NS_ASSERT (IsStateOk ());
+          return;
+        }
+      // the last item becomes a fragment.
+      Expand ();
+    }
   uint16_t current = m_tail;
   while (current != 0xffff && leftToRemove > 0)
     {
@@ -1279,6 +1457,10 @@ uint32_t
 PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
+  if (m_data == 0)
+    {
+      Expand ();
+    }
   const uint8_t* start = buffer;
   uint32_t desSize = size - 4;
 
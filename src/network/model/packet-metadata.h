@@ -23,6 +23,7 @@
 #include <stdint.h>
 #include <vector>
 #include <limits>
+#include <algorithm>
 #include "ns3/callback.h"
 #include "ns3/assert.h"
 #include "ns3/type-id.h"
@@ -74,6 +75,16 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * In compact mode (see EnableCompact), a packet does not allocate
+ * this byte buffer as long as its items are whole headers, trailers
+ * or payload (no fragments, no aggregated packets) and fit in a small
+ * fixed-size record stored inline in the PacketMetadata object. The
+ * first operation which cannot be represented in that record (such
+ * as the creation of a fragment) converts it to the linked list
+ * described above. In this representation, m_data is zero, m_used is
+ * the number of items in the record and m_head and m_tail are the
+ * indexes of the first and last items.
  */
 class PacketMetadata 
 {
@@ -159,6 +170,21 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable the packet metadata in compact mode
+   *
+   * Packets created after this call keep their metadata in a fixed-size
+   * inline record until they are fragmented or aggregated, which bounds
+   * the memory used by the metadata of queued packets.
+   */
+  static void EnableCompact (void);
+  /**
+   * \brief Disable the compact mode of the packet metadata
+   *
+   * Packets created after this call use the regular representation.
+   * The metadata stays enabled.
+   */
+  static void DisableCompact (void);
 
   /**
    * \brief Constructor
@@ -491,6 +517,27 @@ private:
     uint64_t packetUid;
   };
 
+  /**
+   * the number of items which can be stored in the inline record
+   * of the compact mode.
+   */
+  static const uint32_t COMPACT_ITEMS = 4;
+
+  /**
+   * \brief CompactItem structure
+   *
+   * A whole header, trailer or payload stored in the inline record
+   * of the compact mode.
+   */
+  struct CompactItem {
+    /** the uid of the TypeId of the header or trailer, zero for payload. */
+    uint16_t uid;
+    /** the size (in bytes) of the header or trailer. */
+    uint16_t size;
+    /** see SmallItem::chunkUid */
+    uint16_t chunkUid;
+  };
+
   /**
    * \brief Class to hold all the metadata
    */
@@ -583,6 +630,29 @@ public:
    */
   void AppendValueExtra (uint32_t value, uint8_t *buffer);
 
+  /**
+   * \brief Try to add an item to the inline record of the compact mode.
+   * \param typeUid the typeUid of the item, as in SmallItem::typeUid
+   * \param size the size of the item
+   * \param chunkUid the chunkUid of the item
+   * \param atHead true to add the item at the head, false at the tail
+   * \returns true if the item was added, false if it does not fit in
+   *          the record, in which case the record has been converted
+   *          to the regular linked list.
+   */
+  bool AddCompact (uint32_t typeUid, uint32_t size, uint16_t chunkUid, bool atHead);
+  /**
+   * \brief Remove the first or last item of the inline record of the
+   * compact mode.
+   * \param atHead true to remove the first item, false the last one
+   */
+  void RemoveCompact (bool atHead);
+  /**
+   * \brief Convert the inline record of the compact mode to the
+   * regular linked list.
+   */
+  void Expand (void);
+
   /**
    * \brief Reserve space
    * \param n space to reserve
@@ -659,6 +729,7 @@ public:
   static DataFreeList m_freeList; //!< the metadata data storage
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
+  static bool m_enableCompact; //!< Create new packets in compact mode
 
   /**
    * Set to true when adding metadata to a packet is skipped because
@@ -680,6 +751,8 @@ public:
   uint16_t m_tail; //!< list tail
   uint16_t m_used; //!< used portion
   uint64_t m_packetUid; //!< packet Uid
+  /// Inline record of the compact mode, valid if m_data is zero
+  struct CompactItem m_compact[COMPACT_ITEMS];
 };
 
 } // namespace ns3
@@ -687,13 +760,16 @@ public:
 namespace ns3 {
 
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
-  : m_data (PacketMetadata::Create (10)),
+  : m_data (m_enableCompact ? 0 : PacketMetadata::Create (10)),
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
     m_packetUid (uid)
 {
-  memset (m_data->m_data, 0xff, 4);
+  if (m_data != 0)
+    {
+      memset (m_data->m_data, 0xff, 4);
+    }
   if (size > 0)
     {
       DoAddHeader (0, size);
@@ -706,7 +782,11 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_used (o.m_used),
     m_packetUid (o.m_packetUid)
 {
-  NS_ASSERT (m_data != 0);
+  if (m_data == 0)
+    {
+      std::copy (o.m_compact, o.m_compact + m_used, m_compact);
+      return;
+    }
   NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
   m_data->m_count++;
 }
@@ -716,15 +796,23 @@ PacketMetadata::operator = (PacketMetadata const& o)
   if (m_data != o.m_data) 
     {
       // not self assignment
-      NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (m_data != 0)
         {
-          PacketMetadata::Recycle (m_data);
+          m_data->m_count--;
+          if (m_data->m_count == 0) 
+            {
+              PacketMetadata::Recycle (m_data);
+            }
         }
       m_data = o.m_data;
-      NS_ASSERT (m_data != 0);
-      m_data->m_count++;
+      if (m_data != 0)
+        {
+          m_data->m_count++;
+        }
+    }
+  if (m_data == 0 && this != &o)
+    {
+      std::copy (o.m_compact, o.m_compact + o.m_used, m_compact);
     }
   m_head = o.m_head;
   m_tail = o.m_tail;
@@ -734,7 +822,10 @@ PacketMetadata::operator = (PacketMetadata const& o)
 }
 PacketMetadata::~PacketMetadata ()
 {
-  NS_ASSERT (m_data != 0);
+  if (m_data == 0)
+    {
+      return;
+    }
   m_data->m_count--;
   if (m_data->m_count == 0) 
     {
@@ -280,6 +280,20 @@ public:
    * \param size the size of the input buffer.
    */
   Packet (uint8_t const*buffer, uint32_t size);
+  /**
+   * \brief Create a packet whose payload is a slice of an external
+   * payload.
+   *
+   * The payload bytes are not copied: the packet, and all its copies
+   * and fragments, reference them until a real byte buffer is
+   * needed (see Buffer). The packet is allocated with a new uid (as
+   * returned by getUid).
+   *
+   * \param payload the external payload.
+   * \param start offset of the first payload byte of the packet.
+   * \param size the size of the payload of the packet.
+   */
+  Packet (Ptr<const BufferPayload> payload, uint32_t start, uint32_t size);
   /**
    * \brief Create a new packet which contains a fragment of the original
    * packet.
@@ -501,6 +515,17 @@ public:
    * errors will be detected and will abort the program.
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable printing packets metadata, in compact mode.
+   *
+   * Like EnablePrinting, but the metadata of each packet is kept in
+   * a small fixed-size record stored in the packet itself until the
+   * packet is fragmented or aggregated with another one. This bounds
+   * the memory used by the metadata of large packet queues.
+   *
+   * \sa PacketMetadata::EnableCompact
+   */
+  static void EnableCompactPrinting (void);
 
   /**
    * \brief Returns number of bytes required for packet
@@ -22,9 +22,38 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/double.h"
 #include "ns3/test.h"
+#include <cstdio>
+#include <fstream>
+#include <limits>
 
 using namespace ns3;
 
+/**
+ * \brief Compute an Internet checksum one pair of bytes at a time.
+ * \param data the bytes
+ * \param size the number of bytes
+ * \param initialChecksum the initial value
+ * \returns the checksum, in the byte order of Buffer::Iterator::ReadU16
+ */
+static uint16_t
+ReferenceChecksum (uint8_t const *data, uint32_t size, uint32_t initialChecksum)
+{
+  uint32_t sum = initialChecksum;
+  for (uint32_t j = 0; j + 1 < size; j += 2)
+    {
+      sum += data[j] | (data[j + 1] << 8);
+    }
+  if (size & 1)
+    {
+      sum += data[size - 1];
+    }
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return ~sum;
+}
+
 //-----------------------------------------------------------------------------
 // Unit tests
 //-----------------------------------------------------------------------------
@@ -359,6 +388,130 @@ BufferTest::DoRun (void)
   val2 <<= 8;
   val2 |= i.ReadU8 ();
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
+
+  // buffers which reference an external payload.
+  uint8_t payloadBytes[64];
+  for (uint32_t k = 0; k < sizeof (payloadBytes); k++)
+    {
+      payloadBytes[k] = k + 1;
+    }
+  Ptr<BufferPayload> payload = Create<BufferPayload> (payloadBytes, sizeof (payloadBytes));
+
+  buffer = Buffer (payload, 8, 16);
+  NS_TEST_ASSERT_MSG_EQ (buffer.GetSize (), 16, "Bad payload size");
+  i = buffer.Begin ();
+  NS_TEST_ASSERT_MSG_EQ (i.ReadU8 (), 9, "Bad payload read");
+  NS_TEST_ASSERT_MSG_EQ (i.ReadNtohU16 (), 0x0a0b, "Bad payload read");
+
+  buffer.AddAtStart (2);
+  buffer.Begin ().WriteU16 (0xaaaa);
+  buffer.AddAtEnd (1);
+  i = buffer.End ();
+  i.Prev ();
+  i.WriteU8 (0xbb);
+  ENSURE_WRITTEN_BYTES (buffer, 19, 0xaa, 0xaa, 9, 10, 11, 12, 13, 14, 15, 16,
+                        17, 18, 19, 20, 21, 22, 23, 24, 0xbb);
+
+  // removing bytes from the start of the payload shifts the slice.
+  Buffer fragment = Buffer (payload, 8, 16);
+  fragment.RemoveAtStart (4);
+  fragment.RemoveAtEnd (4);
+  ENSURE_WRITTEN_BYTES (fragment, 8, 13, 14, 15, 16, 17, 18, 19, 20);
+
+  // fragments and concatenations reference the same bytes.
+  Buffer whole = Buffer (payload, 0, 8);
+  Buffer end = Buffer (payload, 8, 8).CreateFragment (2, 4);
+  whole.AddAtEnd (end);
+  ENSURE_WRITTEN_BYTES (whole, 12, 1, 2, 3, 4, 5, 6, 7, 8, 11, 12, 13, 14);
+
+  uint8_t copy[6];
+  Buffer (payload, 60, 4).CopyData (copy, 6);
+  NS_TEST_ASSERT_MSG_EQ (copy[0], 61, "Bad payload copied data");
+  NS_TEST_ASSERT_MSG_EQ (copy[3], 64, "Bad payload copied data");
+
+  std::ostringstream os;
+  Buffer (payload, 0, 4).CopyData (&os, 4);
+  NS_TEST_ASSERT_MSG_EQ (os.str (), std::string ("\x01\x02\x03\x04"), "Bad payload copied data");
+
+  // checksums over the data, zero and payload areas, at every alignment.
+  Buffer zeroes = Buffer (40);
+  Buffer withPayload = Buffer (payload, 3, 40);
+  Buffer areas[2] = { zeroes, withPayload };
+  for (uint32_t k = 0; k < 2; k++)
+    {
+      buffer = areas[k];
+      buffer.AddAtStart (7);
+      buffer.AddAtEnd (9);
+      i = buffer.Begin ();
+      for (uint32_t j = 0; j < 7; j++)
+        {
+          i.WriteU8 (0xf0 + j);
+        }
+      i = buffer.End ();
+      i.Prev (9);
+      for (uint32_t j = 0; j < 9; j++)
+        {
+          i.WriteU8 (0xe0 + j);
+        }
+      uint8_t bytes[56];
+      buffer.CopyData (bytes, buffer.GetSize ());
+      for (uint32_t start = 0; start < 9; start++)
+        {
+          for (uint32_t size = 0; start + size <= buffer.GetSize (); size++)
+            {
+              i = buffer.Begin ();
+              i.Next (start);
+              uint16_t checksum = i.CalculateIpChecksum (size, 0x1fffe);
+              NS_TEST_ASSERT_MSG_EQ (checksum, ReferenceChecksum (bytes + start, size, 0x1fffe),
+                                     "Bad checksum at offset " << start << " size " << size);
+              NS_TEST_ASSERT_MSG_EQ (i.GetDistanceFrom (buffer.Begin ()), start + size,
+                                     "Iterator not advanced by the checksum");
+            }
+        }
+    }
+}
+//-----------------------------------------------------------------------------
+class BufferPayloadFileTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferPayloadFileTest ();
+};
+
+BufferPayloadFileTest::BufferPayloadFileTest ()
+  : TestCase ("BufferPayload::CreateFromFile") {
+}
+
+void
+BufferPayloadFileTest::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("buffer-payload.bin");
+  std::ofstream os (filename.c_str (), std::ios::out | std::ios::binary);
+  for (uint32_t k = 0; k < 64; k++)
+    {
+      os.put (k + 1);
+    }
+  os.close ();
+
+  Ptr<BufferPayload> payload = BufferPayload::CreateFromFile (filename);
+  NS_TEST_ASSERT_MSG_NE (payload, 0, "Could not map " << filename);
+  NS_TEST_ASSERT_MSG_EQ (payload->GetSize (), 64, "Bad mapped payload size");
+  Buffer buffer = Buffer (payload, 60, 4);
+  Buffer::Iterator i = buffer.Begin ();
+  NS_TEST_ASSERT_MSG_EQ (i.ReadNtohU32 (), 0x3d3e3f40, "Bad mapped payload read");
+
+  NS_TEST_ASSERT_MSG_EQ (BufferPayload::CreateFromFile (CreateTempDirFilename ("missing.bin")), 0,
+                         "Mapped a missing file");
+
+  // a file larger than a payload can hold is rejected rather than
+  // truncated; it is written sparse, so it does not use 4 GiB of disk.
+  filename = CreateTempDirFilename ("buffer-payload-large.bin");
+  os.open (filename.c_str (), std::ios::out | std::ios::binary);
+  os.seekp (std::numeric_limits<uint32_t>::max ());
+  os.put (1);
+  os.close ();
+  NS_TEST_ASSERT_MSG_EQ (BufferPayload::CreateFromFile (filename), 0,
+                         "Mapped a file larger than the largest payload");
+  std::remove (filename.c_str ());
 }
 //-----------------------------------------------------------------------------
 class BufferTestSuite : public TestSuite
@@ -371,6 +524,7 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferPayloadFileTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite;
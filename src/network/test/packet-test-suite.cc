@@ -27,6 +27,7 @@
 #include <iostream>
 #include <iomanip>
 #include <ctime>
+#include <cstring>
 
 using namespace ns3;
 
@@ -646,6 +647,38 @@ PacketTest::DoRun (void)
     ALargeTestTag a;
     tmp->AddPacketTag (a); 
   }
+
+  /* Test a packet whose payload references an external payload */
+  {
+    uint8_t bytes[64];
+    for (uint32_t k = 0; k < sizeof (bytes); k++)
+      {
+        bytes[k] = k;
+      }
+    Ptr<BufferPayload> payload = Create<BufferPayload> (bytes, sizeof (bytes));
+    Ptr<Packet> tmp = Create<Packet> (payload, 16, 32);
+    tmp->AddHeader (ATestHeader<10> ());
+    NS_TEST_EXPECT_MSG_EQ (tmp->GetSize (), 42, "Bad packet size");
+
+    Ptr<Packet> fragment = tmp->CreateFragment (20, 8);
+    uint8_t copy[8];
+    fragment->CopyData (copy, 8);
+    NS_TEST_EXPECT_MSG_EQ (uint32_t (copy[0]), 26, "Bad external payload bytes");
+    NS_TEST_EXPECT_MSG_EQ (uint32_t (copy[7]), 33, "Bad external payload bytes");
+
+    // serialization must carry the payload bytes, not virtual zeroes.
+    uint32_t size = tmp->GetSerializedSize ();
+    uint8_t *serialized = new uint8_t [size];
+    NS_TEST_EXPECT_MSG_EQ (tmp->Serialize (serialized, size), 1, "Bad serialization");
+    Ptr<Packet> deserialized = Create<Packet> (serialized, size, true);
+    delete [] serialized;
+    ATestHeader<10> header;
+    deserialized->RemoveHeader (header);
+    NS_TEST_EXPECT_MSG_EQ (header.m_error, false, "Bad deserialized header");
+    uint8_t payloadCopy[32];
+    deserialized->CopyData (payloadCopy, 32);
+    NS_TEST_EXPECT_MSG_EQ (memcmp (payloadCopy, bytes + 16, 32), 0, "Bad deserialized payload");
+  }
 }
 //--------------------------------------
 class PacketTagListTest : public TestCase
@@ -20,11 +20,17 @@
 #include <cstdio>
 #include <cstdlib>
 #include <sstream>
+#include <fstream>
 #include <cstring>
+#include <vector>
 
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
+#include "ns3/pcapng-file.h"
+#include "ns3/pcap-file-wrapper.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
 
 using namespace ns3;
 
@@ -956,6 +962,315 @@ RecordHeaderTestCase::DoRun (void)
   f.Close ();
 }
 
+// ===========================================================================
+// Test case to make sure that buffered writes, synchronous or not, produce
+// exactly the same file as unbuffered writes.
+// ===========================================================================
+class BufferedWriteTestCase : public TestCase
+{
+public:
+  BufferedWriteTestCase ();
+  virtual ~BufferedWriteTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * Write the same set of records to a file.
+   * \param filename the name of the file.
+   * \param blockSize the size of the write blocks, zero if unbuffered.
+   * \param asyncFlush whether full blocks are written by a background thread.
+   */
+  void WriteRecords (std::string filename, uint32_t blockSize, bool asyncFlush);
+  /**
+   * \param filename the name of the file.
+   * \returns the content of the file.
+   */
+  std::string ReadContent (std::string filename);
+
+  std::string m_testFilename[3];
+};
+
+BufferedWriteTestCase::BufferedWriteTestCase ()
+  : TestCase ("Check to see that buffered writes do not change the file content")
+{
+}
+
+BufferedWriteTestCase::~BufferedWriteTestCase ()
+{
+}
+
+void
+BufferedWriteTestCase::DoSetup (void)
+{
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      std::stringstream filename;
+      uint32_t n = rand ();
+      filename << n;
+      m_testFilename[i] = CreateTempDirFilename (filename.str () + ".pcap");
+    }
+}
+
+void
+BufferedWriteTestCase::DoTeardown (void)
+{
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      if (remove (m_testFilename[i].c_str ()))
+        {
+          NS_LOG_ERROR ("Failed to delete file " << m_testFilename[i]);
+        }
+    }
+}
+
+void
+BufferedWriteTestCase::WriteRecords (std::string filename, uint32_t blockSize, bool asyncFlush)
+{
+  PcapFile f;
+  f.Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::out\") returns error");
+  f.SetWriteBuffer (blockSize, asyncFlush);
+  f.Init (1234, 8192);
+
+  uint8_t buffer[10000];
+  for (uint32_t i = 0; i < sizeof (buffer); ++i)
+    {
+      buffer[i] = i;
+    }
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      f.Write (i, i, buffer, (i * 37) % 1500);
+    }
+  // larger than a write block, and truncated to the snap length.
+  f.Write (1000, 0, buffer, 6000);
+  f.Write (1001, 0, buffer, 10000);
+  f.Write (1002, 0, buffer, 64);
+  f.Flush ();
+  f.Write (1003, 0, buffer, 64);
+  f.Close ();
+}
+
+std::string
+BufferedWriteTestCase::ReadContent (std::string filename)
+{
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  std::stringstream content;
+  content << is.rdbuf ();
+  return content.str ();
+}
+
+void
+BufferedWriteTestCase::DoRun (void)
+{
+  WriteRecords (m_testFilename[0], 0, false);
+  WriteRecords (m_testFilename[1], 4096, false);
+  WriteRecords (m_testFilename[2], 4096, true);
+
+  // file header, then record headers and packet bytes up to the snap length.
+  uint64_t expectedLength = 24;
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      expectedLength += 16 + (i * 37) % 1500;
+    }
+  expectedLength += 16 + 6000 + 16 + 8192 + 2 * (16 + 64);
+  NS_TEST_ASSERT_MSG_EQ (CheckFileLength (m_testFilename[0], expectedLength), true,
+                         "Unexpected file length");
+  std::string expected = ReadContent (m_testFilename[0]);
+  NS_TEST_EXPECT_MSG_EQ ((ReadContent (m_testFilename[1]) == expected), true,
+                         "Buffered writes change the file content");
+  NS_TEST_EXPECT_MSG_EQ ((ReadContent (m_testFilename[2]) == expected), true,
+                         "Asynchronous buffered writes change the file content");
+
+  // a buffered wrapper is flushed at Simulator::Destroy, without being kept
+  // alive by the simulator however often it is reopened.
+  Ptr<PcapFileWrapper> wrapper = CreateObject<PcapFileWrapper> ();
+  wrapper->SetAttribute ("WriteBufferSize", UintegerValue (4096));
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      wrapper->Open (m_testFilename[1], std::ios::out);
+      NS_TEST_ASSERT_MSG_EQ (wrapper->Fail (), false, "Open (" << m_testFilename[1] << ") returns error");
+      wrapper->Close ();
+    }
+  wrapper->Open (m_testFilename[1], std::ios::out);
+  NS_TEST_EXPECT_MSG_EQ (wrapper->GetReferenceCount (), 1, "The simulator holds a reference to the wrapper");
+  wrapper->Init (1234);
+  uint8_t buffer[64] = { 0 };
+  wrapper->Write (Seconds (1), buffer, sizeof (buffer));
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_EQ (CheckFileLength (m_testFilename[1], 24 + 16 + 64), true,
+                         "Buffered records not flushed at Simulator::Destroy");
+  wrapper->Close ();
+}
+
+// ===========================================================================
+// Test case to make sure that the PcapNg File Object writes interfaces and
+// annotated packets which can be walked block by block.
+// ===========================================================================
+class PcapNgWriteTestCase : public TestCase
+{
+public:
+  PcapNgWriteTestCase ();
+  virtual ~PcapNgWriteTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_testFilename;
+};
+
+PcapNgWriteTestCase::PcapNgWriteTestCase ()
+  : TestCase ("Check to see that PcapNgFile multiplexes interfaces and annotations in one file")
+{
+}
+
+PcapNgWriteTestCase::~PcapNgWriteTestCase ()
+{
+}
+
+void
+PcapNgWriteTestCase::DoSetup (void)
+{
+  std::stringstream filename;
+  uint32_t n = rand ();
+  filename << n;
+  m_testFilename = CreateTempDirFilename (filename.str () + ".pcapng");
+}
+
+void
+PcapNgWriteTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+PcapNgWriteTestCase::DoRun (void)
+{
+  uint8_t buffer[200];
+  for (uint32_t i = 0; i < sizeof (buffer); ++i)
+    {
+      buffer[i] = i;
+    }
+
+  PcapNgFile f;
+  f.Open (m_testFilename);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << m_testFilename << ") returns error");
+  NS_TEST_ASSERT_MSG_EQ (f.AddInterface (9, "0-1"), 0, "Unexpected interface identifier");
+  NS_TEST_ASSERT_MSG_EQ (f.AddInterface (101, "0-1 qdisc", 100), 1, "Unexpected interface identifier");
+  NS_TEST_ASSERT_MSG_EQ (f.GetNInterfaces (), 2, "Unexpected number of interfaces");
+  f.Write (0, 1000000001ULL, buffer, 41, "", PcapNgFile::DIRECTION_OUTBOUND);
+  f.Write (1, 0x123456789ULL, buffer, 200, "RIO OUT early-drop");
+  f.Write (0, 3, buffer, 0);
+  f.Close ();
+
+  std::ifstream is (m_testFilename.c_str (), std::ios::in | std::ios::binary);
+  std::stringstream ss;
+  ss << is.rdbuf ();
+  std::string content = ss.str ();
+
+  // walk the blocks, checking that their leading and trailing lengths agree.
+  std::vector<uint32_t> types;
+  std::vector<uint32_t> offsets;
+  uint32_t offset = 0;
+  while (offset + 12 <= content.size ())
+    {
+      uint32_t type, length, trailer;
+      std::memcpy (&type, &content[offset], 4);
+      std::memcpy (&length, &content[offset + 4], 4);
+      NS_TEST_ASSERT_MSG_EQ (length % 4, 0, "Block length not a multiple of 4");
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (offset + length, content.size (), "Truncated block");
+      std::memcpy (&trailer, &content[offset + length - 4], 4);
+      NS_TEST_ASSERT_MSG_EQ (trailer, length, "Trailing block length mismatch");
+      types.push_back (type);
+      offsets.push_back (offset);
+      offset += length;
+    }
+  NS_TEST_ASSERT_MSG_EQ (offset, content.size (), "Trailing garbage after the last block");
+  NS_TEST_ASSERT_MSG_EQ (types.size (), 6, "Unexpected number of blocks");
+  NS_TEST_EXPECT_MSG_EQ (types[0], 0x0a0d0d0a, "First block is not a Section Header Block");
+  NS_TEST_EXPECT_MSG_EQ (types[1], 1, "Expected an Interface Description Block");
+  NS_TEST_EXPECT_MSG_EQ (types[2], 1, "Expected an Interface Description Block");
+  NS_TEST_EXPECT_MSG_EQ (types[3], 6, "Expected an Enhanced Packet Block");
+  NS_TEST_EXPECT_MSG_EQ (types[4], 6, "Expected an Enhanced Packet Block");
+  NS_TEST_EXPECT_MSG_EQ (types[5], 6, "Expected an Enhanced Packet Block");
+
+  uint32_t magic;
+  std::memcpy (&magic, &content[offsets[0] + 8], 4);
+  NS_TEST_EXPECT_MSG_EQ (magic, 0x1a2b3c4d, "Bad byte-order magic");
+
+  uint16_t linkType;
+  uint32_t snapLen;
+  std::memcpy (&linkType, &content[offsets[2] + 8], 2);
+  std::memcpy (&snapLen, &content[offsets[2] + 12], 4);
+  NS_TEST_EXPECT_MSG_EQ (linkType, 101, "Bad link type of the second interface");
+  NS_TEST_EXPECT_MSG_EQ (snapLen, 100, "Bad snap length of the second interface");
+  NS_TEST_EXPECT_MSG_NE (content.substr (offsets[2], offsets[3] - offsets[2]).find ("0-1 qdisc"),
+                         std::string::npos, "Interface name not found");
+
+  // the second packet: interface, timestamp, lengths, truncated data and comment.
+  uint32_t epb[5];
+  std::memcpy (epb, &content[offsets[4] + 8], sizeof (epb));
+  NS_TEST_EXPECT_MSG_EQ (epb[0], 1, "Bad interface identifier");
+  NS_TEST_EXPECT_MSG_EQ (epb[1], 1, "Bad high timestamp");
+  NS_TEST_EXPECT_MSG_EQ (epb[2], 0x23456789, "Bad low timestamp");
+  NS_TEST_EXPECT_MSG_EQ (epb[3], 100, "Packet not truncated to the snap length");
+  NS_TEST_EXPECT_MSG_EQ (epb[4], 200, "Bad original length");
+  NS_TEST_EXPECT_MSG_EQ (std::memcmp (&content[offsets[4] + 28], buffer, 100), 0, "Bad packet data");
+  uint16_t option[2];
+  std::memcpy (option, &content[offsets[4] + 128], 4);
+  NS_TEST_EXPECT_MSG_EQ (option[0], 1, "Expected a comment option");
+  NS_TEST_EXPECT_MSG_EQ (content.substr (offsets[4] + 132, option[1]), "RIO OUT early-drop", "Bad comment");
+
+  // the first packet: padded data followed by the direction flags.
+  std::memcpy (option, &content[offsets[3] + 28 + 44], 4);
+  NS_TEST_EXPECT_MSG_EQ (option[0], 2, "Expected an epb_flags option");
+  uint32_t flags;
+  std::memcpy (&flags, &content[offsets[3] + 28 + 48], 4);
+  NS_TEST_EXPECT_MSG_EQ (flags, PcapNgFile::DIRECTION_OUTBOUND, "Bad direction flags");
+
+  // an empty packet without options only holds the fixed fields.
+  NS_TEST_EXPECT_MSG_EQ (content.size () - offsets[5], 32, "Unexpected size of an empty packet block");
+
+  // a comment too long for an option length is truncated to 65535 bytes.
+  f.Open (m_testFilename);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << m_testFilename << ") returns error");
+  f.AddInterface (1, "0-1");
+  f.Write (0, 0, buffer, 0, std::string (70000, 'c'));
+  f.Close ();
+
+  is.close ();
+  is.open (m_testFilename.c_str (), std::ios::in | std::ios::binary);
+  ss.str ("");
+  ss << is.rdbuf ();
+  content = ss.str ();
+
+  uint32_t length;
+  offset = 0;
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (offset + 8, content.size (), "Truncated block");
+      std::memcpy (&length, &content[offset + 4], 4);
+      offset += length;
+    }
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (offset + 32, content.size (), "Truncated packet block");
+  std::memcpy (&length, &content[offset + 4], 4);
+  NS_TEST_ASSERT_MSG_EQ (offset + length, content.size (), "Bad length of the packet block");
+  uint32_t trailer;
+  std::memcpy (&trailer, &content[offset + length - 4], 4);
+  NS_TEST_EXPECT_MSG_EQ (trailer, length, "Trailing block length mismatch");
+  std::memcpy (option, &content[offset + 28], 4);
+  NS_TEST_EXPECT_MSG_EQ (option[0], 1, "Expected a comment option");
+  NS_TEST_EXPECT_MSG_EQ (option[1], 0xffff, "Comment not truncated to 65535 bytes");
+  NS_TEST_EXPECT_MSG_EQ (length, 28 + 4 + 65536 + 4 + 4, "Unexpected size of the packet block");
+}
+
 // ===========================================================================
 // Test case to make sure that the Pcap File Object can read out the contents
 // of a known good pcap file.
@@ -1136,6 +1451,8 @@ PcapFileTestSuite::PcapFileTestSuite ()
   //AddTestCase (new AppendModeCreateTestCase, TestCase::QUICK);
   AddTestCase (new FileHeaderTestCase, TestCase::QUICK);
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
+  AddTestCase (new BufferedWriteTestCase, TestCase::QUICK);
+  AddTestCase (new PcapNgWriteTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
 }
@@ -21,6 +21,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/buffer.h"
 #include "ns3/header.h"
+#include "ns3/simulator.h"
 #include "pcap-file-wrapper.h"
 
 namespace ns3 {
@@ -46,6 +47,17 @@ PcapFileWrapper::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PcapFileWrapper::m_nanosecMode),
                    MakeBooleanChecker())
+    .AddAttribute ("WriteBufferSize",
+                   "Size of the memory blocks in which records are buffered before "
+                   "being written to the file. Zero writes each record immediately.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_writeBufferSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("AsyncFlush",
+                   "Whether full write blocks are written by a background thread.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_asyncFlush),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -86,6 +98,7 @@ void
 PcapFileWrapper::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  Simulator::Remove (m_flushEvent);
   m_file.Close ();
 }
 
@@ -94,6 +107,22 @@ PcapFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
 {
   NS_LOG_FUNCTION (this << filename << mode);
   m_file.Open (filename, mode);
+  m_file.SetWriteBuffer (m_writeBufferSize, m_asyncFlush);
+  Simulator::Remove (m_flushEvent);
+  if (m_writeBufferSize > 0)
+    {
+      // make sure the buffered records reach the file even if this
+      // object outlives the simulation. The event does not hold a
+      // reference: Close, called by the destructor, removes it.
+      m_flushEvent = Simulator::ScheduleDestroy (&PcapFileWrapper::Flush, this);
+    }
+}
+
+void
+PcapFileWrapper::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.Flush ();
 }
 
 void
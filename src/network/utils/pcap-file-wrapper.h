@@ -26,6 +26,7 @@
 #include "ns3/packet.h"
 #include "ns3/object.h"
 #include "ns3/nstime.h"
+#include "ns3/event-id.h"
 #include "pcap-file.h"
 
 namespace ns3 {
@@ -82,6 +83,12 @@ public:
    */
   void Close (void);
 
+  /**
+   * Write the records buffered by the underlying pcap file (see the
+   * "WriteBufferSize" attribute).
+   */
+  void Flush (void);
+
   /**
    * Initialize the pcap file associated with this wrapper.  This file must have
    * been previously opened with write permissions.
@@ -224,6 +231,9 @@ private:
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  uint32_t m_writeBufferSize; //!< size of the write blocks, zero if unbuffered
+  bool     m_asyncFlush; //!< write full blocks from a background thread
+  EventId  m_flushEvent; //!< flush of the buffered records at Simulator::Destroy
 };
 
 } // namespace ns3
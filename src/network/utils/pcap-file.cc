@@ -20,6 +20,7 @@
 
 #include <iostream>
 #include <cstring>
+#include <vector>
 #include "ns3/assert.h"
 #include "ns3/packet.h"
 #include "ns3/fatal-error.h"
@@ -29,6 +30,12 @@
 #include "pcap-file.h"
 #include "ns3/log.h"
 #include "ns3/build-profile.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/system-condition.h"
+#endif /* HAVE_PTHREAD_H */
 //
 // This file is used as part of the ns-3 test framework, so please refrain from 
 // adding any ns-3 specific constructs such as Packet to this file.
@@ -47,10 +54,260 @@ const uint32_t NS_SWAPPED_MAGIC = 0x4d3cb2a1; /**< Looks this way if byte swappi
 const uint16_t VERSION_MAJOR = 2;             /**< Major version of supported pcap file format */
 const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pcap file format */
 
+const uint32_t RECORD_HEADER_SIZE = 16;       /**< Size of a serialized pcap record header */
+const uint32_t WRITE_BLOCK_ALIGN = 4096;      /**< Write blocks are a multiple of this size */
+const uint32_t ASYNC_WRITE_BLOCKS = 4;        /**< Number of blocks used by the background flusher */
+const uint64_t FLUSH_WAIT_NS = 10000000;      /**< Maximum wait before checking the block ring again */
+
+/**
+ * \ingroup network
+ * \brief Blocks of pcap records waiting to be written to a file.
+ *
+ * Records are serialized back to back in fixed-size blocks, and a block
+ * is written to the file with a single stream write once it is full.
+ *
+ * The blocks form a ring.  The simulation fills the block at index
+ * m_head while the blocks from m_tail to m_head are waiting to be
+ * written.  In synchronous mode, the ring holds a single block which
+ * is written as soon as it is full.  In asynchronous mode, a background
+ * thread writes the blocks and the simulation only waits if all of them
+ * are full.  The ring indices are protected by a mutex which is taken
+ * once per block, never per record.
+ */
+class PcapWriteBuffer
+{
+public:
+  /**
+   * \param file the file to write to
+   * \param blockSize the size of a block
+   * \param asyncFlush whether blocks are written by a background thread
+   */
+  PcapWriteBuffer (std::fstream *file, uint32_t blockSize, bool asyncFlush);
+  /**
+   * Write all the pending blocks and stop the background thread.
+   */
+  ~PcapWriteBuffer ();
+
+  /**
+   * \brief Reserve room in the current block
+   * \param size the number of bytes to reserve
+   * \returns a pointer to the reserved bytes, or zero if size is
+   * larger than a block.
+   */
+  uint8_t *Reserve (uint32_t size);
+  /**
+   * \brief Write all the pending records and wait for them to be written.
+   */
+  void Flush (void);
+
+private:
+  /**
+   * \brief Hand over the current block to the writer and move to the next one.
+   */
+  void Publish (void);
+  /**
+   * \brief Write a block to the file
+   * \param index the index of the block in the ring
+   */
+  void WriteBlock (uint32_t index);
+  /**
+   * \brief Wait until at most the given number of blocks are pending
+   * \param pending the number of blocks which may stay pending
+   */
+  void WaitPending (uint32_t pending);
+  /**
+   * \brief Body of the background flusher thread
+   */
+  void FlushThread (void);
+
+  std::fstream *m_file;             //!< the file to write to
+  uint32_t m_blockSize;             //!< size of a block
+  std::vector<uint8_t *> m_blocks;  //!< the ring of blocks
+  std::vector<uint32_t> m_used;     //!< number of bytes used in each block
+  uint32_t m_head;                  //!< block being filled (free-running index)
+  uint32_t m_tail;                  //!< next block to write (free-running index)
+#ifdef HAVE_PTHREAD_H
+  Ptr<SystemThread> m_thread;       //!< the background flusher, if any
+  SystemMutex m_mutex;              //!< protects m_head, m_tail and m_stop
+  SystemCondition m_blockReady;     //!< signaled when a block is published
+  SystemCondition m_blockWritten;   //!< signaled when a block is written
+  bool m_stop;                      //!< asks the flusher to exit
+#endif /* HAVE_PTHREAD_H */
+};
+
+PcapWriteBuffer::PcapWriteBuffer (std::fstream *file, uint32_t blockSize, bool asyncFlush)
+  : m_file (file),
+    m_blockSize (blockSize),
+    m_head (0),
+    m_tail (0)
+{
+  NS_LOG_FUNCTION (this << file << blockSize << asyncFlush);
+  uint32_t nBlocks = 1;
+#ifdef HAVE_PTHREAD_H
+  m_stop = false;
+  if (asyncFlush)
+    {
+      nBlocks = ASYNC_WRITE_BLOCKS;
+      m_thread = Create<SystemThread> (MakeCallback (&PcapWriteBuffer::FlushThread, this));
+    }
+#else
+  if (asyncFlush)
+    {
+      NS_LOG_WARN ("Threads are not supported: pcap blocks are written synchronously");
+    }
+#endif /* HAVE_PTHREAD_H */
+  for (uint32_t i = 0; i < nBlocks; ++i)
+    {
+      m_blocks.push_back (new uint8_t [m_blockSize]);
+      m_used.push_back (0);
+    }
+#ifdef HAVE_PTHREAD_H
+  if (m_thread != 0)
+    {
+      m_thread->Start ();
+    }
+#endif /* HAVE_PTHREAD_H */
+}
+
+PcapWriteBuffer::~PcapWriteBuffer ()
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+#ifdef HAVE_PTHREAD_H
+  if (m_thread != 0)
+    {
+      m_mutex.Lock ();
+      m_stop = true;
+      m_mutex.Unlock ();
+      m_blockReady.SetCondition (true);
+      m_blockReady.Signal ();
+      m_thread->Join ();
+      m_thread = 0;
+    }
+#endif /* HAVE_PTHREAD_H */
+  for (uint32_t i = 0; i < m_blocks.size (); ++i)
+    {
+      delete [] m_blocks[i];
+    }
+}
+
+uint8_t *
+PcapWriteBuffer::Reserve (uint32_t size)
+{
+  if (size > m_blockSize)
+    {
+      return 0;
+    }
+  uint32_t index = m_head % m_blocks.size ();
+  if (m_used[index] + size > m_blockSize)
+    {
+      Publish ();
+      index = m_head % m_blocks.size ();
+    }
+  uint8_t *buffer = m_blocks[index] + m_used[index];
+  m_used[index] += size;
+  return buffer;
+}
+
+void
+PcapWriteBuffer::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_used[m_head % m_blocks.size ()] > 0)
+    {
+      Publish ();
+    }
+  WaitPending (0);
+}
+
+void
+PcapWriteBuffer::Publish (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  if (m_thread != 0)
+    {
+      m_mutex.Lock ();
+      m_head++;
+      m_mutex.Unlock ();
+      m_blockReady.SetCondition (true);
+      m_blockReady.Signal ();
+      // the next block must not be waiting to be written.
+      WaitPending (m_blocks.size () - 1);
+      return;
+    }
+#endif /* HAVE_PTHREAD_H */
+  WriteBlock (0);
+}
+
+void
+PcapWriteBuffer::WaitPending (uint32_t pending)
+{
+#ifdef HAVE_PTHREAD_H
+  if (m_thread == 0)
+    {
+      return;
+    }
+  while (true)
+    {
+      m_blockWritten.SetCondition (false);
+      m_mutex.Lock ();
+      uint32_t waiting = m_head - m_tail;
+      m_mutex.Unlock ();
+      if (waiting <= pending)
+        {
+          return;
+        }
+      m_blockWritten.TimedWait (FLUSH_WAIT_NS);
+    }
+#endif /* HAVE_PTHREAD_H */
+}
+
+void
+PcapWriteBuffer::WriteBlock (uint32_t index)
+{
+  m_file->write ((const char *)m_blocks[index], m_used[index]);
+  m_used[index] = 0;
+}
+
+void
+PcapWriteBuffer::FlushThread (void)
+{
+#ifdef HAVE_PTHREAD_H
+  while (true)
+    {
+      m_blockReady.SetCondition (false);
+      m_mutex.Lock ();
+      uint32_t tail = m_tail;
+      bool empty = m_tail == m_head;
+      bool stop = m_stop;
+      m_mutex.Unlock ();
+      if (!empty)
+        {
+          WriteBlock (tail % m_blocks.size ());
+          m_mutex.Lock ();
+          m_tail++;
+          m_mutex.Unlock ();
+          m_blockWritten.SetCondition (true);
+          m_blockWritten.Signal ();
+          continue;
+        }
+      if (stop)
+        {
+          return;
+        }
+      m_blockReady.TimedWait (FLUSH_WAIT_NS);
+    }
+#endif /* HAVE_PTHREAD_H */
+}
+
 PcapFile::PcapFile ()
   : m_file (),
     m_swapMode (false),
-    m_nanosecMode (false)
+    m_nanosecMode (false),
+    m_writeBlockSize (0),
+    m_asyncFlush (false),
+    m_writeBuffer (0)
 {
   NS_LOG_FUNCTION (this);
   FatalImpl::RegisterStream (&m_file); 
@@ -88,9 +345,33 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  delete m_writeBuffer;
+  m_writeBuffer = 0;
   m_file.close ();
 }
 
+void
+PcapFile::SetWriteBuffer (uint32_t blockSize, bool asyncFlush)
+{
+  NS_LOG_FUNCTION (this << blockSize << asyncFlush);
+  // records already buffered are written with the previous settings.
+  delete m_writeBuffer;
+  m_writeBuffer = 0;
+  m_writeBlockSize = (blockSize + WRITE_BLOCK_ALIGN - 1) / WRITE_BLOCK_ALIGN * WRITE_BLOCK_ALIGN;
+  m_asyncFlush = asyncFlush;
+}
+
+void
+PcapFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_writeBuffer != 0)
+    {
+      m_writeBuffer->Flush ();
+    }
+  m_file.flush ();
+}
+
 uint32_t
 PcapFile::GetMagic (void)
 {
@@ -206,6 +487,10 @@ PcapFile::WriteFileHeader (void)
   // If we're initializing the file, we need to write the pcap file header
   // at the start of the file.
   //
+  if (m_writeBuffer != 0)
+    {
+      m_writeBuffer->Flush ();
+    }
   m_file.seekp (0, std::ios::beg);
  
   //
@@ -430,11 +715,64 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
   return inclLen;
 }
 
+void
+PcapFile::SerializePacketHeader (uint8_t *buffer, uint32_t tsSec, uint32_t tsUsec,
+                                 uint32_t inclLen, uint32_t totalLen)
+{
+  PcapRecordHeader header;
+  header.m_tsSec = tsSec;
+  header.m_tsUsec = tsUsec;
+  header.m_inclLen = inclLen;
+  header.m_origLen = totalLen;
+
+  if (m_swapMode)
+    {
+      Swap (&header, &header);
+    }
+
+  //
+  // Same layout as what WritePacketHeader writes, field by field.
+  //
+  std::memcpy (buffer, &header.m_tsSec, sizeof(header.m_tsSec));
+  std::memcpy (buffer + 4, &header.m_tsUsec, sizeof(header.m_tsUsec));
+  std::memcpy (buffer + 8, &header.m_inclLen, sizeof(header.m_inclLen));
+  std::memcpy (buffer + 12, &header.m_origLen, sizeof(header.m_origLen));
+}
+
+uint8_t *
+PcapFile::ReserveRecord (uint32_t inclLen)
+{
+  if (m_writeBlockSize == 0)
+    {
+      return 0;
+    }
+  if (m_writeBuffer == 0)
+    {
+      m_writeBuffer = new PcapWriteBuffer (&m_file, m_writeBlockSize, m_asyncFlush);
+    }
+  uint8_t *record = m_writeBuffer->Reserve (RECORD_HEADER_SIZE + inclLen);
+  if (record == 0)
+    {
+      // the record is written directly to the file: write what is
+      // buffered first to keep the records in order.
+      m_writeBuffer->Flush ();
+    }
+  return record;
+}
+
 void
 PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, uint32_t totalLen)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
-  uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
+  uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
+  uint8_t *record = ReserveRecord (inclLen);
+  if (record != 0)
+    {
+      SerializePacketHeader (record, tsSec, tsUsec, inclLen, totalLen);
+      std::memcpy (record + RECORD_HEADER_SIZE, data, inclLen);
+      return;
+    }
+  inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
   m_file.write ((const char *)data, inclLen);
   NS_BUILD_DEBUG(m_file.flush());
 }
@@ -443,7 +781,16 @@ void
 PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
-  uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
+  uint32_t totalLen = p->GetSize ();
+  uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
+  uint8_t *record = ReserveRecord (inclLen);
+  if (record != 0)
+    {
+      SerializePacketHeader (record, tsSec, tsUsec, inclLen, totalLen);
+      p->CopyData (record + RECORD_HEADER_SIZE, inclLen);
+      return;
+    }
+  inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
   p->CopyData (&m_file, inclLen);
   NS_BUILD_DEBUG(m_file.flush());
 }
@@ -454,12 +801,22 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<cons
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &header << p);
   uint32_t headerSize = header.GetSerializedSize ();
   uint32_t totalSize = headerSize + p->GetSize ();
-  uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalSize);
+  uint32_t inclLen = totalSize > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalSize;
 
   Buffer headerBuffer;
   headerBuffer.AddAtStart (headerSize);
   header.Serialize (headerBuffer.Begin ());
   uint32_t toCopy = std::min (headerSize, inclLen);
+
+  uint8_t *record = ReserveRecord (inclLen);
+  if (record != 0)
+    {
+      SerializePacketHeader (record, tsSec, tsUsec, inclLen, totalSize);
+      headerBuffer.CopyData (record + RECORD_HEADER_SIZE, toCopy);
+      p->CopyData (record + RECORD_HEADER_SIZE + toCopy, inclLen - toCopy);
+      return;
+    }
+  inclLen = WritePacketHeader (tsSec, tsUsec, totalSize);
   headerBuffer.CopyData (&m_file, toCopy);
   inclLen -= toCopy;
   p->CopyData (&m_file, inclLen);
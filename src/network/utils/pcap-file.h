@@ -30,6 +30,7 @@ namespace ns3 {
 
 class Packet;
 class Header;
+class PcapWriteBuffer;
 
 
 /**
@@ -153,6 +154,37 @@ public:
    */
   void Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<const Packet> p);
 
+  /**
+   * \brief Buffer the records written to the file.
+   *
+   * By default, each record header and each packet is written to the
+   * underlying stream as soon as Write is called.  In buffered mode, the
+   * records are serialized back to back in memory blocks and each block
+   * is written to the stream with a single call once it is full.  Packets
+   * are truncated to the snap length before they are serialized, so only
+   * the bytes which end up in the file are ever copied.
+   *
+   * If asyncFlush is true, full blocks are written by a background thread
+   * so that the simulation does not wait for the file system.  This
+   * requires threading support; buffered writes stay synchronous otherwise.
+   *
+   * The buffered records reach the file when Flush or Close is called, or
+   * when the PcapFile is destroyed.
+   *
+   * \param blockSize the size of the write blocks.  It is rounded up to a
+   * multiple of 4096 bytes.  Zero disables buffering.
+   * \param asyncFlush whether full blocks are written by a background thread.
+   */
+  void SetWriteBuffer (uint32_t blockSize, bool asyncFlush = false);
+
+  /**
+   * \brief Write all the buffered records to the file.
+   *
+   * This method returns once the records have been handed over to the
+   * underlying stream, which is then flushed.
+   */
+  void Flush (void);
+
 
   /**
    * \brief Read next packet from file
@@ -361,6 +393,28 @@ private:
    */
   uint32_t WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen);
 
+  /**
+   * \brief Serialize a Pcap packet header in memory
+   *
+   * \param buffer where the 16 bytes of the header are written
+   * \param tsSec Time stamp (seconds part)
+   * \param tsUsec Time stamp (microseconds part)
+   * \param inclLen the length of the packet data saved in the file
+   * \param totalLen total packet length
+   */
+  void SerializePacketHeader (uint8_t *buffer, uint32_t tsSec, uint32_t tsUsec,
+                              uint32_t inclLen, uint32_t totalLen);
+
+  /**
+   * \brief Reserve room for a record in the write buffer
+   *
+   * \param inclLen the length of the packet data saved in the file
+   * \returns where the record must be serialized, or zero if the record
+   * must be written directly to the file (the file is not buffered, or
+   * the record is larger than a write block).
+   */
+  uint8_t *ReserveRecord (uint32_t inclLen);
+
   /**
    * \brief Read and verify a Pcap file header
    */
@@ -371,6 +425,9 @@ private:
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
+  uint32_t m_writeBlockSize;    //!< size of the write blocks, zero if unbuffered
+  bool m_asyncFlush;            //!< write full blocks from a background thread
+  PcapWriteBuffer *m_writeBuffer; //!< blocks of records not yet written
 };
 
 } // namespace ns3
@@ -0,0 +1,105 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAPNG_FILE_WRAPPER_H
+#define PCAPNG_FILE_WRAPPER_H
+
+#include <string>
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "pcapng-file.h"
+
+namespace ns3 {
+
+/**
+ * A class that wraps a PcapNgFile as an ns3::Object, so that a single
+ * pcapng file can be shared by the trace sinks of many devices and
+ * queue discs. The file is kept open as long as a sink holds a
+ * reference to the wrapper.
+ */
+class PcapNgFileWrapper : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PcapNgFileWrapper ();
+  ~PcapNgFileWrapper ();
+
+  /**
+   * \return true if the 'fail' bit is set in the underlying iostream, false otherwise.
+   */
+  bool Fail (void) const;
+  /**
+   * Resets the state of the underlying iostream.
+   */
+  void Clear (void);
+
+  /**
+   * \brief Create a new pcapng file, truncating any existing one.
+   *
+   * \param filename String containing the name of the file.
+   */
+  void Open (std::string const &filename);
+
+  /**
+   * \brief Close the underlying pcapng file.
+   */
+  void Close (void);
+
+  /**
+   * \brief Describe a new capture interface.
+   *
+   * The snapshot length of the interface is taken from the CaptureSize
+   * attribute.
+   *
+   * \param dataLinkType the link type of the packets captured on the interface
+   * \param name the name of the interface, as displayed by Wireshark
+   * \returns the identifier to be passed to Write for this interface
+   */
+  uint32_t AddInterface (uint16_t dataLinkType, std::string const &name);
+
+  /**
+   * \returns the number of interfaces described so far
+   */
+  uint32_t GetNInterfaces (void) const;
+
+  /**
+   * \brief Write the next packet to file
+   *
+   * \param interfaceId the interface the packet was captured on
+   * \param t Packet timestamp as ns3::Time.
+   * \param p Packet to write to the pcapng file.
+   * \param comment annotation stored as the packet comment, if not empty
+   * \param direction the direction of the packet, if known
+   */
+  void Write (uint32_t interfaceId, Time t, Ptr<const Packet> p,
+              std::string const &comment = "",
+              PcapNgFile::Direction direction = PcapNgFile::DIRECTION_UNKNOWN);
+
+private:
+  PcapNgFile m_file;   //!< Pcapng file
+  uint32_t m_snapLen;  //!< max length of saved packets
+};
+
+} // namespace ns3
+
+#endif /* PCAPNG_FILE_WRAPPER_H */
@@ -0,0 +1,230 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "pcapng-file.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapNgFile");
+
+const uint32_t BLOCK_SHB = 0x0a0d0d0a; /**< Section Header Block type */
+const uint32_t BLOCK_IDB = 0x00000001; /**< Interface Description Block type */
+const uint32_t BLOCK_EPB = 0x00000006; /**< Enhanced Packet Block type */
+const uint32_t BYTE_ORDER_MAGIC = 0x1a2b3c4d; /**< Section byte-order magic */
+const uint16_t VERSION_MAJOR = 1; /**< Major version of the format */
+const uint16_t VERSION_MINOR = 0; /**< Minor version of the format */
+
+const uint16_t OPT_ENDOFOPT = 0;   /**< End of options */
+const uint16_t OPT_COMMENT = 1;    /**< Comment, any block */
+const uint16_t SHB_USERAPPL = 4;   /**< Application which wrote the section */
+const uint16_t IF_NAME = 2;        /**< Interface name */
+const uint16_t IF_TSRESOL = 9;     /**< Interface timestamp resolution */
+const uint16_t EPB_FLAGS = 2;      /**< Enhanced packet flags word */
+
+const uint8_t TSRESOL_NANOSECONDS = 9; /**< if_tsresol value: 10^-9 s */
+
+PcapNgFile::PcapNgFile ()
+  : m_hasOptions (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+PcapNgFile::~PcapNgFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+PcapNgFile::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_file.fail ();
+}
+
+void
+PcapNgFile::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.clear ();
+}
+
+void
+PcapNgFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+    }
+  m_snapLens.clear ();
+}
+
+void
+PcapNgFile::Open (std::string const &filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  NS_ASSERT_MSG (!m_file.is_open (), "PcapNgFile::Open(): File already open");
+  m_filename = filename;
+  m_snapLens.clear ();
+  m_file.open (filename.c_str (), std::ios::out | std::ios::trunc | std::ios::binary);
+  if (m_file.fail ())
+    {
+      return;
+    }
+
+  StartBlock (BLOCK_SHB);
+  Append (&BYTE_ORDER_MAGIC, 4);
+  Append (&VERSION_MAJOR, 2);
+  Append (&VERSION_MINOR, 2);
+  // the section length is not known in advance
+  int64_t sectionLength = -1;
+  Append (&sectionLength, 8);
+  std::string application = "ns-3";
+  AppendOption (SHB_USERAPPL, reinterpret_cast<uint8_t const *> (application.data ()), application.size ());
+  FinishBlock ();
+}
+
+uint32_t
+PcapNgFile::AddInterface (uint16_t dataLinkType, std::string const &name, uint32_t snapLen)
+{
+  NS_LOG_FUNCTION (this << dataLinkType << name << snapLen);
+  NS_ASSERT_MSG (m_file.is_open (), "PcapNgFile::AddInterface(): File not open");
+
+  StartBlock (BLOCK_IDB);
+  uint16_t reserved = 0;
+  Append (&dataLinkType, 2);
+  Append (&reserved, 2);
+  Append (&snapLen, 4);
+  if (!name.empty ())
+    {
+      AppendOption (IF_NAME, reinterpret_cast<uint8_t const *> (name.data ()), name.size ());
+    }
+  AppendOption (IF_TSRESOL, &TSRESOL_NANOSECONDS, 1);
+  FinishBlock ();
+
+  m_snapLens.push_back (snapLen);
+  return m_snapLens.size () - 1;
+}
+
+uint32_t
+PcapNgFile::GetNInterfaces (void) const
+{
+  return m_snapLens.size ();
+}
+
+void
+PcapNgFile::Write (uint32_t interfaceId, uint64_t timestamp,
+                   uint8_t const *data, uint32_t totalLen,
+                   std::string const &comment, Direction direction)
+{
+  NS_LOG_FUNCTION (this << interfaceId << timestamp << &data << totalLen << comment << direction);
+  NS_ASSERT_MSG (interfaceId < m_snapLens.size (), "PcapNgFile::Write(): Unknown interface " << interfaceId);
+
+  uint32_t snapLen = m_snapLens[interfaceId];
+  uint32_t inclLen = (snapLen != SNAPLEN_UNLIMITED && totalLen > snapLen) ? snapLen : totalLen;
+  uint32_t tsHigh = timestamp >> 32;
+  uint32_t tsLow = timestamp & 0xffffffff;
+
+  StartBlock (BLOCK_EPB);
+  Append (&interfaceId, 4);
+  Append (&tsHigh, 4);
+  Append (&tsLow, 4);
+  Append (&inclLen, 4);
+  Append (&totalLen, 4);
+  Append (data, inclLen);
+  m_block.resize ((m_block.size () + 3) & ~3, 0);
+  if (!comment.empty ())
+    {
+      AppendOption (OPT_COMMENT, reinterpret_cast<uint8_t const *> (comment.data ()), comment.size ());
+    }
+  if (direction != DIRECTION_UNKNOWN)
+    {
+      uint32_t flags = direction;
+      AppendOption (EPB_FLAGS, reinterpret_cast<uint8_t const *> (&flags), 4);
+    }
+  FinishBlock ();
+}
+
+void
+PcapNgFile::Write (uint32_t interfaceId, uint64_t timestamp, Ptr<const Packet> p,
+                   std::string const &comment, Direction direction)
+{
+  NS_LOG_FUNCTION (this << interfaceId << timestamp << p << comment << direction);
+  NS_ASSERT_MSG (interfaceId < m_snapLens.size (), "PcapNgFile::Write(): Unknown interface " << interfaceId);
+
+  uint32_t snapLen = m_snapLens[interfaceId];
+  uint32_t totalLen = p->GetSize ();
+  uint32_t inclLen = (snapLen != SNAPLEN_UNLIMITED && totalLen > snapLen) ? snapLen : totalLen;
+  // only the bytes which fit in the snapshot length are copied.
+  m_packet.resize (inclLen + 1);
+  p->CopyData (&m_packet[0], inclLen);
+  Write (interfaceId, timestamp, &m_packet[0], totalLen, comment, direction);
+}
+
+void
+PcapNgFile::Append (void const *data, uint32_t length)
+{
+  uint8_t const *bytes = static_cast<uint8_t const *> (data);
+  m_block.insert (m_block.end (), bytes, bytes + length);
+}
+
+void
+PcapNgFile::AppendOption (uint16_t code, uint8_t const *data, uint32_t length)
+{
+  if (length > 0xffff)
+    {
+      NS_LOG_WARN ("Option " << code << " of " << length << " bytes truncated to 65535 bytes");
+      length = 0xffff;
+    }
+  Append (&code, 2);
+  uint16_t optionLength = length;
+  Append (&optionLength, 2);
+  Append (data, length);
+  m_block.resize ((m_block.size () + 3) & ~3, 0);
+  m_hasOptions = true;
+}
+
+void
+PcapNgFile::StartBlock (uint32_t type)
+{
+  m_block.clear ();
+  m_hasOptions = false;
+  Append (&type, 4);
+  // placeholder for the block total length
+  uint32_t length = 0;
+  Append (&length, 4);
+}
+
+void
+PcapNgFile::FinishBlock (void)
+{
+  if (m_hasOptions)
+    {
+      uint32_t endOfOpt = OPT_ENDOFOPT;
+      Append (&endOfOpt, 4);
+    }
+  uint32_t length = m_block.size () + 4;
+  std::memcpy (&m_block[4], &length, 4);
+  Append (&length, 4);
+  m_file.write (reinterpret_cast<char const *> (&m_block[0]), m_block.size ());
+}
+
+} // namespace ns3
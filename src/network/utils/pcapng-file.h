@@ -0,0 +1,176 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAPNG_FILE_H
+#define PCAPNG_FILE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \brief A class representing a pcapng file being written
+ *
+ * Unlike a classic pcap file, which carries a single data link type in
+ * its file header, a pcapng file describes every capture interface with
+ * an Interface Description Block and tags every packet with the index
+ * of the interface it was seen on. This allows the traffic of many
+ * devices, possibly of different link types, to be multiplexed into a
+ * single file which can be loaded in Wireshark as a whole.
+ *
+ * Each packet is stored in an Enhanced Packet Block, which may carry a
+ * free-form comment (opt_comment) and the epb_flags word. The comment is
+ * the place where simulation-specific annotations, such as the reason a
+ * queue disc dropped a packet, are stored.
+ *
+ * Files are written in host byte order with nanosecond timestamps
+ * (if_tsresol = 9) on every interface. Only a single section is written.
+ */
+class PcapNgFile
+{
+public:
+  static const uint32_t SNAPLEN_UNLIMITED = 0;    /**< No limit on the octets saved per packet */
+
+  /**
+   * \brief Values of the direction bits of the epb_flags option.
+   */
+  enum Direction
+  {
+    DIRECTION_UNKNOWN = 0,  //!< direction not available
+    DIRECTION_INBOUND = 1,  //!< packet received by the interface
+    DIRECTION_OUTBOUND = 2  //!< packet sent by the interface
+  };
+
+  PcapNgFile ();
+  ~PcapNgFile ();
+
+  /**
+   * \return true if the 'fail' bit is set in the underlying iostream, false otherwise.
+   */
+  bool Fail (void) const;
+  /**
+   * \brief Clear all state bits of the underlying iostream.
+   */
+  void Clear (void);
+
+  /**
+   * \brief Create a new pcapng file and write its Section Header Block.
+   *
+   * \param filename String containing the name of the file.
+   */
+  void Open (std::string const &filename);
+
+  /**
+   * \brief Close the underlying file.
+   */
+  void Close (void);
+
+  /**
+   * \brief Describe a new capture interface.
+   *
+   * An Interface Description Block is written to the file. Interface
+   * identifiers are allocated sequentially from zero.
+   *
+   * \param dataLinkType the link type of the packets captured on the interface
+   * \param name the name of the interface (if_name), omitted when empty
+   * \param snapLen the maximum number of octets saved per packet, or
+   *        SNAPLEN_UNLIMITED
+   * \returns the identifier of the new interface
+   */
+  uint32_t AddInterface (uint16_t dataLinkType, std::string const &name,
+                         uint32_t snapLen = SNAPLEN_UNLIMITED);
+
+  /**
+   * \returns the number of interfaces described so far
+   */
+  uint32_t GetNInterfaces (void) const;
+
+  /**
+   * \brief Write an Enhanced Packet Block.
+   *
+   * \param interfaceId the interface the packet was captured on
+   * \param timestamp the capture time, in nanoseconds
+   * \param data the packet bytes
+   * \param totalLen the number of bytes in data
+   * \param comment the packet comment, omitted when empty and truncated
+   *        to 65535 bytes
+   * \param direction the direction bits of epb_flags
+   */
+  void Write (uint32_t interfaceId, uint64_t timestamp,
+              uint8_t const *data, uint32_t totalLen,
+              std::string const &comment = "",
+              Direction direction = DIRECTION_UNKNOWN);
+
+  /**
+   * \brief Write an Enhanced Packet Block.
+   *
+   * \param interfaceId the interface the packet was captured on
+   * \param timestamp the capture time, in nanoseconds
+   * \param p the packet to write
+   * \param comment the packet comment, omitted when empty and truncated
+   *        to 65535 bytes
+   * \param direction the direction bits of epb_flags
+   */
+  void Write (uint32_t interfaceId, uint64_t timestamp, Ptr<const Packet> p,
+              std::string const &comment = "",
+              Direction direction = DIRECTION_UNKNOWN);
+
+private:
+  /**
+   * \brief Append raw bytes to the block being built.
+   * \param data the bytes to append
+   * \param length the number of bytes to append
+   */
+  void Append (void const *data, uint32_t length);
+  /**
+   * \brief Append an option to the block being built.
+   *
+   * The option value is padded to a 32 bits boundary. Values longer than
+   * the 65535 bytes an option length can hold are truncated, with a warning.
+   *
+   * \param code the option code
+   * \param data the option value
+   * \param length the length of the option value
+   */
+  void AppendOption (uint16_t code, uint8_t const *data, uint32_t length);
+  /**
+   * \brief Start building a block.
+   * \param type the block type
+   */
+  void StartBlock (uint32_t type);
+  /**
+   * \brief Terminate the options of the block being built, fix its
+   * total length and write it to the file.
+   */
+  void FinishBlock (void);
+
+  std::string   m_filename;    //!< file name
+  std::fstream  m_file;        //!< file stream
+  std::vector<uint32_t> m_snapLens; //!< snapshot length of each interface
+  std::vector<uint8_t> m_block;     //!< block being built, reused across writes
+  std::vector<uint8_t> m_packet;    //!< packet bytes being written, reused across writes
+  bool          m_hasOptions;  //!< options were appended to the block being built
+};
+
+} // namespace ns3
+
+#endif /* PCAPNG_FILE_H */
@@ -115,6 +115,20 @@ QueueDiscItem::SetTxQueueIndex (uint8_t txq)
   m_txq = txq;
 }
 
+Ptr<Packet>
+QueueDiscItem::GetPacketWithHeader (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return GetPacket ()->Copy ();
+}
+
+bool
+QueueDiscItem::Segment (std::list<Ptr<QueueDiscItem> > &segments) const
+{
+  NS_LOG_FUNCTION (this);
+  return false;
+}
+
 void
 QueueDiscItem::Print (std::ostream& os) const
 {
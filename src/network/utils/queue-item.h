@@ -23,6 +23,7 @@
 #include "ns3/ptr.h"
 #include "ns3/simple-ref-count.h"
 #include <ns3/address.h>
+#include <list>
 
 namespace ns3 {
 
@@ -189,6 +190,17 @@ public:
    */
   virtual void AddHeader (void) = 0;
 
+  /**
+   * \brief Get a copy of the packet with the header added
+   *
+   * Unlike AddHeader, the item is left unchanged, so this can be used by
+   * trace sinks (such as pcapng writers) which need the packet as it
+   * would be sent to the device.
+   *
+   * \return a copy of the packet, including the header kept separately
+   */
+  virtual Ptr<Packet> GetPacketWithHeader (void) const;
+
   /**
    * \brief Print the item contents.
    * \param os output stream in which the data should be printed.
@@ -202,6 +214,22 @@ public:
    */
   virtual bool Mark (void) = 0;
 
+  /**
+   * \brief Split a generic segmentation offload (GSO) super-segment
+   *
+   * A super-segment travels through the stack and the queue disc as a single
+   * item, and is split into the items which are actually passed to the device
+   * only at the device boundary. This method must be called before the header
+   * is added to the packet. The items appended to the list carry the same
+   * destination address, protocol and transmission queue index as this item,
+   * and their header has not been added yet.
+   *
+   * \param segments the list to which the segments are appended
+   * \return true if the item was a super-segment and has been split, false
+   *         (and the list is left unchanged) otherwise
+   */
+  virtual bool Segment (std::list<Ptr<QueueDiscItem> > &segments) const;
+
 private:
   /**
    * \brief Default constructor
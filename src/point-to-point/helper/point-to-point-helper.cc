@@ -107,6 +107,22 @@ PointToPointHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, b
   pcapHelper.HookDefaultSink<PointToPointNetDevice> (device, "PromiscSniffer", file);
 }
 
+void
+PointToPointHelper::EnablePcapNgInternal (Ptr<PcapNgFileWrapper> file, Ptr<NetDevice> nd, bool promiscuous)
+{
+  Ptr<PointToPointNetDevice> device = nd->GetObject<PointToPointNetDevice> ();
+  if (device == 0)
+    {
+      NS_LOG_INFO ("PointToPointHelper::EnablePcapNgInternal(): Device " << device << " not of type ns3::PointToPointNetDevice");
+      return;
+    }
+
+  PcapHelper pcapHelper;
+  uint32_t interfaceId = file->AddInterface (PcapHelper::DLT_PPP,
+                                             pcapHelper.GetInterfaceNameFromDevice (device));
+  pcapHelper.HookNgSink<PointToPointNetDevice> (device, "PromiscSniffer", file, interfaceId);
+}
+
 void 
 PointToPointHelper::EnableAsciiInternal (
   Ptr<OutputStreamWrapper> stream, 
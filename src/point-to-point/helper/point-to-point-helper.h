@@ -164,6 +164,18 @@ private:
    */
   virtual void EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool promiscuous, bool explicitFilename);
 
+  /**
+   * \brief Enable pcapng output on the indicated net device.
+   *
+   * NetDevice-specific implementation mechanism for describing the device
+   * as an interface of the shared pcapng file and hooking the trace.
+   *
+   * \param file the pcapng file shared by all the traced devices.
+   * \param nd Net device for which you want to enable tracing.
+   * \param promiscuous If true capture all possible packets available at the device.
+   */
+  virtual void EnablePcapNgInternal (Ptr<PcapNgFileWrapper> file, Ptr<NetDevice> nd, bool promiscuous);
+
   /**
    * \brief Enable ascii trace output on the indicated net device.
    *
@@ -26,6 +26,9 @@
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
 #include "ns3/traffic-control-layer.h"
+#include "ns3/rio-queue-disc.h"
+#include "ns3/trace-helper.h"
+#include "ns3/simulator.h"
 #include "traffic-control-helper.h"
 
 namespace ns3 {
@@ -442,4 +445,79 @@ TrafficControlHelper::Uninstall (NetDeviceContainer c)
 }
 
 
+namespace {
+
+/**
+ * The annotation of the next drop of a queue disc, set by the queue disc
+ * specific trace sinks right before the generic Drop trace is fired.
+ */
+struct PcapNgDropAnnotation : public SimpleRefCount<PcapNgDropAnnotation>
+{
+  Ptr<const QueueDiscItem> item;  //!< the item about to be dropped
+  std::string comment;            //!< the annotation of the drop
+};
+
+/**
+ * Write a dropped item to the pcapng file, with its annotation.
+ * \param file the pcapng file
+ * \param interfaceId the interface describing the queue disc
+ * \param annotation the annotation set for the item, if any
+ * \param item the dropped item
+ */
+void
+PcapNgDropSink (Ptr<PcapNgFileWrapper> file, uint32_t interfaceId,
+                Ptr<PcapNgDropAnnotation> annotation, Ptr<const QueueDiscItem> item)
+{
+  std::string comment = "drop";
+  if (annotation->item == item)
+    {
+      comment = annotation->comment;
+    }
+  annotation->item = 0;
+  file->Write (interfaceId, Simulator::Now (), item->GetPacketWithHeader (), comment);
+}
+
+/**
+ * Record the class of an item dropped by a RIO queue disc and the kind
+ * of drop.
+ * \param annotation the annotation to set
+ * \param item the dropped item
+ * \param inProfile true if the item belongs to the IN class
+ * \param dropType the kind of drop
+ */
+void
+PcapNgRioDropSink (Ptr<PcapNgDropAnnotation> annotation, Ptr<const QueueDiscItem> item,
+                   bool inProfile, uint32_t dropType)
+{
+  annotation->item = item;
+  annotation->comment = std::string ("RIO ") + (inProfile ? "IN " : "OUT ")
+    + (dropType == RioQueueDisc::DTYPE_FORCED ? "forced-drop" : "early-drop");
+}
+
+} // anonymous namespace
+
+void
+TrafficControlHelper::EnablePcapNg (Ptr<PcapNgFileWrapper> file, QueueDiscContainer c)
+{
+  PcapHelper pcapHelper;
+  for (QueueDiscContainer::ConstIterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<QueueDisc> qd = *i;
+      std::string name = "qdisc";
+      if (qd->GetNetDevice () != 0)
+        {
+          name = pcapHelper.GetInterfaceNameFromDevice (qd->GetNetDevice ()) + " " + name;
+        }
+      uint32_t interfaceId = file->AddInterface (PcapHelper::DLT_RAW, name);
+      Ptr<PcapNgDropAnnotation> annotation = Create<PcapNgDropAnnotation> ();
+      if (DynamicCast<RioQueueDisc> (qd) != 0)
+        {
+          qd->TraceConnectWithoutContext ("ClassifiedDrop",
+                                          MakeBoundCallback (&PcapNgRioDropSink, annotation));
+        }
+      qd->TraceConnectWithoutContext ("Drop",
+                                      MakeBoundCallback (&PcapNgDropSink, file, interfaceId, annotation));
+    }
+}
+
 } // namespace ns3
@@ -26,6 +26,7 @@
 #include "ns3/object-factory.h"
 #include "ns3/net-device-container.h"
 #include "ns3/queue-disc-container.h"
+#include "ns3/pcapng-file-wrapper.h"
 
 namespace ns3 {
 
@@ -490,6 +491,19 @@ public:
    */
   void Uninstall (Ptr<NetDevice> d);
 
+  /**
+   * \param file the pcapng file shared with the traced devices
+   * \param c set of queue discs
+   *
+   * This method describes each of the given queue discs as an interface
+   * (carrying raw IP packets) of the given pcapng file, and writes there
+   * the packets dropped by the queue disc, annotated with a packet comment.
+   * The drops of a RioQueueDisc are annotated with the class of the packet
+   * (IN or OUT) and with the kind of drop (early or forced), e.g.,
+   * "RIO OUT early-drop"; other drops are annotated as "drop".
+   */
+  static void EnablePcapNg (Ptr<PcapNgFileWrapper> file, QueueDiscContainer c);
+
 private:
   /// QueueDisc factory, stores the configuration of all the queue discs
   std::vector<QueueDiscFactory> m_queueDiscFactory;
@@ -164,6 +164,7 @@ QueueDisc::DoDispose (void)
   m_device = 0;
   m_devQueueIface = 0;
   m_requeued = 0;
+  m_gsoSegments.clear ();
   Object::DoDispose ();
 }
 
@@ -398,8 +399,11 @@ QueueDisc::Drop (Ptr<const QueueDiscItem> item)
   m_nTotalDroppedPackets++;
   m_nTotalDroppedBytes += item->GetSize ();
 
-  NS_LOG_LOGIC ("m_traceDrop (p)");
-  m_traceDrop (item);
+  if (!m_traceDrop.IsEmpty ())
+    {
+      NS_LOG_LOGIC ("m_traceDrop (p)");
+      m_traceDrop (item);
+    }
 
   NotifyParentDrop (item);
 }
@@ -425,8 +429,11 @@ QueueDisc::Enqueue (Ptr<QueueDiscItem> item)
   m_nTotalReceivedPackets++;
   m_nTotalReceivedBytes += item->GetSize ();
 
-  NS_LOG_LOGIC ("m_traceEnqueue (p)");
-  m_traceEnqueue (item);
+  if (!m_traceEnqueue.IsEmpty ())
+    {
+      NS_LOG_LOGIC ("m_traceEnqueue (p)");
+      m_traceEnqueue (item);
+    }
 
   return DoEnqueue (item);
 }
@@ -444,8 +451,11 @@ QueueDisc::Dequeue (void)
       m_nPackets--;
       m_nBytes -= item->GetSize ();
 
-      NS_LOG_LOGIC ("m_traceDequeue (p)");
-      m_traceDequeue (item);
+      if (!m_traceDequeue.IsEmpty ())
+        {
+          NS_LOG_LOGIC ("m_traceDequeue (p)");
+          m_traceDequeue (item);
+        }
     }
 
   return item;
@@ -534,10 +544,24 @@ QueueDisc::DequeuePacket ()
             m_nPackets--;
             m_nBytes -= item->GetSize ();
 
-            NS_LOG_LOGIC ("m_traceDequeue (p)");
-            m_traceDequeue (item);
+            if (!m_traceDequeue.IsEmpty ())
+              {
+                NS_LOG_LOGIC ("m_traceDequeue (p)");
+                m_traceDequeue (item);
+              }
           }
     }
+  else if (!m_gsoSegments.empty ())
+    {
+      // The remaining segments of a GSO super-segment are sent before any other
+      // packet, as Linux does with the segment list kept in gso_skb
+      if (!m_devQueueIface->GetTxQueue (m_gsoSegments.front ()->GetTxQueueIndex ())->IsStopped ())
+        {
+          item = m_gsoSegments.front ();
+          m_gsoSegments.pop_front ();
+          item->AddHeader ();
+        }
+    }
   else
     {
       // If the device is multi-queue (actually, Linux checks if the queue disc has
@@ -548,9 +572,18 @@ QueueDisc::DequeuePacket ()
       if (m_devQueueIface->GetNTxQueues ()>1 || !m_devQueueIface->GetTxQueue (0)->IsStopped ())
         {
           item = Dequeue ();
-          // If the item is not null, add the header to the packet.
+          // If the item is not null, add the header to the packet. A GSO
+          // super-segment is split here, as it leaves the queue disc for
+          // the device, and its first segment is sent.
           if (item != 0)
             {
+              std::list<Ptr<QueueDiscItem> > segments;
+              if (item->Segment (segments))
+                {
+                  item = segments.front ();
+                  segments.pop_front ();
+                  m_gsoSegments.splice (m_gsoSegments.end (), segments);
+                }
               item->AddHeader ();
             }
           // Here, Linux tries bulk dequeues
@@ -571,8 +604,11 @@ QueueDisc::Requeue (Ptr<QueueDiscItem> item)
   m_nTotalRequeuedPackets++;
   m_nTotalRequeuedBytes += item->GetSize ();
 
-  NS_LOG_LOGIC ("m_traceRequeue (p)");
-  m_traceRequeue (item);
+  if (!m_traceRequeue.IsEmpty ())
+    {
+      NS_LOG_LOGIC ("m_traceRequeue (p)");
+      m_traceRequeue (item);
+    }
 }
 
 bool
@@ -612,9 +648,10 @@ QueueDisc::Transmit (Ptr<QueueDiscItem> item)
   // of the value returned by NetDevice::Send does not match that of the value
   // returned by ndo_start_xmit.
 
-  // if the queue disc is empty or the device queue is now stopped, return false so
-  // that the Run method does not attempt to dequeue other packets and exits
-  if (GetNPackets () == 0 || m_devQueueIface->GetTxQueue (item->GetTxQueueIndex ())->IsStopped ())
+  // if the queue disc is empty (and no segment of a GSO super-segment is left) or
+  // the device queue is now stopped, return false so that the Run method does not
+  // attempt to dequeue other packets and exits
+  if ((GetNPackets () == 0 && m_gsoSegments.empty ()) || m_devQueueIface->GetTxQueue (item->GetTxQueueIndex ())->IsStopped ())
     {
       return false;
     }
@@ -25,6 +25,7 @@
 #include "ns3/net-device.h"
 #include "ns3/queue-item.h"
 #include <vector>
+#include <list>
 #include "packet-filter.h"
 
 namespace ns3 {
@@ -492,6 +493,7 @@ private:
   Ptr<NetDeviceQueueInterface> m_devQueueIface;   //!< NetDevice queue interface
   bool m_running;                   //!< The queue disc is performing multiple dequeue operations
   Ptr<QueueDiscItem> m_requeued;    //!< The last packet that failed to be transmitted
+  std::list<Ptr<QueueDiscItem> > m_gsoSegments; //!< Segments of a dequeued GSO super-segment yet to be transmitted
   ParentDropCallback m_parentDropCallback;   //!< Parent drop callback
 
   /// Traced callback: fired when a packet is enqueued
@@ -9,6 +9,8 @@
 #include "ns3/net-device-queue-interface.h"
 //#include "ns3/flow-monitor-module.h"
 #include <map>
+#include <cmath>
+#include <algorithm>
 #include "ns3/ipv4-queue-disc-item.h"
 
 
@@ -90,6 +92,16 @@ TypeId RioQueueDisc::GetTypeId (void)
                    DoubleValue (50),
                    MakeDoubleAccessor (&RioQueueDisc::m_lIntermOut),
                    MakeDoubleChecker <double> ())
+    .AddAttribute ("KIn",
+                   "Instantaneous length of the In queue in packets/bytes above which In packets are marked, 0 to use RED",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&RioQueueDisc::m_kIn),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("KOut",
+                   "Instantaneous length of the queue in packets/bytes above which Out packets are marked, 0 to use RED",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&RioQueueDisc::m_kOut),
+                   MakeDoubleChecker<double> (0))
     .AddAttribute ("Ns1Compat",
                    "NS-1 compatibility",
                    BooleanValue (false),
@@ -120,13 +132,25 @@ TypeId RioQueueDisc::GetTypeId (void)
                    UintegerValue (1),
                    MakeUintegerAccessor (&RioQueueDisc::SetPriorityMethod),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("FluidStep",
+                   "The integration step of the fluid flows",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&RioQueueDisc::m_fluidStep),
+                   MakeTimeChecker (MicroSeconds (1)))
+    .AddTraceSource ("ClassifiedDrop",
+                     "Early or forced drop of an IN or OUT packet",
+                     MakeTraceSourceAccessor (&RioQueueDisc::m_traceClassifiedDrop),
+                     "ns3::RioQueueDisc::ClassifiedDropTracedCallback")
   ;
 
   return tid;
 }
 
 RioQueueDisc::RioQueueDisc ()
-  : QueueDisc ()
+  : QueueDisc (),
+    m_fluidQueue (0),
+    m_fluidQueueIn (0),
+    m_fluidServedBytes (0)
 {
   NS_LOG_FUNCTION (this);
   m_uv = CreateObject<UniformRandomVariable> ();
@@ -142,6 +166,11 @@ RioQueueDisc::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
   m_uv = 0;
+  Simulator::Cancel (m_fluidEvent);
+  Simulator::Cancel (m_fluidRunEvent);
+  m_fluidGroups.clear ();
+  m_fluidProbs.clear ();
+  m_fluidDepartures.clear ();
   QueueDisc::DoDispose ();
 }
 
@@ -234,6 +263,25 @@ RioQueueDisc::DoDequeue (void)
 
   NS_LOG_FUNCTION (this);
 
+  if (IsFluidAhead ())
+    {
+      Time departure = m_fluidDepartures.front ();
+      NS_LOG_LOGIC ("Fluid ahead of the head packet until " << departure);
+      // nothing else dequeues the packet when the fluid has been served
+      if (!m_fluidRunEvent.IsRunning ())
+        {
+          m_fluidRunEvent = Simulator::Schedule (departure - Simulator::Now (), &QueueDisc::Run, this);
+        }
+      return 0;
+    }
+
+  // The last m_fluidDepartures.size () packets were queued behind some fluid
+  if (!m_fluidDepartures.empty ()
+      && m_fluidDepartures.size () == GetInternalQueue (0)->GetNPackets ())
+    {
+      m_fluidDepartures.pop_front ();
+    }
+
   if (GetInternalQueue (0)->IsEmpty ())
     {
       NS_LOG_LOGIC ("Queue empty");
@@ -260,6 +308,10 @@ RioQueueDisc::DoDequeue (void)
   if (p != 0)
     {
 
+      if (!m_fluidGroups.empty ())
+        {
+          m_fluidServedBytes += p->GetSize ();
+        }
       m_flow = InOrOut (p);
       if (m_flow)
         {
@@ -369,6 +421,13 @@ bool RioQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       qLen = GetInternalQueue (0)->GetNPackets ();
       qLenIn = m_inLen;
     }
+  if (!m_fluidGroups.empty ())
+    {
+      // the fluid backlog shares the queue
+      double scale = (GetMode () == QUEUE_DISC_MODE_BYTES) ? m_meanPktSize : 1.0;
+      qLen += uint32_t (m_fluidQueue * scale + 0.5);
+      qLenIn += uint32_t (m_fluidQueueIn * scale + 0.5);
+    }
    /*
        * if we were idle, we pretend that m packets arrived during
        * the idle period.  m is set to be the ptc times the amount
@@ -441,7 +500,15 @@ bool RioQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
       uint32_t dropType = DTYPE_NONE;
 
 
-      if (m_qAvgIn >= m_minThIn && qLenIn > 1)
+      if (m_kIn > 0)
+        {
+          // step marking on the instantaneous IN queue length
+          if (qLenIn > m_kIn)
+            {
+              dropType = DTYPE_UNFORCED;
+            }
+        }
+      else if (m_qAvgIn >= m_minThIn && qLenIn > 1)
         {
           if ((!m_isGentleIn && m_qAvgIn >= m_maxThIn)
               || (m_isGentleIn && m_qAvgIn >= 2 * m_maxThIn))
@@ -485,12 +552,21 @@ bool RioQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
               m_stats.dropIn++;
               --m_inLen;
               m_inBcount -= item->GetSize ();
+              m_traceClassifiedDrop (item, true, DTYPE_UNFORCED);
               Drop (item);
 
               return false;
             }
-          NS_LOG_DEBUG ("\t Marking In pkt due to Prob Mark " << m_qAvgIn); // where are we marking?
-          m_stats.unforcedMark++;
+          if (m_kIn > 0)
+            {
+              NS_LOG_DEBUG ("\t Marking In pkt due to Step Mark " << qLenIn);
+              m_stats.stepMark++;
+            }
+          else
+            {
+              NS_LOG_DEBUG ("\t Marking In pkt due to Prob Mark " << m_qAvgIn); // where are we marking?
+              m_stats.unforcedMark++;
+            }
 
         }
 
@@ -503,6 +579,7 @@ bool RioQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
               m_stats.dropIn++;
               --m_inLen;
               m_inBcount -= item->GetSize ();
+              m_traceClassifiedDrop (item, true, DTYPE_FORCED);
               Drop (item);
               if (m_isNs1Compat)
                 {
@@ -517,7 +594,16 @@ bool RioQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
           m_stats.forcedMark++;
 
         }
+      if (IsInternalQueueFull (item))
+        {
+          // the internal queue drops the packet, which is a forced drop
+          m_traceClassifiedDrop (item, true, DTYPE_FORCED);
+        }
       bool retval = GetInternalQueue (0)->Enqueue (item);
+      if (retval && !m_fluidGroups.empty ())
+        {
+          m_fluidDepartures.push_back (Simulator::Now () + Seconds (m_fluidQueue / m_ptc));
+        }
       ++m_inLen;
       m_inBcount += item->GetSize ();
       if (!retval)
@@ -575,7 +661,15 @@ bool RioQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
 
       //curq_ = qlen; // helps to trace queue during arrival, if enabled
 
-      if (m_qAvg >= m_minThOut && qLen > 1)
+      if (m_kOut > 0)
+        {
+          // step marking on the instantaneous queue length
+          if (qLen > m_kOut)
+            {
+              dropType = DTYPE_UNFORCED;
+            }
+        }
+      else if (m_qAvg >= m_minThOut && qLen > 1)
         {
           if ((!m_isGentleOut && m_qAvg >= m_maxThOut)
               || (m_isGentleOut && m_qAvg >= 2 * m_maxThOut))
@@ -617,12 +711,21 @@ bool RioQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
             {
               NS_LOG_DEBUG ("\t Dropping Out pkt due to Prob Mark " << m_qAvg);
               m_stats.unforcedDrop++;
+              m_traceClassifiedDrop (item, false, DTYPE_UNFORCED);
               Drop (item);
               m_stats.dropOut++;
               return false;
             }
-          NS_LOG_DEBUG ("\t Marking Out pkt due to Prob Mark " << m_qAvg);
-          m_stats.unforcedMark++;
+          if (m_kOut > 0)
+            {
+              NS_LOG_DEBUG ("\t Marking Out pkt due to Step Mark " << qLen);
+              m_stats.stepMark++;
+            }
+          else
+            {
+              NS_LOG_DEBUG ("\t Marking Out pkt due to Prob Mark " << m_qAvg);
+              m_stats.unforcedMark++;
+            }
 
 
         }
@@ -634,6 +737,7 @@ bool RioQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
               NS_LOG_DEBUG ("\t Dropping Out pkt due to Hard Mark " << m_qAvg);
               m_stats.forcedDrop++;
               m_stats.dropOut++;
+              m_traceClassifiedDrop (item, false, DTYPE_FORCED);
               Drop (item);
               if (m_isNs1Compat)
                 {
@@ -645,7 +749,16 @@ bool RioQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
           NS_LOG_DEBUG ("\t Marking Out pkt due to Hard Mark " << m_qAvg);
           m_stats.forcedMark++;
         }
+      if (IsInternalQueueFull (item))
+        {
+          // the internal queue drops the packet, which is a forced drop
+          m_traceClassifiedDrop (item, false, DTYPE_FORCED);
+        }
       bool retval = GetInternalQueue (0)->Enqueue (item);
+      if (retval && !m_fluidGroups.empty ())
+        {
+          m_fluidDepartures.push_back (Simulator::Now () + Seconds (m_fluidQueue / m_ptc));
+        }
 
       if (!retval)
         {
@@ -829,6 +942,168 @@ RioQueueDisc::DropOutEarly (Ptr<QueueDiscItem> item, uint32_t qSize)
 }
 
 
+uint32_t
+RioQueueDisc::AddFluidFlows (uint32_t nFlows, Time rtt, bool inProfile)
+{
+  NS_LOG_FUNCTION (this << nFlows << rtt << inProfile);
+  NS_ASSERT_MSG (rtt.IsStrictlyPositive (), "The round trip time of the fluid flows must be positive");
+  NS_ABORT_MSG_IF (IsInitialized () && GetNetDevice () == 0,
+                   "The fluid flows need a RioQueueDisc installed as the root queue disc of a device");
+  FluidGroup group;
+  group.nFlows = nFlows;
+  group.rtt = rtt;
+  group.inProfile = inProfile;
+  group.window = 1.0;
+  group.rate = 0.0;
+  m_fluidGroups.push_back (group);
+  if (!m_fluidEvent.IsRunning ())
+    {
+      m_fluidEvent = Simulator::Schedule (m_fluidStep, &RioQueueDisc::FluidUpdate, this);
+    }
+  return m_fluidGroups.size () - 1;
+}
+
+uint32_t
+RioQueueDisc::GetNFluidGroups (void) const
+{
+  return m_fluidGroups.size ();
+}
+
+double
+RioQueueDisc::GetFluidWindow (uint32_t group) const
+{
+  NS_ASSERT (group < m_fluidGroups.size ());
+  return m_fluidGroups[group].window;
+}
+
+DataRate
+RioQueueDisc::GetFluidRate (uint32_t group) const
+{
+  NS_ASSERT (group < m_fluidGroups.size ());
+  return DataRate (uint64_t (m_fluidGroups[group].rate * m_meanPktSize * 8));
+}
+
+double
+RioQueueDisc::GetFluidQueueSize (void) const
+{
+  return (m_mode == QUEUE_DISC_MODE_BYTES) ? m_fluidQueue * m_meanPktSize : m_fluidQueue;
+}
+
+double
+RioQueueDisc::FluidDropProbability (bool inProfile, double qLen, double qLenIn)
+{
+  double k = inProfile ? m_kIn : m_kOut;
+  if (k > 0)
+    {
+      return ((inProfile ? qLenIn : qLen) > k) ? 1.0 : 0.0;
+    }
+
+  double qAvg = inProfile ? m_qAvgIn : m_qAvg;
+  double minTh = inProfile ? m_minThIn : m_minThOut;
+  double maxTh = inProfile ? m_maxThIn : m_maxThOut;
+  bool isGentle = inProfile ? m_isGentleIn : m_isGentleOut;
+  if (qAvg < minTh)
+    {
+      return 0.0;
+    }
+  if ((!isGentle && qAvg >= maxTh) || (isGentle && qAvg >= 2 * maxTh))
+    {
+      return 1.0;
+    }
+  double p = inProfile
+    ? CalculatePNew (qAvg, maxTh, isGentle, m_vAIn, m_vBIn, m_vCIn, m_vDIn, m_curMaxPIn)
+    : CalculatePNew (qAvg, maxTh, isGentle, m_vAOut, m_vBOut, m_vCOut, m_vDOut, m_curMaxPOut);
+
+  // ModifyP spaces the drops uniformly between 1/p and 2/p packets if
+  // m_isWait is true, between 1 and 1/p packets otherwise
+  return m_isWait ? 2.0 * p / 3.0 : std::min (1.0, 2.0 * p);
+}
+
+void
+RioQueueDisc::FluidUpdate (void)
+{
+  NS_LOG_FUNCTION (this);
+  double dt = m_fluidStep.GetSeconds ();
+  double scale = (GetMode () == QUEUE_DISC_MODE_BYTES) ? m_meanPktSize : 1.0;
+  double packets = (GetMode () == QUEUE_DISC_MODE_BYTES) ? GetInternalQueue (0)->GetNBytes ()
+    : GetInternalQueue (0)->GetNPackets ();
+  double packetsIn = GetInQueueSize ();
+
+  // the queue is served at the link rate, hence the queueing delay
+  double qLen = packets + m_fluidQueue * scale;
+  double qLenIn = packetsIn + m_fluidQueueIn * scale;
+  double delay = qLen / scale / m_ptc;
+
+  m_fluidProbs.push_back (std::make_pair (FluidDropProbability (true, qLen, qLenIn),
+                                          FluidDropProbability (false, qLen, qLenIn)));
+
+  double arrivals = 0;
+  double accepted = 0;
+  double acceptedIn = 0;
+  uint32_t maxLag = 0;
+  for (std::vector<FluidGroup>::iterator it = m_fluidGroups.begin (); it != m_fluidGroups.end (); it++)
+    {
+      double rtt = it->rtt.GetSeconds () + delay;
+      // the flows react to the drops of one round trip time ago
+      uint32_t lag = std::min (uint32_t (rtt / dt + 0.5), uint32_t (m_fluidProbs.size () - 1));
+      maxLag = std::max (maxLag, lag);
+      const std::pair<double, double> &probs = m_fluidProbs[m_fluidProbs.size () - 1 - lag];
+      double p = it->inProfile ? probs.first : probs.second;
+
+      // dW/dt = 1/R - W(t) W(t-R) / (2 R(t-R)) p(t-R), with W(t-R)/R(t-R)
+      // approximated by W(t)/R(t)
+      it->window += dt * (1.0 / rtt - it->window * it->window * p / (2.0 * rtt));
+      it->window = std::max (it->window, 1.0);
+      it->rate = it->nFlows * it->window / rtt;
+
+      double sent = it->rate * dt;
+      double kept = m_useEcn ? sent : sent * (1.0 - p);
+      arrivals += sent;
+      accepted += kept;
+      if (it->inProfile)
+        {
+          acceptedIn += kept;
+        }
+    }
+  while (m_fluidProbs.size () > maxLag + 1)
+    {
+      m_fluidProbs.pop_front ();
+    }
+
+  // the link serves the packets dequeued during the step, and the fluid
+  // with the rest of its capacity
+  double capacity = std::max (0.0, m_ptc * dt - double (m_fluidServedBytes) / m_meanPktSize);
+  m_fluidServedBytes = 0;
+  double backlog = m_fluidQueue + accepted;
+  double backlogIn = m_fluidQueueIn + acceptedIn;
+  double served = std::min (backlog, capacity);
+  m_fluidQueue = backlog - served;
+  m_fluidQueueIn = (backlog > 0) ? backlogIn * m_fluidQueue / backlog : 0.0;
+
+  // the fluid which does not fit in the queue is dropped
+  double room = std::max (0.0, (m_queueLimit - packets) / scale);
+  if (m_fluidQueue > room)
+    {
+      m_fluidQueueIn *= room / m_fluidQueue;
+      m_fluidQueue = room;
+    }
+
+  // every arrival updates the average queue sizes, as in DoEnqueue
+  if (arrivals > 0)
+    {
+      double weight = std::pow (1.0 - m_qW, arrivals);
+      m_qAvg = m_qAvg * weight + (1.0 - weight) * (packets + m_fluidQueue * scale);
+      m_qAvgIn = m_qAvgIn * weight + (1.0 - weight) * (packetsIn + m_fluidQueueIn * scale);
+      // the link is not idle
+      m_idle = false;
+      m_idleIn = false;
+    }
+  NS_LOG_DEBUG ("\t fluid arrivals " << arrivals << " fluid queue " << m_fluidQueue
+                << " Qavg " << m_qAvg << " QavgIn " << m_qAvgIn);
+
+  m_fluidEvent = Simulator::Schedule (m_fluidStep, &RioQueueDisc::FluidUpdate, this);
+}
+
 Ptr<const QueueDiscItem>
 RioQueueDisc::DoPeek (void) const
 {
@@ -839,6 +1114,12 @@ RioQueueDisc::DoPeek (void) const
       return 0;
     }
 
+  if (IsFluidAhead ())
+    {
+      NS_LOG_LOGIC ("Fluid ahead of the head packet until " << m_fluidDepartures.front ());
+      return 0;
+    }
+
   Ptr<const QueueDiscItem> item = GetInternalQueue (0)->Peek ();
 
   NS_LOG_LOGIC ("Number packets " << GetInternalQueue (0)->GetNPackets ());
@@ -901,9 +1182,38 @@ RioQueueDisc::CheckConfig (void)
       return false;
     }
 
+  // A packet queued behind the fluid is only dequeued by a run of the queue
+  // disc scheduled when the fluid has been served, which needs a device
+  if (!m_fluidGroups.empty () && GetNetDevice () == 0)
+    {
+      NS_LOG_ERROR ("The fluid flows need a RioQueueDisc installed as the root queue disc of a device");
+      return false;
+    }
+
   return true;
 }
 
+bool
+RioQueueDisc::IsFluidAhead (void) const
+{
+  // The last m_fluidDepartures.size () packets were queued behind some fluid
+  return !m_fluidDepartures.empty ()
+         && m_fluidDepartures.size () == GetInternalQueue (0)->GetNPackets ()
+         && m_fluidDepartures.front () > Simulator::Now ();
+}
+
+bool
+RioQueueDisc::IsInternalQueueFull (Ptr<const QueueDiscItem> item) const
+{
+  // the same test as Queue::Enqueue
+  Ptr<InternalQueue> queue = GetInternalQueue (0);
+  if (queue->GetMode () == QueueBase::QUEUE_MODE_PACKETS)
+    {
+      return queue->GetNPackets () >= queue->GetMaxPackets ();
+    }
+  return queue->GetNBytes () + item->GetSize () > queue->GetMaxBytes ();
+}
+
 void
 RioQueueDisc::InitializeParams (void)
 {
@@ -944,6 +1254,9 @@ RioQueueDisc::InitializeParams (void)
   m_stats.qLimDrop = 0;
   m_stats.forcedMark = 0;
   m_stats.unforcedMark = 0;
+  m_stats.stepMark = 0;
+  m_stats.dropIn = 0;
+  m_stats.dropOut = 0;
 
   m_qAvg = 0.0;
   m_qAvgIn = 0.0;
@@ -7,6 +7,8 @@
 #include "ns3/data-rate.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/simulator.h"
+#include <vector>
+#include <deque>
 
 namespace ns3 {
 
@@ -16,6 +18,27 @@ class TraceContainer;
  * \ingroup traffic-control
  *
  * \brief A RIO packet queue disc
+ *
+ * Each class can be switched to a step marking mode, as used by DCTCP,
+ * by setting its K threshold (attributes KIn and KOut) to a non-zero
+ * value. In this mode, an arriving packet of the class is marked (or
+ * dropped, if it is not ECN-capable or UseEcn is false) when the
+ * instantaneous queue length exceeds K, and the RED logic based on the
+ * average queue length is not used for that class. As for the RED
+ * thresholds, the IN class is compared with the IN queue length and the
+ * OUT class with the total queue length.
+ *
+ * Long-lived background TCP flows can be modeled as a fluid instead of
+ * packets (see AddFluidFlows). Every FluidStep, the window of each group
+ * of fluid flows is advanced with the fluid model of Misra, Gong and
+ * Towsley, driven by the drop probability which RIO applies to the class
+ * of the group. The fluid backlog shares the queue with the packets:
+ * it is included in the queue lengths averaged by RIO and compared with
+ * the thresholds and the queue limit, it uses the capacity of the link
+ * (LinkBandwidth) left over by the packets, and a packet is neither
+ * dequeued nor peeked before the fluid queued ahead of it has been served.
+ * The queue disc then runs itself to send the packet, so the fluid flows
+ * need a RioQueueDisc installed as the root queue disc of a device.
  */
 
 class RioQueueDisc : public QueueDisc
@@ -49,6 +72,7 @@ public:
     uint32_t qLimDrop;                  //!< Drops due to queue limits
     uint32_t unforcedMark;              //!< Early probability marks
     uint32_t forcedMark;                //!< Forced marks, qavg > max threshold
+    uint32_t stepMark;                  //!< Step marks, instantaneous queue > K threshold
     uint32_t dropIn;                                    //!< In pkt drops
     uint32_t dropOut;                                   //!< Out pkt drops
   } Stats;
@@ -56,6 +80,18 @@ public:
   /* tells whether pkt is In or Out*/
   bool InOrOut (Ptr<QueueDiscItem> item );
 
+  /**
+   * TracedCallback signature for the drops decided by the RIO algorithm
+   * and for the packets which overflow the queue.
+   *
+   * \param [in] item The dropped item.
+   * \param [in] inProfile True if the item belongs to the IN class.
+   * \param [in] dropType DTYPE_UNFORCED for an early drop, DTYPE_FORCED
+   *              for a forced drop or a queue overflow.
+   */
+  typedef void (* ClassifiedDropTracedCallback)
+    (Ptr<const QueueDiscItem> item, bool inProfile, uint32_t dropType);
+
   /**
    * \brief Drop types
    */
@@ -128,6 +164,53 @@ public:
   Stats GetStats ();
 
   int64_t AssignStreams (int64_t stream);
+
+  /**
+   * \brief Add a group of long-lived TCP flows modeled as a fluid.
+   *
+   * The flows of the group send packets of MeanPktSize bytes, all belong
+   * to the same class and have the same round trip time, excluding the
+   * queueing delay at this queue disc. They start with a window of one
+   * packet and are active until the end of the simulation. The queue disc
+   * must be the root queue disc of a device.
+   *
+   * \param nFlows the number of flows
+   * \param rtt the round trip time of the flows, excluding the queueing delay
+   * \param inProfile true if the flows belong to the IN class
+   * \returns the index of the group
+   */
+  uint32_t AddFluidFlows (uint32_t nFlows, Time rtt, bool inProfile);
+
+  /**
+   * \brief Get the number of groups of fluid flows.
+   *
+   * \returns the number of groups
+   */
+  uint32_t GetNFluidGroups (void) const;
+
+  /**
+   * \brief Get the congestion window of the flows of a fluid group.
+   *
+   * \param group the index of the group
+   * \returns the window of each flow, in packets
+   */
+  double GetFluidWindow (uint32_t group) const;
+
+  /**
+   * \brief Get the sending rate of a fluid group.
+   *
+   * \param group the index of the group
+   * \returns the aggregate sending rate of the flows of the group
+   */
+  DataRate GetFluidRate (uint32_t group) const;
+
+  /**
+   * \brief Get the fluid backlog.
+   *
+   * \returns the size of the fluid queued, in bytes or packets
+   */
+  double GetFluidQueueSize (void) const;
+
 protected:
   /**
    * \brief Dispose of the object
@@ -206,6 +289,43 @@ private:
   double ModifyP (double p, uint32_t count, uint32_t countBytes,
                   uint32_t meanPktSize, bool wait, uint32_t size);
 
+  /**
+   * \brief A group of long-lived TCP flows modeled as a fluid
+   */
+  struct FluidGroup
+  {
+    uint32_t nFlows;  //!< number of flows
+    Time rtt;         //!< round trip time, excluding the queueing delay
+    bool inProfile;   //!< true if the flows belong to the IN class
+    double window;    //!< window of each flow, in packets
+    double rate;      //!< aggregate sending rate, in packets per second
+  };
+
+  /**
+   * \brief Check whether the head packet waits for the fluid queued ahead of it
+   * \returns true if the head packet cannot be dequeued yet
+   */
+  bool IsFluidAhead (void) const;
+  /**
+   * \brief Check whether the internal queue has no room left for a packet
+   * \param item the packet about to be enqueued
+   * \returns true if the internal queue would drop the packet
+   */
+  bool IsInternalQueueFull (Ptr<const QueueDiscItem> item) const;
+  /**
+   * \brief Advance the fluid flows and the fluid queue by one FluidStep
+   */
+  void FluidUpdate (void);
+
+  /**
+   * \brief Returns the average probability that RIO drops or marks a packet
+   * \param inProfile true for the IN class
+   * \param qLen total queue size, including the fluid backlog
+   * \param qLenIn IN queue size, including the fluid backlog
+   * \returns the drop probability
+   */
+  double FluidDropProbability (bool inProfile, double qLen, double qLenIn);
+
   Stats m_stats; //!< RIO statistics
   // ** Variables supplied by user
   QueueDiscMode m_mode;     //!< Mode (Bytes or packets)
@@ -226,6 +346,8 @@ private:
   bool m_useHardDrop;       //!< True if packets are always dropped above max threshold
   double m_lIntermIn;         //!< The max probability of dropping a packet
   double m_lIntermOut;         //!< The max probability of dropping a packet
+  double m_kIn;               //!< Step marking threshold of the In queue (0 to disable)
+  double m_kOut;              //!< Step marking threshold of the Out queue (0 to disable)
 
 
   // ** Variables maintained by RIO
@@ -261,6 +383,22 @@ private:
 
   Ptr<UniformRandomVariable> m_uv;  //!< rng stream
 
+  /// Traced callback: fired for every early or forced drop, with the class of the item
+  TracedCallback<Ptr<const QueueDiscItem>, bool, uint32_t> m_traceClassifiedDrop;
+
+  // ** Variables of the fluid model
+  std::vector<FluidGroup> m_fluidGroups;  //!< Groups of fluid flows
+  Time m_fluidStep;                       //!< Integration step of the fluid model
+  EventId m_fluidEvent;                   //!< Next step of the fluid model
+  EventId m_fluidRunEvent;                //!< Run of the queue disc when the head packet may leave
+  double m_fluidQueue;                    //!< Fluid backlog, in packets of MeanPktSize
+  double m_fluidQueueIn;                  //!< IN fluid backlog, in packets of MeanPktSize
+  uint32_t m_fluidServedBytes;            //!< Bytes of packets dequeued since the last step
+  /// Drop probabilities of the IN and OUT classes at the last steps, most recent last
+  std::deque<std::pair<double, double> > m_fluidProbs;
+  /// Times before which the last queued packets cannot leave, as the fluid ahead is served
+  std::deque<Time> m_fluidDepartures;
+
   uint32_t m_inLen;       /* In Packets count */
   uint32_t m_inBcount;    /* In packets byte count */
 
@@ -347,16 +347,23 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
     {
       // The device has no attached queue disc, thus add the header to the packet and
       // send it directly to the device if the selected queue is not stopped
-      if (!devQueueIface->GetTxQueue (txq)->IsStopped ())
+      // A GSO super-segment is split here, just before reaching the device
+      std::list<Ptr<QueueDiscItem> > segments;
+      if (!item->Segment (segments))
         {
-          item->AddHeader ();
+          segments.push_back (item);
+        }
+      for (std::list<Ptr<QueueDiscItem> >::iterator it = segments.begin ();
+           it != segments.end () && !devQueueIface->GetTxQueue (txq)->IsStopped (); ++it)
+        {
+          (*it)->AddHeader ();
           // a single queue device makes no use of the priority tag
           if (devQueueIface->GetNTxQueues () == 1)
             {
               SocketPriorityTag priorityTag;
-              item->GetPacket ()->RemovePacketTag (priorityTag);
+              (*it)->GetPacket ()->RemovePacketTag (priorityTag);
             }
-          device->Send (item->GetPacket (), item->GetAddress (), item->GetProtocol ());
+          device->Send ((*it)->GetPacket (), (*it)->GetAddress (), (*it)->GetProtocol ());
         }
     }
   else
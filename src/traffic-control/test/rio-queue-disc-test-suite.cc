@@ -4,11 +4,24 @@
 #include "ns3/uinteger.h"
 #include "ns3/string.h"
 #include "ns3/double.h"
+#include "ns3/boolean.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 #include "ns3/queue-disc.h"
 #include "ns3/ipv4-queue-disc-item.h"
 #include "ns3/ipv4-header.h"
+#include "ns3/data-rate.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/mac48-address.h"
+#include "ns3/pcapng-file-wrapper.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
 
 using namespace ns3;
 
@@ -100,6 +113,15 @@ private:
    * \param mode the mode
    */
   void RunRioTest (StringValue mode);
+  /**
+   * Count the drops reported by the ClassifiedDrop trace source
+   * \param item the dropped item
+   * \param inProfile true for an IN packet
+   * \param dropType the kind of drop
+   */
+  void ClassifiedDrop (Ptr<const QueueDiscItem> item, bool inProfile, uint32_t dropType);
+  uint32_t m_tracedDropIn;  //!< IN drops reported by the trace source
+  uint32_t m_tracedDropOut; //!< OUT drops reported by the trace source
 };
 
 RioQueueDiscTestCase::RioQueueDiscTestCase ()
@@ -230,10 +252,16 @@ RioQueueDiscTestCase::RunRioTest (StringValue mode)
   NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("LIntermOut", DoubleValue (10)), true,
                          "Verify that we can actually set the attribute LIntermOut");
   queue->Initialize ();
+  m_tracedDropIn = 0;
+  m_tracedDropOut = 0;
+  queue->TraceConnectWithoutContext ("ClassifiedDrop",
+                                     MakeCallback (&RioQueueDiscTestCase::ClassifiedDrop, this));
   Enqueue (queue, pktSize, 300, false);
   RioQueueDisc::Stats st = StaticCast<RioQueueDisc> (queue)->GetStats ();
   drop.test2 = st.unforcedDrop + st.forcedDrop + st.qLimDrop;
   NS_TEST_EXPECT_MSG_GT (st.dropOut, st.dropIn, "Out pkts should be dropped more than In pkts");
+  NS_TEST_EXPECT_MSG_EQ (m_tracedDropIn, st.dropIn, "Every In drop should be traced");
+  NS_TEST_EXPECT_MSG_EQ (m_tracedDropOut, st.dropOut, "Every Out drop should be traced");
 
   // test 3: reduced maxTh, this causes more drops
   maxThIn = 20 * modeSize;
@@ -288,6 +316,21 @@ RioQueueDiscTestCase::RunRioTest (StringValue mode)
 
 }
 
+void
+RioQueueDiscTestCase::ClassifiedDrop (Ptr<const QueueDiscItem> item, bool inProfile, uint32_t dropType)
+{
+  NS_TEST_EXPECT_MSG_EQ ((dropType == RioQueueDisc::DTYPE_FORCED || dropType == RioQueueDisc::DTYPE_UNFORCED),
+                         true, "Unexpected drop type");
+  if (inProfile)
+    {
+      m_tracedDropIn++;
+    }
+  else
+    {
+      m_tracedDropOut++;
+    }
+}
+
 void
 RioQueueDiscTestCase::Enqueue (Ptr<RioQueueDisc> queue, uint32_t size, uint32_t nPkt, bool ecnCapable)
 {
@@ -320,6 +363,320 @@ RioQueueDiscTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Rio Queue Disc Test Case for the step marking mode (KIn and KOut)
+ */
+class RioQueueDiscStepMarkingTestCase : public TestCase
+{
+public:
+  RioQueueDiscStepMarkingTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Enqueue an ECN capable packet
+   * \param queue the queue disc
+   * \param dscp the DSCP of the packet, which selects its class
+   */
+  void Enqueue (Ptr<RioQueueDisc> queue, Ipv4Header::DscpType dscp);
+};
+
+RioQueueDiscStepMarkingTestCase::RioQueueDiscStepMarkingTestCase ()
+  : TestCase ("Sanity check on the step marking mode of the rio queue implementation")
+{
+}
+
+void
+RioQueueDiscStepMarkingTestCase::Enqueue (Ptr<RioQueueDisc> queue, Ipv4Header::DscpType dscp)
+{
+  Address dest;
+  Ipv4Header hdr;
+  hdr.SetDscp (dscp);
+  hdr.SetEcn (Ipv4Header::ECN_ECT0);
+  queue->Enqueue (Create<Ipv4QueueDiscItem> (Create<Packet> (500), dest, 0, hdr));
+}
+
+void
+RioQueueDiscStepMarkingTestCase::DoRun (void)
+{
+  uint32_t kIn = 5;
+  uint32_t kOut = 25;
+  uint32_t nIn = 20;
+  uint32_t nOut = 10;
+  Ptr<RioQueueDisc> queue = CreateObject<RioQueueDisc> ();
+
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Mode", StringValue ("QUEUE_DISC_MODE_PACKETS")), true,
+                         "Verify that we can actually set the attribute Mode");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("QueueLimit", UintegerValue (100)), true,
+                         "Verify that we can actually set the attribute QueueLimit");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("UseEcn", BooleanValue (true)), true,
+                         "Verify that we can actually set the attribute UseEcn");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("KIn", DoubleValue (kIn)), true,
+                         "Verify that we can actually set the attribute KIn");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("KOut", DoubleValue (kOut)), true,
+                         "Verify that we can actually set the attribute KOut");
+  queue->Initialize ();
+
+  // IN packets are marked as soon as more than kIn IN packets are queued,
+  // OUT packets as soon as more than kOut packets are queued
+  for (uint32_t i = 0; i < nIn; i++)
+    {
+      Enqueue (queue, Ipv4Header::DSCP_AF11);
+    }
+  for (uint32_t i = 0; i < nOut; i++)
+    {
+      Enqueue (queue, Ipv4Header::DscpDefault);
+    }
+
+  RioQueueDisc::Stats st = queue->GetStats ();
+  uint32_t expectedMarks = (nIn - kIn - 1) + (nIn + nOut - kOut - 1);
+  NS_TEST_EXPECT_MSG_EQ (st.stepMark, expectedMarks, "Unexpected number of step marks");
+  NS_TEST_EXPECT_MSG_EQ (st.unforcedMark + st.forcedMark, 0, "No RED marks expected");
+  NS_TEST_EXPECT_MSG_EQ (st.unforcedDrop + st.forcedDrop + st.qLimDrop, 0, "No drops expected");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), nIn + nOut, "All the packets should be queued");
+
+  for (uint32_t i = 0; i < nIn + nOut; i++)
+    {
+      Ptr<Ipv4QueueDiscItem> item = DynamicCast<Ipv4QueueDiscItem> (queue->Dequeue ());
+      NS_TEST_ASSERT_MSG_NE (item, 0, "A packet should be dequeued");
+      bool marked = (i < nIn) ? (i > kIn) : (i > kOut);
+      NS_TEST_EXPECT_MSG_EQ ((item->GetHeader ().GetEcn () == Ipv4Header::ECN_CE), marked,
+                             "Unexpected ECN codepoint for packet " << i);
+    }
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Rio Queue Disc Test Case for the fluid flows
+ *
+ * An IN and an OUT group of fluid flows share a 10Mbps link. The fluid
+ * must fill the link without overflowing the queue, the IN flows must get
+ * a larger share than the OUT flows, and a packet must wait for the fluid
+ * queued ahead of it, then be sent to the device without any other event.
+ */
+class RioQueueDiscFluidTestCase : public TestCase
+{
+public:
+  RioQueueDiscFluidTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Accumulate the rates of the fluid groups and the fluid backlog
+   * \param queue the queue disc
+   */
+  void Sample (Ptr<RioQueueDisc> queue);
+  /**
+   * Send a packet behind the fluid and check that it cannot be dequeued yet
+   * \param queue the queue disc
+   * \param dev the device of the queue disc
+   */
+  void EnqueuePacket (Ptr<RioQueueDisc> queue, Ptr<NetDevice> dev);
+  /**
+   * Check that the packet was sent once the fluid ahead was served
+   * \param queue the queue disc
+   */
+  void DequeuePacket (Ptr<RioQueueDisc> queue);
+
+  uint32_t m_samples;        //!< number of samples
+  double m_rateIn;           //!< sum of the IN rates, in bps
+  double m_rateOut;          //!< sum of the OUT rates, in bps
+  double m_fluidQueue;       //!< sum of the fluid backlogs
+  double m_maxFluidQueue;    //!< max fluid backlog
+};
+
+RioQueueDiscFluidTestCase::RioQueueDiscFluidTestCase ()
+  : TestCase ("Sanity check on the fluid flows of the rio queue implementation"),
+    m_samples (0),
+    m_rateIn (0),
+    m_rateOut (0),
+    m_fluidQueue (0),
+    m_maxFluidQueue (0)
+{
+}
+
+void
+RioQueueDiscFluidTestCase::Sample (Ptr<RioQueueDisc> queue)
+{
+  m_samples++;
+  m_rateIn += queue->GetFluidRate (0).GetBitRate ();
+  m_rateOut += queue->GetFluidRate (1).GetBitRate ();
+  m_fluidQueue += queue->GetFluidQueueSize ();
+  m_maxFluidQueue = std::max (m_maxFluidQueue, queue->GetFluidQueueSize ());
+}
+
+void
+RioQueueDiscFluidTestCase::EnqueuePacket (Ptr<RioQueueDisc> queue, Ptr<NetDevice> dev)
+{
+  NS_TEST_ASSERT_MSG_GT (queue->GetFluidQueueSize (), 1, "Some fluid should be queued");
+  Ipv4Header hdr;
+  hdr.SetDscp (Ipv4Header::DSCP_AF11);
+  Ptr<TrafficControlLayer> tc = dev->GetNode ()->GetObject<TrafficControlLayer> ();
+  tc->Send (dev, Create<Ipv4QueueDiscItem> (Create<Packet> (1000), Mac48Address::GetBroadcast (), 0, hdr));
+  NS_TEST_ASSERT_MSG_EQ (queue->GetNPackets (), 1, "The packet should wait for the fluid ahead");
+  NS_TEST_EXPECT_MSG_EQ (queue->Peek (), 0, "The packet should not be peeked before the fluid ahead");
+  NS_TEST_EXPECT_MSG_EQ (queue->Dequeue (), 0, "The packet should not be dequeued before the fluid ahead");
+}
+
+void
+RioQueueDiscFluidTestCase::DequeuePacket (Ptr<RioQueueDisc> queue)
+{
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 0, "The packet should have been sent to the device");
+}
+
+void
+RioQueueDiscFluidTestCase::DoRun (void)
+{
+  uint32_t limit = 100;
+  uint32_t pktSize = 1000;
+  DataRate linkRate ("10Mbps");
+
+  // the queue disc runs itself when the fluid ahead of a packet has been
+  // served, so it is installed on a device
+  Ptr<Node> node = CreateObject<Node> ();
+  node->AggregateObject (CreateObject<TrafficControlLayer> ());
+  Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+  node->AddDevice (dev);
+  dev->SetChannel (CreateObject<SimpleChannel> ());
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::RioQueueDisc");
+  Ptr<RioQueueDisc> queue = DynamicCast<RioQueueDisc> (tch.Install (dev).Get (0));
+
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Mode", StringValue ("QUEUE_DISC_MODE_PACKETS")), true,
+                         "Verify that we can actually set the attribute Mode");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("QueueLimit", UintegerValue (limit)), true,
+                         "Verify that we can actually set the attribute QueueLimit");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MeanPktSize", UintegerValue (pktSize)), true,
+                         "Verify that we can actually set the attribute MeanPktSize");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("LinkBandwidth", DataRateValue (linkRate)), true,
+                         "Verify that we can actually set the attribute LinkBandwidth");
+  queue->Initialize ();
+
+  NS_TEST_EXPECT_MSG_EQ (queue->AddFluidFlows (20, MilliSeconds (100), true), 0, "Unexpected group index");
+  NS_TEST_EXPECT_MSG_EQ (queue->AddFluidFlows (20, MilliSeconds (100), false), 1, "Unexpected group index");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNFluidGroups (), 2, "Unexpected number of groups");
+
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      Simulator::Schedule (Seconds (10 + i * 0.01), &RioQueueDiscFluidTestCase::Sample, this, queue);
+    }
+  Simulator::Schedule (Seconds (20.005), &RioQueueDiscFluidTestCase::EnqueuePacket, this, queue, dev);
+  // the fluid ahead of the packet is served within limit / capacity
+  Simulator::Schedule (Seconds (20.005 + limit * pktSize * 8.0 / linkRate.GetBitRate ()),
+                       &RioQueueDiscFluidTestCase::DequeuePacket, this, queue);
+  Simulator::Stop (Seconds (21));
+  Simulator::Run ();
+
+  double rateIn = m_rateIn / m_samples;
+  double rateOut = m_rateOut / m_samples;
+  NS_TEST_EXPECT_MSG_GT (rateIn, rateOut, "The IN flows should get more than the OUT flows");
+  NS_TEST_EXPECT_MSG_GT (rateIn + rateOut, 0.9 * linkRate.GetBitRate (), "The fluid should fill the link");
+  NS_TEST_EXPECT_MSG_LT (rateIn + rateOut, 1.5 * linkRate.GetBitRate (), "The fluid should back off");
+  NS_TEST_EXPECT_MSG_GT (m_fluidQueue / m_samples, 0, "Some fluid should be queued");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (m_maxFluidQueue, limit, "The fluid should fit in the queue");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Rio Queue Disc Test Case for the pcapng annotation of the drops
+ *
+ * The packets which overflow the queue are forced drops of a known class,
+ * and must be annotated as such in the pcapng file.
+ */
+class RioQueueDiscPcapNgTestCase : public TestCase
+{
+public:
+  RioQueueDiscPcapNgTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Enqueue a packet
+   * \param queue the queue disc
+   * \param dscp the DSCP of the packet, which selects its class
+   */
+  void Enqueue (Ptr<RioQueueDisc> queue, Ipv4Header::DscpType dscp);
+  /**
+   * Count the occurrences of a string
+   * \param content the string to search
+   * \param s the string to count
+   * \returns the number of occurrences
+   */
+  uint32_t Count (std::string const &content, std::string const &s);
+};
+
+RioQueueDiscPcapNgTestCase::RioQueueDiscPcapNgTestCase ()
+  : TestCase ("Check the pcapng annotation of the queue overflows of the rio queue implementation")
+{
+}
+
+void
+RioQueueDiscPcapNgTestCase::Enqueue (Ptr<RioQueueDisc> queue, Ipv4Header::DscpType dscp)
+{
+  Address dest;
+  Ipv4Header hdr;
+  hdr.SetDscp (dscp);
+  queue->Enqueue (Create<Ipv4QueueDiscItem> (Create<Packet> (400), dest, 0, hdr));
+}
+
+uint32_t
+RioQueueDiscPcapNgTestCase::Count (std::string const &content, std::string const &s)
+{
+  uint32_t n = 0;
+  for (std::string::size_type pos = content.find (s); pos != std::string::npos; pos = content.find (s, pos + 1))
+    {
+      n++;
+    }
+  return n;
+}
+
+void
+RioQueueDiscPcapNgTestCase::DoRun (void)
+{
+  Ptr<RioQueueDisc> queue = CreateObject<RioQueueDisc> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("Mode", StringValue ("QUEUE_DISC_MODE_BYTES")), true,
+                         "Verify that we can actually set the attribute Mode");
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("QueueLimit", UintegerValue (1000)), true,
+                         "Verify that we can actually set the attribute QueueLimit");
+  queue->SetTh (500, 900, 500, 900);
+  queue->Initialize ();
+
+  std::string filename = CreateTempDirFilename ("rio-queue-disc.pcapng");
+  Ptr<PcapNgFileWrapper> file = CreateObject<PcapNgFileWrapper> ();
+  file->Open (filename);
+  NS_TEST_ASSERT_MSG_EQ (file->Fail (), false, "Open (" << filename << ") returns error");
+  TrafficControlHelper::EnablePcapNg (file, QueueDiscContainer (queue));
+
+  // two packets of 420 bytes fill the queue, whose average size stays
+  // below the thresholds: the next ones overflow the internal queue
+  Enqueue (queue, Ipv4Header::DSCP_AF11);
+  Enqueue (queue, Ipv4Header::DscpDefault);
+  Enqueue (queue, Ipv4Header::DSCP_AF11);
+  Enqueue (queue, Ipv4Header::DscpDefault);
+  Enqueue (queue, Ipv4Header::DscpDefault);
+  file->Close ();
+
+  RioQueueDisc::Stats st = queue->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (st.unforcedDrop + st.forcedDrop, 0, "No RED drops expected");
+  NS_TEST_EXPECT_MSG_EQ (st.qLimDrop, 3, "Unexpected number of queue overflows");
+
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  std::stringstream ss;
+  ss << is.rdbuf ();
+  std::string content = ss.str ();
+  NS_TEST_EXPECT_MSG_EQ (Count (content, "RIO IN forced-drop"), 1, "Unexpected number of IN overflows");
+  NS_TEST_EXPECT_MSG_EQ (Count (content, "RIO OUT forced-drop"), 2, "Unexpected number of OUT overflows");
+  NS_TEST_EXPECT_MSG_EQ (Count (content, "drop"), 3, "Overflows should not be annotated as plain drops");
+  std::remove (filename.c_str ());
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup traffic-control-test
  * \ingroup tests
@@ -333,5 +690,8 @@ public:
     : TestSuite ("rio-queue-disc", UNIT)
   {
     AddTestCase (new RioQueueDiscTestCase (), TestCase::QUICK);
+    AddTestCase (new RioQueueDiscStepMarkingTestCase (), TestCase::QUICK);
+    AddTestCase (new RioQueueDiscFluidTestCase (), TestCase::QUICK);
+    AddTestCase (new RioQueueDiscPcapNgTestCase (), TestCase::QUICK);
   }
 } g_rioQueueTestSuite; ///< the test suite
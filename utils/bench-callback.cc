@@ -0,0 +1,146 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to measure the cost of creating, copying and
+// invoking Callbacks.
+// Sample usage:  ./waf --run 'bench-callback --n=10000000'
+//
+// The program times the creation of member function, function and bound
+// Callbacks, like those created for each packet by the receive paths of
+// the devices and sockets, and the copy and invocation of a member
+// function Callback.
+
+#include "ns3/core-module.h"
+#include <iostream>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+/**
+ * The object of the member function Callbacks.
+ */
+class BenchReceiver
+{
+public:
+  BenchReceiver ()
+    : m_received (0)
+  {
+  }
+  /**
+   * Receive a value.
+   * \param value the value
+   */
+  void Receive (uint32_t value)
+  {
+    m_received += value;
+  }
+  uint64_t m_received; //!< the sum of the values received
+};
+
+static uint64_t g_received = 0; //!< the sum of the values received
+
+/**
+ * Receive a value.
+ * \param value the value
+ */
+static void
+Receive (uint32_t value)
+{
+  g_received += value;
+}
+
+/**
+ * Receive a value and a bound value.
+ * \param bound the bound value
+ * \param value the value
+ */
+static void
+ReceiveBound (uint32_t bound, uint32_t value)
+{
+  g_received += bound + value;
+}
+
+/**
+ * Print the time taken by some operations.
+ * \param name the name of the operations
+ * \param n the number of operations
+ * \param ms the time taken, in milliseconds
+ */
+static void
+PrintTime (std::string name, uint32_t n, int64_t ms)
+{
+  std::cout << name << ": " << ms * 1e6 / n << " ns per callback" << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 10000000;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the creation, copy and invocation of Callbacks");
+  cmd.AddValue ("n", "number of callbacks", n);
+  cmd.Parse (argc, argv);
+
+  if (n < 1)
+    {
+      std::cerr << "Error-- n must be at least 1" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-callback with n=" << n << std::endl;
+
+  BenchReceiver receiver;
+  SystemWallClockMs time;
+
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      MakeCallback (&BenchReceiver::Receive, &receiver) (i);
+    }
+  PrintTime ("Create and invoke member function", n, time.End ());
+
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      MakeCallback (&Receive) (i);
+    }
+  PrintTime ("Create and invoke function", n, time.End ());
+
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      MakeBoundCallback (&ReceiveBound, i) (i);
+    }
+  PrintTime ("Create and invoke bound function", n, time.End ());
+
+  Callback<void, uint32_t> callback = MakeCallback (&BenchReceiver::Receive, &receiver);
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Callback<void, uint32_t> copy = callback;
+      copy (i);
+    }
+  PrintTime ("Copy and invoke member function", n, time.End ());
+
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      callback (i);
+    }
+  PrintTime ("Invoke member function", n, time.End ());
+
+  std::cout << "Received " << receiver.m_received + g_received << std::endl;
+  return 0;
+}
@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to measure the cost of the Config path
+// resolution when trace sinks are connected to 'n' nodes.
+// Sample usage:  ./waf --run 'bench-config --n=2000'
+//
+// Each node has a SimpleNetDevice. The program times the connection of a
+// trace sink to each device through a path naming its node, through a
+// wildcard path, through a Config::CompiledPath, and through a path naming
+// a type that no node has.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/simple-net-device.h"
+#include <iostream>
+#include <sstream>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+static uint64_t g_drops = 0; //!< number of drops traced
+
+/**
+ * Count a dropped packet.
+ * \param packet the packet
+ */
+static void
+CountDrop (Ptr<const Packet> packet)
+{
+  g_drops++;
+}
+
+/**
+ * Print the time taken by some connections.
+ * \param name the name of the connections
+ * \param n the number of connections
+ * \param ms the time taken, in milliseconds
+ */
+static void
+PrintTime (std::string name, uint32_t n, int64_t ms)
+{
+  std::cout << name << ": " << n << " connections in " << ms << " ms" << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 2000;
+  uint32_t repeat = 10;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the Config path resolution");
+  cmd.AddValue ("n", "number of nodes", n);
+  cmd.AddValue ("repeat", "number of wildcard connections", repeat);
+  cmd.Parse (argc, argv);
+
+  if (n < 1)
+    {
+      std::cerr << "Error-- n must be at least 1" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-config with n=" << n << std::endl;
+
+  NodeContainer nodes;
+  nodes.Create (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      nodes.Get (i)->AddDevice (CreateObject<SimpleNetDevice> ());
+    }
+
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      std::ostringstream oss;
+      oss << "/NodeList/" << i << "/DeviceList/0/$ns3::SimpleNetDevice/PhyRxDrop";
+      Config::ConnectWithoutContext (oss.str (), MakeCallback (&CountDrop));
+    }
+  PrintTime ("Per-node paths", n, time.End ());
+
+  std::string wildcard = "/NodeList/*/DeviceList/*/$ns3::SimpleNetDevice/PhyRxDrop";
+  time.Start ();
+  for (uint32_t i = 0; i < repeat; i++)
+    {
+      Config::ConnectWithoutContext (wildcard, MakeCallback (&CountDrop));
+    }
+  PrintTime ("Wildcard paths", repeat * n, time.End ());
+
+  time.Start ();
+  Config::CompiledPath path (wildcard);
+  for (uint32_t i = 0; i < repeat; i++)
+    {
+      path.ConnectWithoutContext (MakeCallback (&CountDrop));
+    }
+  PrintTime ("Compiled wildcard path", repeat * n, time.End ());
+
+  // no PacketSocketFactory is installed on the nodes
+  time.Start ();
+  for (uint32_t i = 0; i < repeat; i++)
+    {
+      Config::ConnectWithoutContext ("/NodeList/*/$ns3::PacketSocketFactory/Unknown", MakeCallback (&CountDrop));
+    }
+  PrintTime ("Wildcard paths without live objects", 0, time.End ());
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,196 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the endpoint demultiplexers of a
+// server with 'n' established connections, as in an incast experiment.
+// Sample usage:  ./waf --run 'bench-end-point-demux --n=50000'
+//
+// The server listens on port 80 and has accepted n connections from
+// distinct clients. For each delivery the demux looks up the endpoint of
+// a segment sent by one of the clients, as TcpL4Protocol::Receive does.
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include <iostream>
+#include <limits>
+#include <algorithm>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+static const uint16_t SERVER_PORT = 80;        //!< port of the server
+static const uint16_t FIRST_CLIENT_PORT = 49152; //!< first port of the clients
+
+/**
+ * \param i the index of a client
+ * \returns the IPv4 address of the client
+ */
+static Ipv4Address
+GetClientAddress (uint32_t i)
+{
+  // 1000 clients per address, on 10.1.0.0/16
+  return Ipv4Address ((10 << 24) | (1 << 16) | (i / 1000 + 2));
+}
+
+/**
+ * \param i the index of a client
+ * \returns the IPv6 address of the client
+ */
+static Ipv6Address
+GetClientAddress6 (uint32_t i)
+{
+  uint8_t buf[16] = { 0x20, 0x01, 0x0d, 0xb8 };
+  buf[14] = ((i / 1000 + 2) >> 8) & 0xff;
+  buf[15] = (i / 1000 + 2) & 0xff;
+  return Ipv6Address (buf);
+}
+
+/**
+ * \param i the index of a client
+ * \returns the port of the client
+ */
+static uint16_t
+GetClientPort (uint32_t i)
+{
+  return FIRST_CLIENT_PORT + i % 1000;
+}
+
+/**
+ * Deliver packets to n established IPv4 connections.
+ * \param n the number of connections
+ * \param packets the number of packets to deliver
+ * \returns the number of packets delivered
+ */
+static uint32_t
+benchIpv4 (uint32_t n, uint32_t packets)
+{
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  Ipv4Address server ("10.0.0.1");
+  interface->AddAddress (Ipv4InterfaceAddress (server, Ipv4Mask ("255.255.0.0")));
+
+  Ipv4EndPointDemux demux;
+  demux.Allocate (SERVER_PORT);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      demux.Allocate (server, SERVER_PORT, GetClientAddress (i), GetClientPort (i));
+    }
+
+  uint32_t delivered = 0;
+  for (uint32_t p = 0; p < packets; p++)
+    {
+      // visit the connections with a stride, as interleaved flows would
+      uint32_t i = (p * 7919) % n;
+      Ipv4EndPointDemux::EndPoints endPoints =
+        demux.Lookup (server, SERVER_PORT, GetClientAddress (i), GetClientPort (i), interface);
+      delivered += endPoints.size ();
+    }
+  return delivered;
+}
+
+/**
+ * Deliver packets to n established IPv6 connections.
+ * \param n the number of connections
+ * \param packets the number of packets to deliver
+ * \returns the number of packets delivered
+ */
+static uint32_t
+benchIpv6 (uint32_t n, uint32_t packets)
+{
+  Ipv6Address server ("2001:db8::1");
+
+  Ipv6EndPointDemux demux;
+  demux.Allocate (SERVER_PORT);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      demux.Allocate (server, SERVER_PORT, GetClientAddress6 (i), GetClientPort (i));
+    }
+
+  uint32_t delivered = 0;
+  for (uint32_t p = 0; p < packets; p++)
+    {
+      uint32_t i = (p * 7919) % n;
+      Ipv6EndPointDemux::EndPoints endPoints =
+        demux.Lookup (server, SERVER_PORT, GetClientAddress6 (i), GetClientPort (i), 0);
+      delivered += endPoints.size ();
+    }
+  return delivered;
+}
+
+/**
+ * Run a benchmark and print the delivery rate.
+ * \param bench the benchmark function
+ * \param n the number of connections
+ * \param packets the number of packets to deliver
+ * \param minIterations number of runs to take the fastest from
+ * \param name the benchmark name
+ */
+static void
+runBench (uint32_t (*bench) (uint32_t, uint32_t), uint32_t n, uint32_t packets,
+          uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  uint32_t delivered = 0;
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      delivered = bench (n, packets);
+      uint64_t delay = time.End ();
+      minDelay = std::min (minDelay, delay);
+    }
+  if (delivered != packets)
+    {
+      std::cerr << "Error-- " << delivered << " packets delivered out of " << packets << std::endl;
+      exit (1);
+    }
+  double ps = packets;
+  ps *= 1000;
+  ps /= std::max (minDelay, (uint64_t) 1);
+  std::cout << ps << " packets/s"
+            << " (" << minDelay << " ms elapsed, including setup)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 50000;
+  uint32_t packets = 1000000;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the delivery of packets to established connections");
+  cmd.AddValue ("n", "number of established connections", n);
+  cmd.AddValue ("packets", "number of packets to deliver", packets);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- n must be positive" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-end-point-demux with n=" << n << std::endl;
+
+  runBench (benchIpv4, n, packets, minIterations, "Ipv4EndPointDemux");
+  runBench (benchIpv6, n, packets, minIterations, "Ipv6EndPointDemux");
+
+  return 0;
+}
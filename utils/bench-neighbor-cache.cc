@@ -0,0 +1,194 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to measure the cost of address resolution in a
+// LAN of 'n' nodes, with and without the caches populated by the
+// NeighborCacheHelper.
+// Sample usage:  ./waf --run 'bench-neighbor-cache --n=1000'
+//
+// The nodes share a CSMA channel, and each node sends a UDP datagram to the
+// next one. The program prints the number of events scheduled by the
+// simulation (including the events of the address assignment, e.g., the
+// IPv6 Duplicate Address Detection, which is disabled when the caches are
+// populated) and the number of frames received by the nodes.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/csma-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/neighbor-cache-helper.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include <iostream>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+static uint64_t g_frames = 0; //!< number of frames received by the nodes
+
+/**
+ * Count a received frame.
+ * \param device the receiving device
+ * \param packet the frame payload
+ * \param protocol the protocol number
+ * \param from the source address
+ * \param to the destination address
+ * \param type the packet type
+ */
+static void
+CountFrame (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+            const Address &from, const Address &to, NetDevice::PacketType type)
+{
+  g_frames++;
+}
+
+/**
+ * Do nothing; used to mark the event count.
+ */
+static void
+Nop (void)
+{
+}
+
+/**
+ * Send a datagram.
+ * \param socket the sending socket
+ * \param to the destination
+ */
+static void
+Send (Ptr<Socket> socket, Address to)
+{
+  socket->SendTo (Create<Packet> (100), 0, to);
+}
+
+/**
+ * Simulate the LAN and print the number of events and frames.
+ * \param n the number of nodes
+ * \param ipv6 whether the datagrams are sent over IPv6
+ * \param populate whether the caches are populated by the helper
+ */
+static void
+runBench (uint32_t n, bool ipv6, bool populate)
+{
+  // with static caches the IPv6 addresses need no message at startup
+  Config::SetDefault ("ns3::Icmpv6L4Protocol::DAD", BooleanValue (!populate));
+
+  g_frames = 0;
+  NodeContainer nodes;
+  nodes.Create (n);
+  uint32_t firstUid = Simulator::Schedule (Seconds (0), &Nop).GetUid ();
+
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (!ipv6);
+  internet.SetIpv6StackInstall (ipv6);
+  internet.Install (nodes);
+
+  CsmaHelper csma;
+  csma.SetChannelAttribute ("DataRate", StringValue ("1Gbps"));
+  csma.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (1)));
+  NetDeviceContainer devices = csma.Install (nodes);
+
+  std::vector<Address> addresses;
+  if (ipv6)
+    {
+      Ipv6AddressHelper address (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+      Ipv6InterfaceContainer interfaces = address.Assign (devices);
+      for (uint32_t i = 0; i < n; i++)
+        {
+          addresses.push_back (Inet6SocketAddress (interfaces.GetAddress (i, 1), 9));
+        }
+    }
+  else
+    {
+      Ipv4AddressHelper address ("10.0.0.0", "255.0.0.0");
+      Ipv4InterfaceContainer interfaces = address.Assign (devices);
+      for (uint32_t i = 0; i < n; i++)
+        {
+          addresses.push_back (InetSocketAddress (interfaces.GetAddress (i), 9));
+        }
+    }
+
+  SystemWallClockMs time;
+  time.Start ();
+  if (populate)
+    {
+      NeighborCacheHelper neighborCache;
+      neighborCache.PopulateNeighborCache ();
+    }
+  uint64_t populateDelay = time.End ();
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Node> node = nodes.Get (i);
+      node->RegisterProtocolHandler (MakeCallback (&CountFrame), 0, 0);
+      Ptr<Socket> rxSocket = Socket::CreateSocket (node, UdpSocketFactory::GetTypeId ());
+      if (ipv6)
+        {
+          rxSocket->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), 9));
+        }
+      else
+        {
+          rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+        }
+      Ptr<Socket> txSocket = Socket::CreateSocket (node, UdpSocketFactory::GetTypeId ());
+      Simulator::ScheduleWithContext (i, Seconds (2) + MicroSeconds (i), &Send, txSocket, addresses[(i + 1) % n]);
+    }
+
+  time.Start ();
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  uint64_t runDelay = time.End ();
+  uint32_t events = Simulator::Schedule (Seconds (0), &Nop).GetUid () - firstUid - 1;
+  Simulator::Destroy ();
+
+  std::cout << (ipv6 ? "IPv6" : "IPv4")
+            << (populate ? " static caches:  " : " dynamic caches: ")
+            << events << " events, "
+            << g_frames << " frames, "
+            << runDelay << " ms elapsed";
+  if (populate)
+    {
+      std::cout << " (+" << populateDelay << " ms to populate the caches)";
+    }
+  std::cout << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 1000;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the address resolution in a CSMA LAN");
+  cmd.AddValue ("n", "number of nodes", n);
+  cmd.Parse (argc, argv);
+
+  if (n < 2)
+    {
+      std::cerr << "Error-- n must be at least 2" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-neighbor-cache with n=" << n << std::endl;
+
+  runBench (n, false, false);
+  runBench (n, false, true);
+  runBench (n, true, false);
+  runBench (n, true, true);
+
+  return 0;
+}
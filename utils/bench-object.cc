@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to measure the cost of Object::GetObject and
+// TypeId::IsChildOf.
+// Sample usage:  ./waf --run 'bench-object --n=10000000'
+//
+// An object is aggregated with 'aggregates' objects of other types, like a
+// node with its protocols, and the program times the lookup of the last
+// aggregated type, of a parent type, and of a type which is not aggregated.
+
+#include "ns3/core-module.h"
+#include <iostream>
+#include <sstream>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+/**
+ * The parent of the aggregated objects.
+ */
+class BenchBase : public Object
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("BenchBase")
+      .SetParent<Object> ()
+      .HideFromDocumentation ();
+    return tid;
+  }
+};
+
+/**
+ * An aggregated object; each N is a different type.
+ */
+template <int N>
+class BenchObject : public BenchBase
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId (GetName ().c_str ())
+      .SetParent<BenchBase> ()
+      .HideFromDocumentation ();
+    return tid;
+  }
+  /**
+   * \return The name of this type.
+   */
+  static std::string GetName (void)
+  {
+    std::ostringstream oss;
+    oss << "BenchObject" << N;
+    return oss.str ();
+  }
+};
+
+/**
+ * Aggregate a new object to an object, if there are fewer than some
+ * number of aggregates.
+ * \param object the object
+ * \param aggregates the number of aggregates
+ * \param last the type of the last aggregated object
+ */
+template <int N>
+static void
+Aggregate (Ptr<Object> object, uint32_t aggregates, TypeId *last)
+{
+  if ((uint32_t) N < aggregates)
+    {
+      object->AggregateObject (CreateObject<BenchObject<N> > ());
+      *last = BenchObject<N>::GetTypeId ();
+    }
+}
+
+/**
+ * Time a lookup.
+ * \param name the name of the lookup
+ * \param object the object to look up from
+ * \param tid the type to look up
+ * \param n the number of lookups
+ */
+static void
+TimeGetObject (std::string name, Ptr<Object> object, TypeId tid, uint32_t n)
+{
+  uint32_t found = 0;
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      found += (object->GetObject<Object> (tid) != 0);
+    }
+  int64_t ms = time.End ();
+  std::cout << name << ": " << ms * 1e6 / n << " ns per lookup ("
+            << found << " found)" << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 10000000;
+  uint32_t aggregates = 8;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark Object::GetObject and TypeId::IsChildOf");
+  cmd.AddValue ("n", "number of lookups", n);
+  cmd.AddValue ("aggregates", "number of aggregated objects, up to 8", aggregates);
+  cmd.Parse (argc, argv);
+
+  if (aggregates < 1 || aggregates > 8)
+    {
+      std::cerr << "Error-- aggregates must be in [1,8]" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-object with n=" << n
+            << ", aggregates=" << aggregates << std::endl;
+
+  Ptr<Object> object = CreateObject<Object> ();
+  TypeId last;
+  Aggregate<0> (object, aggregates, &last);
+  Aggregate<1> (object, aggregates, &last);
+  Aggregate<2> (object, aggregates, &last);
+  Aggregate<3> (object, aggregates, &last);
+  Aggregate<4> (object, aggregates, &last);
+  Aggregate<5> (object, aggregates, &last);
+  Aggregate<6> (object, aggregates, &last);
+  Aggregate<7> (object, aggregates, &last);
+
+  TimeGetObject ("Aggregated type", object, last, n);
+  TimeGetObject ("Parent type", object, BenchBase::GetTypeId (), n);
+  TimeGetObject ("Missing type", object, BenchObject<8>::GetTypeId (), n);
+
+  uint32_t children = 0;
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      children += last.IsChildOf (Object::GetTypeId ());
+    }
+  int64_t ms = time.End ();
+  std::cout << "TypeId::IsChildOf: " << ms * 1e6 / n << " ns per call ("
+            << children << " true)" << std::endl;
+
+  object->Dispose ();
+  return 0;
+}
@@ -21,6 +21,11 @@
 // This program can be used to benchmark packet serialization/deserialization
 // operations using Headers and Tags, for various numbers of packets 'n'
 // Sample usage:  ./waf --run 'bench-packets --n=10000'
+//
+// It also reports the memory held by a queue of packets, which can be
+// used to compare the packet metadata modes:
+//   ./waf --run 'bench-packets --n=10000 --enable-printing'
+//   ./waf --run 'bench-packets --n=10000 --compact-metadata'
 
 #include "ns3/command-line.h"
 #include "ns3/system-wall-clock-ms.h"
@@ -32,9 +37,46 @@
 #include <stdlib.h> // for exit ()
 #include <limits>
 #include <algorithm>
+#include <vector>
+#include <new>
 
 using namespace ns3;
 
+/// number of bytes currently allocated with operator new
+static uint64_t g_liveBytes = 0;
+
+/**
+ * The global allocation functions are replaced to keep track of the
+ * number of bytes in use. Each block is prefixed with its size, in a
+ * slot large enough to keep the returned pointer suitably aligned.
+ */
+static const size_t ALLOCATION_PREFIX = 16;
+
+void *
+operator new (size_t size)
+{
+  uint8_t *buf = static_cast<uint8_t *> (malloc (size + ALLOCATION_PREFIX));
+  if (buf == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  *reinterpret_cast<size_t *> (buf) = size;
+  g_liveBytes += size;
+  return buf + ALLOCATION_PREFIX;
+}
+
+void
+operator delete (void *p) throw ()
+{
+  if (p == 0)
+    {
+      return;
+    }
+  uint8_t *buf = static_cast<uint8_t *> (p) - ALLOCATION_PREFIX;
+  g_liveBytes -= *reinterpret_cast<size_t *> (buf);
+  free (buf);
+}
+
 /// BenchHeader class used for benchmarking packet serialization/deserialization
 template <int N>
 class BenchHeader : public Header
@@ -328,6 +370,29 @@ benchByteTags (uint32_t n)
     }
 }
 
+static void
+benchQueueMemory (uint32_t queueSize, char const *name)
+{
+  BenchHeader<25> ipv4;
+  BenchHeader<8> udp;
+
+  std::vector<Ptr<Packet> > queue;
+  queue.reserve (queueSize);
+  uint64_t before = g_liveBytes;
+  for (uint32_t i = 0; i < queueSize; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      p->AddHeader (udp);
+      p->AddHeader (ipv4);
+      queue.push_back (p);
+    }
+  uint64_t used = g_liveBytes - before;
+  std::cout << used / queueSize << " bytes/packet"
+            << " (" << used << " bytes for " << queueSize << " queued packets)\t"
+            << name
+            << std::endl;
+}
+
 static uint64_t
 runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 {
@@ -362,12 +427,16 @@ int main (int argc, char *argv[])
   uint32_t n = 0;
   uint32_t minIterations = 1;
   bool enablePrinting = false;
+  bool compactMetadata = false;
+  uint32_t queueSize = 10000;
 
   CommandLine cmd;
   cmd.Usage ("Benchmark Packet class");
   cmd.AddValue ("n", "number of iterations", n);
   cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
   cmd.AddValue ("enable-printing", "enable packet printing", enablePrinting);
+  cmd.AddValue ("compact-metadata", "enable packet printing with the compact metadata mode", compactMetadata);
+  cmd.AddValue ("queue-size", "number of packets queued by the memory benchmark", queueSize);
   cmd.Parse (argc, argv);
 
   if (n == 0)
@@ -376,15 +445,27 @@ int main (int argc, char *argv[])
         "by command-line argument --n=(number of packets)" << std::endl;
       exit (1);
     }
+  if (compactMetadata)
+    {
+      Packet::EnableCompactPrinting ();
+    }
+  else if (enablePrinting)
+    {
+      Packet::EnablePrinting ();
+    }
   std::cout << "Running bench-packets with n=" << n << std::endl;
   std::cout << "All tests begin by adding UDP and IPv4 headers." << std::endl;
 
+  benchQueueMemory (queueSize, "Queue memory footprint");
   runBench (&benchA, n, minIterations, "Copy packet, remove headers");
   runBench (&benchB, n, minIterations, "Just add headers");
   runBench (&benchC, n, minIterations, "Remove by func call");
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  // the metadata buffers of the packets created from now on are sized
+  // after the largest metadata seen so far (here, the fragments).
+  benchQueueMemory (queueSize, "Queue memory footprint, after fragmentation");
 
   return 0;
 }
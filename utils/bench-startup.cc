@@ -0,0 +1,79 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to measure the startup time of a program
+// linked against all the modules.
+// Sample usage:  ./waf --run 'bench-startup --n=100'
+//
+// The program runs itself 'n' times with --n=0, which makes it return as
+// soon as it starts, and times these runs. With --lookup, each run also
+// looks up a TypeId by name, like a program which sets a default value.
+
+#include "ns3/core-module.h"
+#include <iostream>
+#include <sstream>
+#include <stdlib.h> // for exit () and system ()
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 100;
+  std::string lookup = "";
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the startup of a program linked against all the modules");
+  cmd.AddValue ("n", "number of runs, or 0 to return immediately", n);
+  cmd.AddValue ("lookup", "name of a TypeId to look up in each run", lookup);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      if (lookup != "")
+        {
+          TypeId::LookupByName (lookup);
+        }
+      return 0;
+    }
+  std::cout << "Running bench-startup with n=" << n;
+  if (lookup != "")
+    {
+      std::cout << ", lookup=" << lookup;
+    }
+  std::cout << std::endl;
+
+  std::ostringstream command;
+  command << "\"" << argv[0] << "\" --n=0";
+  if (lookup != "")
+    {
+      command << " --lookup=" << lookup;
+    }
+
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      if (system (command.str ().c_str ()) != 0)
+        {
+          std::cerr << "Error-- " << command.str () << " failed" << std::endl;
+          exit (1);
+        }
+    }
+  int64_t ms = time.End ();
+  std::cout << "Startup: " << (double) ms / n << " ms per run" << std::endl;
+  std::cout << "Registered TypeIds: " << TypeId::GetRegisteredN () << std::endl;
+  return 0;
+}
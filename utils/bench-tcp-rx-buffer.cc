@@ -0,0 +1,152 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the TcpRxBuffer with a large
+// window, 'n' segments, received out of order.
+// Sample usage:  ./waf --run 'bench-tcp-rx-buffer --n=10000'
+//
+// The segments of each window are received in a random order, in packet
+// mode and in ring buffer mode; the application reads the available data
+// after every segment, as TcpSocketBase does when it notifies the receiver.
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-rx-buffer.h"
+#include "ns3/random-variable-stream.h"
+#include <iostream>
+#include <limits>
+#include <algorithm>
+#include <vector>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+static const uint32_t SEGMENT_SIZE = 1448; //!< segment size
+
+/**
+ * Receive 'windows' windows of n segments each.
+ * \param n the number of segments in a window
+ * \param windows the number of windows received
+ * \param reorder the maximum distance of a segment from its place
+ * \param ringBuffer true to use the ring buffer mode
+ * \returns the number of segments received
+ */
+static uint32_t
+benchSegments (uint32_t n, uint32_t windows, uint32_t reorder, bool ringBuffer)
+{
+  Ptr<TcpRxBuffer> rxBuf = CreateObject<TcpRxBuffer> ();
+  rxBuf->SetRingBuffer (ringBuffer);
+  rxBuf->SetMaxBufferSize (n * SEGMENT_SIZE);
+  SequenceNumber32 seq (1);
+  rxBuf->SetNextRxSequence (seq);
+
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  rand->SetStream (1);
+  std::vector<uint32_t> order (n);
+  Ptr<Packet> p = Create<Packet> (SEGMENT_SIZE);
+  TcpHeader h;
+  uint32_t segments = 0;
+  for (uint32_t w = 0; w < windows; ++w)
+    {
+      // each segment is swapped with one at most 'reorder' places ahead
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          order[i] = i;
+        }
+      for (uint32_t i = 0; i + 1 < n && reorder > 0; ++i)
+        {
+          uint32_t j = std::min (i + rand->GetInteger (0, reorder), n - 1);
+          std::swap (order[i], order[j]);
+        }
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          h.SetSequenceNumber (seq + SequenceNumber32 (order[i] * SEGMENT_SIZE));
+          rxBuf->Add (p, h);
+          ++segments;
+          if (rxBuf->Available () > 0)
+            {
+              rxBuf->Extract (rxBuf->Available ());
+            }
+        }
+      seq += n * SEGMENT_SIZE;
+    }
+  return segments;
+}
+
+/**
+ * Run a benchmark and print the segment rate.
+ * \param n the number of segments in a window
+ * \param windows the number of windows received
+ * \param reorder the maximum distance of a segment from its place
+ * \param ringBuffer true to use the ring buffer mode
+ * \param minIterations number of runs to take the fastest from
+ * \param name the benchmark name
+ */
+static void
+runBench (uint32_t n, uint32_t windows, uint32_t reorder, bool ringBuffer,
+          uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  uint32_t segments = 0;
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      segments = benchSegments (n, windows, reorder, ringBuffer);
+      uint64_t delay = time.End ();
+      minDelay = std::min (minDelay, delay);
+    }
+  double ps = segments;
+  ps *= 1000;
+  ps /= std::max (minDelay, (uint64_t) 1);
+  std::cout << ps << " segments/s"
+            << " (" << minDelay << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 1000;
+  uint32_t windows = 10;
+  uint32_t minIterations = 1;
+  uint32_t reorder = 100;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the TcpRxBuffer with out-of-order segments");
+  cmd.AddValue ("n", "number of segments in a window", n);
+  cmd.AddValue ("windows", "number of windows received", windows);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.AddValue ("reorder", "maximum distance of a segment from its place", reorder);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- n must be positive" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-tcp-rx-buffer with n=" << n << std::endl;
+
+  runBench (n, windows, 0, false, minIterations, "In order, packets");
+  runBench (n, windows, 0, true, minIterations, "In order, ring buffer");
+  runBench (n, windows, reorder, false, minIterations, "Reordered, packets");
+  runBench (n, windows, reorder, true, minIterations, "Reordered, ring buffer");
+  runBench (n, windows, n, false, minIterations, "Shuffled window, packets");
+  runBench (n, windows, n, true, minIterations, "Shuffled window, ring buffer");
+
+  return 0;
+}
@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the TcpTxBuffer scoreboard with
+// a large window in flight, 'n' segments, as seen by a SACK sender.
+// Sample usage:  ./waf --run 'bench-tcp-tx-buffer --n=10000'
+//
+// Every 'loss-every' segments one is lost. For each segment which reaches
+// the receiver the sender processes an ACK as TcpSocketBase does: it
+// updates the scoreboard with the SACK blocks, computes the pipe and asks
+// NextSeg for a retransmission.
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-tx-buffer.h"
+#include <iostream>
+#include <limits>
+#include <algorithm>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+static const uint32_t SEGMENT_SIZE = 1448; //!< segment size
+static const uint32_t DUP_THRESH = 3;      //!< duplicate ACK threshold
+
+/**
+ * Send n segments, then process the ACKs of the ones which are not lost.
+ * \param n the number of segments in flight
+ * \param lossEvery one segment every lossEvery is lost, 0 for no losses
+ * \returns the number of ACKs processed
+ */
+static uint32_t
+benchAcks (uint32_t n, uint32_t lossEvery)
+{
+  Ptr<TcpTxBuffer> txBuf = CreateObject<TcpTxBuffer> ();
+  SequenceNumber32 head (1);
+  txBuf->SetHeadSequence (head);
+  txBuf->SetMaxBufferSize (n * SEGMENT_SIZE);
+  txBuf->Add (Create<Packet> (n * SEGMENT_SIZE));
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      txBuf->CopyFromSequence (SEGMENT_SIZE, head + i * SEGMENT_SIZE);
+    }
+
+  uint32_t acks = 0;
+  uint32_t firstLost = lossEvery > 0 ? 0 : n;
+  SequenceNumber32 runStart = head;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      SequenceNumber32 seq = head + i * SEGMENT_SIZE;
+      if (lossEvery > 0 && i % lossEvery == 0)
+        {
+          // the next SACK block starts after the hole
+          runStart = seq + SEGMENT_SIZE;
+          continue;
+        }
+
+      if (i < firstLost)
+        {
+          txBuf->DiscardUpTo (seq + SEGMENT_SIZE);
+        }
+      else
+        {
+          TcpOptionSack::SackList list;
+          list.push_back (TcpOptionSack::SackBlock (runStart, seq + SEGMENT_SIZE));
+          txBuf->Update (list);
+        }
+      ++acks;
+
+      txBuf->BytesInFlight (DUP_THRESH, SEGMENT_SIZE);
+      SequenceNumber32 next;
+      if (txBuf->NextSeg (&next, DUP_THRESH, SEGMENT_SIZE, true)
+          && next < seq && txBuf->IsLost (next, DUP_THRESH, SEGMENT_SIZE))
+        {
+          txBuf->CopyFromSequence (SEGMENT_SIZE, next);
+        }
+    }
+
+  txBuf->DiscardUpTo (head + n * SEGMENT_SIZE);
+  return acks;
+}
+
+/**
+ * Run a benchmark and print the ACK rate.
+ * \param n the number of segments in flight
+ * \param lossEvery one segment every lossEvery is lost, 0 for no losses
+ * \param minIterations number of runs to take the fastest from
+ * \param name the benchmark name
+ */
+static void
+runBench (uint32_t n, uint32_t lossEvery, uint32_t minIterations, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  uint32_t acks = 0;
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      acks = benchAcks (n, lossEvery);
+      uint64_t delay = time.End ();
+      minDelay = std::min (minDelay, delay);
+    }
+  double ps = acks;
+  ps *= 1000;
+  ps /= std::max (minDelay, (uint64_t) 1);
+  std::cout << ps << " acks/s"
+            << " (" << minDelay << " ms elapsed)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 10000;
+  uint32_t minIterations = 1;
+  uint32_t lossEvery = 100;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the TcpTxBuffer scoreboard");
+  cmd.AddValue ("n", "number of segments in flight", n);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.AddValue ("loss-every", "one segment every loss-every is lost", lossEvery);
+  cmd.Parse (argc, argv);
+
+  if (n == 0 || lossEvery == 1)
+    {
+      std::cerr << "Error-- n must be positive and loss-every different from 1" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-tcp-tx-buffer with n=" << n << std::endl;
+
+  runBench (n, 0, minIterations, "Cumulative ACKs, no losses");
+  runBench (n, lossEvery, minIterations, "SACK recovery");
+  runBench (n, 2, minIterations, "SACK recovery, one segment every two lost");
+
+  return 0;
+}
@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to measure the per-packet cost of the trace
+// sources of a queue disc.
+// Sample usage:  ./waf --run 'bench-traced-callback --n=1000000'
+//
+// Packets are enqueued into and dequeued from a PfifoFastQueueDisc while
+// 0, 1 and 4 sinks are connected to its Enqueue trace source. The queue
+// disc and its internal queues fire their other trace sources, which have
+// no sinks, for every packet as well. The program also times a
+// TracedCallback and a TracedValue alone, with the same number of sinks.
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/traffic-control-module.h"
+#include <iostream>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+/**
+ * A queue disc item which carries no header.
+ */
+class BenchQueueDiscItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor.
+   * \param p the packet
+   */
+  BenchQueueDiscItem (Ptr<Packet> p)
+    : QueueDiscItem (p, Address (), 0)
+  {
+  }
+  virtual void AddHeader (void)
+  {
+  }
+  virtual bool Mark (void)
+  {
+    return false;
+  }
+};
+
+static uint64_t g_enqueued = 0; //!< number of enqueues traced
+
+/**
+ * Count an enqueued item.
+ * \param item the item
+ */
+static void
+CountEnqueue (Ptr<const QueueDiscItem> item)
+{
+  g_enqueued++;
+}
+
+/**
+ * Count a change of a value.
+ * \param oldValue the old value
+ * \param newValue the new value
+ */
+static void
+CountChange (uint32_t oldValue, uint32_t newValue)
+{
+  g_enqueued++;
+}
+
+/**
+ * Print the time taken by some operations.
+ * \param name the name of the operations
+ * \param sinks the number of sinks
+ * \param n the number of calls
+ * \param ms the time taken, in milliseconds
+ */
+static void
+PrintTime (std::string name, uint32_t sinks, uint32_t n, int64_t ms)
+{
+  std::cout << name << " with " << sinks << " sinks: " << ms * 1e6 / n
+            << " ns per call (" << g_enqueued << " traced)" << std::endl;
+}
+
+/**
+ * Time the enqueue and dequeue of some packets, and the invocation of a
+ * TracedCallback and of a TracedValue.
+ * \param qdisc the queue disc
+ * \param trace the TracedCallback
+ * \param value the TracedValue
+ * \param sinks the number of sinks connected to each trace source
+ * \param n the number of packets
+ * \param calls the number of invocations of the TracedCallback and of
+ * changes of the TracedValue
+ */
+static void
+TimeTraces (Ptr<QueueDisc> qdisc, const TracedCallback<Ptr<const QueueDiscItem> > &trace,
+            TracedValue<uint32_t> &value, uint32_t sinks, uint32_t n, uint32_t calls)
+{
+  Ptr<Packet> packet = Create<Packet> (1000);
+  SystemWallClockMs time;
+
+  g_enqueued = 0;
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      qdisc->Enqueue (Create<BenchQueueDiscItem> (packet));
+      qdisc->Dequeue ();
+    }
+  PrintTime ("QueueDisc::Enqueue", sinks, n, time.End ());
+
+  Ptr<QueueDiscItem> item = Create<BenchQueueDiscItem> (packet);
+  g_enqueued = 0;
+  time.Start ();
+  for (uint32_t i = 0; i < calls; i++)
+    {
+      trace (item);
+    }
+  PrintTime ("TracedCallback", sinks, calls, time.End ());
+
+  g_enqueued = 0;
+  time.Start ();
+  for (uint32_t i = 0; i < calls; i++)
+    {
+      value++;
+    }
+  PrintTime ("TracedValue", sinks, calls, time.End ());
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 1000000;
+  uint32_t calls = 100000000;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the trace sources of a queue disc");
+  cmd.AddValue ("n", "number of packets", n);
+  cmd.AddValue ("calls", "number of calls of the TracedCallback and TracedValue", calls);
+  cmd.Parse (argc, argv);
+
+  if (n < 1)
+    {
+      std::cerr << "Error-- n must be at least 1" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-traced-callback with n=" << n
+            << ", calls=" << calls << std::endl;
+
+  Ptr<QueueDisc> qdisc = CreateObject<PfifoFastQueueDisc> ();
+  qdisc->Initialize ();
+  TracedCallback<Ptr<const QueueDiscItem> > trace;
+  TracedValue<uint32_t> value = 0;
+
+  uint32_t sinks = 0;
+  uint32_t steps[] = { 0, 1, 4 };
+  for (uint32_t i = 0; i < sizeof (steps) / sizeof (steps[0]); i++)
+    {
+      for (; sinks < steps[i]; sinks++)
+        {
+          qdisc->TraceConnectWithoutContext ("Enqueue", MakeCallback (&CountEnqueue));
+          trace.ConnectWithoutContext (MakeCallback (&CountEnqueue));
+          value.ConnectWithoutContext (MakeCallback (&CountChange));
+        }
+      TimeTraces (qdisc, trace, value, sinks, n, calls);
+    }
+
+  qdisc->Dispose ();
+  return 0;
+}